@@ -1,220 +1,1056 @@
-/*******************************************************************************
-  * @file		main.c
-  * @brief      Generador de señales con entrada por UART
-  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
-  * @detail		Recibe una entrada por UART y la saca por DAC.
-  ******************************************************************************
-  * @attention
-  ******************************************************************************
-  */
-
-/* Includes ------------------------------------------------------------------*/
-#include "main.h"
-#include "string.h"
-
-/* Private define ------------------------------------------------------------*/
-#define LARGO_PAQUETE		5		// Paquete de datos recibidos por UART
-#define LARGO_MAX_PAQUETE	16		// Lo admisible ante error de transmisión
-
-/* Private typedef -----------------------------------------------------------*/
-
-/* Variables privadas ------- ------------------------------------------------*/
-uint32_t Senial[N_MUESTRAS] = {
-		0,6,19,39,66,100,142,190,244,306,373,
-		447,526,611,700,795,894,997,1104,1215,1328,1444,1562,1682,1803,1925,
-		2048,2170,2292,2413,2533,2651,2767,2880,2991,3098,3201,3300,3395,3484,3569,
-		3648,3722,3789,3851,3905,3953,3995,4029,4056,4076,4089,4095,4093,4084,4067,
-		4044,4013,3975,3930,3879,3821,3756,3686,3609,3527,3440,3348,3251,3150,3045,
-		2936,2824,2709,2592,2473,2353,2231,2109,1986,1864,1742,1622,1503,1386,1271,
-		1159,1050,945,844,747,655,568,486,409,339,274,216,165,120,82,
-		51,28,11,2
-};								// Senial inicial y donde se almacenarán nuevas señales
-uint16_t MuestraNro = 0;		// Posición en que se va a almacenar próxima muestra
-
-/* Private function prototypes -----------------------------------------------*/
-void SystemClock_Config(void);
-static void Leer_UART(void);	// <-- Esta rutina lee de a un caracter
-static void Cargar_Paquete(uint8_t PaqueteRecibido[]);
-
-/**
-  * @brief  The application entry point.
-  * @retval int
-  */
-int main(void)
-{
-  /* MCU Configuration--------------------------------------------------------*/
-  HAL_Init();
-  SystemClock_Config();
-
-  /* Inicializacion de periféricos y APIs -------------------------------------*/
-  Inicializar_DAC_DMA();					// DAC con acceso DMA utilizando Timer 2
-  if (uartInit() != true) Error_Handler();	// Conexión con terminal
-  debounceFSM_init();						// MEF antirrebote del pulsador de usuario
-  Gen_Init();								// Inicialización del generador de señal
-
-  /* Inicio... ----------------------------------------------------------------*/
-  uartSendString((uint8_t *) "\nGENERADOR DE SENIAL V1.0\nTiempo entre muestras: 10,5 Msps\nTension: 0V - 3,3V");
-  uartSendString((uint8_t *) "\n\n");
-  Gen_Espera();	// Estado inicial del generador
-
-  /* Infinite loop */
-  /* USER CODE BEGIN WHILE */
-  while (1)
-  {
-	  // Reviso botón de usuario:
-	  debounceFSM_update();
-
-	  // Reviso parpadeo de leds
-	  Gen_Actualiza_Leds();
-
-	  // Si estoy en estado = Recibiendo o Cargado, espero recibir una señal
-	  if (Gen_Estado() == Recibiendo || Gen_Estado() == Cargado) {
-          Leer_UART();
-	  }
-
-	  // Si presionamos el botón de usuario cambiamos de estadoMEF
-	  if (readKeyPush()) {
-		  switch (Gen_Estado()) {
-
-		  case Espera:
-			  Gen_Recibir();
-			  break;
-
-		  case Recibiendo:
-			  // Para salir de este estado, se deben cargar los datos por UART
-			  break;
-
-		  case Cargado:
-			  Gen_Encender();
-			  break;
-
-		  case Generando:
-			  Gen_Pausar();
-			  break;
-
-		  case Pausa:
-			  Gen_Encender();
-			  break;
-
-		  default:
-			  // nada...
-			  break;
-		  }
-	  }
-
-	  // Si hay flanco descendente (señal lógica de 1 a 0), evalúo si fue un pulso largo:
-	  if (readKeyRelease()) {
-		  if ((readPresionadoLargo() == true) &&  Gen_Estado() >= Generando)
-			  Gen_Espera();
-	  }
-   }
-}
-
-/*******************************************************************************
-  * @brief  Lee UART porque espera recibir la señal: números separados por coma
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-static void Leer_UART(void){
-	static uint8_t Buffer[LARGO_MAX_PAQUETE];	//Aquí guardo los caracteres antes de mandar el paquete
-	static uint8_t Buffer_pos=0;
-	uint8_t Leo;
-
-	while (uartReceiveStringSize( &Leo, 1) == true) {
-		// Mientras esté recibiendo por UART me quedo en este loop
-
-		if ( Leo>=48 && Leo<=57 ) {
-			// Es un dígito numérico: Debo almacenarlo en el Buffer
-			Buffer[Buffer_pos] = Leo;
-			Buffer_pos++;
-			Buffer_pos = (Buffer_pos >= LARGO_MAX_PAQUETE) ? (LARGO_MAX_PAQUETE - 1) : Buffer_pos;
-			// Esto último evita corromper la memoria si desde la terminal mandan formatos incorrectos
-
-		} else if (Leo == ',') {
-			// Es el fin de un paquete: Debo cargarlo en la Senial
-			// 1) Le damos formato de string (debe terminar en \0)
-			for (uint16_t i=Buffer_pos; i<LARGO_MAX_PAQUETE; i++) Buffer[i] = '\0';
-			// 2) Enviamos a cargarlo...
-			Cargar_Paquete(Buffer);
-			Buffer_pos=0;
-
-		}   // Si no es número ni ',', no lo considero.
-	}
-}
-
-/*******************************************************************************
-  * @brief  Carga una muestra en la Senial (que luego se pasará al generador)
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-static void Cargar_Paquete(uint8_t PaqueteRecibido[]) {
-	// PaqueteRecibido es un string?
-	uint32_t Largo = strlen((char *) PaqueteRecibido);
-	if ( Largo > LARGO_MAX_PAQUETE) Error_Handler();
-
-	// Transformamos string recibido en número y lo asignamos a Senial[]
-	uint32_t Numero = 0;
-	Numero = atoi((char *) PaqueteRecibido );
-	Senial[MuestraNro] = Numero;
-
-	// Informamos en UART
-	char muestra_str[16];
-	sprintf(muestra_str, "%u", MuestraNro);
-	uartSendString((uint8_t *) "Muestra #");
-	uartSendString((uint8_t *) muestra_str);
-	uartSendString((uint8_t *) ": ");
-	uartSendString((uint8_t *) PaqueteRecibido);
-	uartSendString((uint8_t *) "\n");
-
-	// Incrementamos para próxima carga y verificamos si ya completamos
-	MuestraNro++;
-	if (MuestraNro >= N_MUESTRAS) {
-		MuestraNro = 0;
-		Gen_Cargar(Senial);
-	}
-}
-
-/**
-  * @brief System Clock Configuration
-  * @retval None
-  */
-void SystemClock_Config(void)
-{
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-
-  /** Configure the main internal regulator output voltage
-  */
-  __HAL_RCC_PWR_CLK_ENABLE();
-  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
-
-  /** Initializes the RCC Oscillators according to the specified parameters
-  * in the RCC_OscInitTypeDef structure.
-  */
-  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
-  RCC_OscInitStruct.HSEState = RCC_HSE_BYPASS;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
-  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
-  RCC_OscInitStruct.PLL.PLLM = 4;
-  RCC_OscInitStruct.PLL.PLLN = 168;
-  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
-  RCC_OscInitStruct.PLL.PLLQ = 7;
-  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-  {
-    Error_Handler();
-  }
-
-  /** Initializes the CPU, AHB and APB buses clocks
-  */
-  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
-                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
-  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
-
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
-  {
-    Error_Handler();
-  }
-}
+/*******************************************************************************
+  * @file		main.c
+  * @brief      Generador de señales con entrada por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  * @detail		Recibe una entrada por UART y la saca por DAC.
+  ******************************************************************************
+  * @attention
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "string.h"
+
+/* Private define ------------------------------------------------------------*/
+#define CANTIDAD_RANURAS	4		// Formas de onda guardadas (comando SLOT)
+#define GANANCIA_MAXIMA		7999	// Milésimas (el Q12 de 16 bits llega a 7,9998)
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Variables privadas ------- ------------------------------------------------*/
+uint16_t Senial[N_MUESTRAS] = {
+		0,6,19,39,66,100,142,190,244,306,373,
+		447,526,611,700,795,894,997,1104,1215,1328,1444,1562,1682,1803,1925,
+		2048,2170,2292,2413,2533,2651,2767,2880,2991,3098,3201,3300,3395,3484,3569,
+		3648,3722,3789,3851,3905,3953,3995,4029,4056,4076,4089,4095,4093,4084,4067,
+		4044,4013,3975,3930,3879,3821,3756,3686,3609,3527,3440,3348,3251,3150,3045,
+		2936,2824,2709,2592,2473,2353,2231,2109,1986,1864,1742,1622,1503,1386,1271,
+		1159,1050,945,844,747,655,568,486,409,339,274,216,165,120,82,
+		51,28,11,2
+};								// Senial inicial y donde se almacenarán nuevas señales
+uint16_t MuestraNro = 0;		// Posición en que se va a almacenar próxima muestra
+fourier_t Armonicos;			// Armónicos recibidos con FOURIER / H
+interpolacion_t Puntos;			// Puntos de control recibidos luego de INTERP
+bool_t CargandoPuntos = false;	// Los números recibidos son puntos de control
+sintesis_t Ranuras[CANTIDAD_RANURAS];		// Parámetros de GEN de cada ranura
+bool_t RanuraSintetizada[CANTIDAD_RANURAS];	// La ranura ya tiene una forma de onda
+uint8_t RanuraActual = 0;
+captura_t Captura;				// Parámetros de CAPT (se conservan entre capturas)
+coefFiltro_t Filtro;			// Coeficientes cargados con FIR, TAP y BQ
+uint32_t BloqueDsp = DSP_BLOQUE_DEFECTO;	// Muestras por bloque de DSP
+rafaga_t Rafagas;				// Parámetros de BURST
+barrido_t Barridos;				// Parámetros de SWEEP
+modulacion_t Modulaciones;		// Parámetros de MOD
+ondasDAC_t OndasDAC;			// Parámetros de HW
+aleatorio_t Aleatorios;			// Parámetros de RAND
+
+/* Private function prototypes -----------------------------------------------*/
+void SystemClock_Config(void);
+static void Leer_UART(void);	// <-- Esta rutina lee de a un caracter
+static void Cargar_Paquete(uint16_t Numero);
+static void Aplicar_Ranura(void);
+static bool_t Leer_Numero(const char * Texto, int32_t Minimo, int32_t Maximo, int32_t * Valor);
+
+// Acciones de los comandos (ver Tabla_Comandos)
+static void Comando_Identificar(char * Args);
+static void Comando_Amplitud(char * Args);
+static void Comando_Desplazamiento(char * Args);
+static void Comando_Biquad(char * Args);
+static void Comando_Rafaga(char * Args);
+static void Comando_Consultar_Rafaga(char * Args);
+static void Comando_Calibrar(char * Args);
+static void Comando_Consultar_Cal(char * Args);
+static void Comando_Capturar(char * Args);
+static void Comando_Comprimido(char * Args);
+static void Comando_Dsp(char * Args);
+static void Comando_Consultar_Dsp(char * Args);
+static void Comando_Fir(char * Args);
+static void Comando_Fourier(char * Args);
+static void Comando_Ganancia(char * Args);
+static void Comando_Gen(char * Args);
+static void Comando_Armonico(char * Args);
+static void Comando_Ayuda(char * Args);
+static void Comando_Interp(char * Args);
+static void Comando_Largo(char * Args);
+static void Comando_Cargar(char * Args);
+static void Comando_Modulacion(char * Args);
+static void Comando_Consultar_Modulacion(char * Args);
+static void Comando_Offset(char * Args);
+static void Comando_Periodo(char * Args);
+static void Comando_Consultar_Periodo(char * Args);
+static void Comando_Reiniciar(char * Args);
+static void Comando_Secuencia(char * Args);
+static void Comando_Consultar_Secuencia(char * Args);
+static void Comando_Puntos(char * Args);
+static void Comando_Consultar_Puntos(char * Args);
+static void Comando_Aleatorio(char * Args);
+static void Comando_Consultar_Aleatorio(char * Args);
+static void Comando_Ranura(char * Args);
+static void Comando_Comenzar(char * Args);
+static void Comando_Estado(char * Args);
+static void Comando_Parar(char * Args);
+static void Comando_Stream(char * Args);
+static void Comando_Barrido(char * Args);
+static void Comando_Consultar_Barrido(char * Args);
+static void Comando_Conmutacion(char * Args);
+static void Comando_Onda_DAC(char * Args);
+static void Comando_Consultar_Onda_DAC(char * Args);
+static void Comando_Consultar_Conmutacion(char * Args);
+static void Comando_Tap(char * Args);
+static void Comando_Zoh(char * Args);
+static void Comando_Consultar_Zoh(char * Args);
+static void Comando_Disparar(char * Args);
+
+/* Tabla de comandos ---------------------------------------------------------*/
+// Ordenada por nombre (strcmp): Cmd_Init lo verifica y la búsqueda es binaria.
+static const comando_t Tabla_Comandos[] = {
+	{ "*IDN?",   Comando_Identificar,       "identificacion" },
+	{ "*TRG",    Comando_Disparar,          "dispara una rafaga" },
+	{ "AMP",     Comando_Amplitud,          "<cuentas> amplitud de la ranura" },
+	{ "BIAS",    Comando_Desplazamiento,    "<cuentas> offset de la salida" },
+	{ "BQ",      Comando_Biquad,            "<etapa> b0 b1 b2 a1 a2 (Q14) | CLR" },
+	{ "BURST",   Comando_Rafaga,            "[K=..] [IDLE=..] [SRC=SW|PIN] rafagas | OFF" },
+	{ "BURST?",  Comando_Consultar_Rafaga,  "disparos, latencia y jitter de las rafagas" },
+	{ "CAL",     Comando_Calibrar,          "[ON|OFF] calibra el DAC o usa la correccion" },
+	{ "CAL?",    Comando_Consultar_Cal,     "resultado de la calibracion" },
+	{ "CAPT",    Comando_Capturar,          "[CONT] [PRE=..] [POST=..] [DEC=..] [TRIG=..] | STOP" },
+	{ "COMP",    Comando_Comprimido,        "N=<n> carga comprimida" },
+	{ "DSP",     Comando_Dsp,               "[N=<bloque>] filtra ADC -> DAC | OFF" },
+	{ "DSP?",    Comando_Consultar_Dsp,     "latencia, carga y margen del filtrado" },
+	{ "FIR",     Comando_Fir,               "<taps> nuevo FIR en cero" },
+	{ "FOURIER", Comando_Fourier,           "[N=..] [OFF=..] [MODE=..] | END" },
+	{ "GAIN",    Comando_Ganancia,          "<milesimas> ganancia de la salida" },
+	{ "GEN",     Comando_Gen,               "<forma> [N=..] [AMP=..] [OFF=..] ..." },
+	{ "H",       Comando_Armonico,          "<k> <amplitud> [fase]" },
+	{ "HELP",    Comando_Ayuda,             "lista de comandos" },
+	{ "HW",      Comando_Onda_DAC,          "[TRI|NOISE] [BITS=..] [BASE=..|SIG] [RATE=..] onda del DAC | OFF" },
+	{ "HW?",     Comando_Consultar_Onda_DAC, "pico, periodo y frecuencia de la onda del DAC" },
+	{ "INTERP",  Comando_Interp,            "[N=..] [MODE=LIN|CR] | END" },
+	{ "LEN",     Comando_Largo,             "<n> muestras de la ranura" },
+	{ "LOAD",    Comando_Cargar,            "espera una senial por UART" },
+	{ "MOD",     Comando_Modulacion,        "[AM|FM|PM|PWM] [FC=..] [FMOD=..] [DEPTH=..] [DEV=..] ... | OFF" },
+	{ "MOD?",    Comando_Consultar_Modulacion, "[<% CPU>] carga y fs maxima de cada modulacion" },
+	{ "OFF",     Comando_Offset,            "<cuentas> valor medio de la ranura" },
+	{ "PTS",     Comando_Puntos,            "ADD <ns> <valor> [...] | CLR | RUN | OFF" },
+	{ "PTS?",    Comando_Consultar_Puntos,  "puntos, duracion y memoria frente a paso fijo" },
+	{ "RAND",    Comando_Aleatorio,         "[PRBS7|..|PRBS31|UNIF|GAUSS] [AMP=..] [OFF=..] [CHIP=..] [DEC=..] [SEED=..] | OFF" },
+	{ "RAND?",   Comando_Consultar_Aleatorio, "[<% CPU>] ancho de banda, carga y fs maxima de cada generador" },
+	{ "RATE",    Comando_Periodo,           "<periodo> ARR de TIM2" },
+	{ "RATE?",   Comando_Consultar_Periodo, "periodo y frecuencia de muestras" },
+	{ "RESET",   Comando_Reiniciar,         "vacia el generador" },
+	{ "SEQ",     Comando_Secuencia,         "ADD [REP=..|INF] | CLR | NEXT | RUN | OFF" },
+	{ "SEQ?",    Comando_Consultar_Secuencia, "segmentos, respuesta y fs maxima de la secuencia" },
+	{ "SLOT",    Comando_Ranura,            "<0..3> elige la ranura" },
+	{ "START",   Comando_Comenzar,          "enciende la salida" },
+	{ "STAT?",   Comando_Estado,            "estado del generador" },
+	{ "STOP",    Comando_Parar,             "pausa la salida" },
+	{ "STREAM",  Comando_Stream,            "[periodo] reproduccion continua" },
+	{ "SWEEP",   Comando_Barrido,           "[LIN|LOG|STEP|STEPLOG] [F1=..] [F2=..] [T=..] ... | OFF" },
+	{ "SWEEP?",  Comando_Consultar_Barrido, "frecuencia actual, marcas y carga del barrido" },
+	{ "SWITCH",  Comando_Conmutacion,       "[OFF|IMM|PERIOD|MATCH|FADE] [TOL=..] [K=..] cambio en marcha" },
+	{ "SWITCH?", Comando_Consultar_Conmutacion, "escalon, espera y ciclos del ultimo cambio" },
+	{ "TAP",     Comando_Tap,               "<k> <h> [<h> ...] coeficientes del FIR (Q15)" },
+	{ "ZOH",     Comando_Zoh,               "ON [TAPS=3|5|7|9] compensa la retencion del DAC | OFF" },
+	{ "ZOH?",    Comando_Consultar_Zoh,     "planicidad y ciclos de la compensacion" },
+};
+
+static const char * const Nombre_Estado[] = {
+	[Espera] = "ESPERA", [Recibiendo] = "RECIBIENDO", [Cargado] = "CARGADO",
+	[Generando] = "GENERANDO", [Pausa] = "PAUSA", [Reproduciendo] = "REPRODUCIENDO",
+	[Filtrando] = "FILTRANDO", [Rafaga] = "RAFAGA", [Barriendo] = "BARRIENDO",
+	[Modulando] = "MODULANDO", [Secuenciando] = "SECUENCIANDO", [Trazando] = "TRAZANDO",
+	[Autonomo] = "AUTONOMO", [Aleatorio] = "ALEATORIO"
+};
+
+/**
+  * @brief  The application entry point.
+  * @retval int
+  */
+int main(void)
+{
+  /* MCU Configuration--------------------------------------------------------*/
+  HAL_Init();
+  SystemClock_Config();
+
+  /* Inicializacion de periféricos y APIs -------------------------------------*/
+  Inicializar_DAC_DMA();					// DAC con acceso DMA utilizando Timer 2
+  Inicializar_ADC();						// ADC1 sobre la salida del DAC2 (calibración)
+  Inicializar_Rafaga();					// TIM3 (compuerta de TIM2) y TIM5 (disparo en PA0)
+  Inicializar_Wobulador();				// TIM4: marcas de los barridos en PD12
+  if (uartInit() != true) Error_Handler();	// Conexión con terminal
+  debounceFSM_init();						// Antirrebote del pulsador de usuario (SysTick)
+  Gen_Init();								// Inicialización del generador de señal
+  Fourier_Iniciar(&Armonicos);
+  Interp_Iniciar(&Puntos);
+  Capt_Defecto(&Captura);
+  Filtro_Defecto(&Filtro);
+  Rafaga_Defecto(&Rafagas);
+  Barrido_Defecto(&Barridos);
+  Mod_Defecto(&Modulaciones);
+  Ondas_Defecto(&OndasDAC);
+  Alea_Defecto(&Aleatorios);
+  for (uint8_t i=0; i<CANTIDAD_RANURAS; i++) {
+	  Sint_Defecto(&Ranuras[i]);
+	  RanuraSintetizada[i] = false;
+  }
+  if (Cmd_Init(Tabla_Comandos, sizeof(Tabla_Comandos) / sizeof(Tabla_Comandos[0])) != true) Error_Handler();
+
+  /* Inicio... ----------------------------------------------------------------*/
+  uartSendString((uint8_t *) "\nGENERADOR DE SENIAL V1.0\nTiempo entre muestras: 10,5 Msps\nTension: 0V - 3,3V");
+  uartSendString((uint8_t *) "\n\n");
+  Gen_Espera();	// Estado inicial del generador
+
+  /* Infinite loop */
+  /* USER CODE BEGIN WHILE */
+  while (1)
+  {
+	  // Reviso parpadeo de leds y avisos de las interrupciones del DAC
+	  Gen_Actualiza_Leds();
+	  Gen_Procesar_Eventos();
+
+	  // Comandos por UART en todo momento; la señal sólo en Recibiendo o Cargado
+	  if (Gen_Descomprimiendo()) {
+		  Gen_Procesar_Descompresion();
+	  } else if (Gen_Estado() != Reproduciendo) {
+          Leer_UART();
+	  }
+
+	  // La captura envía sus bloques de a uno, entre comandos
+	  if (Capt_Activa()) Capt_Procesar();
+
+	  // En streaming las muestras llegan continuamente por UART
+	  if (Gen_Estado() == Reproduciendo) {
+		  if (Stream_Procesar() != true) Gen_Terminar_Stream();
+	  }
+
+	  // Un barrido ONCE termina solo
+	  if (Gen_Estado() == Barriendo) {
+		  if (Wob_Procesar() != true) Gen_Terminar_Barrido();
+	  }
+
+	  // Si presionamos el botón de usuario cambiamos de estadoMEF
+	  if (readKeyPush()) {
+		  switch (Gen_Estado()) {
+
+		  case Espera:
+			  Gen_Recibir();
+			  break;
+
+		  case Recibiendo:
+			  // Para salir de este estado, se deben cargar los datos por UART
+			  break;
+
+		  case Cargado:
+			  Gen_Encender();
+			  break;
+
+		  case Generando:
+			  Gen_Pausar();
+			  break;
+
+		  case Pausa:
+			  Gen_Encender();
+			  break;
+
+		  case Reproduciendo:
+			  // Sale al terminar el stream o con pulsador largo
+			  break;
+
+		  case Filtrando:
+			  // Sale con DSP OFF o con pulsador largo
+			  break;
+
+		  case Rafaga:
+			  // Cada pulsación dispara una ráfaga; sale con BURST OFF o pulsador largo
+			  Gen_Disparar();
+			  break;
+
+		  case Barriendo:
+			  // Sale con SWEEP OFF, al terminar un ONCE o con pulsador largo
+			  break;
+
+		  case Modulando:
+			  // Sale con MOD OFF o con pulsador largo
+			  break;
+
+		  case Secuenciando:
+			  // Cada pulsación pasa al segmento siguiente; sale con SEQ OFF o pulsador largo
+			  Secuenciador_Avanzar();
+			  break;
+
+		  case Trazando:
+			  // Sale con PTS OFF o con pulsador largo
+			  break;
+
+		  case Autonomo:
+			  // Sale con HW OFF o con pulsador largo
+			  break;
+
+		  case Aleatorio:
+			  // Sale con RAND OFF o con pulsador largo
+			  break;
+
+		  default:
+			  // nada...
+			  break;
+		  }
+	  }
+
+	  // Si hay flanco descendente (señal lógica de 1 a 0), evalúo si fue un pulso largo:
+	  if (readKeyRelease()) {
+		  if ((readPresionadoLargo() == true) &&  Gen_Estado() >= Generando)
+			  Gen_Espera();
+	  }
+   }
+}
+
+/*******************************************************************************
+  * @brief  Lee UART de a un caracter, sin esperar: las líneas que empiezan con
+  *         letra son comandos (ver Tabla_Comandos); en Recibiendo o Cargado
+  *         los números separados por coma son la señal.
+  * @param  None
+  * @retval None
+  */
+static void Leer_UART(void){
+	static acumuladorDecimal_t Paquete = { 0, SINT_MAX_DAC, 0, false };	// Número en curso
+	uint8_t Leo;
+
+	while (uartReceiveStringSize( &Leo, 1) == true) {
+		// Mientras esté recibiendo por UART me quedo en este loop
+
+		estadoCmd_t Comando = Cmd_Byte(Leo);
+		if (Comando != CMD_NO_CONSUMIDO) {
+			// Es parte de un comando: el intérprete acumula la línea y la ejecuta
+			if (Comando == CMD_DESCONOCIDO) uartSendString((uint8_t *) "Comando desconocido.\n");
+			if (Comando == CMD_DESBORDE) uartSendString((uint8_t *) "Linea demasiado larga.\n");
+			// En streaming o con COMP lo que sigue son datos binarios: no los leo acá
+			if (Gen_Estado() == Reproduciendo || Gen_Descomprimiendo()) return;
+			continue;
+		}
+
+		// La señal sólo se recibe en Recibiendo o Cargado
+		if (Gen_Estado() != Recibiendo && Gen_Estado() != Cargado) continue;
+
+		if (Num_Digito(&Paquete, Leo)) {
+			// Es un dígito numérico: se acumula directamente en el número.
+			// Más de 4095 queda marcado fuera de rango (y nunca desborda).
+
+		} else if (Leo == ',') {
+			// Es el fin de un paquete: Debo cargarlo en la Senial
+			if (Num_Valido(&Paquete)) {
+				Cargar_Paquete((uint16_t) Paquete.valor);
+			} else if (Paquete.digitos > 0) {
+				uartSendLiteral("Muestra fuera de rango (0-4095).\n");
+			}
+			Num_Iniciar(&Paquete, SINT_MAX_DAC);
+
+		}   // Si no es número ni ',', no lo considero.
+	}
+}
+
+/* Acciones de los comandos --------------------------------------------------*/
+
+static void Comando_Identificar(char * Args) {
+	uartSendString((uint8_t *) "UNDAV,GENERADOR DE SENIAL,DAC2,V1.0\n");
+}
+
+static void Comando_Ayuda(char * Args) {
+	uint8_t Cantidad;
+	const comando_t * Tabla = Cmd_Tabla(&Cantidad);
+	for (uint8_t i=0; i<Cantidad; i++) {
+		uartSendString((uint8_t *) Tabla[i].nombre);
+		uartSendString((uint8_t *) " ");
+		uartSendString((uint8_t *) Tabla[i].ayuda);
+		uartSendString((uint8_t *) "\n");
+	}
+}
+
+static void Comando_Estado(char * Args) {
+	char Informe[96];
+	uint32_t Periodo = Leer_Periodo_DAC_DMA();
+	char * Fin = Num_AgregarTexto(Informe, "ESTADO=");
+	Fin = Num_AgregarTexto(Fin, Nombre_Estado[Gen_Estado()]);
+	Fin = Num_AgregarTexto(Fin, " N=");
+	Fin = Num_AgregarDecimal(Fin, Gen_Largo());
+	Fin = Num_AgregarTexto(Fin, " RATE=");
+	Fin = Num_AgregarDecimal(Fin, Periodo);
+	Fin = Num_AgregarTexto(Fin, " FS=");
+	Fin = Num_AgregarDecimal(Fin, FRECUENCIA_TIM2 / (Periodo + 1));
+	Fin = Num_AgregarTexto(Fin, " SLOT=");
+	Fin = Num_AgregarDecimal(Fin, RanuraActual);
+	Fin = Num_AgregarTexto(Fin, " GAIN=");
+	int32_t Ganancia = Gen_Ganancia() * 1000;		// Q12 -> milésimas, redondeado
+	Fin = Num_AgregarEntero(Fin, (Ganancia + ((Ganancia < 0) ? -2048 : 2048)) / ACOND_GANANCIA_UNO);
+	Fin = Num_AgregarTexto(Fin, " BIAS=");
+	Fin = Num_AgregarEntero(Fin, Gen_Offset());
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+}
+
+static void Comando_Cargar(char * Args) {
+	if (Gen_Estado() != Espera) {
+		uartSendString((uint8_t *) "Solo desde ESPERA.\n");
+		return;
+	}
+	Gen_Recibir();
+}
+
+static void Comando_Comenzar(char * Args) {
+	if (Gen_Estado() != Cargado && Gen_Estado() != Pausa) {
+		uartSendString((uint8_t *) "No hay senial cargada.\n");
+		return;
+	}
+	Gen_Encender();
+}
+
+static void Comando_Parar(char * Args) {
+	if (Gen_Estado() == Generando) Gen_Pausar();
+}
+
+static void Comando_Reiniciar(char * Args) {
+	CargandoPuntos = false;
+	MuestraNro = 0;
+	Gen_Espera();
+}
+
+static void Comando_Periodo(char * Args) {
+	int32_t Periodo;
+	if (Leer_Numero(Args, PERIODO_DAC_MINIMO, INT32_MAX, &Periodo) != true) {
+		uartSendString((uint8_t *) "Periodo invalido.\n");
+		return;
+	}
+	if (Gen_Estado() == Filtrando && FRECUENCIA_TIM2 / ((uint32_t) Periodo + 1) > ADC_FS_MAXIMA) {
+		uartSendLiteral("Frecuencia de muestras mayor que la del ADC (RATE >= 59).\n");
+		return;
+	}
+	if (Gen_Estado() == Barriendo) {
+		uartSendLiteral("El barrido usa la frecuencia actual: SWEEP OFF primero.\n");
+		return;
+	}
+	if (Gen_Estado() == Modulando) {
+		uartSendLiteral("La modulacion usa la frecuencia actual: MOD OFF primero.\n");
+		return;
+	}
+	if (Gen_Estado() == Trazando) {
+		uartSendLiteral("Los puntos fijan su propio periodo: PTS OFF primero.\n");
+		return;
+	}
+	Capt_Parar();					// Su frecuencia de muestras ya no sería la anunciada
+	Fijar_Periodo_DAC_DMA((uint32_t) Periodo);
+	Comando_Consultar_Periodo(Args);
+}
+
+static void Comando_Consultar_Periodo(char * Args) {
+	char Informe[48];
+	uint32_t Periodo = Leer_Periodo_DAC_DMA();
+	char * Fin = Num_AgregarTexto(Informe, "RATE=");
+	Fin = Num_AgregarDecimal(Fin, Periodo);
+	Fin = Num_AgregarTexto(Fin, " FS=");
+	Fin = Num_AgregarDecimal(Fin, FRECUENCIA_TIM2 / (Periodo + 1));
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+}
+
+static void Comando_Stream(char * Args) {
+	int32_t Periodo = PERIODO_DAC_DEFECTO;
+	if (Args[0] != '\0' && Leer_Numero(Args, PERIODO_DAC_MINIMO, INT32_MAX, &Periodo) != true) {
+		uartSendString((uint8_t *) "Periodo invalido.\n");
+		return;
+	}
+	Capt_Parar();					// Sus bloques se mezclarían con los créditos
+	Gen_Stream((uint32_t) Periodo);
+}
+
+static void Comando_Gen(char * Args) {
+	sintesis_t Parametros = Ranuras[RanuraActual];
+	if (Sint_Interpretar(Args, &Parametros) != true) {
+		uartSendString((uint8_t *) "Parametros de GEN invalidos.\n");
+		return;
+	}
+	Ranuras[RanuraActual] = Parametros;
+	RanuraSintetizada[RanuraActual] = true;
+	Aplicar_Ranura();
+}
+
+static void Comando_Largo(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, 2, N_MAX_MUESTRAS, &Valor) != true) {
+		uartSendString((uint8_t *) "Largo invalido.\n");
+		return;
+	}
+	Ranuras[RanuraActual].largo = (uint32_t) Valor;
+	if (RanuraSintetizada[RanuraActual]) Aplicar_Ranura();
+}
+
+static void Comando_Amplitud(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, 0, SINT_MAX_DAC, &Valor) != true) {
+		uartSendString((uint8_t *) "Amplitud invalida.\n");
+		return;
+	}
+	Ranuras[RanuraActual].amplitud = Valor;
+	if (RanuraSintetizada[RanuraActual]) Aplicar_Ranura();
+}
+
+static void Comando_Offset(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, 0, SINT_MAX_DAC, &Valor) != true) {
+		uartSendString((uint8_t *) "Offset invalido.\n");
+		return;
+	}
+	Ranuras[RanuraActual].offset = Valor;
+	if (RanuraSintetizada[RanuraActual]) Aplicar_Ranura();
+}
+
+// GAIN y BIAS actúan sobre la señal cargada, sin volver a cargarla ni sintetizarla
+static void Comando_Ganancia(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, -GANANCIA_MAXIMA, GANANCIA_MAXIMA, &Valor) != true) {
+		uartSendString((uint8_t *) "Ganancia invalida.\n");
+		return;
+	}
+	// Milésimas -> Q12, redondeado
+	Gen_Fijar_Ganancia((int16_t) ((Valor * ACOND_GANANCIA_UNO + ((Valor < 0) ? -500 : 500)) / 1000));
+}
+
+static void Comando_Desplazamiento(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, -SINT_MAX_DAC, SINT_MAX_DAC, &Valor) != true) {
+		uartSendString((uint8_t *) "Offset invalido.\n");
+		return;
+	}
+	Gen_Fijar_Offset((int16_t) Valor);
+}
+
+static void Comando_Calibrar(char * Args) {
+	if (Args[0] == '\0') {
+		Capt_Parar();				// El ADC no puede capturar y medir a la vez
+		Gen_Calibrar();
+	} else if (strcmp(Args, "ON") == 0 || strcmp(Args, "OFF") == 0) {
+		if (Gen_Usar_Calibracion(Args[1] == 'N') != true) {
+			uartSendString((uint8_t *) "No hay calibracion: usar CAL.\n");
+			return;
+		}
+		Gen_Informar_Calibracion();
+	} else {
+		uartSendString((uint8_t *) "Parametro de CAL invalido.\n");
+	}
+}
+
+static void Comando_Consultar_Cal(char * Args) {
+	Gen_Informar_Calibracion();
+}
+
+static void Comando_Zoh(char * Args) {
+	int32_t Taps = ZOH_MAX_TAPS;
+	if (strcmp(Args, "OFF") == 0) {
+		Taps = 0;
+	} else if (strncmp(Args, "ON", 2) == 0 && (Args[2] == '\0' || Args[2] == ' ')) {
+		const char * Resto = Args + 2;
+		while (*Resto == ' ') Resto++;
+		if (*Resto != '\0' && (strncmp(Resto, "TAPS=", 5) != 0
+				|| Leer_Numero(Resto + 5, 3, ZOH_MAX_TAPS, &Taps) != true)) {
+			uartSendString((uint8_t *) "Parametro de ZOH invalido.\n");
+			return;
+		}
+	} else {
+		uartSendString((uint8_t *) "Parametro de ZOH invalido.\n");
+		return;
+	}
+	if (Gen_Compensar_Retencion((uint32_t) Taps) != true) {
+		uartSendString((uint8_t *) "TAPS de ZOH: 3, 5, 7 o 9.\n");
+		return;
+	}
+	Gen_Informar_Compensacion();
+}
+
+static void Comando_Consultar_Zoh(char * Args) {
+	Gen_Informar_Compensacion();
+}
+
+static void Comando_Ranura(char * Args) {
+	int32_t Valor;
+	if (Leer_Numero(Args, 0, CANTIDAD_RANURAS - 1, &Valor) != true) {
+		uartSendString((uint8_t *) "Ranura invalida.\n");
+		return;
+	}
+	RanuraActual = (uint8_t) Valor;
+	if (RanuraSintetizada[RanuraActual]) Aplicar_Ranura();
+	else uartSendString((uint8_t *) "Ranura vacia: usar GEN.\n");
+}
+
+static void Comando_Fourier(char * Args) {
+	if (strcmp(Args, "END") == 0) {
+		Gen_Fourier(&Armonicos);
+		return;
+	}
+	Fourier_Iniciar(&Armonicos);
+	if (Fourier_Interpretar(Args, &Armonicos) != true) {
+		uartSendString((uint8_t *) "Parametros de FOURIER invalidos.\n");
+		return;
+	}
+	uartSendString((uint8_t *) "Esperando armonicos...\n");
+}
+
+static void Comando_Armonico(char * Args) {
+	if (Fourier_Interpretar_Armonico(Args, &Armonicos) != true) {
+		uartSendString((uint8_t *) "Armonico invalido.\n");
+	}
+}
+
+static void Comando_Interp(char * Args) {
+	if (strcmp(Args, "END") == 0) {
+		CargandoPuntos = false;
+		Gen_Interpolar(&Puntos);
+		return;
+	}
+	Interp_Iniciar(&Puntos);
+	if (Interp_Interpretar(Args, &Puntos) != true) {
+		uartSendString((uint8_t *) "Parametros de INTERP invalidos.\n");
+		return;
+	}
+	CargandoPuntos = true;
+	MuestraNro = 0;
+	uartSendString((uint8_t *) "Esperando puntos de control...\n");
+}
+
+static void Comando_Capturar(char * Args) {
+	if (strcmp(Args, "STOP") == 0) {
+		Capt_Parar();
+		return;
+	}
+	if (Gen_Estado() == Filtrando) {
+		uartSendLiteral("El ADC esta en uso: DSP OFF primero.\n");
+		return;
+	}
+	if (Gen_Estado() == Trazando) {
+		uartSendLiteral("Con los puntos TIM2 no tiene un periodo fijo: PTS OFF primero.\n");
+		return;
+	}
+	captura_t Parametros = Captura;
+	Parametros.continua = false;			// Sólo con CONT
+	if (Capt_Interpretar(Args, &Parametros) != true) {
+		uartSendString((uint8_t *) "Parametros de CAPT invalidos.\n");
+		return;
+	}
+	Captura = Parametros;
+	if (Capt_Iniciar(&Captura) != true) {
+		uartSendString((uint8_t *) "Frecuencia de muestras mayor que la del ADC (RATE >= 59).\n");
+	}
+}
+
+static void Comando_Fir(char * Args) {
+	if (Filtro_Interpretar_Fir(Args, &Filtro) != true) {
+		uartSendLiteral("Cantidad de coeficientes invalida (0-128).\n");
+	}
+}
+
+static void Comando_Tap(char * Args) {
+	if (Filtro_Interpretar_Taps(Args, &Filtro) != true) {
+		uartSendLiteral("Coeficientes invalidos.\n");
+	}
+}
+
+static void Comando_Biquad(char * Args) {
+	if (Filtro_Interpretar_Biquad(Args, &Filtro) != true) {
+		uartSendLiteral("Etapa invalida.\n");
+	}
+}
+
+// Con el filtrado en marcha y el mismo bloque, los coeficientes cambian sin cortar la salida
+static void Comando_Dsp(char * Args) {
+	int32_t Bloque = (int32_t) BloqueDsp;
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Filtro();
+		return;
+	}
+	if (Args[0] != '\0' && (Args[0] != 'N' || Args[1] != '='
+			|| Leer_Numero(&Args[2], DSP_BLOQUE_MINIMO, DSP_BLOQUE_MAXIMO, &Bloque) != true)) {
+		uartSendLiteral("Bloque invalido.\n");
+		return;
+	}
+	if (Gen_Estado() == Filtrando && (uint32_t) Bloque == Dsp_Bloque()) {
+		if (Dsp_Aplicar(&Filtro) != true) uartSendLiteral("FIR invalido: la suma de |h| llega a 32.\n");
+		else uartSendLiteral("Coeficientes aplicados.\n");
+		return;
+	}
+	Capt_Parar();					// El ADC no puede capturar y filtrar a la vez
+	BloqueDsp = (uint32_t) Bloque;
+	Gen_Filtrar(&Filtro, BloqueDsp);
+}
+
+static void Comando_Consultar_Dsp(char * Args) {
+	if (Gen_Estado() == Filtrando) {
+		Dsp_Informar();
+		return;
+	}
+	char Informe[64];
+	char * Fin = Num_AgregarTexto(Informe, "DSP=OFF TAPS=");
+	Fin = Num_AgregarDecimal(Fin, Filtro.taps);
+	Fin = Num_AgregarTexto(Fin, " BIQUADS=");
+	Fin = Num_AgregarDecimal(Fin, Filtro.etapas);
+	Fin = Num_AgregarTexto(Fin, " BLOQUE=");
+	Fin = Num_AgregarDecimal(Fin, BloqueDsp);
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+}
+
+static void Comando_Rafaga(char * Args) {
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Rafaga();
+		return;
+	}
+	rafaga_t Parametros = Rafagas;
+	if (Rafaga_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de BURST invalidos.\n");
+		return;
+	}
+	Rafagas = Parametros;
+	Gen_Rafaga(&Rafagas);
+}
+
+static void Comando_Consultar_Rafaga(char * Args) {
+	if (Gen_Estado() == Rafaga) {
+		Rafaga_Informar();
+		return;
+	}
+	char Informe[64];
+	char * Fin = Num_AgregarTexto(Informe, "RAFAGA=OFF K=");
+	Fin = Num_AgregarDecimal(Fin, Rafagas.periodos);
+	Fin = Num_AgregarTexto(Fin, " IDLE=");
+	Fin = Num_AgregarDecimal(Fin, Rafagas.reposo);
+	Fin = Num_AgregarTexto(Fin, Rafagas.pin ? " SRC=PIN" : " SRC=SW");
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+}
+
+static void Comando_Disparar(char * Args) {
+	Gen_Disparar();
+}
+
+static void Comando_Barrido(char * Args) {
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Barrido();
+		return;
+	}
+	barrido_t Parametros = Barridos;
+	if (Barrido_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de SWEEP invalidos.\n");
+		return;
+	}
+	Barridos = Parametros;
+	Gen_Barrer(&Barridos);
+}
+
+static void Comando_Consultar_Barrido(char * Args) {
+	if (Gen_Estado() == Barriendo) {
+		Wob_Informar();
+		return;
+	}
+	char Informe[80];
+	char * Fin = Num_AgregarTexto(Informe, "SWEEP=OFF TIPO=");
+	Fin = Num_AgregarTexto(Fin, Barrido_Nombre(Barridos.tipo));
+	Fin = Num_AgregarTexto(Fin, " F1=");
+	Fin = Num_AgregarDecimal(Fin, Barridos.f1);
+	Fin = Num_AgregarTexto(Fin, " F2=");
+	Fin = Num_AgregarDecimal(Fin, Barridos.f2);
+	Fin = Num_AgregarTexto(Fin, " T=");
+	Fin = Num_AgregarDecimal(Fin, Barridos.tiempo);
+	Fin = Num_AgregarTexto(Fin, " STEPS=");
+	Fin = Num_AgregarDecimal(Fin, Barridos.pasos);
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+}
+
+static void Comando_Onda_DAC(char * Args) {
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Onda_DAC();
+		return;
+	}
+	ondasDAC_t Parametros = OndasDAC;
+	if (Ondas_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de HW invalidos.\n");
+		return;
+	}
+	OndasDAC = Parametros;
+	if (OndasDAC.periodo != 0) Capt_Parar();	// Su frecuencia de muestras ya no sería la anunciada
+	if (Gen_Onda_DAC(&OndasDAC)) Ondas_Informar(&OndasDAC, true);
+}
+
+static void Comando_Consultar_Onda_DAC(char * Args) {
+	Ondas_Informar(&OndasDAC, Gen_Estado() == Autonomo);
+}
+
+// Rige para la próxima GEN, FOURIER o INTERP mientras genera
+static void Comando_Conmutacion(char * Args) {
+	conmutacion_t Parametros = *Gen_Conmutacion();
+	if (Conm_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de SWITCH invalidos.\n");
+		return;
+	}
+	Gen_Fijar_Conmutacion(&Parametros);
+	Conmutador_Informar(Gen_Conmutacion());
+}
+
+static void Comando_Consultar_Conmutacion(char * Args) {
+	Conmutador_Informar(Gen_Conmutacion());
+}
+
+// En marcha y con el mismo tipo, modulante, portadora, AMP y OFF, frecuencias,
+// profundidad y desvío cambian sin cortar la salida
+static void Comando_Modulacion(char * Args) {
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Modulacion();
+		return;
+	}
+	modulacion_t Parametros = Modulaciones;
+	if (Mod_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de MOD invalidos.\n");
+		return;
+	}
+	if (Gen_Estado() == Modulando && Modulador_Compatible(&Parametros)) {
+		if (Modulador_Aplicar(&Parametros) != true) return;
+		Modulaciones = Parametros;
+		uartSendLiteral("Modulacion ajustada.\n");
+		return;
+	}
+	Modulaciones = Parametros;
+	Gen_Modular(&Modulaciones);
+}
+
+// ADD agrega la señal cargada (con GAIN, BIAS y CAL) al final de la secuencia;
+// NEXT deja el segmento en curso al terminar su pasada
+static void Comando_Secuencia(char * Args) {
+	if (Args[0] == '\0' || strcmp(Args, "RUN") == 0) {
+		Gen_Secuenciar();
+	} else if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Secuencia();
+	} else if (strcmp(Args, "NEXT") == 0) {
+		Secuenciador_Avanzar();
+	} else if (strcmp(Args, "CLR") == 0) {
+		if (Secuenciador_Vaciar()) uartSendLiteral("Secuencia vacia.\n");
+	} else if (strncmp(Args, "ADD", 3) == 0 && (Args[3] == '\0' || Args[3] == ' ')) {
+		int32_t Repeticiones = 1;
+		const char * Rep = (Args[3] == ' ') ? Args + 4 : Args + 3;
+		if (strcmp(Rep, "REP=INF") == 0) {
+			Repeticiones = SEQ_INFINITO;
+		} else if (Rep[0] != '\0' && (strncmp(Rep, "REP=", 4) != 0
+				|| Leer_Numero(Rep + 4, 1, SEQ_MAX_REPETICIONES, &Repeticiones) != true)) {
+			uartSendLiteral("Repeticiones invalidas (REP=1..1000000000 o REP=INF).\n");
+			return;
+		}
+		Gen_Agregar_Segmento((uint32_t) Repeticiones);
+	} else {
+		uartSendLiteral("Parametro de SEQ invalido.\n");
+	}
+}
+
+static void Comando_Consultar_Secuencia(char * Args) {
+	Secuenciador_Informar();
+}
+
+static void Comando_Puntos(char * Args) {
+	if (Args[0] == '\0' || strcmp(Args, "RUN") == 0) {
+		Capt_Parar();				// Con los puntos TIM2 no tiene un período fijo
+		Gen_Trazar();
+	} else if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Trazado();
+	} else if (strcmp(Args, "CLR") == 0) {
+		if (Trazador_Vaciar()) uartSendLiteral("Puntos borrados.\n");
+	} else if (strncmp(Args, "ADD ", 4) == 0) {
+		Trazador_Agregar(Args + 4);
+	} else {
+		uartSendLiteral("Parametro de PTS invalido.\n");
+	}
+}
+
+static void Comando_Consultar_Puntos(char * Args) {
+	Trazador_Informar();
+}
+
+// Cada RAND arranca desde la semilla: la misma secuencia se repite a pedido
+static void Comando_Aleatorio(char * Args) {
+	if (strcmp(Args, "OFF") == 0) {
+		Gen_Terminar_Aleatorio();
+		return;
+	}
+	aleatorio_t Parametros = Aleatorios;
+	if (Alea_Interpretar(Args, &Parametros) != true) {
+		uartSendLiteral("Parametros de RAND invalidos.\n");
+		return;
+	}
+	Aleatorios = Parametros;
+	Gen_Aleatorio(&Aleatorios);
+}
+
+static void Comando_Consultar_Aleatorio(char * Args) {
+	int32_t Porcentaje = RUIDO_PRESUPUESTO_CPU;
+	if (Args[0] != '\0' && Leer_Numero(Args, 1, 100, &Porcentaje) != true) {
+		uartSendLiteral("Porcentaje de CPU invalido (1..100).\n");
+		return;
+	}
+	if (Gen_Estado() == Aleatorio) {
+		Ruido_Informar();
+	} else {
+		uint32_t Fs = FRECUENCIA_TIM2 / (Leer_Periodo_DAC_DMA() + 1);
+		char Informe[128];
+		char * Fin = Num_AgregarTexto(Informe, "RAND=OFF TIPO=");
+		Fin = Num_AgregarTexto(Fin, Alea_Nombre(Aleatorios.tipo));
+		Fin = Num_AgregarTexto(Fin, " AMP=");
+		Fin = Num_AgregarDecimal(Fin, Aleatorios.amplitud);
+		Fin = Num_AgregarTexto(Fin, " OFF=");
+		Fin = Num_AgregarDecimal(Fin, Aleatorios.offset);
+		Fin = Num_AgregarTexto(Fin, " CHIP=");
+		Fin = Num_AgregarDecimal(Fin, Aleatorios.chip);
+		Fin = Num_AgregarTexto(Fin, " DEC=");
+		Fin = Num_AgregarDecimal(Fin, Aleatorios.decimacion);
+		Fin = Num_AgregarTexto(Fin, " SEED=");
+		Fin = Num_AgregarDecimal(Fin, Aleatorios.semilla);
+		Fin = Num_AgregarTexto(Fin, " BW=");
+		Fin = Num_AgregarDecimal(Fin, Alea_Ancho_Banda(&Aleatorios, Fs));
+		Fin = Num_AgregarTexto(Fin, " FS=");
+		Fin = Num_AgregarDecimal(Fin, Fs);
+		*Fin++ = '\n';
+		uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+	}
+	Ruido_Capacidad(&Aleatorios, (uint32_t) Porcentaje);
+}
+
+static void Comando_Consultar_Modulacion(char * Args) {
+	int32_t Porcentaje = MOD_PRESUPUESTO_CPU;
+	if (Args[0] != '\0' && Leer_Numero(Args, 1, 100, &Porcentaje) != true) {
+		uartSendLiteral("Porcentaje de CPU invalido (1..100).\n");
+		return;
+	}
+	if (Gen_Estado() == Modulando) {
+		Modulador_Informar();
+	} else {
+		char Informe[96];
+		char * Fin = Num_AgregarTexto(Informe, "MOD=OFF TIPO=");
+		Fin = Num_AgregarTexto(Fin, Mod_Nombre(Modulaciones.tipo));
+		Fin = Num_AgregarTexto(Fin, " FC=");
+		Fin = Num_AgregarDecimal(Fin, Modulaciones.portadora);
+		Fin = Num_AgregarTexto(Fin, " FMOD=");
+		Fin = Num_AgregarDecimal(Fin, Modulaciones.modulante);
+		Fin = Num_AgregarTexto(Fin, " DEPTH=");
+		Fin = Num_AgregarDecimal(Fin, Modulaciones.profundidad);
+		Fin = Num_AgregarTexto(Fin, " DEV=");
+		Fin = Num_AgregarDecimal(Fin, Modulaciones.desvio);
+		Fin = Num_AgregarTexto(Fin, " WAVE=");
+		Fin = Num_AgregarTexto(Fin, Mod_Nombre_Forma(Modulaciones.forma));
+		Fin = Num_AgregarTexto(Fin, Modulaciones.tabla ? " CAR=TABLE" : " CAR=SINE");
+		*Fin++ = '\n';
+		uartSendStringSize((uint8_t *) Informe, (uint16_t) (Fin - Informe));
+	}
+	Modulador_Capacidad(&Modulaciones, (uint32_t) Porcentaje);
+}
+
+static void Comando_Comprimido(char * Args) {
+	int32_t Largo;
+	if (Args[0] != 'N' || Args[1] != '=' || Leer_Numero(&Args[2], 1, N_MAX_MUESTRAS, &Largo) != true) {
+		uartSendString((uint8_t *) "Cantidad de muestras invalida.\n");
+		return;
+	}
+	Gen_Descomprimir((uint32_t) Largo);
+}
+
+/*******************************************************************************
+  * @brief  Sintetiza la ranura actual. Si el generador estaba sacando la
+  *         señal, la vuelve a encender con la nueva.
+  * @param  None
+  * @retval None
+  */
+static void Aplicar_Ranura(void) {
+	bool_t Generaba = (Gen_Estado() == Generando);
+	Gen_Sintetizar(&Ranuras[RanuraActual]);
+	if (Generaba && Gen_Estado() == Cargado) Gen_Encender();
+}
+
+/*******************************************************************************
+  * @brief  Lee un entero decimal y verifica el rango.
+  * @param  Texto: número (sin otros caracteres)
+  * @param  Minimo, Maximo: rango admitido
+  * @param  Valor: destino
+  * @retval true si el número es válido
+  */
+static bool_t Leer_Numero(const char * Texto, int32_t Minimo, int32_t Maximo, int32_t * Valor) {
+	return Num_Leer(Texto, Minimo, Maximo, Valor, NULL);
+}
+
+/*******************************************************************************
+  * @brief  Carga una muestra en la Senial (que luego se pasará al generador)
+  * @param  Numero: muestra ya validada (0..4095)
+  * @retval None
+  */
+static void Cargar_Paquete(uint16_t Numero) {
+	// En modo INTERP el número es un punto de control
+	if (CargandoPuntos) {
+		if (Interp_Agregar(&Puntos, Numero) != true) {
+			uartSendLiteral("Punto sin lugar.\n");
+		}
+		return;
+	}
+	Senial[MuestraNro] = Numero;
+
+	// Informamos en UART: "Muestra #<n>: <valor>\n"
+	char Eco[32];
+	char * Fin = Num_AgregarTexto(Eco, "Muestra #");
+	Fin = Num_AgregarDecimal(Fin, MuestraNro);
+	Fin = Num_AgregarTexto(Fin, ": ");
+	Fin = Num_AgregarDecimal(Fin, Numero);
+	*Fin++ = '\n';
+	uartSendStringSize((uint8_t *) Eco, (uint16_t) (Fin - Eco));
+
+	// Incrementamos para próxima carga y verificamos si ya completamos
+	MuestraNro++;
+	if (MuestraNro >= N_MUESTRAS) {
+		MuestraNro = 0;
+		Gen_Cargar(Senial, N_MUESTRAS);
+	}
+}
+
+/**
+  * @brief System Clock Configuration
+  * @retval None
+  */
+void SystemClock_Config(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /** Configure the main internal regulator output voltage
+  */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  /** Initializes the RCC Oscillators according to the specified parameters
+  * in the RCC_OscInitTypeDef structure.
+  */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_BYPASS;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = 4;
+  RCC_OscInitStruct.PLL.PLLN = 168;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = 7;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Initializes the CPU, AHB and APB buses clocks
+  */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
@@ -0,0 +1,36 @@
+/*******************************************************************************
+  * @file		API_acondicionamiento.h
+  * @brief      Acondicionamiento de muestras: recorte a 12 bits, ganancia
+  *             y offset en una sola pasada
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * salida = sat12( (min(entrada, 4095) * ganancia) >> 12 + offset )
+  * El núcleo procesa dos muestras por palabra de 32 bits con las
+  * instrucciones SIMD de 16 bits del Cortex-M4 (UQSUB16, SMUAD/SMUADX,
+  * QADD16, USAT16). En la PC (Herramientas) se usan equivalentes en C con el
+  * mismo resultado bit a bit. Las muestras recortadas se cuentan: el llamador
+  * decide qué hacer con ellas.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_ACONDICIONAMIENTO_H
+#define __API_ACONDICIONAMIENTO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define ACOND_BITS_GANANCIA		12						// Ganancia en Q12
+#define ACOND_GANANCIA_UNO		(1 << ACOND_BITS_GANANCIA)
+#define ACOND_MAX_DAC			0x0FFF
+
+/* Funciones públicas --------------------------------------------------------*/
+// Devuelve la cantidad de muestras recortadas (origen y destino pueden coincidir)
+uint32_t Acond_Procesar(const uint16_t * origen, uint16_t * destino, uint32_t largo,
+		                int16_t ganancia, int16_t offset);
+
+#endif /* __API_ACONDICIONAMIENTO_H */
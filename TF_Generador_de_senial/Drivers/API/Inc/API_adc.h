@@ -0,0 +1,57 @@
+/*******************************************************************************
+  * @file		API_adc.h
+  * @brief      Conversiones del ADC1: lazo sobre la salida del DAC2 y
+  *             entradas analógicas externas
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * PA5 es a la vez DAC_OUT2 y ADC12_IN5: el ADC1 lee la salida del generador
+  * sin cables externos (lazo para la calibración, ver API_calibracion.h).
+  * Las señales externas entran por otra pata (PA3 = A0 de la Nucleo-144):
+  * en PA5 el DAC2 impone su propia salida.
+  * Dos modos:
+  *  - Medir_ADC(): conversiones por software, promediadas, siempre del lazo.
+  *  - Comenzar_Captura_ADC(): una conversión por cada disparo de TIM2 (el
+  *    mismo TRGO que mueve el DAC2) del canal elegido, por DMA a un buffer
+  *    de dos mitades.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_ADC_H
+#define __API_ADC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "errorHandler.h"
+#include "API_numeros.h"			/* <- bool_t */
+
+/* Macros públicas -----------------------------------------------------------*/
+#define ADC_BITS_PROMEDIO	4			// Medir_ADC devuelve cuentas x 16
+#define ADC_FS_MAXIMA		1400000		// Hz: 21 MHz / (3 + 12 ciclos) por conversión
+
+/* Typedef públicos ----------------------------------------------------------*/
+// Patas que puede convertir el ADC1
+typedef enum {
+	ADC_LAZO_PA5,			// ADC12_IN5: la salida del DAC2 (sólo calibración)
+	ADC_ENTRADA_PA3,		// ADC123_IN3, A0 de la Nucleo-144: señal externa
+	ADC_ENTRADA_PC0,		// ADC123_IN10, A1
+	ADC_ENTRADA_PC3			// ADC123_IN13, A2
+} canalADC_t;
+
+// Mitad del buffer de captura que el DMA acaba de completar (contexto de
+// interrupción): hay que leerla antes de que el DMA vuelva a ella.
+typedef void (*bloqueADC_t)(const uint16_t * mitad, uint32_t cantidad);
+
+/* Funciones públicas --------------------------------------------------------*/
+void Inicializar_ADC(void);
+uint16_t Medir_ADC(uint32_t promedios);	// Promedio de conversiones (cuentas x 16)
+void Comenzar_Captura_ADC(canalADC_t Canal, uint16_t * Datos, uint32_t Num_Datos, bloqueADC_t bloque);
+void Parar_Captura_ADC(void);
+uint32_t Leer_Desbordes_ADC(void);		// Conversiones perdidas (DMA que no llegó)
+bool_t Interpretar_Entrada_ADC(const char * texto, canalADC_t * canal);	// "PA3", "PC0" o "PC3"
+const char * Nombre_Canal_ADC(canalADC_t canal);
+
+#endif /* __API_ADC_H */
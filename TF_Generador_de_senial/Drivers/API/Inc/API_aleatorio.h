@@ -0,0 +1,90 @@
+/*******************************************************************************
+  * @file		API_aleatorio.h
+  * @brief      Secuencias PRBS y ruido uniforme o gaussiano en punto fijo,
+  *             de a bloques, para identificación de sistemas
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Generadores:
+  *  - PRBS7, PRBS15, PRBS23 y PRBS31: LFSR de Galois con los polinomios de
+  *    ITU-T O.150 (x^7+x^6+1, x^15+x^14+1, x^23+x^18+1, x^31+x^28+1), de
+  *    período 2^n - 1. Cada bit dura CHIP muestras y sale como OFF + AMP
+  *    (uno) u OFF - AMP (cero).
+  *  - UNIF: xorshift32, uniforme en [OFF - AMP, OFF + AMP].
+  *  - GAUSS: Box-Muller con dos xorshift32; AMP es el desvío estándar.
+  *    sqrt(-2 ln u) sale del exponente de u (CLZ), una tabla de ln de 65
+  *    valores y una raíz entera; el coseno y el seno, de Sint_Seno(). Se
+  *    recorta en 6,66 desvíos (u >= 2^-32).
+  * El ancho de banda se elige con DEC: un filtro CIC de orden 2 (dos
+  * sumas móviles de DEC muestras, el filtro de decimación de siempre)
+  * corre a la frecuencia de muestras; su primer cero cae en fs / DEC y
+  * los -3 dB en 0,32 fs / DEC. Para UNIF y GAUSS la ganancia se corrige
+  * para conservar la potencia pedida; para PRBS se conserva el nivel.
+  * Todo el trabajo es fijo por muestra. Se compila también en la PC
+  * (ver Herramientas/aleatorio_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_ALEATORIO_H
+#define __API_ALEATORIO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_sintesis.h"
+#include "API_numeros.h"
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define ALEA_MAX_DEC			256			// Largo máximo de las sumas del CIC
+#define ALEA_MAX_CHIP			65536		// Muestras por bit de PRBS
+#define ALEA_BITS_LN			6			// Tabla de ln(1 + i/64)
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	ALEA_PRBS7,
+	ALEA_PRBS15,
+	ALEA_PRBS23,
+	ALEA_PRBS31,
+	ALEA_UNIFORME,
+	ALEA_GAUSS
+} tipoAleatorio_t;
+
+#define ALEA_TIPOS				(ALEA_GAUSS + 1)
+
+typedef struct {
+	tipoAleatorio_t tipo;
+	int32_t amplitud;			// AMP: cuentas (PRBS y UNIF: pico; GAUSS: desvío)
+	int32_t offset;				// OFF: cuentas
+	uint32_t chip;				// CHIP: muestras por bit (PRBS)
+	uint32_t decimacion;		// DEC: largo del CIC, potencia de 2 (1: sin filtro)
+	uint32_t semilla;			// SEED: estado inicial (0 no vale: se usa 1)
+} aleatorio_t;
+
+typedef struct {
+	aleatorio_t p;
+	uint32_t registro;			// LFSR o xorshift
+	uint32_t mascara;			// Realimentación del LFSR de Galois
+	uint32_t restan;			// Muestras que le quedan al bit en curso
+	int32_t nivel;				// Valor del bit en curso, o el segundo gaussiano
+	bool_t guardado;			// GAUSS: 'nivel' es el seno del par anterior
+	int32_t escala;				// Q12: AMP x corrección de potencia del CIC
+	uint32_t corrimiento;		// 2 log2(DEC): ganancia en continua del CIC
+	uint32_t indice;
+	int32_t suma1;
+	int64_t suma2;				// Llega a DEC^2 x 6,66 desvíos: no entra en 32 bits
+	int32_t entradas[ALEA_MAX_DEC];		// Línea de retardo de cada suma móvil
+	int32_t sumas[ALEA_MAX_DEC];
+} estadoAleatorio_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Alea_Defecto(aleatorio_t * a);
+bool_t Alea_Interpretar(char * texto, aleatorio_t * a);
+bool_t Alea_Preparar(estadoAleatorio_t * e, const aleatorio_t * a);
+uint32_t Alea_Generar(estadoAleatorio_t * e, uint16_t * destino, uint32_t cantidad);	// Devuelve las saturadas
+uint32_t Alea_Periodo_Bits(tipoAleatorio_t tipo);	// 2^n - 1 (0: no es PRBS)
+uint32_t Alea_Ancho_Banda(const aleatorio_t * a, uint32_t fs);	// Hz a -3 dB
+const char * Alea_Nombre(tipoAleatorio_t tipo);
+
+#endif /* __API_ALEATORIO_H */
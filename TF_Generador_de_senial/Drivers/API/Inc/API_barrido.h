@@ -0,0 +1,101 @@
+/*******************************************************************************
+  * @file		API_barrido.h
+  * @brief      Barridos de frecuencia: chirp lineal o logarítmico y barrido
+  *             por pasos (lineales o logarítmicos) con permanencia fija
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Síntesis directa (DDS) de a bloques, sin tocar el período de TIM2: la
+  * fase es un acumulador de 64 bits (2^64 = un ciclo) al que se le suma el
+  * paso (frecuencia / fs) en cada muestra. La fase nunca se reinicia, así
+  * que la señal es continua en los cambios de frecuencia, de bloque y de
+  * barrido; sólo cambia el paso.
+  * El barrido se arma con tramos (paso += delta, delta += curva):
+  *  - LIN: un tramo por barrido.
+  *  - LOG: tramos de BARRIDO_SEGMENTO muestras; el paso es una parábola
+  *    que pasa por los valores exactos (2^x en punto fijo) del comienzo,
+  *    el medio y el final de cada tramo.
+  *  - STEP / STEPLOG: un tramo de delta cero por paso. Cada paso (y cada
+  *    comienzo de chirp) deja una marca: la muestra en que empieza.
+  * Sin divisiones ni 64 x 64 dentro del lazo por muestra. Se compila
+  * también en la PC (ver Herramientas/barrido_sim.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_BARRIDO_H
+#define __API_BARRIDO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_sintesis.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define BARRIDO_MAX_FRECUENCIA	5250000		// Hz: la mitad de la fs máxima
+#define BARRIDO_MAX_TIEMPO		100000		// ms: duración o permanencia por paso
+#define BARRIDO_MAX_PASOS		1000
+#define BARRIDO_SEGMENTO		64			// Muestras por tramo del chirp LOG
+#define BARRIDO_MAX_OCTAVAS_TRAMO	4		// LOG: hasta 1/4 de octava por tramo
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	BARRIDO_LIN,			// Chirp lineal
+	BARRIDO_LOG,			// Chirp logarítmico (igual tiempo por octava)
+	BARRIDO_PASOS,			// Pasos equiespaciados en Hz
+	BARRIDO_PASOS_LOG		// Pasos equiespaciados en octavas
+} tipoBarrido_t;
+
+typedef struct {
+	tipoBarrido_t tipo;
+	uint32_t f1;			// F1: frecuencia inicial, Hz
+	uint32_t f2;			// F2: frecuencia final, Hz (puede ser menor que F1)
+	uint32_t tiempo;		// T: ms de barrido (chirp) o de cada paso
+	uint32_t pasos;			// STEPS: pasos de F1 a F2, ambos incluidos
+	int32_t amplitud;		// AMP: cuentas del DAC
+	int32_t offset;			// OFF: cuentas del DAC
+	bool_t repetir;			// false con ONCE: un barrido y queda en OFF
+} barrido_t;
+
+// Avance exacto de total / divisor por llamada (Bresenham)
+typedef struct {
+	uint64_t valor;
+	uint64_t cociente;
+	uint32_t resto;
+	uint32_t acumulado;
+	uint32_t divisor;
+} avanceBarrido_t;
+
+typedef struct {
+	barrido_t p;
+	uint64_t fase;				// Q0.64: ciclos
+	uint64_t paso;				// Q0.64: ciclos por muestra
+	int64_t delta;				// Cambio del paso por muestra en el tramo
+	int64_t curva;				// Cambio de delta por muestra (LOG)
+	uint64_t pasoSiguiente;		// Paso exacto al comienzo del próximo tramo
+	uint64_t paso1, paso2;		// Extremos del barrido
+	uint64_t octavas;			// |log2(F2 / F1)| en Q32 (LOG y STEPLOG)
+	bool_t baja;				// F2 < F1
+	avanceBarrido_t avance;		// Posición dentro del barrido
+	int32_t amplitud;			// Cero al terminar (la salida queda en OFF)
+	uint32_t largo;				// Muestras del barrido (chirp) o de un paso
+	uint32_t tramos;			// Tramos por barrido
+	uint32_t tramo;				// Próximo tramo
+	uint32_t restantes;			// Muestras que le quedan al tramo actual
+	uint32_t muestra;			// Muestras generadas (módulo 2^32)
+	uint32_t marca;				// Muestra en que empezó el último paso o barrido
+	uint32_t marcas;
+	uint32_t barridos;			// Barridos completos
+	bool_t terminado;
+} estadoBarrido_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Barrido_Defecto(barrido_t * b);
+bool_t Barrido_Interpretar(char * texto, barrido_t * b);
+bool_t Barrido_Preparar(estadoBarrido_t * e, const barrido_t * b, uint32_t reloj, uint32_t divisor);
+uint32_t Barrido_Generar(estadoBarrido_t * e, uint16_t * destino, uint32_t cantidad);	// Devuelve las saturadas
+const char * Barrido_Nombre(tipoBarrido_t tipo);
+uint32_t Barrido_Frecuencia(const estadoBarrido_t * e, uint32_t reloj, uint32_t divisor);	// Hz del paso actual
+
+#endif /* __API_BARRIDO_H */
@@ -0,0 +1,54 @@
+/*******************************************************************************
+  * @file		API_bloques.h
+  * @brief      Lo común de las salidas que el DAC2 genera por bloques en la
+  *             interrupción del DMA (modulador, ruido, wobulador y DSP)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Cada una llena una mitad del buffer por interrupción, con plazo de un
+  * bloque: 'cantidad' muestras a Leer_Ciclos_Muestra_DAC_DMA() ciclos cada
+  * una. Acá están los contadores de bloques y ciclos (contador DWT), el
+  * arranque con las dos mitades llenas antes del primer disparo, la
+  * parada, la medición del costo de un bloque y los campos del informe
+  * que comparan ese costo con el presupuesto de CPU.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_BLOQUES_H
+#define __API_BLOQUES_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_dac_dma.h"
+#include "API_medicion.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define BLOQUES_REPETICIONES	4		// Mediciones de costo: se queda con la menor
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t bloques;			// Bloques generados
+	uint32_t ciclos;			// Ciclos de CPU del último bloque
+	uint32_t ciclosMaximo;		// Ciclos del peor bloque
+	uint32_t saturadas;			// Muestras fuera de 0..4095
+	uint32_t atrasos;			// Bloques que tardaron más que su plazo
+} bloquesContadores_t;
+
+// Nombre de cada tipo de generador, para el informe de capacidad
+typedef const char * (*nombreBloques_t)(uint32_t tipo);
+
+/* Funciones públicas --------------------------------------------------------*/
+void Bloques_Comenzar(uint16_t * buffer, uint32_t mitad, recargaDAC_t recarga);
+void Bloques_Parar(void);
+void Bloques_Registrar(volatile bloquesContadores_t * c, uint32_t inicio, uint32_t cantidad);
+uint32_t Bloques_Medir(recargaDAC_t generar, uint16_t * destino, uint32_t cantidad);
+uint32_t Bloques_Fs_Maxima(uint32_t ciclos, uint32_t mitad, uint32_t porcentaje);
+char * Bloques_AgregarCosto(char * fin, const bloquesContadores_t * c, uint32_t mitad);
+char * Bloques_AgregarCapacidad(char * fin, const uint32_t * ciclos, uint32_t tipos, nombreBloques_t nombre,
+		                        uint32_t porcentaje, uint32_t mitad);
+
+#endif /* __API_BLOQUES_H */
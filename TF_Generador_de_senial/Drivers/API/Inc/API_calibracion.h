@@ -0,0 +1,58 @@
+/*******************************************************************************
+  * @file		API_calibracion.h
+  * @brief      Calibración del DAC: ajuste de ganancia y offset, tabla de
+  *             no linealidad (INL) y tabla de corrección por código
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Se mide la salida del DAC en CAL_PUNTOS códigos equiespaciados (con el ADC,
+  * en cuentas del ADC x 16). Con esas medidas se ajusta una recta por mínimos
+  * cuadrados en el tramo lineal (el buffer de salida no llega a los rieles) y
+  * se guarda el apartamiento de cada punto respecto de ella (INL).
+  * La tabla de corrección invierte la transferencia medida: para cada código
+  * deseado da el código que hay que escribir en el DAC para obtenerlo.
+  * Se aplica al armar la salida: la reproducción no tiene costo adicional.
+  * Código C puro: el simulador de la PC (Herramientas/cal_sim.c) usa este
+  * mismo ajuste.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_CALIBRACION_H
+#define __API_CALIBRACION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Macros públicas -----------------------------------------------------------*/
+#define CAL_PUNTOS			65			// Códigos medidos: 0, 64, 128 ... 4032, 4095
+#define CAL_PASO			64
+#define CAL_CODIGOS			4096		// Entradas de la tabla de corrección
+#define CAL_BITS_MEDIDA		4			// Medidas en cuentas x 16 (promedios)
+#define CAL_BITS_GANANCIA	16			// Ganancia en Q16
+#define CAL_FIRMA			0x43414C31UL	// "CAL1"
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bool bool_t;
+
+// Resultado de la calibración (es lo que se guarda en flash)
+typedef struct {
+	uint32_t firma;					// CAL_FIRMA si es válida
+	int32_t ganancia;				// Q16: cuentas medidas por código
+	int32_t offset;					// Medida con código 0 según la recta (x 16)
+	uint16_t primero;				// Tramo lineal usado en el ajuste (índices)
+	uint16_t ultimo;
+	int16_t inl[CAL_PUNTOS];		// Medida - recta, en cada punto (x 16)
+	uint32_t suma;					// Verificación del resto de la estructura
+} calibracion_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+uint16_t Cal_Codigo(uint32_t punto);		// Código del DAC del punto 0..CAL_PUNTOS-1
+bool_t Cal_Ajustar(const uint16_t medidas[CAL_PUNTOS], calibracion_t * cal);
+bool_t Cal_Valida(const calibracion_t * cal);
+int32_t Cal_Inl_Maximo(const calibracion_t * cal);	// |INL| máximo (x 16)
+void Cal_Tabla(const calibracion_t * cal, uint16_t tabla[CAL_CODIGOS]);
+void Cal_Rango(const calibracion_t * cal, uint16_t * minimo, uint16_t * maximo);
+void Cal_Corregir(const uint16_t tabla[CAL_CODIGOS], uint16_t * muestras, uint32_t largo);
+
+#endif /* __API_CALIBRACION_H */
@@ -0,0 +1,92 @@
+/*******************************************************************************
+  * @file		API_captura.h
+  * @brief      Captura de la respuesta (modo osciloscopio): ADC1 disparado por
+  *             TIM2 junto con el DAC2, con disparo, pre/post-disparo,
+  *             decimación y envío binario por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La respuesta entra por una pata externa ('entrada': PA3, PC0 o PC3); para
+  * ver la propia salida se une PA5 con esa pata.
+  * Las muestras del ADC se promedian de a 'decimacion' y luego:
+  *  - Captura única: se guardan en una historia circular hasta el disparo
+  *    (inmediato o por flanco ascendente a través de 'nivel') y 'post'
+  *    muestras más; se envían 'pre' + 'post' muestras en bloques.
+  *  - Captura continua: se arman bloques de CAPT_BLOQUE muestras y se
+  *    envían a medida que el enlace lo permite; si no hay lugar, el bloque
+  *    se pierde (la secuencia salta y se cuenta).
+  * Protocolo (el texto termina en '\n'; los bloques son binarios):
+  *  - "CAPT <fs ADC> <decimacion> <fs decimada> <enlace>\n" al comenzar,
+  *    con <enlace> las muestras por segundo que sostiene la UART.
+  *  - Cada bloque: 0xA5 0x5A, secuencia (2 bytes), cantidad (2 bytes) y las
+  *    muestras (2 bytes cada una), todo little-endian.
+  *  - "FIN CAPT ..." con los contadores al terminar.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_CAPTURA_H
+#define __API_CAPTURA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errorHandler.h>
+#include "API_ring.h"
+#include "API_uart.h"
+#include "API_adc.h"
+#include "API_dac_dma.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define CAPT_HISTORIA			8192	// Muestras (decimadas) de una captura única
+#define CAPT_MITAD				256		// Muestras del ADC por mitad del buffer del DMA
+#define CAPT_BLOQUE				128		// Muestras por bloque enviado
+#define CAPT_BLOQUES			32		// Bloques en espera de la captura continua
+#define CAPT_DECIMACION_MAXIMA	65536
+#define CAPT_SINCRONISMO_1		0xA5	// Comienzo de bloque (no aparece en los textos)
+#define CAPT_SINCRONISMO_2		0x5A
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	CAPT_INMEDIATO,				// Dispara apenas hay 'pre' muestras
+	CAPT_NIVEL					// Flanco ascendente a través de 'nivel'
+} disparoCaptura_t;
+
+typedef struct {
+	bool_t continua;			// true: bloques sin fin (hasta Capt_Parar)
+	disparoCaptura_t disparo;
+	uint16_t nivel;				// Cuentas del ADC
+	uint32_t pre;				// Muestras antes del disparo
+	uint32_t post;				// Muestras desde el disparo (inclusive)
+	uint32_t decimacion;		// Muestras del ADC promediadas por muestra
+	canalADC_t entrada;			// Pata de la respuesta (PA5 queda para CAL)
+} captura_t;
+
+typedef struct {
+	uint32_t adquiridas;		// Conversiones del ADC
+	uint32_t bloques;			// Bloques armados
+	uint32_t enviados;
+	uint32_t perdidos;			// Sin lugar para esperar al enlace
+	uint32_t desbordes;			// Conversiones que el DMA no llegó a leer
+	uint32_t bytesPorSegundo;	// Caudal sostenido del envío
+} captContadores_t;
+
+// Bloque tal como sale por la UART
+typedef struct {
+	uint8_t sincronismo[2];
+	uint16_t secuencia;
+	uint16_t cantidad;
+	uint16_t muestras[CAPT_BLOQUE];
+} bloqueCaptura_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Capt_Defecto(captura_t * c);
+bool_t Capt_Interpretar(char * texto, captura_t * c);
+bool_t Capt_Iniciar(const captura_t * c);	// false si TIM2 va más rápido que el ADC
+bool_t Capt_Procesar(void);					// Devuelve false cuando terminó
+void Capt_Parar(void);
+bool_t Capt_Activa(void);
+void Capt_Contadores(captContadores_t * contadores);
+
+#endif /* __API_CAPTURA_H */
@@ -0,0 +1,53 @@
+/*******************************************************************************
+  * @file		API_comandos.h
+  * @brief      Intérprete de comandos de texto (estilo SCPI) por tabla
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Los bytes se entregan de a uno a medida que llegan (Cmd_Byte): nunca se
+  * espera una línea completa. Una línea empieza con letra o '*', termina en
+  * '\n' o '\r' y su primera palabra se busca en una tabla ordenada con
+  * búsqueda binaria. El resto de la línea son los argumentos de la acción.
+  * Código C puro: también compila en la PC (ver Herramientas/comandos_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_COMANDOS_H
+#define __API_COMANDOS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Macros públicas -----------------------------------------------------------*/
+#define CMD_LARGO_LINEA		64
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bool bool_t;
+
+typedef void (*accionComando_t)(char * argumentos);
+
+typedef struct {
+	const char * nombre;		// En mayúsculas; la tabla va ordenada por nombre
+	accionComando_t accion;
+	const char * ayuda;
+} comando_t;
+
+typedef enum {
+	CMD_NO_CONSUMIDO,		// El byte no es parte de un comando (p.ej. una muestra)
+	CMD_EN_CURSO,			// Se acumuló en la línea
+	CMD_EJECUTADO,			// Terminó la línea y se ejecutó la acción
+	CMD_DESCONOCIDO,		// Terminó la línea y el comando no está en la tabla
+	CMD_DESBORDE			// Terminó una línea más larga que CMD_LARGO_LINEA
+} estadoCmd_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Cmd_Init(const comando_t * tabla, uint8_t cantidad);	// false si no está ordenada
+estadoCmd_t Cmd_Byte(uint8_t byte);
+estadoCmd_t Cmd_Ejecutar(char * linea);
+const comando_t * Cmd_Buscar(const char * nombre);
+const comando_t * Cmd_Tabla(uint8_t * cantidad);
+
+#endif /* __API_COMANDOS_H */
@@ -0,0 +1,59 @@
+/*******************************************************************************
+  * @file		API_compensacion.h
+  * @brief      Compensación de la retención de orden cero del DAC: FIR
+  *             inverso de sinc, circular, en punto fijo
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * El DAC mantiene cada muestra un período de muestreo: la salida queda
+  * multiplicada por sinc(f / fs), que a 0,45 fs ya resta 3,1 dB. Con
+  * 105 muestras por período los armónicos altos de una cuadrada caen ahí.
+  * Se pre-enfatiza la tabla con un FIR simétrico de 3, 5, 7 o 9
+  * coeficientes (Q14, suma 1: no cambia el valor medio) ajustado en
+  * minimax a 1 / sinc(f / fs) entre 0 y 0,45 fs.
+  * La tabla es un período de una señal periódica: la convolución es
+  * circular (las primeras muestras usan las últimas y al revés), así que
+  * no hay transitorios en los bordes. Se hace en el lugar, de a bloques
+  * de ZOH_BLOQUE muestras; las ZOH_MAX_TAPS / 2 primeras se guardan
+  * antes porque el final las vuelve a necesitar.
+  * El núcleo es el del FIR de API_filtro.h: dos coeficientes por SMLAD y
+  * dos salidas por vuelta. La salida se satura a 0..4095 y las saturadas
+  * se cuentan. En la PC se usan equivalentes en C de las instrucciones
+  * (Herramientas/retencion_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_COMPENSACION_H
+#define __API_COMPENSACION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_numeros.h"
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define ZOH_MAX_TAPS			9		// Coeficientes del FIR (impar: fase cero)
+#define ZOH_MITAD_MAXIMA		(ZOH_MAX_TAPS / 2)
+#define ZOH_BLOQUE				256		// Muestras por vuelta de la convolución
+#define ZOH_BITS				14		// Coeficientes en Q14 (el central pasa de 1)
+#define ZOH_BANDA				450		// Banda del ajuste: milésimas de fs
+#define ZOH_MAX_DAC				0x0FFF
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t taps;								// 0: sin compensar
+	uint32_t pares;								// Pares de coeficientes (el último con un cero)
+	uint32_t coeficientes[(ZOH_MAX_TAPS + 1) / 2];	// Dos por palabra
+	int16_t cabeza[ZOH_MITAD_MAXIMA];			// Primeras muestras originales
+	int16_t ventana[ZOH_BLOQUE + ZOH_MAX_TAPS + 1];	// Bloque con sus vecinas
+} compensacion_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Zoh_Preparar(compensacion_t * c, uint32_t taps);	// taps: 0, 3, 5, 7 o 9
+uint32_t Zoh_Compensar(compensacion_t * c, uint16_t * senial, uint32_t largo);	// Devuelve las saturadas
+uint32_t Zoh_Planicidad(uint32_t taps);		// Centésimas de dB hasta ZOH_BANDA (0 taps: sin compensar)
+const int16_t * Zoh_Coeficientes(uint32_t taps);	// Del central hacia afuera; NULL si no existe
+
+#endif /* __API_COMPENSACION_H */
@@ -0,0 +1,64 @@
+/*******************************************************************************
+  * @file		API_compresion.h
+  * @brief      Decodificador incremental de señales comprimidas
+  *             (delta + zig-zag varint + repetición, elegido por bloque)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Formato: una sucesión de bloques hasta completar N muestras. Cada bloque
+  * empieza con un byte de cabecera:
+  *   bits 7..6: tipo     bits 5..0: cantidad de muestras - 1 (1 a 64)
+  *   COMP_LITERAL  (00): siguen 'cantidad' deltas, uno por muestra.
+  *   COMP_REPETIR  (01): sigue un solo delta, que se suma 'cantidad' veces
+  *                       (delta 0: valor constante; otro: rampa).
+  * Cada delta es la diferencia con la muestra anterior (la primera se toma
+  * respecto de 0), en zig-zag (0,-1,1,-2.. -> 0,1,2,3..) y varint de 7 bits
+  * por byte (bit 7 = siguen más bytes).
+  * Los bytes se procesan a medida que llegan: no hace falta guardar la
+  * imagen comprimida. Código C puro: el codificador de la PC
+  * (Herramientas/comp_codificador.c) usa este mismo decodificador.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_COMPRESION_H
+#define __API_COMPRESION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Macros públicas -----------------------------------------------------------*/
+#define COMP_LITERAL			0x00
+#define COMP_REPETIR			0x40
+#define COMP_MASCARA_TIPO		0xC0
+#define COMP_MASCARA_CANTIDAD	0x3F
+#define COMP_MAX_BLOQUE			64
+#define COMP_MAX_VALOR			0x0FFF
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bool bool_t;
+
+typedef enum {
+	COMP_EN_CURSO,			// Faltan bytes
+	COMP_COMPLETO,			// Ya se decodificaron las N muestras
+	COMP_ERROR				// Formato inválido o muestra fuera de 0..4095
+} estadoComp_t;
+
+typedef struct {
+	uint16_t * destino;
+	uint32_t largo;			// N: muestras a decodificar
+	uint32_t escritas;
+	uint32_t bytes;			// Bytes consumidos
+	int32_t anterior;		// Última muestra
+	uint8_t tipo;			// Bloque en curso
+	uint8_t restantes;		// Muestras que faltan del bloque (0: espero cabecera)
+	uint32_t varint;		// Delta en curso
+	uint8_t desplazamiento;
+	estadoComp_t estado;
+} decodificador_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Comp_Iniciar(decodificador_t * d, uint16_t * destino, uint32_t largo);
+estadoComp_t Comp_Decodificar(decodificador_t * d, const uint8_t * datos, uint32_t cantidad);
+
+#endif /* __API_COMPRESION_H */
@@ -0,0 +1,86 @@
+/*******************************************************************************
+  * @file		API_conmutacion.h
+  * @brief      Cambio de señal en marcha sin saltos: políticas de conmutación
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La salida es un anillo de un período que el DMA recorre en círculo. Para
+  * pasar a otra señal del mismo largo se reescribe el anillo, de a mitades,
+  * detrás del DAC: la posición p del anillo es la fase, así que la nueva
+  * señal entra con la misma fase que la que sale. Cuándo y cómo entra lo
+  * decide la política:
+  *  - CONM_INMEDIATO:   en la primera posición que se reescribe,
+  *  - CONM_PERIODO:     al comienzo del período (posición 0),
+  *  - CONM_COINCIDENCIA: en la primera posición donde la nueva difiere de
+  *    la anterior en no más de la tolerancia; si no la hay en un período
+  *    completo, al comienzo del período siguiente,
+  *  - CONM_FUNDIDO:     mezcla lineal de K muestras (K no más que el largo).
+  * Cuando el anillo tiene un período entero de la señal nueva la
+  * conmutación termina y el DMA sigue solo. Cada llamada a Conm_Generar()
+  * hace un trabajo fijo por muestra. Se compila también en la PC
+  * (ver Herramientas/conmutacion_sim.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_CONMUTACION_H
+#define __API_CONMUTACION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define CONM_MAX_TOLERANCIA		4095		// Cuentas del DAC
+#define CONM_MAX_FUNDIDO		16384		// Muestras (N_MAX_MUESTRAS)
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	CONM_REINICIO,				// Sin conmutación: la salida se detiene y arranca de nuevo
+	CONM_INMEDIATO,
+	CONM_PERIODO,
+	CONM_COINCIDENCIA,
+	CONM_FUNDIDO
+} politicaConmutacion_t;
+
+#define CONM_POLITICAS			(CONM_FUNDIDO + 1)
+
+typedef struct {
+	politicaConmutacion_t politica;
+	uint32_t tolerancia;		// TOL: cuentas (COINCIDENCIA)
+	uint32_t fundido;			// K: muestras (FUNDIDO)
+} conmutacion_t;
+
+typedef enum {
+	CONM_ESPERANDO,				// Todavía sale la señal anterior
+	CONM_FUNDIENDO,
+	CONM_COMPLETANDO,			// Sale la nueva: falta completar el anillo
+	CONM_TERMINADA
+} faseConmutacion_t;
+
+typedef struct {
+	conmutacion_t p;
+	const uint16_t * nueva;
+	uint32_t largo;
+	faseConmutacion_t fase;
+	uint32_t revisadas;			// Posiciones revisadas buscando la coincidencia
+	uint32_t mezcladas;			// Muestras del fundido ya escritas
+	uint32_t pesoPaso;			// Q16: 1 / K
+	uint32_t puras;				// Muestras de la nueva escritas desde el cambio
+	uint32_t escritas;			// Muestras escritas hasta el cambio (latencia)
+	uint32_t posicion;			// Posición del anillo donde empezó el cambio
+	bool_t forzada;				// COINCIDENCIA sin coincidencia
+	bool_t primera;				// Todavía no se escribió ninguna muestra
+	uint16_t anterior;			// Última muestra del anillo, en orden de salida
+	uint32_t escalon;			// Mayor salto del cambio hasta la primera muestra pura
+} estadoConmutacion_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Conm_Defecto(conmutacion_t * c);
+bool_t Conm_Interpretar(char * texto, conmutacion_t * c);
+bool_t Conm_Preparar(estadoConmutacion_t * e, const conmutacion_t * c, const uint16_t * nueva, uint32_t largo);
+bool_t Conm_Generar(estadoConmutacion_t * e, uint16_t * anillo, uint32_t posicion, uint32_t cantidad);	// true: terminó
+const char * Conm_Nombre(politicaConmutacion_t politica);
+
+#endif /* __API_CONMUTACION_H */
@@ -0,0 +1,48 @@
+/*******************************************************************************
+  * @file		API_conmutador.h
+  * @brief      Cambio de señal en marcha por el DAC2 (ver API_conmutacion.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Mientras dura la conmutación, la recarga de media transferencia del DMA
+  * (Fijar_Recarga_DAC_DMA) reescribe cada mitad del buffer en curso detrás
+  * del DAC con Conm_Generar(). Al terminar, el buffer es la señal nueva y
+  * el lazo principal quita la recarga: el DMA sigue solo, sin CPU. La
+  * interrupción mide sus ciclos; el plazo es lo que tarda el DAC en llegar
+  * a la mitad que se está reescribiendo.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_CONMUTADOR_H
+#define __API_CONMUTADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_conmutacion.h"
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_medicion.h"
+#include "API_numeros.h"
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t tramos;			// Mitades reescritas
+	uint32_t ciclosMaximo;		// Ciclos de la peor mitad
+	uint32_t escalon;			// Mayor salto del cambio y el fundido (cuentas)
+	uint32_t natural;			// Mayor salto de la señal nueva (cuentas)
+	uint32_t espera;			// Muestras de la anterior antes del cambio
+	bool_t forzada;				// MATCH sin coincidencia: cambió al comenzar el período
+} conmContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Conmutador_Iniciar(const conmutacion_t * c, const uint16_t * nueva, uint32_t largo);	// false: informa el motivo
+bool_t Conmutador_Procesar(void);		// true al terminar (lo informa)
+void Conmutador_Cancelar(void);			// Antes de detener la salida
+bool_t Conmutador_Activo(void);
+void Conmutador_Informar(const conmutacion_t * c);
+
+#endif /* __API_CONMUTADOR_H */
@@ -1,40 +1,94 @@
-/**
-  ******************************************************************************
-  * @file           : main.h
-  * @brief          : Header for API_dac_dma.c file.
-  *                   Manejo de DAC con DMA.
-  ******************************************************************************
-  * @attention
-  *
-  * Copyright (c) 2022 STMicroelectronics.
-  * All rights reserved.
-  *
-  * This software is licensed under terms that can be found in the LICENSE file
-  * in the root directory of this software component.
-  * If no LICENSE file comes with this software, it is provided AS-IS.
-  *
-  ******************************************************************************
-  */
-
-/* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef __API_DAC_DMA_H
-#define __API_DAC_DMA_H
-
-/* Includes ------------------------------------------------------------------*/
-#include <stdio.h>
-#include "stm32f4xx_hal.h"
-#include "stm32f4xx_hal_dac.h"
-#include "errorHandler.h"
-/*#include <stdlib.h>
-#include "stm32f4xx_nucleo_144.h"
-#include <stdint.h>
-#include <stdbool.h> */
-
-/* Funciones públicas --------------------------------------------------------*/
-void Inicializar_DAC_DMA(void);
-void Comenzar_DAC_DMA(uint32_t * Datos, uint32_t Num_Datos);
-void Parar_DAC_DMA(void);
-
-/* Private includes ----------------------------------------------------------*/
-
-#endif /* __API_DAC_DMA_H */
+/**
+  ******************************************************************************
+  * @file           : main.h
+  * @brief          : Header for API_dac_dma.c file.
+  *                   Manejo de DAC con DMA.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_DAC_DMA_H
+#define __API_DAC_DMA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_hal_dac.h"
+#include "errorHandler.h"
+#include "API_ring.h"
+/*#include <stdlib.h>
+#include "stm32f4xx_nucleo_144.h"
+#include <stdint.h>
+#include <stdbool.h> */
+
+/* Macros públicas -----------------------------------------------------------*/
+#define FRECUENCIA_TIM2		84000000	// Hz: reloj de TIM2 (APB1 x 2)
+#define PERIODO_DAC_DEFECTO	7			// ARR de TIM2: 84 MHz / 8 = 10,5 Msps
+#define PERIODO_DAC_MINIMO	7			// Más rápido el DMA no alcanza al DAC
+#define PERIODO_PUNTOS_MINIMO	15		// Con puntos cada disparo pide dos DMA
+#define ONDA_DAC_MAX_BITS	12			// MAMP2: bits del contador o del LFSR
+
+/* Typedef públicos ----------------------------------------------------------*/
+// Recarga de media transferencia: se llama desde la interrupción del DMA con
+// la mitad del buffer que el DAC acaba de terminar de leer.
+typedef void (*recargaDAC_t)(uint16_t * mitad, uint32_t cantidad);
+
+// Secuencias: se llama desde la interrupción de transferencia completa con
+// las muestras que le faltan a la memoria que acaba de empezar; devuelve el
+// bloque que sigue, que se escribe en la memoria que quedó libre.
+typedef const uint16_t * (*siguienteDAC_t)(uint32_t quedan);
+
+// Eventos que las interrupciones del DAC/DMA informan al lazo principal
+typedef enum {
+	DAC_EVENTO_SUBEJECUCION,	// El DMA no llegó a tiempo al disparo del timer
+	DAC_EVENTO_ERROR_DMA,
+	DAC_EVENTO_CAMBIO,			// Se completó un Cambiar_Datos_DAC_DMA()
+	DAC_EVENTO_REPOSO			// DOR2 no tomó el reposo: el DAC no responde
+} eventoDAC_t;
+
+// Generadores propios del DAC: con cada disparo suman a DHR un contador
+// triangular o un LFSR, con 'bits' bits de amplitud
+typedef enum {
+	ONDA_DAC_NINGUNA,
+	ONDA_DAC_TRIANGULAR,
+	ONDA_DAC_RUIDO
+} ondaDAC_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Inicializar_DAC_DMA(void);
+void Comenzar_DAC_DMA(uint16_t * Datos, uint32_t Num_Datos);
+void Parar_DAC_DMA(void);
+bool_t Leer_Evento_DAC_DMA(eventoDAC_t * evento);
+void Fijar_Periodo_DAC_DMA(uint32_t periodo);
+uint32_t Leer_Periodo_DAC_DMA(void);
+uint32_t Leer_Ciclos_Muestra_DAC_DMA(void);		// Presupuesto de CPU por muestra
+void Fijar_Recarga_DAC_DMA(recargaDAC_t recarga);
+void Cambiar_Datos_DAC_DMA(uint16_t * Datos);
+uint16_t * Leer_Datos_DAC_DMA(void);
+uint32_t Leer_Ciclo_Cambio_DAC_DMA(void);
+void Fijar_Valor_DAC_DMA(uint16_t Valor);		// Salida fija, sin DMA (calibración)
+void Detener_Disparo_DAC_DMA(void);			// Congela TIM2 (DAC y ADC a la vez)
+void Reanudar_Disparo_DAC_DMA(void);
+void Comenzar_Tabla_DAC_DMA(uint16_t * Datos, uint32_t Num_Datos);	// Circular, sin interrupciones
+void Fijar_Compuerta_DAC_DMA(bool_t Compuerta);	// TIM2 cuenta sólo con TRGO de TIM3 en alto
+void Preparar_Disparo_DAC_DMA(void);		// Compuerta cerrada: próximo disparo a un ciclo
+bool_t Fijar_Reposo_DAC_DMA(uint16_t Reposo, uint16_t Proxima);
+void Comenzar_Secuencia_DAC_DMA(const uint16_t * Primero, const uint16_t * Segundo, uint32_t Num_Datos,
+		                        siguienteDAC_t Siguiente);
+void Comenzar_Puntos_DAC_DMA(const uint16_t * Valores, const uint32_t * Periodos, uint32_t Num_Datos);
+void Parar_Puntos_DAC_DMA(void);			// TIM2 vuelve al ARR de antes
+void Fijar_Onda_DAC_DMA(ondaDAC_t Onda, uint32_t Bits);	// Sin DMA ni CPU por muestra
+
+/* Private includes ----------------------------------------------------------*/
+
+#endif /* __API_DAC_DMA_H */
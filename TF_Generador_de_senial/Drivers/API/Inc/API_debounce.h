@@ -1,38 +1,87 @@
-/*******************************************************************************
-* @file    API_debounce.h
-* @author  Guillermo Caporaletti
-* @brief   CESE_Co18 - Práctica 4 - Punto 2:
-*          Implementación de módulo anti-rebote de pulsador.
-*******************************************************************************/
-
-/* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef __API_DEBOUNCE_H
-#define __API_DEBOUNCE_H
-
-/* Includes ------------------------------------------------------------------*/
-#include <errorHandler.h>
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include "stm32f4xx_hal.h"  		/* <- HAL include */
-#include "API_delay.h"
-#include "../../BSP/stm32f4xx_nucleo_144.h" 	/* <- BSP include */
-
-/* Types ---------------------------------------------------------------------*/
-
-/* Constants -----------------------------------------------------------------*/
-
-/* Funciones públicas---------------------------------------------------------*/
-
-void debounceFSM_init();		// Carga el estado inicial de la MFE antirrebote
-void debounceFSM_update();		// Actualiza estado de MFE antirrebote:
-								// Lee las entradas, resuelve la lógica de transición
-								// y actualizar las salidas.
-bool_t readKeyPush();
-bool_t readKeyRelease();
-bool_t readPresionadoLargo();
-
-/*----------------------------------------------------------------------------*/
-#endif /* __MAIN_H */
-
-/***************************************************************END OF FILE****/
+/*******************************************************************************
+* @file    API_debounce.h
+* @author  Guillermo Caporaletti
+* @brief   Módulo anti-rebote de pulsadores por puerto GPIO completo.
+*          Muestrea el registro IDR desde la interrupción periódica (SysTick)
+*          y resuelve los 16 pines en paralelo con contadores verticales.
+*******************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_DEBOUNCE_H
+#define __API_DEBOUNCE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#if defined(__arm__)
+#include <errorHandler.h>
+#include "stm32f4xx_hal.h"  		/* <- HAL include */
+#include "API_delay.h"
+#include "../../BSP/stm32f4xx_nucleo_144.h" 	/* <- BSP include */
+#else
+// Compilación en la PC (Herramientas/debounce_bench.c): el puerto es una
+// variable en memoria y el banco de pruebas escribe su IDR.
+typedef struct {
+	volatile uint32_t IDR;
+} GPIO_TypeDef;
+#define GPIO_PIN_All			((uint16_t) 0xFFFF)
+#endif
+#include "API_ring.h"
+
+/* Constants -----------------------------------------------------------------*/
+#define DEBOUNCE_PERIODO_MS		8		// Una muestra cada 8 ticks de SysTick (1 ms).
+										// El contador vertical valida con 4 muestras
+										// iguales: ventana antirrebote de 32 ms.
+#define DEBOUNCE_BITS_LARGO		6		// Contador vertical de presionado largo:
+										// satura en 63 muestras = 504 ms.
+#define DEBOUNCE_MAX_PUERTOS	4		// Puertos que pueden registrarse
+#define DEBOUNCE_EVENTOS		8		// Registros de eventos por puerto (potencia de 2)
+
+/* Types ---------------------------------------------------------------------*/
+// Eventos de una muestra: la interrupción los encola, el lazo principal los lee.
+typedef struct {
+	uint16_t presionados;
+	uint16_t liberados;
+	uint16_t largos;						// Se marcan junto con la liberación
+} debounceEvento_t;
+
+// Antirrebote de un puerto: cada bit de los campos uint16_t es un pin.
+typedef struct {
+	GPIO_TypeDef * puerto;					// Puerto muestreado (se lee IDR completo)
+	uint16_t mascara;						// Pines considerados
+	uint16_t activosBajo;					// Pines que están presionados en '0'
+	uint16_t estable;						// Estado validado (1 = presionado)
+	uint16_t cont0;							// Contador vertical de 2 bits por pin
+	uint16_t cont1;
+	uint16_t largo[DEBOUNCE_BITS_LARGO];	// Contador vertical de tiempo presionado
+	ring_t eventos;							// Interrupción -> lazo principal
+	debounceEvento_t memoriaEventos[DEBOUNCE_EVENTOS];
+	debounceEvento_t pendientes;			// Eventos ya sacados del buffer y no leídos
+	uint32_t eventosPerdidos;				// Buffer de eventos lleno
+	uint32_t ciclosUltimo;					// Costo de la última muestra (ciclos CPU)
+	uint32_t ciclosMaximo;					// Peor caso observado
+} debouncePuerto_t;
+
+/* Funciones públicas---------------------------------------------------------*/
+
+// Antirrebote por puerto:
+void debouncePuerto_init(debouncePuerto_t * p, GPIO_TypeDef * puerto,
+		                 uint16_t mascara, uint16_t activosBajo);
+void debouncePuerto_muestrear(debouncePuerto_t * p);	// Un paso del contador vertical
+uint16_t debouncePuerto_leerPresionados(debouncePuerto_t * p, uint16_t pines);
+uint16_t debouncePuerto_leerLiberados(debouncePuerto_t * p, uint16_t pines);
+uint16_t debouncePuerto_leerLargos(debouncePuerto_t * p, uint16_t pines);
+uint16_t debouncePuerto_estado(debouncePuerto_t * p);
+void debounceTick(void);				// Llamar desde SysTick_Handler
+
+// Pulsador de usuario (vistas sobre el puerto del pulsador):
+void debounceFSM_init();		// Registra el puerto del pulsador de usuario
+bool_t readKeyPush();
+bool_t readKeyRelease();
+bool_t readPresionadoLargo();
+
+/*----------------------------------------------------------------------------*/
+#endif /* __API_DEBOUNCE_H */
+
+/***************************************************************END OF FILE****/
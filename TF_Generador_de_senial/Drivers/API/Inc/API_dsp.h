@@ -0,0 +1,54 @@
+/*******************************************************************************
+  * @file		API_dsp.h
+  * @brief      Procesamiento en tiempo real: ADC1 -> filtro -> DAC2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La entrada es PA3 (A0 de la Nucleo-144) y la salida el DAC2 en PA5.
+  * El ADC1 y el DAC2 convierten con el mismo disparo de TIM2, cada uno con
+  * un buffer de dos mitades de 'bloque' muestras. Cuando el DMA del ADC
+  * completa una mitad, su interrupción la filtra (API_filtro.h) y escribe el
+  * resultado en la misma mitad del buffer del DAC, que éste ya leyó y vuelve
+  * a leer un bloque después.
+  * Latencia: 2 x bloque + 1 muestras (la muestra n sale con el disparo
+  * 2 x bloque + n + 1). Plazo del cálculo: un bloque.
+  * Los coeficientes nuevos entran al comienzo de un bloque, con el estado
+  * del filtro en cero.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_DSP_H
+#define __API_DSP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <errorHandler.h>
+#include "API_filtro.h"
+#include "API_uart.h"
+#include "API_adc.h"
+#include "API_bloques.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define DSP_BLOQUE_DEFECTO		64
+#define DSP_BLOQUE_MINIMO		4
+#define DSP_BLOQUE_MAXIMO		FILTRO_MAX_BLOQUE
+#define DSP_ENTRADA				ADC_ENTRADA_PA3		// No PA5: ahí está la salida
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	bloquesContadores_t bloque;	// Saturadas: en los biquads o a la salida
+	uint32_t desbordes;			// Conversiones del ADC perdidas
+} dspContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Dsp_Iniciar(const coefFiltro_t * c, uint32_t bloque);	// false: informa el motivo
+bool_t Dsp_Aplicar(const coefFiltro_t * c);		// En marcha: entra en el próximo bloque
+void Dsp_Parar(void);
+bool_t Dsp_Activo(void);
+uint32_t Dsp_Bloque(void);
+void Dsp_Contadores(dspContadores_t * contadores);
+void Dsp_Informar(void);
+
+#endif /* __API_DSP_H */
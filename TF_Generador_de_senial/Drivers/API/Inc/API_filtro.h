@@ -0,0 +1,73 @@
+/*******************************************************************************
+  * @file		API_filtro.h
+  * @brief      Filtros en punto fijo: FIR en Q15 y cascada de biquads en Q14,
+  *             procesados por bloques
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Las muestras de 12 bits (0..4095) se centran en FILTRO_CENTRO y pasan por
+  * el FIR y luego por los biquads (forma directa I), con resultados
+  * intermedios de 16 bits: 24 dB de margen sobre la señal de 12 bits.
+  * La salida se vuelve a centrar y se satura a 0..4095.
+  *  - FIR: y[n] = sum h[k] x[n-k], h en Q15. Dos coeficientes por
+  *    instrucción (SMLAD) y dos salidas por vuelta. El acumulador es de 32
+  *    bits: se rechazan los FIR con sum |h| >= 32 (FILTRO_NORMA_MAXIMA),
+  *    así nunca desborda.
+  *  - Biquad: y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2],
+  *    coeficientes en Q14 (|c| < 2), acumulador de 64 bits (SMLALD).
+  * Ambos redondean al más cercano y saturan a 16 bits. En la PC se usan
+  * equivalentes en C de las instrucciones con el mismo resultado bit a bit
+  * (Herramientas/filtro_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_FILTRO_H
+#define __API_FILTRO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_numeros.h"
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define FILTRO_MAX_TAPS			128		// Coeficientes del FIR
+#define FILTRO_MAX_ETAPAS		4		// Biquads en cascada
+#define FILTRO_MAX_BLOQUE		256		// Muestras por llamada a Filtro_Procesar
+#define FILTRO_BITS_FIR			15		// h en Q15
+#define FILTRO_BITS_BIQUAD		14		// b y a en Q14
+#define FILTRO_CENTRO			2048	// Cero de la señal de 12 bits
+#define FILTRO_MAX_DAC			0x0FFF
+#define FILTRO_NORMA_MAXIMA		((INT32_MAX - (1L << (FILTRO_BITS_FIR - 1))) / FILTRO_CENTRO)
+
+/* Typedef públicos ----------------------------------------------------------*/
+// Coeficientes tal como se cargan (comandos FIR, TAP y BQ)
+typedef struct {
+	uint32_t taps;									// 0: sin FIR
+	int16_t fir[FILTRO_MAX_TAPS];					// h[0] multiplica a la muestra más nueva
+	uint32_t etapas;								// 0: sin biquads
+	int16_t biquad[FILTRO_MAX_ETAPAS][5];			// b0 b1 b2 a1 a2 (a0 = 1)
+} coefFiltro_t;
+
+// Filtro listo para procesar: coeficientes empaquetados de a dos y estado
+typedef struct {
+	uint32_t pares;									// Pares de coeficientes del FIR
+	uint32_t fir[FILTRO_MAX_TAPS / 2];				// h invertidos, dos por palabra
+	int16_t historia[FILTRO_MAX_TAPS + FILTRO_MAX_BLOQUE];	// Entradas previas + bloque
+	uint32_t etapas;
+	uint32_t biquad[FILTRO_MAX_ETAPAS][2];			// {b0,b1} {b2,-a1}
+	int16_t menosA2[FILTRO_MAX_ETAPAS];
+	int16_t estado[FILTRO_MAX_ETAPAS][4];			// x[n-1] x[n-2] y[n-1] y[n-2]
+} filtro_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Filtro_Defecto(coefFiltro_t * c);			// Sin FIR ni biquads: la salida copia la entrada
+bool_t Filtro_Interpretar_Fir(const char * texto, coefFiltro_t * c);		// "<taps>"
+bool_t Filtro_Interpretar_Taps(const char * texto, coefFiltro_t * c);		// "<k> <h> [<h> ...]"
+bool_t Filtro_Interpretar_Biquad(const char * texto, coefFiltro_t * c);	// "<e> b0 b1 b2 a1 a2" | "CLR"
+uint32_t Filtro_Norma(const coefFiltro_t * c);	// sum |h| (Q15)
+bool_t Filtro_Preparar(filtro_t * f, const coefFiltro_t * c);		// false si el FIR puede desbordar
+uint32_t Filtro_Procesar(filtro_t * f, const uint16_t * entrada, uint16_t * salida, uint32_t largo);
+
+#endif /* __API_FILTRO_H */
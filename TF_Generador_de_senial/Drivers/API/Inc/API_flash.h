@@ -0,0 +1,32 @@
+/*******************************************************************************
+  * @file		API_flash.h
+  * @brief      Datos persistentes en el último sector de la flash
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * El sector 23 (0x081E0000, 128 KB) queda fuera del programa: el linker
+  * (STM32F429ZITX_FLASH.ld) usa sólo los primeros 1920 KB.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_FLASH_H
+#define __API_FLASH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define FLASH_DATOS_DIRECCION	0x081E0000UL	// Sector 23
+#define FLASH_DATOS_SECTOR		FLASH_SECTOR_23
+#define FLASH_DATOS_LARGO		(128 * 1024)
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bool bool_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+const void * Flash_Leer(void);					// Borrada: todo en 0xFF
+bool_t Flash_Guardar(const void * datos, uint32_t largo);
+
+#endif /* __API_FLASH_H */
@@ -0,0 +1,61 @@
+/*******************************************************************************
+  * @file		API_fourier.h
+  * @brief      Síntesis de una señal periódica a partir de sus armónicos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La señal es OFF + suma de AMP_k * sin(2*pi*k*n/N + FASE_k). Se sube la
+  * lista de armónicos (O(armónicos) bytes) en lugar de las N muestras.
+  * Dos métodos:
+  *  - Directo: acumulación con la tabla de seno, costo O(armónicos * N).
+  *  - FFT inversa radix-2 (N potencia de 2), costo O(N log N).
+  * Código C puro: también compila en la PC (ver Herramientas/fourier_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_FOURIER_H
+#define __API_FOURIER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "API_sintesis.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define FOURIER_MAX_ARMONICOS	32
+#define FOURIER_MAX_LARGO		8192	// Limitado por el buffer de trabajo en CCM RAM
+#define FOURIER_MAX_AMPLITUD	4095
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	FOURIER_AUTOMATICO,		// FFT si N es potencia de 2 y conviene
+	FOURIER_DIRECTO,
+	FOURIER_FFT
+} metodoFourier_t;
+
+typedef struct {
+	uint16_t indice;		// k: múltiplo de la fundamental (1..N/2-1)
+	uint16_t amplitud;		// Amplitud pico en cuentas del DAC
+	uint16_t fase;			// Grados
+} armonico_t;
+
+typedef struct {
+	uint32_t largo;			// N: muestras por período
+	int32_t offset;			// Valor medio en cuentas del DAC
+	metodoFourier_t metodo;
+	uint8_t cantidad;		// Armónicos cargados
+	armonico_t armonicos[FOURIER_MAX_ARMONICOS];
+} fourier_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Fourier_Iniciar(fourier_t * f);
+bool_t Fourier_Interpretar(char * texto, fourier_t * f);			// "N=.. OFF=.. MODE=.."
+bool_t Fourier_Interpretar_Armonico(char * texto, fourier_t * f);	// "<k> <amp> <fase>"
+bool_t Fourier_Agregar(fourier_t * f, uint16_t indice, uint16_t amplitud, uint16_t fase);
+bool_t Fourier_Valido(const fourier_t * f);
+metodoFourier_t Fourier_Metodo(const fourier_t * f);
+uint32_t Fourier_Sintetizar(const fourier_t * f, uint16_t * destino);
+
+#endif /* __API_FOURIER_H */
@@ -1,50 +1,119 @@
-/*******************************************************************************
-  * @file		API_generador.h
-  * @brief      Maneja acciones de los estados del
-  *             Generador de señales con entrada por UART
-  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
-  ******************************************************************************
-  */
-
-/* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef __API_GENERADOR_H
-#define __API_GENERADOR_H
-
-/* Includes ------------------------------------------------------------------*/
-#include "stm32f4xx_hal.h"
-#include <stdlib.h>
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include "stm32f4xx_hal_dac.h"
-#include <errorHandler.h>
-#include "API_delay.h"
-#include "API_debounce.h"
-#include "API_uart.h"
-#include "API_dac_dma.h"
-
-/* Macros públicas -----------------------------------------------------------*/
-#define N_MUESTRAS			105		// Muestras en un período de señal
-
-/* Typedef públicos ----------------------------------------------------------*/
-// Los estados por los que puede pasar cada generador (DAC1 o DAC2)
-typedef enum {
-	Espera,
-	Vacio = Espera,
-	Recibiendo,
-	Cargado,
-	Generando,
-	Pausa
-} estadosMEF;
-
-/* Funciones públicas --------------------------------------------------------*/
-void Gen_Init(void);
-void Gen_Espera(void);
-void Gen_Recibir(void);
-void Gen_Cargar(uint32_t Senial[]);
-void Gen_Encender(void);
-void Gen_Pausar(void);
-estadosMEF Gen_Estado(void);
-void Gen_Actualiza_Leds(void);
-
-#endif /* __API_GENERADOR_H */
+/*******************************************************************************
+  * @file		API_generador.h
+  * @brief      Maneja acciones de los estados del
+  *             Generador de señales con entrada por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_GENERADOR_H
+#define __API_GENERADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal_dac.h"
+#include <errorHandler.h>
+#include "API_delay.h"
+#include "API_debounce.h"
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_stream.h"
+#include "API_sintesis.h"
+#include "API_fourier.h"
+#include "API_interpolacion.h"
+#include "API_compresion.h"
+#include "API_acondicionamiento.h"
+#include "API_compensacion.h"
+#include "API_calibracion.h"
+#include "API_adc.h"
+#include "API_dsp.h"
+#include "API_rafaga.h"
+#include "API_wobulador.h"
+#include "API_modulador.h"
+#include "API_secuenciador.h"
+#include "API_trazador.h"
+#include "API_conmutador.h"
+#include "API_ondas_dac.h"
+#include "API_ruido.h"
+#include "API_flash.h"
+#include "API_medicion.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define N_MUESTRAS			105		// Muestras en un período de señal cargada por UART
+#define N_MAX_MUESTRAS		SINT_MAX_LARGO	// Máximo de muestras por período (señal sintetizada)
+
+/* Typedef públicos ----------------------------------------------------------*/
+// Los estados por los que puede pasar cada generador (DAC1 o DAC2)
+typedef enum {
+	Espera,
+	Vacio = Espera,
+	Recibiendo,
+	Cargado,
+	Generando,
+	Pausa,
+	Reproduciendo,			// Streaming: muestras continuas desde la UART
+	Filtrando,				// La salida es la entrada del ADC filtrada
+	Rafaga,					// K períodos por disparo, en reposo entre disparos
+	Barriendo,				// Barrido de frecuencia (chirp o pasos)
+	Modulando,				// Modulación AM, FM, PM o PWM
+	Secuenciando,			// Secuencia de segmentos con repeticiones
+	Trazando,				// Puntos, cada uno con su propia duración
+	Autonomo,				// Triangular o ruido del propio DAC (sin CPU)
+	Aleatorio				// PRBS o ruido uniforme o gaussiano
+} estadosMEF;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Gen_Init(void);
+void Gen_Espera(void);
+void Gen_Recibir(void);
+void Gen_Cargar(const uint16_t Senial[], uint32_t Largo);
+void Gen_Sintetizar(const sintesis_t * Parametros);
+void Gen_Fourier(const fourier_t * Armonicos);
+void Gen_Interpolar(const interpolacion_t * Puntos);
+void Gen_Descomprimir(uint32_t Largo);
+bool_t Gen_Descomprimiendo(void);
+void Gen_Procesar_Descompresion(void);
+void Gen_Encender(void);
+void Gen_Pausar(void);
+void Gen_Stream(uint32_t periodo);
+void Gen_Terminar_Stream(void);
+bool_t Gen_Filtrar(const coefFiltro_t * Coeficientes, uint32_t Bloque);
+void Gen_Terminar_Filtro(void);
+void Gen_Rafaga(const rafaga_t * Parametros);
+void Gen_Disparar(void);
+void Gen_Terminar_Rafaga(void);
+bool_t Gen_Barrer(const barrido_t * Parametros);
+void Gen_Terminar_Barrido(void);
+bool_t Gen_Modular(const modulacion_t * Parametros);
+void Gen_Terminar_Modulacion(void);
+bool_t Gen_Agregar_Segmento(uint32_t Repeticiones);
+bool_t Gen_Secuenciar(void);
+void Gen_Terminar_Secuencia(void);
+bool_t Gen_Trazar(void);
+void Gen_Terminar_Trazado(void);
+bool_t Gen_Onda_DAC(const ondasDAC_t * Parametros);
+void Gen_Terminar_Onda_DAC(void);
+bool_t Gen_Aleatorio(const aleatorio_t * Parametros);
+void Gen_Terminar_Aleatorio(void);
+estadosMEF Gen_Estado(void);
+uint32_t Gen_Largo(void);
+void Gen_Fijar_Ganancia(int16_t Ganancia);	// Q12: sin volver a cargar la señal
+void Gen_Fijar_Offset(int16_t Offset);
+int16_t Gen_Ganancia(void);
+int16_t Gen_Offset(void);
+void Gen_Calibrar(void);					// Barre el DAC y lo mide con el ADC
+bool_t Gen_Usar_Calibracion(bool_t Usar);	// false si no hay calibración
+void Gen_Informar_Calibracion(void);
+bool_t Gen_Compensar_Retencion(uint32_t Taps);	// 0: sin compensar; false si no hay diseño
+void Gen_Informar_Compensacion(void);
+void Gen_Fijar_Conmutacion(const conmutacion_t * Politica);
+const conmutacion_t * Gen_Conmutacion(void);
+void Gen_Actualiza_Leds(void);
+void Gen_Procesar_Eventos(void);
+
+#endif /* __API_GENERADOR_H */
@@ -0,0 +1,50 @@
+/*******************************************************************************
+  * @file		API_interpolacion.h
+  * @brief      Expansión de puntos de control a un período completo
+  *             (interpolación lineal o Catmull-Rom)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Se suben K puntos de control equiespaciados en el período y el dispositivo
+  * los expande a N muestras: la carga por UART baja en un factor N/K.
+  * La señal es periódica: después del último punto se vuelve al primero.
+  * Los núcleos usan las instrucciones SIMD de 16 bits del Cortex-M4
+  * (SMUAD/SMLAD: dos productos y la suma en un ciclo).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_INTERPOLACION_H
+#define __API_INTERPOLACION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "API_sintesis.h"
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define INTERP_MAX_PUNTOS		256
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	INTERP_LINEAL,
+	INTERP_CATMULL_ROM		// Cúbica que pasa por los puntos (puede sobrepasarlos)
+} metodoInterp_t;
+
+typedef struct {
+	uint32_t largo;			// N: muestras por período
+	metodoInterp_t metodo;
+	uint16_t cantidad;		// K: puntos cargados
+	uint16_t puntos[INTERP_MAX_PUNTOS];
+} interpolacion_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Interp_Iniciar(interpolacion_t * p);
+bool_t Interp_Interpretar(char * texto, interpolacion_t * p);	// "N=.. MODE=LIN|CR"
+bool_t Interp_Agregar(interpolacion_t * p, uint16_t punto);
+bool_t Interp_Valido(const interpolacion_t * p);
+uint32_t Interp_Expandir(const interpolacion_t * p, uint16_t * destino);
+
+#endif /* __API_INTERPOLACION_H */
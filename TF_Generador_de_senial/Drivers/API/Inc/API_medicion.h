@@ -0,0 +1,25 @@
+/*******************************************************************************
+* @file    API_medicion.h
+* @author  Guillermo Caporaletti
+* @brief   Medición de tiempos de ejecución con el contador de ciclos DWT
+*          del Cortex-M4.
+*******************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_MEDICION_H
+#define __API_MEDICION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#if defined(__arm__)
+#include "stm32f4xx_hal.h"  		/* <- HAL include */
+#endif
+
+/* Functions -----------------------------------------------------------------*/
+void medicionInit(void);		// Habilita el contador de ciclos
+uint32_t medicionCiclos(void);	// Lectura actual del contador de ciclos
+
+/*----------------------------------------------------------------------------*/
+#endif /* __API_MEDICION_H */
+
+/***************************************************************END OF FILE****/
@@ -0,0 +1,96 @@
+/*******************************************************************************
+  * @file		API_modulacion.h
+  * @brief      Modulación AM, FM, PM y PWM en punto fijo, de a bloques
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Portadora y modulante son osciladores DDS con fase de 32 bits (2^32 = un
+  * ciclo). La portadora es el seno de API_sintesis.h o la señal cargada,
+  * recorrida como tabla con interpolación lineal; la modulante es un seno,
+  * una triangular o una cuadrada. Cada muestra combina las dos:
+  *  - AM:  offset + amp x c(fp) x (1 + m x s(fm))     (pico amp x (1 + m))
+  *  - FM:  el paso de la portadora suma desvío x s(fm)
+  *  - PM:  la fase de la portadora suma desvío x s(fm)
+  *  - PWM: pulso de la portadora con ciclo de trabajo 50% x (1 + m x s(fm))
+  * Profundidad y desvío (el "índice") cambian sin escalones: en cada bloque
+  * el índice se acerca al pedido en 1/2^MOD_SUAVIZADO de lo que falta, con
+  * una rampa lineal dentro del bloque. Las frecuencias cambian sólo el paso:
+  * la fase es continua. Se compila también en la PC
+  * (ver Herramientas/modulacion_bench.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_MODULACION_H
+#define __API_MODULACION_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_sintesis.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define MOD_MAX_FRECUENCIA		5250000		// Hz: la mitad de la fs máxima
+#define MOD_MAX_GRADOS			179			// Desvío de PM (media vuelta no entra)
+#define MOD_BLOQUE_MAXIMO		256			// Muestras por rampa del índice
+#define MOD_SUAVIZADO			2			// Cada bloque recorre 1/4 de lo que falta
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef enum {
+	MOD_AM,
+	MOD_FM,
+	MOD_PM,
+	MOD_PWM
+} tipoModulacion_t;
+
+#define MOD_TIPOS				(MOD_PWM + 1)
+
+typedef enum {
+	MOD_SENO,
+	MOD_TRIANGULAR,
+	MOD_CUADRADA
+} formaModulante_t;
+
+typedef struct {
+	tipoModulacion_t tipo;
+	formaModulante_t forma;		// WAVE: forma de la modulante
+	bool_t tabla;				// CAR=TABLE: la portadora es la señal cargada
+	uint32_t portadora;			// FC: Hz
+	uint32_t modulante;			// FMOD: Hz
+	uint32_t profundidad;		// DEPTH: % (AM y PWM)
+	uint32_t desvio;			// DEV: Hz (FM) o grados (PM)
+	int32_t amplitud;			// AMP: cuentas del DAC
+	int32_t offset;				// OFF: cuentas del DAC
+} modulacion_t;
+
+// Parámetros ya convertidos a pasos de fase para una fs
+typedef struct {
+	modulacion_t p;
+	uint32_t pasoPortadora;		// Q0.32: ciclos por muestra
+	uint32_t pasoModulante;
+	int32_t indice;				// AM y PWM: m en Q30; FM: desvío del paso, Q0.32;
+								// PM: desvío de fase, Q0.32
+} ajusteModulacion_t;
+
+typedef struct {
+	ajusteModulacion_t a;		// a.indice es el índice pedido
+	const uint16_t * tabla;		// Portadora de tabla (NULL: seno)
+	uint32_t largo;
+	uint32_t fasePortadora;
+	uint32_t faseModulante;
+	int32_t indice;				// Índice actual (se acerca a a.indice)
+	int16_t modulante[MOD_BLOQUE_MAXIMO];	// s(fm) del bloque, Q15
+} estadoModulacion_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Mod_Defecto(modulacion_t * m);
+bool_t Mod_Interpretar(char * texto, modulacion_t * m);
+bool_t Mod_Calcular(ajusteModulacion_t * a, const modulacion_t * m, uint32_t reloj, uint32_t divisor);
+bool_t Mod_Preparar(estadoModulacion_t * e, const ajusteModulacion_t * a, const uint16_t * tabla, uint32_t largo);
+void Mod_Ajustar(estadoModulacion_t * e, const ajusteModulacion_t * a);	// Sin cortar la salida
+uint32_t Mod_Generar(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad);	// Devuelve las saturadas
+const char * Mod_Nombre(tipoModulacion_t tipo);
+const char * Mod_Nombre_Forma(formaModulante_t forma);
+
+#endif /* __API_MODULACION_H */
@@ -0,0 +1,54 @@
+/*******************************************************************************
+  * @file		API_modulador.h
+  * @brief      Modulación AM, FM, PM y PWM en tiempo real por el DAC2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Una salida por bloques (API_bloques.h): el DAC2 recorre un buffer de
+  * dos mitades de MOD_MITAD muestras y la interrupción de media
+  * transferencia genera la mitad que ya leyó con API_modulacion.h, a la
+  * frecuencia de muestras de TIM2 (RATE).
+  * Frecuencias, profundidad y desvío cambian en marcha: el lazo principal
+  * deja el ajuste y la interrupción lo toma al comenzar el bloque siguiente
+  * (la profundidad y el desvío llegan con el suavizado de API_modulacion.h).
+  * Al arrancar se mide el costo de un bloque de cada tipo de modulación con
+  * la misma portadora y modulante: Modulador_Capacidad() informa la fs
+  * máxima de cada tipo para una fracción de la CPU.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_MODULADOR_H
+#define __API_MODULADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_modulacion.h"
+#include "API_uart.h"
+#include "API_bloques.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define MOD_MITAD				128		// Muestras por bloque (media transferencia)
+#define MOD_PRESUPUESTO_CPU		80		// % de la CPU para la fs máxima, por defecto
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	bloquesContadores_t bloque;	// Bloques, ciclos, saturadas y atrasos
+	uint32_t ajustes;			// Ajustes en marcha que tomó la interrupción
+} modContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Modulador_Iniciar(const modulacion_t * m, const uint16_t * tabla, uint32_t largo);	// false: informa el motivo
+bool_t Modulador_Compatible(const modulacion_t * m);	// Se puede ajustar sin reiniciar
+bool_t Modulador_Aplicar(const modulacion_t * m);		// false: informa el motivo
+void Modulador_Parar(void);
+bool_t Modulador_Activo(void);
+void Modulador_Contadores(modContadores_t * contadores);
+void Modulador_Informar(void);
+void Modulador_Capacidad(const modulacion_t * m, uint32_t porcentaje);
+
+#endif /* __API_MODULADOR_H */
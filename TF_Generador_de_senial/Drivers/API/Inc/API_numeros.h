@@ -0,0 +1,50 @@
+/*******************************************************************************
+* @file    API_numeros.h
+* @author  Guillermo Caporaletti
+* @brief   Lectura y escritura de números decimales sin la biblioteca C
+*          (reemplaza atoi, strtol y sprintf en el camino de la UART).
+*          No reserva memoria: todo se escribe en buffers del llamador.
+*******************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_NUMEROS_H
+#define __API_NUMEROS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Constants -----------------------------------------------------------------*/
+#define NUM_MAX_DIGITOS		11		// "-2147483648"
+
+/* Types ---------------------------------------------------------------------*/
+typedef bool bool_t;
+
+// Acumulador de dígitos que llegan de a uno (p.ej. por UART)
+typedef struct {
+	uint32_t valor;
+	uint32_t maximo;				// Valor admitido
+	uint8_t digitos;
+	bool_t fueraDeRango;			// Se pasó de 'maximo' (deja de acumular)
+} acumuladorDecimal_t;
+
+/* Functions -----------------------------------------------------------------*/
+// Lectura incremental:
+void Num_Iniciar(acumuladorDecimal_t * a, uint32_t maximo);
+bool_t Num_Digito(acumuladorDecimal_t * a, uint8_t caracter);	// false si no es dígito
+bool_t Num_Valido(const acumuladorDecimal_t * a);
+
+// Lectura de un texto completo:
+bool_t Num_Leer(const char * texto, int32_t minimo, int32_t maximo, int32_t * valor,
+		        const char ** fin);
+
+// Escritura: devuelven el puntero al final (donde quedó el '\0')
+char * Num_AgregarDecimal(char * destino, uint32_t valor);
+char * Num_AgregarEntero(char * destino, int32_t valor);
+char * Num_AgregarTexto(char * destino, const char * texto);
+
+/*----------------------------------------------------------------------------*/
+#endif /* __API_NUMEROS_H */
+
+/***************************************************************END OF FILE****/
@@ -0,0 +1,55 @@
+/*******************************************************************************
+  * @file		API_ondas_dac.h
+  * @brief      Triangular y ruido con los generadores propios del DAC2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * El DAC2 suma a DHR12R2, con cada disparo de TIM2, un contador triangular
+  * (sube de 0 a 2^BITS - 1 y baja) o BITS bits de un LFSR de 12 bits
+  * (ruido pseudoaleatorio que se repite cada 4095 disparos). No hace falta
+  * buffer ni DMA ni interrupciones:
+  *  - BASE=<cuentas>: DHR queda fijo; la salida no usa memoria ni DMA,
+  *  - BASE=SIG: el DMA recorre la señal cargada (con ganancia, offset y
+  *    corrección) y el generador le suma la triangular o el ruido: ruido
+  *    de dither a la frecuencia de muestras.
+  * La frecuencia la fija el disparo (RATE): la triangular dura
+  * 2 x (2^BITS - 1) disparos.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_ONDAS_DAC_H
+#define __API_ONDAS_DAC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define ONDAS_LARGO_LFSR		4095	// Disparos hasta que el ruido se repite
+#define ONDAS_MAX_DAC			4095
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	ondaDAC_t onda;				// ONDA_DAC_TRIANGULAR o ONDA_DAC_RUIDO
+	uint32_t bits;				// BITS: 1..12
+	uint16_t base;				// BASE: código en DHR (sin la señal)
+	bool_t senial;				// BASE=SIG: el DMA recorre la señal cargada
+	uint32_t periodo;			// RATE: ARR de TIM2 (0: el actual)
+} ondasDAC_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Ondas_Defecto(ondasDAC_t * o);
+bool_t Ondas_Interpretar(char * texto, ondasDAC_t * o);	// "[TRI|NOISE] [BITS=..] [BASE=..|SIG] [RATE=..]"
+uint32_t Ondas_Pico(const ondasDAC_t * o);				// 2^BITS - 1
+bool_t Ondas_Iniciar(const ondasDAC_t * o, uint16_t * senial, uint32_t largo);	// false: informa el motivo
+void Ondas_Parar(void);
+void Ondas_Informar(const ondasDAC_t * o, bool_t activa);
+const char * Ondas_Nombre(ondaDAC_t onda);
+
+#endif /* __API_ONDAS_DAC_H */
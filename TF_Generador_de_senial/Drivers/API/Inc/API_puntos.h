@@ -0,0 +1,54 @@
+/*******************************************************************************
+  * @file		API_puntos.h
+  * @brief      Tabla de puntos, cada uno con su propia duración
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Cada punto es un código del DAC y el tiempo que se sostiene, en ns. Los
+  * tiempos se pasan a ciclos del reloj de TIM2 sobre la suma acumulada (el
+  * redondeo no se acumula: el fin del punto k cae a medio ciclo de la suma
+  * pedida) y se guardan como el ARR de cada punto. Una señal con tramos
+  * largos y transitorios cortos ocupa un punto por tramo, no una muestra
+  * por cada paso del tramo más fino.
+  * El DMA del timer escribe el ARR de un punto con el disparo anterior
+  * (ARR con precarga): Pts_Preparar() deja la tabla en el orden en que la
+  * toman los dos DMA y Pts_Restaurar() la vuelve al orden natural. Se
+  * compila también en la PC (ver Herramientas/puntos_sim.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_PUNTOS_H
+#define __API_PUNTOS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define PTS_MAX_PUNTOS			2048
+#define PTS_MAX_VALOR			4095
+#define PTS_MAX_DURACION		1000000000	// ns por punto
+#define PTS_CICLOS_MINIMO		16			// Ciclos de TIM2 por punto (dos DMA por disparo)
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint16_t valores[PTS_MAX_PUNTOS];	// Códigos del DAC
+	uint32_t periodos[PTS_MAX_PUNTOS];	// ARR de TIM2: ciclos del punto - 1
+	uint32_t cantidad;
+	uint64_t nanosegundos;		// Suma de las duraciones pedidas
+	uint64_t ciclos;			// Suma de los ciclos asignados
+	uint32_t mcd;				// Máximo común divisor de los ciclos
+	bool_t rotado;				// En el orden de los DMA (ver Pts_Preparar)
+} puntos_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Pts_Vaciar(puntos_t * p);
+bool_t Pts_Agregar(puntos_t * p, uint32_t nanosegundos, uint16_t valor, uint32_t reloj);
+bool_t Pts_Interpretar(const char * texto, puntos_t * p, uint32_t reloj);	// "<ns> <valor> ..."
+bool_t Pts_Preparar(puntos_t * p);		// Orden de los DMA
+void Pts_Restaurar(puntos_t * p);		// Orden natural
+uint64_t Pts_Muestras_Uniformes(const puntos_t * p);	// Con paso fijo = mcd
+
+#endif /* __API_PUNTOS_H */
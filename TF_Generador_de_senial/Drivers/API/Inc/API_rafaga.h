@@ -0,0 +1,73 @@
+/*******************************************************************************
+  * @file		API_rafaga.h
+  * @brief      Ráfagas: K períodos exactos de la señal por cada disparo, con
+  *             la salida en un nivel de reposo entre ráfagas
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La cuenta la hace el hardware, no una interrupción:
+  *  - TIM3 cuenta los TRGO de TIM2 (reloj externo por ITR1) con prescaler
+  *    N: avanza uno por período. Su OC1REF (PWM 1, CCR1 = K) está en alto
+  *    mientras no completó K períodos y sale como TRGO.
+  *  - TIM2 está en modo compuerta (gated) con ese TRGO (ITR2): sólo cuenta,
+  *    y dispara al DAC, mientras la ráfaga está abierta. Se detiene justo
+  *    después del disparo K x N.
+  *  - Disparar es poner TIM3 en cero (UG). TIM2 espera con CNT = ARR, así
+  *    la primera muestra sale un ciclo de TIM2 después de abrir la compuerta.
+  * El DAC saca DHR con cada disparo y el DMA recarga DHR después: el buffer
+  * del DMA es la señal rotada una muestra y la primera muestra espera en DHR.
+  * Como la ráfaga consume un múltiplo de N, el DMA vuelve al mismo lugar.
+  * La interrupción de fin de ráfaga (CC1 de TIM3) lleva la salida al reposo.
+  * Fuentes de disparo: comando *TRG, pulsador de usuario y flanco ascendente
+  * en PA0 (TIM5_CH1). El flanco lo marca la captura de TIM5 (84 MHz) y la
+  * interrupción mide cuánto tardó en abrir la compuerta: latencia y jitter.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_RAFAGA_H
+#define __API_RAFAGA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define RAFAGA_MAX_PERIODOS		65534	// CCR1 de TIM3 (16 bits, por debajo de ARR)
+#define RAFAGA_MAX_LARGO		65536	// Prescaler de TIM3
+#define RAFAGA_REPOSO_DEFECTO	2048	// Mitad de escala
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t periodos;			// K: períodos por ráfaga
+	uint16_t reposo;			// Código del DAC entre ráfagas
+	bool_t pin;					// También dispara el flanco ascendente en PA0
+} rafaga_t;
+
+typedef struct {
+	uint32_t disparos;			// Ráfagas comenzadas
+	uint32_t emitidas;			// Ráfagas completas
+	uint32_t ignorados;			// Disparos durante una ráfaga
+	uint32_t medidos;			// Disparos por PA0 con latencia medida
+	uint32_t latenciaMinima;	// Ciclos de 84 MHz del flanco a la compuerta
+	uint32_t latenciaMaxima;
+} rafagaContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Inicializar_Rafaga(void);
+void Rafaga_Defecto(rafaga_t * r);
+bool_t Rafaga_Interpretar(char * texto, rafaga_t * r);		// "[K=..] [IDLE=..] [SRC=SW|PIN]"
+void Rafaga_Iniciar(const rafaga_t * r, const uint16_t * senial, uint16_t * buffer, uint32_t largo);
+bool_t Rafaga_Disparar(void);		// false si hay una ráfaga en curso
+void Rafaga_Parar(void);			// Corta la salida y devuelve TIM2 a su marcha libre
+void Rafaga_Contadores(rafagaContadores_t * contadores);
+void Rafaga_Informar(void);
+void rafagaFinIRQHandler(void);		// Llamar desde TIM3_IRQHandler
+void rafagaPinIRQHandler(void);		// Llamar desde TIM5_IRQHandler
+
+#endif /* __API_RAFAGA_H */
@@ -0,0 +1,64 @@
+/*******************************************************************************
+* @file    API_ring.h
+* @author  Guillermo Caporaletti
+* @brief   Buffer circular de un productor y un consumidor (SPSC) sin bloqueo.
+*          Permite pasar datos entre interrupciones y el lazo principal sin
+*          deshabilitar interrupciones: cada índice lo escribe un solo lado
+*          y las barreras de memoria ordenan datos e índices.
+*******************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_RING_H
+#define __API_RING_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#if defined(__arm__)
+#include <errorHandler.h>
+#include "stm32f4xx_hal.h"  		/* <- HAL include (barreras __DMB) */
+#else
+// Compilación en la PC (Herramientas/ring_bench.c): productor y consumidor
+// son dos hilos, en núcleos distintos. La barrera completa de C11 ordena
+// también el hardware, como __DMB() en el Cortex-M4.
+#include <stdlib.h>
+#define __DMB()				__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define Error_Handler()		abort()
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+typedef bool bool_t;
+
+// Los índices corren libres y se enmascaran al acceder: con capacidad
+// potencia de 2, (cabeza - cola) es siempre la ocupación, aun con desborde.
+typedef struct {
+	uint8_t * datos;			// Memoria: capacidad * largoRegistro bytes
+	uint32_t mascara;			// capacidad - 1
+	uint16_t largoRegistro;		// Bytes por registro (1 en la variante de bytes)
+	volatile uint32_t cabeza;	// Sólo la escribe el productor
+	volatile uint32_t cola;		// Sólo la escribe el consumidor
+} ring_t;
+
+/* Functions -----------------------------------------------------------------*/
+void ringInit(ring_t * r, void * memoria, uint32_t capacidad, uint16_t largoRegistro);
+
+// Variante de bytes
+bool_t ringPutByte(ring_t * r, uint8_t dato);
+bool_t ringGetByte(ring_t * r, uint8_t * dato);
+uint32_t ringPutBytes(ring_t * r, const uint8_t * datos, uint32_t cantidad);
+uint32_t ringGetBytes(ring_t * r, uint8_t * datos, uint32_t cantidad);
+
+// Variante de registros de largo fijo
+bool_t ringPut(ring_t * r, const void * registro);
+bool_t ringGet(ring_t * r, void * registro);
+
+// Consultas (válidas desde cualquiera de los dos lados)
+uint32_t ringCount(ring_t * r);
+uint32_t ringFree(ring_t * r);
+void ringFlush(ring_t * r);		// Sólo desde el consumidor
+
+/*----------------------------------------------------------------------------*/
+#endif /* __API_RING_H */
+
+/***************************************************************END OF FILE****/
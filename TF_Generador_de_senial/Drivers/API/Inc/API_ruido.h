@@ -0,0 +1,47 @@
+/*******************************************************************************
+  * @file		API_ruido.h
+  * @brief      PRBS y ruido en tiempo real por el DAC2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Una salida por bloques (API_bloques.h): el DAC2 recorre un buffer de
+  * dos mitades de RUIDO_MITAD muestras y la interrupción de media
+  * transferencia genera con API_aleatorio.h la mitad que ya leyó, a la
+  * frecuencia de muestras de TIM2 (RATE). La secuencia no se repite por el tamaño del buffer:
+  * sólo se repite la PRBS, con su período de 2^n - 1 bits.
+  * Al arrancar se mide el costo de un bloque de cada generador con el
+  * mismo filtro: Ruido_Capacidad() informa la fs máxima de cada uno para
+  * una fracción de la CPU.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_RUIDO_H
+#define __API_RUIDO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_aleatorio.h"
+#include "API_uart.h"
+#include "API_bloques.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define RUIDO_MITAD				128		// Muestras por bloque (media transferencia)
+#define RUIDO_PRESUPUESTO_CPU	80		// % de la CPU para la fs máxima, por defecto
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bloquesContadores_t ruidoContadores_t;		// Sin contadores propios
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Ruido_Iniciar(const aleatorio_t * a);		// false: informa el motivo
+void Ruido_Parar(void);
+bool_t Ruido_Activo(void);
+void Ruido_Contadores(ruidoContadores_t * contadores);
+void Ruido_Informar(void);
+void Ruido_Capacidad(const aleatorio_t * a, uint32_t porcentaje);
+
+#endif /* __API_RUIDO_H */
@@ -0,0 +1,62 @@
+/*******************************************************************************
+  * @file		API_secuencia.h
+  * @brief      Secuencia de segmentos con repeticiones, de a gránulos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Una secuencia es una lista de segmentos (buffers de muestras ya listas
+  * para el DAC), cada uno con su cantidad de repeticiones o para siempre.
+  * Al terminar el último vuelve al primero.
+  * El DMA en doble buffer transfiere la misma cantidad de muestras con cada
+  * memoria (NDTR es uno solo), así que la secuencia se recorre de a gránulos
+  * de igual largo: el máximo común divisor de los largos de los segmentos.
+  * Seq_Siguiente() entrega el próximo gránulo en tiempo constante, sin
+  * copiar muestras: es lo que se escribe en la memoria libre del DMA. Se
+  * compila también en la PC (ver Herramientas/secuencia_sim.c).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_SECUENCIA_H
+#define __API_SECUENCIA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define SEQ_MAX_SEGMENTOS		16
+#define SEQ_GRANULO_MINIMO		16			// Muestras por transferencia del DMA
+#define SEQ_MAX_GRANULO			65535		// NDTR del DMA
+#define SEQ_INFINITO			0			// Repeticiones: para siempre
+#define SEQ_MAX_REPETICIONES	1000000000
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	const uint16_t * datos;
+	uint32_t largo;				// Muestras (múltiplo del gránulo)
+	uint32_t repeticiones;		// SEQ_INFINITO: hasta Seq_Avanzar()
+} segmento_t;
+
+typedef struct {
+	segmento_t segmentos[SEQ_MAX_SEGMENTOS];
+	uint32_t cantidad;
+	uint32_t granulo;
+	uint32_t actual;			// Segmento en curso
+	const uint16_t * proximo;	// Próximo gránulo a entregar
+	const uint16_t * fin;		// Fin de la pasada en curso
+	uint32_t restantes;			// Pasadas que faltan después de la actual
+	uint32_t vueltas;			// Secuencias completas
+	volatile bool_t avanzar;	// Dejar el segmento al terminar la pasada
+} secuencia_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Seq_Vaciar(secuencia_t * s);
+bool_t Seq_Agregar(secuencia_t * s, const uint16_t * datos, uint32_t largo, uint32_t repeticiones);
+uint32_t Seq_Granulo(const secuencia_t * s);		// Máximo común divisor de los largos
+bool_t Seq_Preparar(secuencia_t * s, uint32_t granulo);	// Vuelve al comienzo
+const uint16_t * Seq_Siguiente(secuencia_t * s);
+void Seq_Avanzar(secuencia_t * s);
+
+#endif /* __API_SECUENCIA_H */
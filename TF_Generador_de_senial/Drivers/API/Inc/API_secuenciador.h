@@ -0,0 +1,56 @@
+/*******************************************************************************
+  * @file		API_secuenciador.h
+  * @brief      Secuencias de segmentos por el DAC2, sin cortes entre segmentos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Los segmentos se guardan en una memoria propia, ya con ganancia, offset y
+  * corrección, y la secuencia (API_secuencia.h) se recorre con el DMA en
+  * doble buffer: en cada transferencia completa la interrupción apunta la
+  * memoria que quedó libre al gránulo siguiente (Comenzar_Secuencia_DAC_DMA).
+  * No se copian muestras: el costo por gránulo es fijo y el plazo es lo que
+  * dura un gránulo. La interrupción mide cuánto tarda en responder (desde
+  * el cambio de memoria hasta entregar el gránulo siguiente) y con eso se
+  * informa la tasa máxima de gránulos y la fs máxima de la secuencia.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_SECUENCIADOR_H
+#define __API_SECUENCIADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_secuencia.h"
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_medicion.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define SEQ_MEMORIA				8192	// Muestras para todos los segmentos
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t bloques;			// Gránulos entregados
+	uint32_t ciclos;			// Ciclos de CPU del último gránulo
+	uint32_t ciclosMaximo;
+	uint32_t demoraMaxima;		// Muestras que ya había sacado el DAC al entrar
+	uint32_t respuestaMaxima;	// Ciclos desde el cambio de memoria hasta entregar
+} seqContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+uint16_t * Secuenciador_Reservar(uint32_t largo);		// NULL: informa el motivo
+bool_t Secuenciador_Agregar(uint32_t repeticiones, uint32_t recortadas);
+bool_t Secuenciador_Vaciar(void);
+bool_t Secuenciador_Iniciar(void);		// false: informa el motivo
+void Secuenciador_Avanzar(void);
+void Secuenciador_Parar(void);
+bool_t Secuenciador_Activo(void);
+void Secuenciador_Contadores(seqContadores_t * contadores);
+void Secuenciador_Informar(void);
+
+#endif /* __API_SECUENCIADOR_H */
@@ -0,0 +1,77 @@
+/*******************************************************************************
+  * @file		API_simd.h
+  * @brief      Intrínsecas SIMD y de saturación (CMSIS) para el firmware y
+  *             sus equivalentes en C para compilar en la PC (Herramientas)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * En el dispositivo son las de CMSIS, a través del HAL. En la PC cada una
+  * reproduce bit a bit la instrucción del Cortex-M4: en las de 16 bits cada
+  * mitad de la palabra es una muestra o un coeficiente con signo (salvo
+  * __UQSUB16, sin signo). Así los bancos de prueba ejercitan el mismo
+  * código que corre en el dispositivo.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_SIMD_H
+#define __API_SIMD_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#if defined(__arm__)
+#include "stm32f4xx_hal.h"		/* <- intrínsecas SIMD (CMSIS) */
+#else
+
+/* Funciones privadas (sólo en la PC) ----------------------------------------*/
+static inline int32_t simdSaturar16(int32_t valor) {
+	return (valor > INT16_MAX) ? INT16_MAX : (valor < INT16_MIN) ? INT16_MIN : valor;
+}
+static inline uint32_t simdSaturarSinSigno(int32_t valor, uint32_t bits) {
+	int32_t maximo = (int32_t) ((1UL << bits) - 1);
+	return (uint32_t) ((valor < 0) ? 0 : (valor > maximo) ? maximo : valor);
+}
+
+/* Saturación y conteo de ceros ----------------------------------------------*/
+static inline int32_t __SSAT(int32_t valor, uint32_t bits) {
+	int32_t maximo = (int32_t) ((1UL << (bits - 1)) - 1);
+	return (valor > maximo) ? maximo : (valor < -maximo - 1) ? -maximo - 1 : valor;
+}
+static inline uint32_t __USAT(int32_t valor, uint32_t bits) {
+	return simdSaturarSinSigno(valor, bits);
+}
+static inline uint32_t __CLZ(uint32_t valor) {
+	return (valor == 0) ? 32 : (uint32_t) __builtin_clz(valor);
+}
+
+/* SIMD de 16 bits -----------------------------------------------------------*/
+static inline uint32_t __SMUAD(uint32_t a, uint32_t b) {
+	return (uint32_t) ((int16_t) a * (int16_t) b + (int16_t) (a >> 16) * (int16_t) (b >> 16));
+}
+static inline uint32_t __SMUADX(uint32_t a, uint32_t b) {
+	return (uint32_t) ((int16_t) a * (int16_t) (b >> 16) + (int16_t) (a >> 16) * (int16_t) b);
+}
+static inline uint32_t __SMLAD(uint32_t a, uint32_t b, uint32_t acumulado) {
+	return __SMUAD(a, b) + acumulado;
+}
+static inline uint64_t __SMLALD(uint32_t a, uint32_t b, uint64_t acumulado) {
+	return acumulado + (uint64_t) ((int64_t) (int16_t) a * (int16_t) b
+			                       + (int64_t) (int16_t) (a >> 16) * (int16_t) (b >> 16));
+}
+static inline uint32_t __QADD16(uint32_t a, uint32_t b) {
+	uint32_t bajo = (uint16_t) simdSaturar16((int16_t) a + (int16_t) b);
+	uint32_t alto = (uint16_t) simdSaturar16((int16_t) (a >> 16) + (int16_t) (b >> 16));
+	return bajo | (alto << 16);
+}
+static inline uint32_t __UQSUB16(uint32_t a, uint32_t b) {
+	uint32_t bajo = ((a & 0xFFFF) > (b & 0xFFFF)) ? (a & 0xFFFF) - (b & 0xFFFF) : 0;
+	uint32_t alto = ((a >> 16) > (b >> 16)) ? (a >> 16) - (b >> 16) : 0;
+	return bajo | (alto << 16);
+}
+#define __USAT16(valor, bits) \
+	(simdSaturarSinSigno((int16_t) (valor), (bits)) | (simdSaturarSinSigno((int16_t) ((valor) >> 16), (bits)) << 16))
+#define __PKHBT(bajo, alto, desplazamiento) \
+	(((uint32_t) (bajo) & 0xFFFFUL) | ((uint32_t) (alto) << (desplazamiento)))
+
+#endif /* __arm__ */
+
+#endif /* __API_SIMD_H */
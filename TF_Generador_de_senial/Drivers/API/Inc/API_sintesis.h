@@ -0,0 +1,67 @@
+/*******************************************************************************
+  * @file		API_sintesis.h
+  * @brief      Síntesis de formas de onda en el dispositivo
+  *             (seno, cuadrada, triangular, sierra, continua y ruido)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Todo en punto fijo: el seno sale de una tabla de 256 valores Q15 con
+  * interpolación lineal y las rampas de acumuladores 16.16, sin divisiones
+  * dentro del lazo. El costo es lineal en la cantidad de muestras.
+  * Con BL la cuadrada (y el pulso, con DUTY) y la sierra se arman sumando
+  * sus armónicos hasta K, por debajo de fs/2: sin el aliasing de los
+  * flancos muestreados. Costo proporcional a N x K.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_SINTESIS_H
+#define __API_SINTESIS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "API_numeros.h"
+#include "API_simd.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define SINT_BITS_TABLA		8						// Tabla de seno de 256 valores
+#define SINT_MAX_DAC		0x0FFF					// 12 bits
+#define SINT_MAX_LARGO		16384					// Tope de N (el buffer del generador)
+#define SINT_BL_MAX_ARMONICOS	512					// Tope de K con BL
+#define SINT_BL_NYQUIST		UINT32_MAX				// BL=MAX: todos los armónicos bajo fs/2
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef bool bool_t;
+
+typedef enum {
+	SINT_SENO,
+	SINT_CUADRADA,
+	SINT_TRIANGULAR,
+	SINT_SIERRA,
+	SINT_CONTINUA,
+	SINT_RUIDO
+} formaOnda_t;
+
+// Parámetros de una forma de onda (un período en 'largo' muestras)
+typedef struct {
+	formaOnda_t forma;
+	uint32_t largo;			// N: muestras por período
+	int32_t amplitud;		// AMP: amplitud pico, en cuentas del DAC (0..4095)
+	int32_t offset;			// OFF: valor medio, en cuentas del DAC (0..4095)
+	uint32_t fase;			// PHASE: desplazamiento en grados
+	uint32_t ciclo;			// DUTY (cuadrada) o SYM (triangular), en %
+	uint32_t semilla;		// SEED: semilla del ruido
+	uint32_t armonicos;		// BL: último armónico de la cuadrada o la sierra (0: sin limitar)
+} sintesis_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Sint_Defecto(sintesis_t * p);
+bool_t Sint_Interpretar(char * texto, sintesis_t * p);
+uint32_t Sint_Generar(const sintesis_t * p, uint16_t * destino);
+uint32_t Sint_Armonicos(const sintesis_t * p);	// K efectivo de BL (0: síntesis directa)
+int32_t Sint_Seno(uint32_t fase);		// Fase de 32 bits (2^32 = 360°), resultado Q15
+uint32_t Sint_Grados(uint32_t grados);	// Grados a fase de 32 bits
+
+#endif /* __API_SINTESIS_H */
@@ -0,0 +1,51 @@
+/*******************************************************************************
+  * @file		API_stream.h
+  * @brief      Reproducción continua (streaming) de muestras recibidas por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Protocolo:
+  *  - El dispositivo anuncia "STREAM <capacidad> <credito>\n". El host puede
+  *    enviar hasta <capacidad> muestras sin esperar.
+  *  - Cada muestra son 2 bytes little-endian (12 bits útiles).
+  *  - Por cada <credito> muestras que salen del buffer, el dispositivo envía
+  *    un byte STREAM_BYTE_CREDITO y el host puede enviar <credito> más.
+  *  - La muestra STREAM_FIN termina el stream. Los bytes que la siguen
+  *    quedan para el intérprete de comandos.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_STREAM_H
+#define __API_STREAM_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <errorHandler.h>
+#include "API_ring.h"
+#include "API_uart.h"
+#include "API_dac_dma.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define STREAM_CAPACIDAD		2048	// Muestras en el buffer circular (potencia de 2)
+#define STREAM_MITAD			128		// Muestras por mitad del buffer del DMA
+#define STREAM_CREDITO			64		// Muestras que vale cada crédito
+#define STREAM_BYTE_CREDITO		0x11	// Byte de crédito (DC1, no aparece en los textos)
+#define STREAM_FIN				0xFFFF	// Muestra que marca el final del stream
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	uint32_t recibidas;			// Muestras que llegaron por UART
+	uint32_t reproducidas;		// Muestras del host que salieron por el DAC
+	uint32_t subejecuciones;	// Muestras que faltaron al recargar (se repite la última)
+	uint32_t sobreescrituras;	// Muestras descartadas por buffer lleno (host sin créditos)
+	uint32_t recortadas;		// Muestras mayores a 0x0FFF
+} streamContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Stream_Iniciar(uint32_t periodo);
+bool_t Stream_Procesar(void);		// Devuelve false cuando el stream terminó
+void Stream_Parar(void);
+void Stream_Contadores(streamContadores_t * contadores);
+
+#endif /* __API_STREAM_H */
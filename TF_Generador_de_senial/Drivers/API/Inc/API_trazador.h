@@ -0,0 +1,38 @@
+/*******************************************************************************
+  * @file		API_trazador.h
+  * @brief      Salida punto por punto, cada punto con su propia duración
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Guarda la tabla de puntos (API_puntos.h) y la recorre en forma circular
+  * con dos DMA en paralelo: el del DAC2 carga el valor y el de la
+  * actualización de TIM2 el ARR de cada punto (Comenzar_Puntos_DAC_DMA).
+  * La CPU no interviene mientras tanto. La duración mínima de un punto es
+  * PTS_CICLOS_MINIMO ciclos de TIM2: los dos pedidos de DMA de un disparo
+  * tienen que terminar antes del siguiente.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_TRAZADOR_H
+#define __API_TRAZADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_puntos.h"
+#include "API_uart.h"
+#include "API_dac_dma.h"
+#include "API_numeros.h"
+
+/* Funciones públicas --------------------------------------------------------*/
+bool_t Trazador_Agregar(const char * texto);	// false: informa el motivo
+bool_t Trazador_Vaciar(void);
+bool_t Trazador_Iniciar(void);					// false: informa el motivo
+void Trazador_Parar(void);
+bool_t Trazador_Activo(void);
+void Trazador_Informar(void);
+
+#endif /* __API_TRAZADOR_H */
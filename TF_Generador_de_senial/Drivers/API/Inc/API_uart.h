@@ -1,54 +1,71 @@
-/*******************************************************************************
-* @file    API_uart.h
-* @author  Guillermo Caporaletti
-* @brief   Módulo para manejo de puerto UART.
-********************************************************************************
-*
-*******************************************************************************/
-
-/* Define to prevent recursive inclusion -------------------------------------*/
-#ifndef __API_UART_H
-#define __API_UART_H
-
-/* Includes ------------------------------------------------------------------*/
-#include <errorHandler.h>
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include <string.h>
-#include "stm32f4xx_hal.h"
-
-#include "../../BSP/stm32f4xx_nucleo_144.h"
-
-/* Exported types ------------------------------------------------------------*/
-typedef bool bool_t;	// Si ya estaba definido, lo sobre-escribe y listo.
-
-/* Exported constants and macros ---------------------------------------------*/
-
-/* Definition for USARTx clock resources */
-#define USARTx                           USART3
-#define USARTx_CLK_ENABLE()              __HAL_RCC_USART3_CLK_ENABLE()
-#define USARTx_RX_GPIO_CLK_ENABLE()      __HAL_RCC_GPIOD_CLK_ENABLE()
-#define USARTx_TX_GPIO_CLK_ENABLE()      __HAL_RCC_GPIOD_CLK_ENABLE()
-#define USARTx_FORCE_RESET()             __HAL_RCC_USART3_FORCE_RESET()
-#define USARTx_RELEASE_RESET()           __HAL_RCC_USART3_RELEASE_RESET()
-
-/* Definition for USARTx Pins */
-#define USARTx_TX_PIN                    GPIO_PIN_8
-#define USARTx_TX_GPIO_PORT              GPIOD
-#define USARTx_TX_AF                     GPIO_AF7_USART3
-#define USARTx_RX_PIN                    GPIO_PIN_9
-#define USARTx_RX_GPIO_PORT              GPIOD
-#define USARTx_RX_AF                     GPIO_AF7_USART3
-
-/* Exported functions ------------------------------------------------------- */
-bool_t uartInit();
-void uartSendString(uint8_t * pstring);
-void uartSendStringSize(uint8_t * pstring, uint16_t size);
-bool_t uartReceiveStringSize(uint8_t * pstring, uint16_t size);
-void uartClearBuffer();
-
-/*----------------------------------------------------------------------------*/
-#endif /* __API_UART_H */
-
-/***************************************************************END OF FILE****/
+/*******************************************************************************
+* @file    API_uart.h
+* @author  Guillermo Caporaletti
+* @brief   Módulo para manejo de puerto UART.
+********************************************************************************
+*
+*******************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_UART_H
+#define __API_UART_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <errorHandler.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "API_ring.h"
+#include "API_numeros.h"
+
+#include "../../BSP/stm32f4xx_nucleo_144.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef bool bool_t;	// Si ya estaba definido, lo sobre-escribe y listo.
+
+/* Exported constants and macros ---------------------------------------------*/
+
+/* Definition for USARTx clock resources */
+#define USARTx                           USART3
+#define USARTx_CLK_ENABLE()              __HAL_RCC_USART3_CLK_ENABLE()
+#define USARTx_RX_GPIO_CLK_ENABLE()      __HAL_RCC_GPIOD_CLK_ENABLE()
+#define USARTx_TX_GPIO_CLK_ENABLE()      __HAL_RCC_GPIOD_CLK_ENABLE()
+#define USARTx_FORCE_RESET()             __HAL_RCC_USART3_FORCE_RESET()
+#define USARTx_RELEASE_RESET()           __HAL_RCC_USART3_RELEASE_RESET()
+
+/* Definition for USARTx Pins */
+#define USARTx_TX_PIN                    GPIO_PIN_8
+#define USARTx_TX_GPIO_PORT              GPIOD
+#define USARTx_TX_AF                     GPIO_AF7_USART3
+#define USARTx_RX_PIN                    GPIO_PIN_9
+#define USARTx_RX_GPIO_PORT              GPIOD
+#define USARTx_RX_AF                     GPIO_AF7_USART3
+
+/* Definition for USARTx's NVIC */
+#define USARTx_IRQn                      USART3_IRQn
+#define USARTx_IRQ_PRIORITY              5
+
+/* Velocidad de la conexión: limita también el modo streaming a
+ * UART_BAUDIOS / 10 bytes por segundo (8N1) */
+#define UART_BAUDIOS                     9600
+
+/* Recepción por interrupción */
+#define UART_RX_CAPACIDAD                256	// Bytes (potencia de 2)
+
+/* Exported functions ------------------------------------------------------- */
+bool_t uartInit();
+void uartSendString(uint8_t * pstring);
+void uartSendStringSize(uint8_t * pstring, uint16_t size);
+#define uartSendLiteral(texto)	uartSendStringSize((uint8_t *) (texto), sizeof(texto) - 1)	// Sólo literales
+bool_t uartReceiveStringSize(uint8_t * pstring, uint16_t size);
+uint16_t uartReceiveAvailable(uint8_t * pstring, uint16_t size);
+void uartClearBuffer();
+void uartIRQHandler(void);						// Llamar desde USART3_IRQHandler
+uint32_t uartRxDescartados(void);				// Bytes perdidos por buffer lleno
+
+/*----------------------------------------------------------------------------*/
+#endif /* __API_UART_H */
+
+/***************************************************************END OF FILE****/
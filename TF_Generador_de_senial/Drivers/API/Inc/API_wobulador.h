@@ -0,0 +1,55 @@
+/*******************************************************************************
+  * @file		API_wobulador.h
+  * @brief      Barridos de frecuencia en tiempo real por el DAC2, con marca
+  *             de sincronismo por PD12
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Una salida por bloques (API_bloques.h): el DAC2 recorre un buffer de
+  * dos mitades de WOB_MITAD muestras y la interrupción de media
+  * transferencia genera la mitad que ya leyó con API_barrido.h. La frecuencia de muestras es la de TIM2 (RATE) y no
+  * cambia durante el barrido: la frecuencia cambia en el paso de fase, así
+  * que la fase es continua en todos los cambios.
+  * Marca de sincronismo: TIM4 cuenta los disparos de TIM2 (reloj externo
+  * por ITR1) y su canal 1 en modo toggle invierte PD12 en el disparo que
+  * saca la primera muestra de cada paso (o de cada barrido, en los chirps).
+  * La interrupción que genera el bloque programa la comparación; entran dos
+  * marcas pendientes, las demás se cuentan como perdidas.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __API_WOBULADOR_H
+#define __API_WOBULADOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include <errorHandler.h>
+#include "API_barrido.h"
+#include "API_uart.h"
+#include "API_bloques.h"
+#include "API_numeros.h"
+
+/* Macros públicas -----------------------------------------------------------*/
+#define WOB_MITAD		128		// Muestras por bloque (media transferencia)
+
+/* Typedef públicos ----------------------------------------------------------*/
+typedef struct {
+	bloquesContadores_t bloque;	// Bloques, ciclos, saturadas y atrasos
+	uint32_t marcas;			// Marcas que salieron por PD12
+	uint32_t perdidas;			// Marcas que no se pudieron programar
+} wobContadores_t;
+
+/* Funciones públicas --------------------------------------------------------*/
+void Inicializar_Wobulador(void);
+bool_t Wob_Iniciar(const barrido_t * b);	// false: informa el motivo
+void Wob_Parar(void);
+bool_t Wob_Activo(void);
+bool_t Wob_Procesar(void);			// false cuando terminó un barrido ONCE
+void Wob_Contadores(wobContadores_t * contadores);
+void Wob_Informar(void);
+void wobuladorMarcaIRQHandler(void);	// Llamar desde TIM4_IRQHandler
+
+#endif /* __API_WOBULADOR_H */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+  * @file		API_acondicionamiento.c
+  * @brief      Acondicionamiento de muestras: recorte a 12 bits, ganancia
+  *             y offset en una sola pasada
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_acondicionamiento.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAXIMOS			0x0FFF0FFFUL		// ACOND_MAX_DAC en ambas mitades
+
+/* Prototipos privados -------------------------------------------------------*/
+static inline uint32_t acondicionarPar(uint32_t entrada, uint32_t factor,
+		                               uint32_t desplazamiento, uint32_t * marcas);
+static inline uint32_t contarMitades(uint32_t palabra);
+
+/*******************************************************************************
+  * @brief  Recorta, escala y desplaza las muestras, dos por palabra.
+  *         Con ganancia 1 y offset 0 sólo recorta (una instrucción por par).
+  * @param  origen: muestras de entrada (cualquier valor de 16 bits)
+  * @param  destino: muestras de 12 bits (puede ser el mismo origen)
+  * @param  largo: cantidad de muestras
+  * @param  ganancia: Q12 (ACOND_GANANCIA_UNO = 1,0)
+  * @param  offset: cuentas que se suman luego de la ganancia
+  * @retval Muestras recortadas (entrada mayor a 4095 o salida fuera de 0..4095)
+  */
+uint32_t Acond_Procesar(const uint16_t * origen, uint16_t * destino, uint32_t largo,
+		                int16_t ganancia, int16_t offset) {
+	uint32_t factor = (uint16_t) ganancia;				// Ganancia en la mitad baja
+	uint32_t desplazamiento = __PKHBT(offset, offset, 16);
+	uint32_t recortadas = 0;
+	uint32_t pares = largo / 2;
+	uint32_t entrada, exceso, salida, marcas;
+
+	// memcpy: el Cortex-M4 lee y escribe palabras no alineadas con LDR/STR
+	if (ganancia == ACOND_GANANCIA_UNO && offset == 0) {
+		for (uint32_t i=0; i<pares; i++) {
+			memcpy(&entrada, &origen[2 * i], sizeof(entrada));
+			exceso = __UQSUB16(entrada, MAXIMOS);		// Lo que pasa de 4095 (o 0)
+			salida = entrada - exceso;					// min(entrada, 4095): sin préstamo
+			recortadas += contarMitades(exceso);
+			memcpy(&destino[2 * i], &salida, sizeof(salida));
+		}
+	} else {
+		for (uint32_t i=0; i<pares; i++) {
+			memcpy(&entrada, &origen[2 * i], sizeof(entrada));
+			salida = acondicionarPar(entrada, factor, desplazamiento, &marcas);
+			recortadas += contarMitades(marcas);
+			memcpy(&destino[2 * i], &salida, sizeof(salida));
+		}
+	}
+
+	// Muestra impar: sólo la mitad baja
+	if (largo & 1) {
+		salida = acondicionarPar(origen[largo - 1], factor, desplazamiento, &marcas);
+		destino[largo - 1] = (uint16_t) salida;
+		recortadas += contarMitades(marcas & 0xFFFF);
+	}
+	return recortadas;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Acondiciona un par de muestras.
+  * @param  entrada: dos muestras (mitad baja y alta)
+  * @param  factor: ganancia Q12 en la mitad baja
+  * @param  desplazamiento: offset en ambas mitades
+  * @param  marcas: mitades distintas de cero donde hubo recorte
+  * @retval Dos muestras de 12 bits
+  */
+static inline uint32_t acondicionarPar(uint32_t entrada, uint32_t factor,
+		                               uint32_t desplazamiento, uint32_t * marcas) {
+	uint32_t exceso = __UQSUB16(entrada, MAXIMOS);
+	entrada -= exceso;
+	int32_t bajo = (int32_t) __SMUAD(entrada, factor) >> ACOND_BITS_GANANCIA;
+	int32_t alto = (int32_t) __SMUADX(entrada, factor) >> ACOND_BITS_GANANCIA;
+	uint32_t escalado = __QADD16(__PKHBT(bajo, alto, 16), desplazamiento);
+	uint32_t salida = __USAT16(escalado, 12);
+	*marcas = exceso | (escalado ^ salida);
+	return salida;
+}
+
+/*******************************************************************************
+  * @brief  Cuenta las mitades distintas de cero.
+  * @param  palabra: dos valores de 16 bits
+  * @retval 0, 1 ó 2
+  */
+static inline uint32_t contarMitades(uint32_t palabra) {
+	return ((palabra & 0xFFFF) != 0) + ((palabra >> 16) != 0);
+}
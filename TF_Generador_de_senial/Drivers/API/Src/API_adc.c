@@ -0,0 +1,252 @@
+/*******************************************************************************
+  * @file		API_adc.c
+  * @brief      Conversiones del ADC1: lazo sobre la salida del DAC2 y
+  *             entradas analógicas externas
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  * @detail		El ADCx_Init del BSP no sirve: es privado y usa el ADC3 en PF3
+  *             (entrada del joystick de la placa de expansión). En reposo el
+  *             ADC1 convierte ADC1_IN5 (PA5) por software; la captura lo
+  *             reconfigura con el canal pedido para que lo dispare TIM2 y
+  *             al terminar vuelve al lazo con disparo por software.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_adc.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TIEMPO_CONVERSION	2		// ms: una conversión tarda menos de 10 us
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+	uint32_t canal;				// ADC_CHANNEL_x
+	GPIO_TypeDef * puerto;
+	uint16_t pin;
+	const char * nombre;
+} pataADC_t;
+
+/* Private const -------------------------------------------------------------*/
+static const pataADC_t Patas[] = {
+	[ADC_LAZO_PA5]    = { ADC_CHANNEL_5,  GPIOA, GPIO_PIN_5, "PA5" },
+	[ADC_ENTRADA_PA3] = { ADC_CHANNEL_3,  GPIOA, GPIO_PIN_3, "PA3" },
+	[ADC_ENTRADA_PC0] = { ADC_CHANNEL_10, GPIOC, GPIO_PIN_0, "PC0" },
+	[ADC_ENTRADA_PC3] = { ADC_CHANNEL_13, GPIOC, GPIO_PIN_3, "PC3" },
+};
+#define CANTIDAD_PATAS		(sizeof(Patas) / sizeof(Patas[0]))
+
+/* Private variables HAL ------------------------------------------------------*/
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+
+/* Private variables ---------------------------------------------------------*/
+static volatile bloqueADC_t bloqueActivo = NULL;
+static volatile uint32_t desbordes = 0;
+static uint16_t * datosCaptura = NULL;
+static uint32_t cantidadCaptura = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void MX_DMA_Init(void);
+static void MX_ADC1_Init(uint32_t disparo, uint32_t muestreo, canalADC_t canal);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/**
+  * @brief Inicializa el ADC1 sobre la salida del DAC2
+  * @param None
+  * @retval None
+  */
+void Inicializar_ADC(void) {
+	MX_DMA_Init();
+	MX_ADC1_Init(ADC_SOFTWARE_START, ADC_SAMPLETIME_144CYCLES, ADC_LAZO_PA5);
+}
+
+/**
+  * @brief Promedia varias conversiones de la salida del DAC2.
+  * @param promedios: cantidad de conversiones (1 a 65536)
+  * @retval Promedio en cuentas x 16 (ADC_BITS_PROMEDIO bits de fracción)
+  */
+uint16_t Medir_ADC(uint32_t promedios) {
+	uint32_t suma = 0;
+
+	if (promedios == 0 || promedios > 65536) Error_Handler();
+	for (uint32_t i=0; i<promedios; i++) {
+		if (HAL_ADC_Start(&hadc1) != HAL_OK) Error_Handler();
+		if (HAL_ADC_PollForConversion(&hadc1, TIEMPO_CONVERSION) != HAL_OK) Error_Handler();
+		suma += HAL_ADC_GetValue(&hadc1);
+	}
+	HAL_ADC_Stop(&hadc1);
+	return (uint16_t) (((suma << ADC_BITS_PROMEDIO) + promedios / 2) / promedios);
+}
+
+/**
+  * @brief Comienza a capturar: una conversión por cada TRGO de TIM2, por DMA
+  *        circular. Cada mitad completa se entrega a 'bloque'.
+  *        Con el DAC2 generando, la muestra k se toma en el mismo disparo
+  *        que saca la muestra k del estímulo.
+  * @param Canal: pata a convertir
+  * @param Datos: buffer de captura (Num_Datos par)
+  * @param Num_Datos: muestras del buffer (dos mitades)
+  * @param bloque: función a llamar desde la interrupción del DMA
+  * @retval None
+  */
+void Comenzar_Captura_ADC(canalADC_t Canal, uint16_t * Datos, uint32_t Num_Datos, bloqueADC_t bloque) {
+	if (bloque == NULL || Num_Datos < 2 || (Num_Datos & 1)) Error_Handler();
+	if ((uint32_t) Canal >= CANTIDAD_PATAS) Error_Handler();
+	datosCaptura = Datos;
+	cantidadCaptura = Num_Datos;
+	bloqueActivo = bloque;
+	desbordes = 0;
+	HAL_ADC_DeInit(&hadc1);
+	MX_ADC1_Init(ADC_EXTERNALTRIGCONV_T2_TRGO, ADC_SAMPLETIME_3CYCLES, Canal);
+	if (HAL_ADC_Start_DMA(&hadc1, (uint32_t *) Datos, Num_Datos) != HAL_OK) Error_Handler();
+}
+
+/**
+  * @brief Termina la captura y vuelve a las conversiones por software del lazo
+  * @param None
+  * @retval None
+  */
+void Parar_Captura_ADC(void) {
+	HAL_ADC_Stop_DMA(&hadc1);
+	bloqueActivo = NULL;
+	HAL_ADC_DeInit(&hadc1);
+	MX_ADC1_Init(ADC_SOFTWARE_START, ADC_SAMPLETIME_144CYCLES, ADC_LAZO_PA5);
+}
+
+/**
+  * @brief Desbordes del ADC en la captura en curso (o la última)
+  * @param None
+  * @retval Cantidad de desbordes
+  */
+uint32_t Leer_Desbordes_ADC(void) {
+	return desbordes;
+}
+
+/**
+  * @brief Interpreta el nombre de una entrada externa. PA5 no es una de
+  *        ellas: ahí está la salida del DAC2 (lazo de la calibración).
+  * @param texto: "PA3", "PC0" o "PC3"
+  * @param canal: destino
+  * @retval true si es una entrada externa
+  */
+bool_t Interpretar_Entrada_ADC(const char * texto, canalADC_t * canal) {
+	for (uint32_t k=0; k<CANTIDAD_PATAS; k++) {
+		if (k == ADC_LAZO_PA5 || strcmp(texto, Patas[k].nombre) != 0) continue;
+		*canal = (canalADC_t) k;
+		return true;
+	}
+	return false;
+}
+
+/**
+  * @brief Nombre de la pata de un canal, para los informes
+  * @param canal: canal del ADC1
+  * @retval "PA5", "PA3", ...
+  */
+const char * Nombre_Canal_ADC(canalADC_t canal) {
+	if ((uint32_t) canal >= CANTIDAD_PATAS) return "?";
+	return Patas[canal].nombre;
+}
+
+/* Callbacks de HAL (contexto de interrupción) -------------------------------*/
+
+/**
+  * @brief El DMA completó la primera mitad del buffer de captura
+  */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef * hadc) {
+	bloqueADC_t bloque = bloqueActivo;
+	if (bloque != NULL) bloque(datosCaptura, cantidadCaptura / 2);
+}
+
+/**
+  * @brief El DMA completó la segunda mitad del buffer de captura
+  */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef * hadc) {
+	bloqueADC_t bloque = bloqueActivo;
+	if (bloque != NULL) bloque(datosCaptura + cantidadCaptura / 2, cantidadCaptura / 2);
+}
+
+/**
+  * @brief Desborde (OVR): una conversión no llegó a leerse antes de la
+  *        siguiente. El HAL detiene el DMA; se vuelve a arrancar.
+  */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef * hadc) {
+	if (bloqueActivo == NULL) return;
+	desbordes++;
+	HAL_ADC_Stop_DMA(hadc);
+	HAL_ADC_Start_DMA(hadc, (uint32_t *) datosCaptura, cantidadCaptura);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/**
+  * @brief ADC1 Initialization Function
+  * @param disparo: ADC_SOFTWARE_START o ADC_EXTERNALTRIGCONV_T2_TRGO
+  * @param muestreo: tiempo de muestreo del canal
+  * @param canal: pata a convertir (queda en modo analógico)
+  * @retval None
+  */
+static void MX_ADC1_Init(uint32_t disparo, uint32_t muestreo, canalADC_t canal)
+{
+  ADC_ChannelConfTypeDef sConfig = {0};
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  /** Configure the global features of the ADC (Clock, Resolution, Data Alignment and number of conversion)
+  */
+  hadc1.Instance = ADC1;
+  hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;		// 84 MHz / 4 = 21 MHz
+  hadc1.Init.Resolution = ADC_RESOLUTION_12B;
+  hadc1.Init.ScanConvMode = DISABLE;
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConvEdge = (disparo == ADC_SOFTWARE_START) ? ADC_EXTERNALTRIGCONVEDGE_NONE
+		                                                             : ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.ExternalTrigConv = disparo;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.NbrOfConversion = 1;
+  hadc1.Init.DMAContinuousRequests = (disparo == ADC_SOFTWARE_START) ? DISABLE : ENABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Pata del canal en modo analógico (PA5 ya lo está desde HAL_ADC_MspInit)
+  */
+  if (Patas[canal].puerto == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
+  else __HAL_RCC_GPIOA_CLK_ENABLE();
+  GPIO_InitStruct.Pin = Patas[canal].pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  HAL_GPIO_Init(Patas[canal].puerto, &GPIO_InitStruct);
+
+  /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
+  */
+  sConfig.Channel = Patas[canal].canal;
+  sConfig.Rank = 1;
+  sConfig.SamplingTime = muestreo;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA2_Stream0_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+  /* ADC_IRQn: avisos de desborde del ADC */
+  HAL_NVIC_SetPriority(ADC_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(ADC_IRQn);
+
+}
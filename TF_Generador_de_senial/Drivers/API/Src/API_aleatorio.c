@@ -0,0 +1,324 @@
+/*******************************************************************************
+  * @file		API_aleatorio.c
+  * @brief      Secuencias PRBS y ruido uniforme o gaussiano en punto fijo
+  *             (ver API_aleatorio.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_aleatorio.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define DOS_LN2_Q16			90852		// 2 ln 2 en Q16
+#define CUARTO_DE_VUELTA	0x40000000u	// 90° en fase de 32 bits
+
+/* Variables privadas --------------------------------------------------------*/
+// ln(1 + i/64) en Q16, con un valor extra para interpolar el último tramo
+static const uint32_t TablaLn[(1 << ALEA_BITS_LN) + 1] = {
+		0, 1016, 2017, 3002, 3973, 4930, 5873, 6802, 7719, 8623, 9515, 10394,
+		11262, 12119, 12965, 13800, 14624, 15438, 16242, 17037, 17821, 18597, 19364, 20121,
+		20870, 21611, 22343, 23067, 23783, 24492, 25193, 25886, 26573, 27252, 27924, 28589,
+		29248, 29900, 30546, 31185, 31818, 32445, 33067, 33682, 34292, 34896, 35494, 36087,
+		36675, 37258, 37835, 38407, 38975, 39537, 40095, 40648, 41196, 41740, 42280, 42815,
+		43345, 43872, 44394, 44912, 45426
+};
+
+// Orden y realimentación de Galois (bit e-1 por cada término x^e) de cada PRBS
+static const uint8_t OrdenPrbs[] = { 7, 15, 23, 31 };
+static const uint32_t MascaraPrbs[] = {
+	(1u << 6) | (1u << 5),			// x^7 + x^6 + 1
+	(1u << 14) | (1u << 13),		// x^15 + x^14 + 1
+	(1u << 22) | (1u << 17),		// x^23 + x^18 + 1
+	(1u << 30) | (1u << 27)			// x^31 + x^28 + 1
+};
+
+// -3 dB de potencia del CIC en diezmilésimas de fs / DEC, por log2(DEC)
+static const uint16_t AnchoCic[] = { 5000, 3641, 3286, 3213, 3195, 3191, 3190, 3189, 3189 };
+
+// Nombres de los generadores para el comando RAND
+static const char * const NombreTipo[] = {
+	[ALEA_PRBS7] = "PRBS7", [ALEA_PRBS15] = "PRBS15", [ALEA_PRBS23] = "PRBS23",
+	[ALEA_PRBS31] = "PRBS31", [ALEA_UNIFORME] = "UNIF", [ALEA_GAUSS] = "GAUSS"
+};
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t xorshift(uint32_t * x);
+static int32_t gauss(estadoAleatorio_t * e);
+static uint32_t raiz(uint64_t valor);
+static uint32_t raiz32(uint32_t valor);
+static bool_t esPrbs(tipoAleatorio_t tipo);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  PRBS15 de +-1000 cuentas alrededor de 2048, un bit por muestra,
+  *         sin filtro
+  * @param  a: parámetros a completar
+  * @retval None
+  */
+void Alea_Defecto(aleatorio_t * a) {
+	a->tipo = ALEA_PRBS15;
+	a->amplitud = 1000;
+	a->offset = 2048;
+	a->chip = 1;
+	a->decimacion = 1;
+	a->semilla = 1;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[PRBS7|PRBS15|PRBS23|PRBS31|UNIF|GAUSS] [AMP=..]
+  *         [OFF=..] [CHIP=..] [DEC=..] [SEED=..]". Lo que no aparece
+  *         conserva su valor. Modifica el texto (strtok).
+  * @param  texto: argumentos del comando
+  * @param  a: parámetros a modificar
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Alea_Interpretar(char * texto, aleatorio_t * a) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		uint8_t i;
+		for (i=0; i<ALEA_TIPOS; i++) {
+			if (strcmp(token, NombreTipo[i]) == 0) break;
+		}
+		if (i < ALEA_TIPOS) {
+			a->tipo = (tipoAleatorio_t) i;
+		} else {
+			char * igual = strchr(token, '=');
+			if (igual == NULL) return false;
+			*igual = '\0';
+			const char * textoValor = igual + 1;
+
+			if (strcmp(token, "AMP") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				a->amplitud = valor;
+			} else if (strcmp(token, "OFF") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				a->offset = valor;
+			} else if (strcmp(token, "CHIP") == 0) {
+				if (Num_Leer(textoValor, 1, ALEA_MAX_CHIP, &valor, NULL) != true) return false;
+				a->chip = (uint32_t) valor;
+			} else if (strcmp(token, "DEC") == 0) {
+				if (Num_Leer(textoValor, 1, ALEA_MAX_DEC, &valor, NULL) != true) return false;
+				if ((valor & (valor - 1)) != 0) return false;
+				a->decimacion = (uint32_t) valor;
+			} else if (strcmp(token, "SEED") == 0) {
+				if (Num_Leer(textoValor, 1, INT32_MAX, &valor, NULL) != true) return false;
+				a->semilla = (uint32_t) valor;
+			} else return false;
+		}
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Deja el generador listo para empezar desde la semilla
+  * @param  e: estado a preparar
+  * @param  a: parámetros
+  * @retval false si algún parámetro está fuera de rango
+  */
+bool_t Alea_Preparar(estadoAleatorio_t * e, const aleatorio_t * a) {
+	if (a->tipo >= ALEA_TIPOS || a->amplitud < 0 || a->amplitud > SINT_MAX_DAC) return false;
+	if (a->chip == 0 || a->chip > ALEA_MAX_CHIP) return false;
+	if (a->decimacion == 0 || a->decimacion > ALEA_MAX_DEC || (a->decimacion & (a->decimacion - 1)) != 0) return false;
+
+	memset(e, 0, sizeof(*e));
+	e->p = *a;
+	e->registro = (a->semilla != 0) ? a->semilla : 1;
+	if (esPrbs(a->tipo)) {
+		uint32_t orden = OrdenPrbs[a->tipo - ALEA_PRBS7];
+		e->mascara = MascaraPrbs[a->tipo - ALEA_PRBS7];
+		e->registro &= (1u << orden) - 1;
+		if (e->registro == 0) e->registro = 1;
+	}
+	e->corrimiento = 2 * (31 - __CLZ(a->decimacion));
+
+	// Con ruido blanco el CIC deja pasar sum(h^2) / DEC^4 = (2 DEC^2 + 1) / (3 DEC^3)
+	// de la potencia: la entrada se agranda en la raíz de la inversa (Q12)
+	uint64_t d = a->decimacion;
+	uint32_t correccion = esPrbs(a->tipo) ? 4096 : raiz(((3 * d * d * d) << 24) / (2 * d * d + 1));
+	e->escala = a->amplitud * (int32_t) correccion;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Genera las muestras siguientes. Trabajo fijo por muestra: se puede
+  *         llamar desde la interrupción del DMA.
+  * @param  e: estado del generador
+  * @param  destino: muestras para el DAC
+  * @param  cantidad: muestras a generar
+  * @retval Muestras recortadas a 0..4095
+  */
+uint32_t Alea_Generar(estadoAleatorio_t * e, uint16_t * destino, uint32_t cantidad) {
+	const aleatorio_t * p = &e->p;
+	uint32_t mascaraIndice = p->decimacion - 1;
+	int32_t redondeo = (e->corrimiento > 0) ? (1 << (e->corrimiento - 1)) : 0;
+	uint32_t saturadas = 0;
+
+	for (uint32_t k=0; k<cantidad; k++) {
+		int32_t x;
+
+		switch (p->tipo) {
+		case ALEA_UNIFORME:
+			// u (2 A + 1) - A en Q12, con A = AMP corregida: piso de -A a A
+			x = (int32_t) (((uint64_t) xorshift(&e->registro) * (uint32_t) (2 * e->escala + 4096)) >> 32);
+			x = (x - e->escala) >> 12;
+			break;
+		case ALEA_GAUSS:
+			x = (int32_t) (((int64_t) gauss(e) * e->escala + (1 << 23)) >> 24);
+			break;
+		default:
+			// PRBS: un bit del LFSR de Galois cada CHIP muestras
+			if (e->restan == 0) {
+				uint32_t bit = e->registro & 1u;
+				e->registro = (e->registro >> 1) ^ ((0u - bit) & e->mascara);
+				e->nivel = bit ? p->amplitud : -p->amplitud;
+				e->restan = p->chip;
+			}
+			e->restan--;
+			x = e->nivel;
+			break;
+		}
+
+		if (p->decimacion > 1) {
+			// CIC de orden 2: dos sumas móviles de DEC muestras
+			e->suma1 += x - e->entradas[e->indice];
+			e->entradas[e->indice] = x;
+			e->suma2 += e->suma1 - e->sumas[e->indice];
+			e->sumas[e->indice] = e->suma1;
+			e->indice = (e->indice + 1) & mascaraIndice;
+			x = (int32_t) ((e->suma2 + redondeo) >> e->corrimiento);
+		}
+
+		int32_t v = p->offset + x;
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[k] = (uint16_t) s;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Bits hasta que la PRBS se repite
+  * @param  tipo: generador
+  * @retval 2^n - 1, o 0 si no es una PRBS
+  */
+uint32_t Alea_Periodo_Bits(tipoAleatorio_t tipo) {
+	return esPrbs(tipo) ? (1u << OrdenPrbs[tipo - ALEA_PRBS7]) - 1 : 0;
+}
+
+/*******************************************************************************
+  * @brief  Ancho de banda a -3 dB de la potencia: 0,32 a 0,36 fs / DEC por el CIC
+  *         y 0,44 fs / CHIP por los bits de la PRBS; el menor (aproximado
+  *         si intervienen los dos). Sin filtro ni CHIP, fs / 2.
+  * @param  a: parámetros
+  * @param  fs: frecuencia de muestras, Hz
+  * @retval Hz
+  */
+uint32_t Alea_Ancho_Banda(const aleatorio_t * a, uint32_t fs) {
+	uint32_t ancho = fs / 2;
+	if (a->decimacion > 1) {
+		uint32_t cic = (uint32_t) ((uint64_t) fs * AnchoCic[31 - __CLZ(a->decimacion)] / (10000ULL * a->decimacion));
+		if (cic < ancho) ancho = cic;
+	}
+	if (esPrbs(a->tipo) && a->chip > 1) {
+		uint32_t bits = (uint32_t) ((uint64_t) fs * 4429 / (10000ULL * a->chip));
+		if (bits < ancho) ancho = bits;
+	}
+	return ancho;
+}
+
+/*******************************************************************************
+  * @brief  Nombre del generador (como en el comando RAND)
+  * @param  tipo: generador
+  * @retval Texto
+  */
+const char * Alea_Nombre(tipoAleatorio_t tipo) {
+	return (tipo < ALEA_TIPOS) ? NombreTipo[tipo] : "?";
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  xorshift32 de Marsaglia (13, 17, 5): período 2^32 - 1, nunca 0
+  */
+static uint32_t xorshift(uint32_t * x) {
+	uint32_t v = *x;
+	v ^= v << 13;
+	v ^= v >> 17;
+	v ^= v << 5;
+	*x = v;
+	return v;
+}
+
+/*******************************************************************************
+  * @brief  Gaussiano de media 0 y desvío 1 en Q12, por Box-Muller: cada par
+  *         r cos(2 pi v), r sin(2 pi v) con r = sqrt(-2 ln u) sale de tres
+  *         xorshift; el seno queda guardado para la muestra siguiente.
+  *         u = m 2^-e con m en [1, 2): -2 ln u = 2 e ln 2 - 2 ln m.
+  */
+static int32_t gauss(estadoAleatorio_t * e) {
+	if (e->guardado) {
+		e->guardado = false;
+		return e->nivel;
+	}
+	uint32_t u = xorshift(&e->registro);
+	uint32_t ceros = __CLZ(u);
+	uint32_t mantisa = (u << ceros) << 1;			// Bits después del primer uno
+	uint32_t j = mantisa >> (32 - ALEA_BITS_LN);
+	uint32_t fraccion = (mantisa >> (32 - ALEA_BITS_LN - 16)) & 0xFFFF;
+	uint32_t ln = TablaLn[j] + (((TablaLn[j + 1] - TablaLn[j]) * fraccion) >> 16);
+	uint32_t t = (ceros + 1) * DOS_LN2_Q16 - 2 * ln;	// -2 ln u, Q16
+	int32_t r = (int32_t) raiz32(t << 8);				// Q12
+
+	uint32_t fase = xorshift(&e->registro);
+	e->nivel = (r * Sint_Seno(fase)) >> 15;
+	e->guardado = true;
+	return (r * Sint_Seno(fase + CUARTO_DE_VUELTA)) >> 15;
+}
+
+/*******************************************************************************
+  * @brief  Raíz cuadrada entera (piso), bit a bit
+  */
+static uint32_t raiz(uint64_t valor) {
+	uint64_t resultado = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > valor) bit >>= 2;
+	while (bit != 0) {
+		if (valor >= resultado + bit) {
+			valor -= resultado + bit;
+			resultado = (resultado >> 1) + bit;
+		} else {
+			resultado >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t) resultado;
+}
+
+/*******************************************************************************
+  * @brief  Raíz cuadrada entera (piso) de 32 bits: 16 pasos fijos y sin
+  *         saltos (cada bit se decide con una máscara)
+  */
+static uint32_t raiz32(uint32_t valor) {
+	uint32_t resultado = 0;
+
+	for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2) {
+		uint32_t prueba = resultado + bit;
+		uint32_t mascara = 0u - (uint32_t) (valor >= prueba);
+		valor -= prueba & mascara;
+		resultado = (resultado >> 1) + (bit & mascara);
+	}
+	return resultado;
+}
+
+/*******************************************************************************
+  * @brief  Indica si el generador es una PRBS
+  */
+static bool_t esPrbs(tipoAleatorio_t tipo) {
+	return tipo <= ALEA_PRBS31;
+}
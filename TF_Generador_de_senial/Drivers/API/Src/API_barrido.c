@@ -0,0 +1,426 @@
+/*******************************************************************************
+  * @file		API_barrido.c
+  * @brief      Barridos de frecuencia en punto fijo (ver API_barrido.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_barrido.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define UNO_Q32			0x100000000ULL
+#define LN2_Q32			2977044472ULL		// ln(2) en Q32
+#define BITS_EXP2		6					// Tabla de 2^(i/64)
+
+/* Variables privadas --------------------------------------------------------*/
+// 2^(i/64) en Q30, i = 0..63
+static const uint32_t Exp2Tabla[1 << BITS_EXP2] = {
+		1073741824, 1085434106, 1097253708, 1109202018, 1121280436, 1133490379, 1145833280, 1158310587,
+		1170923762, 1183674286, 1196563654, 1209593378, 1222764986, 1236080024, 1249540052, 1263146652,
+		1276901417, 1290805962, 1304861917, 1319070932, 1333434672, 1347954824, 1362633090, 1377471191,
+		1392470869, 1407633882, 1422962010, 1438457051, 1454120821, 1469955159, 1485961921, 1502142985,
+		1518500250, 1535035634, 1551751076, 1568648537, 1585730000, 1602997467, 1620452965, 1638098541,
+		1655936265, 1673968228, 1692196547, 1710623359, 1729250827, 1748081133, 1767116489, 1786359126,
+		1805811301, 1825475297, 1845353420, 1865448001, 1885761398, 1906295993, 1927054196, 1948038440,
+		1969251188, 1990694927, 2012372174, 2034285470, 2056437387, 2078830522, 2101467502, 2124350982,
+};
+
+static const char * const NombreTipo[] = {
+	[BARRIDO_LIN] = "LIN", [BARRIDO_LOG] = "LOG",
+	[BARRIDO_PASOS] = "STEP", [BARRIDO_PASOS_LOG] = "STEPLOG"
+};
+
+/* Prototipos privados -------------------------------------------------------*/
+static void siguienteTramo(estadoBarrido_t * e);
+static void parabola(estadoBarrido_t * e, uint64_t pasoMedio, uint32_t medio);
+static uint64_t pasoDeFrecuencia(uint32_t f, uint32_t reloj, uint32_t divisor);
+static uint64_t log2Q32(uint32_t x);
+static uint64_t exp2Paso(uint64_t base, uint64_t octavas, bool_t negativo);
+static void avanceIniciar(avanceBarrido_t * a, uint64_t total, uint32_t divisor);
+static void avanceSumar(avanceBarrido_t * a);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Parámetros por defecto: chirp lineal de 100 Hz a 10 kHz en 1 s,
+  *         a escala completa y repetido.
+  * @param  b: parámetros a inicializar
+  * @retval None
+  */
+void Barrido_Defecto(barrido_t * b) {
+	b->tipo = BARRIDO_LIN;
+	b->f1 = 100;
+	b->f2 = 10000;
+	b->tiempo = 1000;
+	b->pasos = 10;
+	b->amplitud = 2047;
+	b->offset = 2048;
+	b->repetir = true;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[LIN|LOG|STEP|STEPLOG] [F1=..] [F2=..] [T=..]
+  *         [STEPS=..] [AMP=..] [OFF=..] [ONCE]". Lo que no aparece conserva
+  *         su valor (salvo ONCE, que sólo vale si aparece). Modifica el
+  *         texto (strtok). Los límites que dependen de fs los verifica
+  *         Barrido_Preparar().
+  * @param  texto: argumentos del comando
+  * @param  b: parámetros a modificar
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Barrido_Interpretar(char * texto, barrido_t * b) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	b->repetir = true;
+	while (token != NULL) {
+		uint8_t i;
+		for (i=0; i<sizeof(NombreTipo)/sizeof(NombreTipo[0]); i++) {
+			if (strcmp(token, NombreTipo[i]) == 0) break;
+		}
+		if (i < sizeof(NombreTipo)/sizeof(NombreTipo[0])) {
+			b->tipo = (tipoBarrido_t) i;
+		} else if (strcmp(token, "ONCE") == 0) {
+			b->repetir = false;
+		} else {
+			char * igual = strchr(token, '=');
+			if (igual == NULL) return false;
+			*igual = '\0';
+			const char * textoValor = igual + 1;
+
+			if (strcmp(token, "F1") == 0) {
+				if (Num_Leer(textoValor, 0, BARRIDO_MAX_FRECUENCIA, &valor, NULL) != true) return false;
+				b->f1 = (uint32_t) valor;
+			} else if (strcmp(token, "F2") == 0) {
+				if (Num_Leer(textoValor, 0, BARRIDO_MAX_FRECUENCIA, &valor, NULL) != true) return false;
+				b->f2 = (uint32_t) valor;
+			} else if (strcmp(token, "T") == 0) {
+				if (Num_Leer(textoValor, 1, BARRIDO_MAX_TIEMPO, &valor, NULL) != true) return false;
+				b->tiempo = (uint32_t) valor;
+			} else if (strcmp(token, "STEPS") == 0) {
+				if (Num_Leer(textoValor, 2, BARRIDO_MAX_PASOS, &valor, NULL) != true) return false;
+				b->pasos = (uint32_t) valor;
+			} else if (strcmp(token, "AMP") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				b->amplitud = valor;
+			} else if (strcmp(token, "OFF") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				b->offset = valor;
+			} else return false;
+		}
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Prepara el barrido para fs = reloj / divisor, con la fase en cero.
+  * @param  e: estado a inicializar
+  * @param  b: parámetros
+  * @param  reloj: Hz del reloj de los disparos (FRECUENCIA_TIM2)
+  * @param  divisor: ciclos de reloj por muestra (ARR + 1)
+  * @retval false si alguna frecuencia llega a fs / 2, LOG o STEPLOG con una
+  *         frecuencia en cero, el barrido (o un paso) dura menos de una
+  *         muestra o más de 2^32 muestras, o el chirp LOG es más rápido que
+  *         BARRIDO_MAX_OCTAVAS_TRAMO
+  */
+bool_t Barrido_Preparar(estadoBarrido_t * e, const barrido_t * b, uint32_t reloj, uint32_t divisor) {
+	bool_t logaritmico = (b->tipo == BARRIDO_LOG || b->tipo == BARRIDO_PASOS_LOG);
+
+	if (divisor == 0) return false;
+	if ((uint64_t) b->f1 * divisor * 2 >= reloj || (uint64_t) b->f2 * divisor * 2 >= reloj) return false;
+	if (logaritmico && (b->f1 == 0 || b->f2 == 0)) return false;
+	uint64_t largo = (uint64_t) b->tiempo * reloj / ((uint64_t) 1000 * divisor);
+	if (largo < 1 || largo > UINT32_MAX) return false;
+	if ((b->tipo == BARRIDO_LIN || b->tipo == BARRIDO_LOG) && largo < 2) return false;
+
+	memset(e, 0, sizeof(estadoBarrido_t));
+	e->p = *b;
+	e->amplitud = b->amplitud;
+	e->largo = (uint32_t) largo;
+	e->paso1 = pasoDeFrecuencia(b->f1, reloj, divisor);
+	e->paso2 = pasoDeFrecuencia(b->f2, reloj, divisor);
+	e->baja = (b->f2 < b->f1);
+	if (logaritmico) {
+		uint64_t l1 = log2Q32(b->f1);
+		uint64_t l2 = log2Q32(b->f2);
+		e->octavas = e->baja ? l1 - l2 : l2 - l1;
+	}
+	// Velocidad máxima del LOG: el error de la parábola crece con el cubo
+	// de las octavas por tramo
+	if (b->tipo == BARRIDO_LOG
+			&& e->octavas * BARRIDO_SEGMENTO * BARRIDO_MAX_OCTAVAS_TRAMO > (uint64_t) e->largo << 32) return false;
+
+	switch (b->tipo) {
+	case BARRIDO_LIN:
+		e->tramos = 1;
+		break;
+	case BARRIDO_LOG:
+		e->tramos = (e->largo + BARRIDO_SEGMENTO - 1) / BARRIDO_SEGMENTO;
+		break;
+	default:
+		e->tramos = b->pasos;
+		break;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Genera las próximas muestras del barrido.
+  *         offset + amplitud x seno(fase), saturado a 12 bits.
+  * @param  e: estado (preparado con Barrido_Preparar)
+  * @param  destino: muestras para el DAC
+  * @param  cantidad: muestras a generar
+  * @retval Muestras saturadas
+  */
+uint32_t Barrido_Generar(estadoBarrido_t * e, uint16_t * destino, uint32_t cantidad) {
+	uint32_t saturadas = 0;
+
+	while (cantidad > 0) {
+		if (e->restantes == 0) siguienteTramo(e);
+		uint32_t n = (cantidad < e->restantes) ? cantidad : e->restantes;
+
+		uint64_t fase = e->fase;
+		uint64_t paso = e->paso;
+		int64_t delta = e->delta;
+		int64_t curva = e->curva;
+		int32_t amplitud = e->amplitud;
+		int32_t offset = e->p.offset;
+		for (uint32_t i=0; i<n; i++) {
+			int32_t valor = offset + ((amplitud * Sint_Seno((uint32_t) (fase >> 32))) >> 15);
+			uint32_t muestra = __USAT(valor, 12);
+			if ((int32_t) muestra != valor) saturadas++;
+			*destino++ = (uint16_t) muestra;
+			fase += paso;
+			paso += (uint64_t) delta;
+			delta += curva;
+		}
+		e->fase = fase;
+		e->paso = paso;
+		e->delta = delta;
+		e->restantes -= n;
+		e->muestra += n;
+		cantidad -= n;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Nombre del tipo de barrido, como en el comando
+  * @param  tipo
+  * @retval "LIN", "LOG", "STEP" o "STEPLOG"
+  */
+const char * Barrido_Nombre(tipoBarrido_t tipo) {
+	return NombreTipo[tipo];
+}
+
+/*******************************************************************************
+  * @brief  Frecuencia que se está generando
+  * @param  e: estado
+  * @param  reloj, divisor: los de Barrido_Preparar()
+  * @retval Hz (truncados)
+  */
+uint32_t Barrido_Frecuencia(const estadoBarrido_t * e, uint32_t reloj, uint32_t divisor) {
+	return (uint32_t) ((((e->paso >> 32) * reloj) >> 32) / divisor);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Pasa al próximo tramo. El paso arranca en el valor exacto que
+  *         corresponde al tramo (corrige lo que truncó delta) y la fase no
+  *         se toca. Al terminar un barrido lo repite o deja la salida en OFF.
+  * @param  e: estado
+  * @retval None
+  */
+static void siguienteTramo(estadoBarrido_t * e) {
+	if (e->terminado) {
+		e->restantes = UINT32_MAX;
+		return;
+	}
+	if (e->tramo == e->tramos) {
+		e->barridos++;
+		if (!e->p.repetir) {
+			e->terminado = true;
+			e->amplitud = 0;
+			e->paso = 0;
+			e->delta = 0;
+			e->curva = 0;
+			e->restantes = UINT32_MAX;
+			return;
+		}
+		e->tramo = 0;
+	}
+
+	// Posición en el barrido: octavas por segmento (LOG), Hz por paso
+	// (STEP) u octavas por paso (STEPLOG)
+	if (e->tramo == 0) {
+		e->pasoSiguiente = e->paso1;
+		if (e->p.tipo == BARRIDO_LOG) {
+			avanceIniciar(&e->avance, e->octavas * BARRIDO_SEGMENTO, e->largo);
+		} else if (e->p.tipo == BARRIDO_PASOS) {
+			avanceIniciar(&e->avance, e->baja ? e->paso1 - e->paso2 : e->paso2 - e->paso1, e->p.pasos - 1);
+		} else if (e->p.tipo == BARRIDO_PASOS_LOG) {
+			avanceIniciar(&e->avance, e->octavas, e->p.pasos - 1);
+		}
+	}
+	e->paso = e->pasoSiguiente;
+	e->curva = 0;
+	bool_t ultimo = (e->tramo + 1 == e->tramos);
+	bool_t penultimo = (e->tramo + 2 == e->tramos);
+
+	switch (e->p.tipo) {
+	case BARRIDO_LIN:
+		e->restantes = e->largo;
+		e->delta = (int64_t) (e->paso2 - e->paso1) / (int64_t) e->largo;
+		break;
+
+	case BARRIDO_LOG:
+		e->restantes = ultimo ? e->largo - e->tramo * BARRIDO_SEGMENTO : BARRIDO_SEGMENTO;
+		{
+			// Parábola por el comienzo, el medio y el final del tramo
+			uint64_t inicio = e->avance.valor;
+			if (ultimo) {
+				e->pasoSiguiente = e->paso2;
+				avanceSumar(&e->avance);	// Pasa de largo: sólo para el medio
+			} else {
+				avanceSumar(&e->avance);
+				e->pasoSiguiente = exp2Paso(e->paso1, e->avance.valor, e->baja);
+			}
+			uint32_t medio = e->restantes / 2;
+			uint64_t posicionMedio = inicio + (e->avance.valor - inicio) * medio / BARRIDO_SEGMENTO;
+			parabola(e, exp2Paso(e->paso1, posicionMedio, e->baja), medio);
+		}
+		break;
+
+	case BARRIDO_PASOS:
+	case BARRIDO_PASOS_LOG:
+		e->restantes = e->largo;
+		e->delta = 0;
+		if (ultimo) break;
+		avanceSumar(&e->avance);
+		if (penultimo) e->pasoSiguiente = e->paso2;
+		else if (e->p.tipo == BARRIDO_PASOS_LOG) e->pasoSiguiente = exp2Paso(e->paso1, e->avance.valor, e->baja);
+		else e->pasoSiguiente = e->baja ? e->paso1 - e->avance.valor : e->paso1 + e->avance.valor;
+		break;
+	}
+
+	// Marca: cada paso o el comienzo de cada chirp
+	if (e->tramo == 0 || e->p.tipo == BARRIDO_PASOS || e->p.tipo == BARRIDO_PASOS_LOG) {
+		e->marca = e->muestra;
+		e->marcas++;
+	}
+	e->tramo++;
+}
+
+/*******************************************************************************
+  * @brief  Delta y curva del tramo para que el paso pase por 'pasoMedio' en
+  *         la muestra 'medio' y llegue a pasoSiguiente al final (diferencias
+  *         sucesivas de una parábola: paso += delta, delta += curva).
+  * @param  e: estado, con paso, pasoSiguiente y restantes del tramo
+  * @param  pasoMedio: paso exacto en la muestra 'medio'
+  * @param  medio: muestra del tramo (restantes / 2)
+  * @retval None
+  */
+static void parabola(estadoBarrido_t * e, uint64_t pasoMedio, uint32_t medio) {
+	int64_t largo = (int64_t) e->restantes;
+	int64_t pendienteFinal = (int64_t) (e->pasoSiguiente - e->paso) / largo;
+
+	if (medio == 0) {				// Tramo de una muestra: recta
+		e->delta = pendienteFinal;
+		return;
+	}
+	int64_t pendienteMedio = (int64_t) (pasoMedio - e->paso) / (int64_t) medio;
+	int64_t c = (pendienteFinal - pendienteMedio) / (largo - (int64_t) medio);
+	e->delta = pendienteMedio - c * (int64_t) medio + c;
+	e->curva = 2 * c;
+}
+
+/*******************************************************************************
+  * @brief  Paso de fase de una frecuencia: f x divisor / reloj en Q0.64
+  * @param  f: Hz, menor que fs / 2
+  * @param  reloj, divisor: fs = reloj / divisor
+  * @retval Ciclos por muestra en Q0.64
+  */
+static uint64_t pasoDeFrecuencia(uint32_t f, uint32_t reloj, uint32_t divisor) {
+	uint64_t numerador = (uint64_t) f * divisor;		// < reloj / 2
+	uint64_t alto = (numerador << 32) / reloj;
+	uint64_t resto = (numerador << 32) % reloj;
+	return (alto << 32) | ((resto << 32) / reloj);
+}
+
+/*******************************************************************************
+  * @brief  log2(x) en Q32, por cuadrados sucesivos de la mantisa
+  * @param  x: mayor que cero
+  * @retval log2(x) x 2^32
+  */
+static uint64_t log2Q32(uint32_t x) {
+	uint32_t exponente = 31;
+	while ((x & 0x80000000UL) == 0) {
+		x <<= 1;
+		exponente--;
+	}
+	uint64_t mantisa = x;				// [1, 2) en Q31
+	uint64_t resultado = (uint64_t) exponente << 32;
+	for (int32_t bit=31; bit>=0; bit--) {
+		mantisa = (mantisa * mantisa) >> 31;
+		if (mantisa >= UNO_Q32) {		// Llegó a 2
+			mantisa >>= 1;
+			resultado |= (uint64_t) 1 << bit;
+		}
+	}
+	return resultado;
+}
+
+/*******************************************************************************
+  * @brief  base x 2^(+/- octavas). La fracción sale de la tabla (1/64 de
+  *         octava) y de Taylor de tercer orden para el resto: error
+  *         relativo del orden de 2^-30.
+  * @param  base: paso en Q0.64
+  * @param  octavas: Q32
+  * @param  negativo: base x 2^(-octavas)
+  * @retval Paso en Q0.64
+  */
+static uint64_t exp2Paso(uint64_t base, uint64_t octavas, bool_t negativo) {
+	int32_t exponente;
+	uint32_t fraccion;
+	if (negativo) {
+		exponente = -(int32_t) ((octavas + 0xFFFFFFFFULL) >> 32);
+		fraccion = (uint32_t) (0 - octavas);
+	} else {
+		exponente = (int32_t) (octavas >> 32);
+		fraccion = (uint32_t) octavas;
+	}
+
+	// 2^fraccion = tabla x e^(resto x ln 2), resto < 1/64
+	uint64_t y = ((uint64_t) (fraccion & ((1UL << (32 - BITS_EXP2)) - 1)) * LN2_Q32) >> 32;
+	uint64_t cuadrado = (y * y) >> 32;
+	uint64_t serie = UNO_Q32 + y + (cuadrado >> 1) + ((cuadrado * y) >> 32) / 6;
+	uint64_t mantisa = ((uint64_t) Exp2Tabla[fraccion >> (32 - BITS_EXP2)] * serie) >> 32;	// Q30
+
+	// base x mantisa / 2^30 sin pasar de 64 bits
+	uint64_t resultado = (((base >> 32) * mantisa) << 2) + (((base & 0xFFFFFFFFULL) * mantisa) >> 30);
+	return (exponente >= 0) ? resultado << exponente : resultado >> -exponente;
+}
+
+/*******************************************************************************
+  * @brief  Prepara un avance de total / divisor por llamada: después de
+  *         'divisor' llamadas el valor es exactamente 'total'.
+  */
+static void avanceIniciar(avanceBarrido_t * a, uint64_t total, uint32_t divisor) {
+	a->valor = 0;
+	a->cociente = total / divisor;
+	a->resto = (uint32_t) (total % divisor);
+	a->acumulado = 0;
+	a->divisor = divisor;
+}
+
+static void avanceSumar(avanceBarrido_t * a) {
+	a->valor += a->cociente;
+	a->acumulado += a->resto;
+	if (a->acumulado >= a->divisor) {
+		a->acumulado -= a->divisor;
+		a->valor++;
+	}
+}
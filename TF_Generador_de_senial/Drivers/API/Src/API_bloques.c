@@ -0,0 +1,142 @@
+/*******************************************************************************
+  * @file		API_bloques.c
+  * @brief      Lo común de las salidas por bloques del DAC2 (ver API_bloques.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_bloques.h"
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Arranca el DAC recorriendo 'buffer' con la recarga de media
+  *         transferencia. Las dos mitades se generan con el timer detenido,
+  *         antes del primer disparo.
+  * @param  buffer: dos mitades de 'mitad' muestras
+  * @param  mitad: muestras por bloque
+  * @param  recarga: genera una mitad (también las dos primeras)
+  * @retval None
+  */
+void Bloques_Comenzar(uint16_t * buffer, uint32_t mitad, recargaDAC_t recarga) {
+	if (buffer == NULL || recarga == NULL) Error_Handler();
+	Detener_Disparo_DAC_DMA();
+	recarga(buffer, mitad);
+	recarga(buffer + mitad, mitad);
+	Fijar_Recarga_DAC_DMA(recarga);
+	Comenzar_DAC_DMA(buffer, 2 * mitad);
+	Reanudar_Disparo_DAC_DMA();
+}
+
+/*******************************************************************************
+  * @brief  Detiene el DAC (la salida queda en la última muestra) y quita la
+  *         recarga
+  * @param  None
+  * @retval None
+  */
+void Bloques_Parar(void) {
+	Parar_DAC_DMA();
+	Fijar_Recarga_DAC_DMA(NULL);
+}
+
+/*******************************************************************************
+  * @brief  Cuenta un bloque terminado: sus ciclos, el peor y si pasó su
+  *         plazo. Al final de la recarga, en contexto de interrupción.
+  * @param  c: contadores del generador
+  * @param  inicio: medicionCiclos() al comenzar el bloque
+  * @param  cantidad: muestras del bloque
+  * @retval None
+  */
+void Bloques_Registrar(volatile bloquesContadores_t * c, uint32_t inicio, uint32_t cantidad) {
+	uint32_t ciclos = medicionCiclos() - inicio;
+	c->bloques++;
+	c->ciclos = ciclos;
+	if (ciclos > c->ciclosMaximo) c->ciclosMaximo = ciclos;
+	if (ciclos > Leer_Ciclos_Muestra_DAC_DMA() * cantidad) c->atrasos++;
+}
+
+/*******************************************************************************
+  * @brief  Ciclos de un bloque: la menor de BLOQUES_REPETICIONES
+  *         mediciones (la que no tuvo interrupciones en el medio)
+  * @param  generar: genera un bloque con un estado de prueba
+  * @param  destino: lugar para el bloque (no el buffer del DMA)
+  * @param  cantidad: muestras del bloque
+  * @retval Ciclos de CPU
+  */
+uint32_t Bloques_Medir(recargaDAC_t generar, uint16_t * destino, uint32_t cantidad) {
+	uint32_t menor = UINT32_MAX;
+	for (uint32_t r=0; r<BLOQUES_REPETICIONES; r++) {
+		uint32_t inicio = medicionCiclos();
+		generar(destino, cantidad);
+		uint32_t medidos = medicionCiclos() - inicio;
+		if (medidos < menor) menor = medidos;
+	}
+	return menor;
+}
+
+/*******************************************************************************
+  * @brief  Frecuencia de muestras a la que un bloque de 'ciclos' ocuparía
+  *         'porcentaje' de la CPU
+  * @param  ciclos: ciclos de un bloque
+  * @param  mitad: muestras del bloque
+  * @param  porcentaje: fracción de la CPU, 1..100
+  * @retval Muestras por segundo
+  */
+uint32_t Bloques_Fs_Maxima(uint32_t ciclos, uint32_t mitad, uint32_t porcentaje) {
+	if (ciclos == 0) ciclos = 1;
+	return (uint32_t) ((uint64_t) SystemCoreClock * porcentaje * mitad / (100ULL * ciclos));
+}
+
+/*******************************************************************************
+  * @brief  Agrega el costo por muestra contra el presupuesto de la fs actual:
+  *         " CICLOS=<último bloque> MAX=<peor bloque> PRESUPUESTO=
+  *          CARGA=<%>%"
+  * @param  fin: donde seguir escribiendo
+  * @param  c: contadores (copia)
+  * @param  mitad: muestras por bloque
+  * @retval Fin del texto agregado
+  */
+char * Bloques_AgregarCosto(char * fin, const bloquesContadores_t * c, uint32_t mitad) {
+	uint32_t porMuestra = Leer_Ciclos_Muestra_DAC_DMA();
+	uint32_t disponible = porMuestra * mitad;
+
+	fin = Num_AgregarTexto(fin, " CICLOS=");
+	fin = Num_AgregarDecimal(fin, c->ciclos / mitad);
+	fin = Num_AgregarTexto(fin, " MAX=");
+	fin = Num_AgregarDecimal(fin, c->ciclosMaximo / mitad);
+	fin = Num_AgregarTexto(fin, " PRESUPUESTO=");
+	fin = Num_AgregarDecimal(fin, porMuestra);
+	fin = Num_AgregarTexto(fin, " CARGA=");
+	fin = Num_AgregarDecimal(fin, (uint32_t) ((uint64_t) c->ciclos * 100 / disponible));
+	return Num_AgregarTexto(fin, "%");
+}
+
+/*******************************************************************************
+  * @brief  Agrega la fs máxima de cada tipo con 'porcentaje' de la CPU y
+  *         sus ciclos por muestra: " <tipo>=<fs> ... CICLOS <tipo>= ..."
+  * @param  fin: donde seguir escribiendo
+  * @param  ciclos: ciclos por bloque de cada tipo (ver Bloques_Medir)
+  * @param  tipos: cantidad de tipos
+  * @param  nombre: nombre de cada tipo
+  * @param  porcentaje: fracción de la CPU, 1..100
+  * @param  mitad: muestras por bloque
+  * @retval Fin del texto agregado
+  */
+char * Bloques_AgregarCapacidad(char * fin, const uint32_t * ciclos, uint32_t tipos, nombreBloques_t nombre,
+		                        uint32_t porcentaje, uint32_t mitad) {
+	for (uint32_t t=0; t<tipos; t++) {
+		fin = Num_AgregarTexto(fin, " ");
+		fin = Num_AgregarTexto(fin, nombre(t));
+		fin = Num_AgregarTexto(fin, "=");
+		fin = Num_AgregarDecimal(fin, Bloques_Fs_Maxima(ciclos[t], mitad, porcentaje));
+	}
+	fin = Num_AgregarTexto(fin, " CICLOS");
+	for (uint32_t t=0; t<tipos; t++) {
+		fin = Num_AgregarTexto(fin, " ");
+		fin = Num_AgregarTexto(fin, nombre(t));
+		fin = Num_AgregarTexto(fin, "=");
+		fin = Num_AgregarDecimal(fin, ciclos[t] / mitad);
+	}
+	return fin;
+}
@@ -0,0 +1,209 @@
+/*******************************************************************************
+  * @file		API_calibracion.c
+  * @brief      Calibración del DAC: ajuste de ganancia y offset, tabla de
+  *             no linealidad (INL) y tabla de corrección por código
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include "API_calibracion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_CODIGO			(CAL_CODIGOS - 1)
+#define MINIMO_LINEALES		(CAL_PUNTOS / 2)	// Puntos del tramo lineal para aceptar el ajuste
+#define MEDIDA_MINIMA		(1 << CAL_BITS_MEDIDA)					// Más abajo el ADC satura
+#define MEDIDA_MAXIMA		((MAX_CODIGO - 1) << CAL_BITS_MEDIDA)	// Más arriba, también
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t calcularSuma(const calibracion_t * cal);
+static int32_t recta(const calibracion_t * cal, uint32_t codigo);
+
+/*******************************************************************************
+  * @brief  Código del DAC de un punto de medición.
+  * @param  punto: 0..CAL_PUNTOS-1
+  * @retval Código (el último punto es 4095)
+  */
+uint16_t Cal_Codigo(uint32_t punto) {
+	uint32_t codigo = punto * CAL_PASO;
+	return (uint16_t) ((codigo > MAX_CODIGO) ? MAX_CODIGO : codigo);
+}
+
+/*******************************************************************************
+  * @brief  Ajusta ganancia y offset en el tramo lineal y calcula la INL.
+  *         El tramo lineal es la racha más larga de pasos entre puntos que
+  *         crecen al menos 3/4 de lo esperado (cerca de los rieles el
+  *         buffer de salida comprime la transferencia) y que el ADC no
+  *         midió saturado.
+  * @param  medidas: salida medida en cada punto (cuentas del ADC x 16)
+  * @param  cal: resultado
+  * @retval false si la transferencia no tiene un tramo lineal suficiente
+  *         (p.ej. la entrada del ADC no está conectada a la salida)
+  */
+bool_t Cal_Ajustar(const uint16_t medidas[CAL_PUNTOS], calibracion_t * cal) {
+	memset(cal, 0, sizeof(*cal));		// También el relleno: entra en la suma
+
+	// 1) Tramo lineal
+	uint32_t inicio = 0, mejorInicio = 0, mejorLargo = 0;
+	for (uint32_t k=0; k<CAL_PUNTOS - 1; k++) {
+		int32_t esperado = (Cal_Codigo(k + 1) - Cal_Codigo(k)) << CAL_BITS_MEDIDA;
+		if (4 * ((int32_t) medidas[k + 1] - medidas[k]) < 3 * esperado
+				|| medidas[k] < MEDIDA_MINIMA || medidas[k + 1] > MEDIDA_MAXIMA) {
+			inicio = k + 1;
+		} else if (k + 1 - inicio > mejorLargo) {
+			mejorInicio = inicio;
+			mejorLargo = k + 1 - inicio;
+		}
+	}
+	if (mejorLargo + 1 < MINIMO_LINEALES) return false;
+	cal->primero = (uint16_t) mejorInicio;
+	cal->ultimo = (uint16_t) (mejorInicio + mejorLargo);
+
+	// 2) Recta por mínimos cuadrados (enteros de 64 bits: mismo resultado en la PC)
+	int64_t n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+	for (uint32_t k=cal->primero; k<=cal->ultimo; k++) {
+		int64_t x = Cal_Codigo(k), y = medidas[k];
+		n++;
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+	int64_t denominador = n * sxx - sx * sx;
+	if (denominador <= 0) return false;
+	cal->ganancia = (int32_t) (((n * sxy - sx * sy) << CAL_BITS_GANANCIA) / denominador);
+	if (cal->ganancia <= 0) return false;
+	int64_t numerador = (sy << CAL_BITS_GANANCIA) - (int64_t) cal->ganancia * sx;
+	int64_t divisor = n << CAL_BITS_GANANCIA;
+	cal->offset = (int32_t) ((numerador + ((numerador < 0) ? -divisor : divisor) / 2) / divisor);
+
+	// 3) Apartamiento de cada punto respecto de la recta
+	for (uint32_t k=0; k<CAL_PUNTOS; k++) {
+		int32_t inl = (int32_t) medidas[k] - recta(cal, Cal_Codigo(k));
+		cal->inl[k] = (int16_t) ((inl > INT16_MAX) ? INT16_MAX : (inl < INT16_MIN) ? INT16_MIN : inl);
+	}
+
+	cal->firma = CAL_FIRMA;
+	cal->suma = calcularSuma(cal);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Verifica firma y suma (p.ej. de la copia guardada en flash).
+  * @param  cal: calibración
+  * @retval true si se puede usar
+  */
+bool_t Cal_Valida(const calibracion_t * cal) {
+	return cal->firma == CAL_FIRMA && cal->suma == calcularSuma(cal) && cal->ganancia > 0
+	       && cal->primero < cal->ultimo && cal->ultimo < CAL_PUNTOS;
+}
+
+/*******************************************************************************
+  * @brief  Mayor apartamiento de la recta dentro del tramo lineal.
+  * @param  cal: calibración
+  * @retval |INL| máximo (cuentas x 16)
+  */
+int32_t Cal_Inl_Maximo(const calibracion_t * cal) {
+	int32_t maximo = 0;
+	for (uint32_t k=cal->primero; k<=cal->ultimo; k++) {
+		int32_t inl = (cal->inl[k] < 0) ? -cal->inl[k] : cal->inl[k];
+		if (inl > maximo) maximo = inl;
+	}
+	return maximo;
+}
+
+/*******************************************************************************
+  * @brief  Arma la tabla de corrección invirtiendo la transferencia medida
+  *         (recta + INL, interpolada entre puntos). Los códigos deseados que
+  *         el DAC no alcanza quedan en el extremo más cercano.
+  * @param  cal: calibración válida
+  * @param  tabla: código a escribir en el DAC para cada código deseado
+  * @retval None
+  */
+void Cal_Tabla(const calibracion_t * cal, uint16_t tabla[CAL_CODIGOS]) {
+	int32_t medida[CAL_PUNTOS];
+
+	// Transferencia reconstruida, forzada a no decreciente
+	for (uint32_t k=0; k<CAL_PUNTOS; k++) {
+		medida[k] = recta(cal, Cal_Codigo(k)) + cal->inl[k];
+		if (k > 0 && medida[k] < medida[k - 1]) medida[k] = medida[k - 1];
+	}
+
+	uint32_t k = 0;
+	for (uint32_t deseado=0; deseado<CAL_CODIGOS; deseado++) {
+		int32_t objetivo = (int32_t) (deseado << CAL_BITS_MEDIDA);
+		while (k < CAL_PUNTOS - 2 && medida[k + 1] < objetivo) k++;
+
+		int32_t codigo;
+		if (objetivo <= medida[0]) {
+			codigo = 0;
+		} else if (objetivo >= medida[CAL_PUNTOS - 1]) {
+			codigo = MAX_CODIGO;
+		} else {
+			int32_t diferencia = medida[k + 1] - medida[k];
+			int32_t paso = Cal_Codigo(k + 1) - Cal_Codigo(k);
+			codigo = Cal_Codigo(k);
+			if (diferencia > 0) codigo += ((objetivo - medida[k]) * paso + diferencia / 2) / diferencia;
+		}
+		tabla[deseado] = (uint16_t) ((codigo > MAX_CODIGO) ? MAX_CODIGO : codigo);
+	}
+}
+
+/*******************************************************************************
+  * @brief  Rango útil: códigos deseados que caen dentro del tramo lineal.
+  *         Fuera de él la tabla igual interpola entre las medidas, pero un
+  *         quiebre entre dos puntos (riel del buffer, saturación del ADC)
+  *         no se corrige.
+  * @param  cal: calibración válida
+  * @param  minimo: primer código deseado del tramo lineal
+  * @param  maximo: último código deseado del tramo lineal
+  * @retval None
+  */
+void Cal_Rango(const calibracion_t * cal, uint16_t * minimo, uint16_t * maximo) {
+	int32_t bajo = recta(cal, Cal_Codigo(cal->primero)) + cal->inl[cal->primero];
+	int32_t alto = recta(cal, Cal_Codigo(cal->ultimo)) + cal->inl[cal->ultimo];
+	bajo = (bajo + (1 << CAL_BITS_MEDIDA) - 1) >> CAL_BITS_MEDIDA;		// Hacia adentro
+	alto >>= CAL_BITS_MEDIDA;
+	*minimo = (uint16_t) ((bajo < 0) ? 0 : (bajo > MAX_CODIGO) ? MAX_CODIGO : bajo);
+	*maximo = (uint16_t) ((alto < 0) ? 0 : (alto > MAX_CODIGO) ? MAX_CODIGO : alto);
+}
+
+/*******************************************************************************
+  * @brief  Pasa las muestras por la tabla de corrección.
+  * @param  tabla: ver Cal_Tabla
+  * @param  muestras: muestras de 12 bits (se corrigen en el lugar)
+  * @param  largo: cantidad de muestras
+  * @retval None
+  */
+void Cal_Corregir(const uint16_t tabla[CAL_CODIGOS], uint16_t * muestras, uint32_t largo) {
+	for (uint32_t i=0; i<largo; i++) muestras[i] = tabla[muestras[i] & MAX_CODIGO];
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Suma de verificación de todo lo anterior al campo 'suma'.
+  * @param  cal: calibración
+  * @retval Suma (rota un bit por byte: detecta bytes intercambiados)
+  */
+static uint32_t calcularSuma(const calibracion_t * cal) {
+	const uint8_t * bytes = (const uint8_t *) cal;
+	uint32_t suma = 0x5A5A5A5AUL;
+	for (size_t i=0; i<offsetof(calibracion_t, suma); i++) {
+		suma = ((suma << 1) | (suma >> 31)) + bytes[i];
+	}
+	return suma;
+}
+
+/*******************************************************************************
+  * @brief  Valor de la recta ajustada en un código.
+  * @param  cal: calibración
+  * @param  codigo: código del DAC
+  * @retval Medida esperada (cuentas x 16)
+  */
+static int32_t recta(const calibracion_t * cal, uint32_t codigo) {
+	int64_t producto = (int64_t) cal->ganancia * codigo;
+	return (int32_t) ((producto + (1L << (CAL_BITS_GANANCIA - 1))) >> CAL_BITS_GANANCIA) + cal->offset;
+}
@@ -0,0 +1,343 @@
+/*******************************************************************************
+  * @file		API_captura.c
+  * @brief      Captura de la respuesta (modo osciloscopio): ADC1 disparado por
+  *             TIM2 junto con el DAC2, con disparo, pre/post-disparo,
+  *             decimación y envío binario por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La interrupción del DMA del ADC (productor) decima cada mitad del buffer
+  * y guarda el resultado: en la historia (captura única) o en bloques que
+  * pasan al lazo principal por un buffer circular (captura continua). El
+  * lazo principal (consumidor) envía los bloques por UART, de a uno por
+  * llamada para seguir atendiendo comandos.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_captura.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MASCARA_HISTORIA	(CAPT_HISTORIA - 1)
+#define LARGO_ENCABEZADO	(sizeof(bloqueCaptura_t) - CAPT_BLOQUE * sizeof(uint16_t))
+#define PRE_DEFECTO			256
+#define POST_DEFECTO		1792
+
+/* Typedef privados ----------------------------------------------------------*/
+typedef enum {
+	INACTIVA,
+	ARMADA,				// Esperando 'pre' muestras y el disparo
+	DISPARADA,			// Esperando 'post' muestras
+	COMPLETA			// El ADC ya no escribe la historia
+} estadoCaptura_t;
+
+/* Variables privadas --------------------------------------------------------*/
+// La captura única y la continua no ocurren a la vez: comparten la memoria
+static union {
+	uint16_t historia[CAPT_HISTORIA];
+	bloqueCaptura_t bloques[CAPT_BLOQUES];
+} memoria;
+static uint16_t bufferADC[2 * CAPT_MITAD];	// Lo que escribe el DMA
+static ring_t cola;							// Interrupción -> lazo principal (continua)
+static bloqueCaptura_t armado;				// Bloque en curso (interrupción)
+static bloqueCaptura_t envio;				// Bloque que se envía (lazo principal)
+
+static captura_t parametros;
+static bool_t activa = false;
+static bool_t adcEnMarcha = false;
+static volatile estadoCaptura_t estado = INACTIVA;
+static uint32_t suma = 0;					// Decimación en curso
+static uint32_t sumadas = 0;
+static uint32_t escritas = 0;				// Muestras decimadas en la historia
+static uint32_t disparo = 0;				// Índice de la muestra de disparo
+static uint16_t anterior = 0xFFFF;			// Muestra previa (flanco)
+static uint32_t llenas = 0;					// Muestras en 'armado'
+static uint16_t secuencia = 0;
+static uint32_t leidas = 0;					// Muestras de la historia ya enviadas
+static uint32_t bytesEnviados = 0;
+static uint32_t inicioEnvio = 0;			// ms (HAL_GetTick) del primer bloque
+static captContadores_t contadores;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void recibirMitad(const uint16_t * mitad, uint32_t cantidad);
+static bool_t agregarUnica(uint16_t muestra);
+static void agregarContinua(uint16_t muestra);
+static void enviarBloque(bloqueCaptura_t * bloque);
+
+/*******************************************************************************
+  * @brief  Parámetros por defecto: captura única de 2048 muestras de PA3
+  *         con disparo inmediato y 256 de pre-disparo, sin decimar.
+  * @param  c: parámetros
+  * @retval None
+  */
+void Capt_Defecto(captura_t * c) {
+	c->continua = false;
+	c->disparo = CAPT_INMEDIATO;
+	c->nivel = 2048;
+	c->pre = PRE_DEFECTO;
+	c->post = POST_DEFECTO;
+	c->decimacion = 1;
+	c->entrada = ADC_ENTRADA_PA3;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[CONT] [PRE=..] [POST=..] [DEC=..] [TRIG=AUTO|<nivel>]
+  *         [IN=PA3|PC0|PC3]".
+  *         Lo que no se indica queda como estaba.
+  * @param  texto: argumentos del comando (se modifica)
+  * @param  c: parámetros
+  * @retval true si los parámetros son válidos
+  */
+bool_t Capt_Interpretar(char * texto, captura_t * c) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		if (strcmp(token, "CONT") == 0) {
+			c->continua = true;
+			token = strtok(NULL, " ");
+			continue;
+		}
+		char * igual = strchr(token, '=');
+		if (igual == NULL) return false;
+		*igual = '\0';
+		const char * textoValor = igual + 1;
+
+		if (strcmp(token, "TRIG") == 0) {
+			if (strcmp(textoValor, "AUTO") == 0) {
+				c->disparo = CAPT_INMEDIATO;
+			} else if (Num_Leer(textoValor, 0, 0x0FFF, &valor, NULL)) {
+				c->disparo = CAPT_NIVEL;
+				c->nivel = (uint16_t) valor;
+			} else return false;
+		} else if (strcmp(token, "IN") == 0) {
+			if (Interpretar_Entrada_ADC(textoValor, &c->entrada) != true) return false;
+		} else {
+			if (Num_Leer(textoValor, 0, CAPT_DECIMACION_MAXIMA, &valor, NULL) != true) return false;
+			if      (strcmp(token, "PRE") == 0)  c->pre = (uint32_t) valor;
+			else if (strcmp(token, "POST") == 0) c->post = (uint32_t) valor;
+			else if (strcmp(token, "DEC") == 0)  c->decimacion = (uint32_t) valor;
+			else return false;
+		}
+		token = strtok(NULL, " ");
+	}
+	return (c->decimacion >= 1 && c->post >= 1 && c->pre + c->post <= CAPT_HISTORIA);
+}
+
+/*******************************************************************************
+  * @brief  Arranca la captura con la frecuencia de muestras actual de TIM2
+  *         y anuncia las tasas: "CAPT <fs> <dec> <fs/dec> <enlace>\n".
+  * @param  c: parámetros válidos (ver Capt_Interpretar)
+  * @retval false si TIM2 dispara más rápido de lo que convierte el ADC
+  */
+bool_t Capt_Iniciar(const captura_t * c) {
+	uint32_t fs = FRECUENCIA_TIM2 / (Leer_Periodo_DAC_DMA() + 1);
+	uint32_t enlace = UART_BAUDIOS / 10 * CAPT_BLOQUE / sizeof(bloqueCaptura_t);
+	char anuncio[64];
+
+	if (activa) Capt_Parar();
+	if (fs > ADC_FS_MAXIMA) return false;
+
+	parametros = *c;
+	memset(&contadores, 0, sizeof(contadores));
+	suma = 0;
+	sumadas = 0;
+	escritas = 0;
+	anterior = 0xFFFF;
+	llenas = 0;
+	secuencia = 0;
+	leidas = 0;
+	bytesEnviados = 0;
+	ringInit(&cola, memoria.bloques, CAPT_BLOQUES, sizeof(bloqueCaptura_t));
+	armado.sincronismo[0] = envio.sincronismo[0] = CAPT_SINCRONISMO_1;
+	armado.sincronismo[1] = envio.sincronismo[1] = CAPT_SINCRONISMO_2;
+	armado.cantidad = CAPT_BLOQUE;
+
+	char * fin = Num_AgregarDecimal(Num_AgregarTexto(anuncio, "CAPT "), fs);
+	*fin++ = ' ';
+	fin = Num_AgregarDecimal(fin, parametros.decimacion);
+	*fin++ = ' ';
+	fin = Num_AgregarDecimal(fin, fs / parametros.decimacion);
+	*fin++ = ' ';
+	fin = Num_AgregarDecimal(fin, enlace);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) anuncio, (uint16_t) (fin - anuncio));
+	if (parametros.continua && fs / parametros.decimacion > enlace) {
+		uartSendLiteral("Aviso: la captura supera al enlace, se perderan bloques.\n");
+	}
+
+	estado = ARMADA;
+	activa = true;
+	Comenzar_Captura_ADC(parametros.entrada, bufferADC, 2 * CAPT_MITAD, recibirMitad);
+	adcEnMarcha = true;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Atiende la captura desde el lazo principal: envía a lo sumo un
+  *         bloque por llamada.
+  * @param  None
+  * @retval false cuando la captura terminó (ya se informó)
+  */
+bool_t Capt_Procesar(void) {
+	if (!activa) return false;
+
+	if (parametros.continua) {
+		if (ringGet(&cola, &envio)) enviarBloque(&envio);
+		return true;
+	}
+
+	if (estado != COMPLETA) return true;
+	if (adcEnMarcha) {
+		Parar_Captura_ADC();
+		adcEnMarcha = false;
+	}
+
+	// Captura única: de 'pre' muestras antes del disparo a 'post' desde él
+	uint32_t total = parametros.pre + parametros.post;
+	uint32_t cantidad = (total - leidas < CAPT_BLOQUE) ? total - leidas : CAPT_BLOQUE;
+	uint32_t origen = disparo - parametros.pre + leidas;
+	for (uint32_t k=0; k<cantidad; k++) envio.muestras[k] = memoria.historia[(origen + k) & MASCARA_HISTORIA];
+	envio.secuencia = secuencia++;
+	envio.cantidad = (uint16_t) cantidad;
+	contadores.bloques++;
+	enviarBloque(&envio);
+	leidas += cantidad;
+
+	if (leidas < total) return true;
+	Capt_Parar();
+	return false;
+}
+
+/*******************************************************************************
+  * @brief  Detiene la captura e informa:
+  *         "FIN CAPT adquiridas= bloques= enviados= perdidos= desbordes= B/s=
+  *         entrada="
+  * @param  None
+  * @retval None
+  */
+void Capt_Parar(void) {
+	char informe[144];
+
+	if (!activa) return;
+	if (adcEnMarcha) Parar_Captura_ADC();
+	adcEnMarcha = false;
+	activa = false;
+	estado = INACTIVA;
+
+	Capt_Contadores(&contadores);
+	char * fin = Num_AgregarTexto(informe, "FIN CAPT adquiridas=");
+	fin = Num_AgregarDecimal(fin, contadores.adquiridas);
+	fin = Num_AgregarTexto(fin, " bloques=");
+	fin = Num_AgregarDecimal(fin, contadores.bloques);
+	fin = Num_AgregarTexto(fin, " enviados=");
+	fin = Num_AgregarDecimal(fin, contadores.enviados);
+	fin = Num_AgregarTexto(fin, " perdidos=");
+	fin = Num_AgregarDecimal(fin, contadores.perdidos);
+	fin = Num_AgregarTexto(fin, " desbordes=");
+	fin = Num_AgregarDecimal(fin, contadores.desbordes);
+	fin = Num_AgregarTexto(fin, " B/s=");
+	fin = Num_AgregarDecimal(fin, contadores.bytesPorSegundo);
+	fin = Num_AgregarTexto(fin, " entrada=");
+	fin = Num_AgregarTexto(fin, Nombre_Canal_ADC(parametros.entrada));
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay una captura en curso.
+  * @param  None
+  * @retval true desde Capt_Iniciar hasta que termina o se para
+  */
+bool_t Capt_Activa(void) {
+	return activa;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores de la captura actual (o de la última).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Capt_Contadores(captContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	contadores.desbordes = Leer_Desbordes_ADC();
+	uint32_t transcurrido = HAL_GetTick() - inicioEnvio;
+	contadores.bytesPorSegundo = (bytesEnviados != 0 && transcurrido != 0)
+			                   ? (uint32_t) ((uint64_t) bytesEnviados * 1000 / transcurrido) : 0;
+	*destino = contadores;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Decima una mitad del buffer del ADC. Contexto de interrupción.
+  * @param  mitad: conversiones recién completadas
+  * @param  cantidad: conversiones de esa mitad
+  * @retval None
+  */
+static void recibirMitad(const uint16_t * mitad, uint32_t cantidad) {
+	uint32_t decimacion = parametros.decimacion;
+
+	contadores.adquiridas += cantidad;
+	for (uint32_t i=0; i<cantidad; i++) {
+		suma += mitad[i];
+		if (++sumadas < decimacion) continue;
+		uint16_t muestra = (uint16_t) ((suma + decimacion / 2) / decimacion);
+		suma = 0;
+		sumadas = 0;
+		if (parametros.continua) agregarContinua(muestra);
+		else if (agregarUnica(muestra) != true) return;
+	}
+}
+
+/*******************************************************************************
+  * @brief  Guarda una muestra en la historia y evalúa el disparo.
+  * @param  muestra: muestra decimada
+  * @retval false cuando la captura está completa (la historia ya no cambia)
+  */
+static bool_t agregarUnica(uint16_t muestra) {
+	if (estado == COMPLETA) return false;
+
+	memoria.historia[escritas & MASCARA_HISTORIA] = muestra;
+	escritas++;
+	if (estado == ARMADA && escritas > parametros.pre) {
+		if (parametros.disparo == CAPT_INMEDIATO || (anterior < parametros.nivel && muestra >= parametros.nivel)) {
+			disparo = escritas - 1;
+			estado = DISPARADA;
+		}
+	}
+	anterior = muestra;
+
+	if (estado == DISPARADA && escritas - disparo >= parametros.post) {
+		estado = COMPLETA;
+		return false;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Agrega una muestra al bloque en curso; completo, lo pasa al lazo
+  *         principal o lo cuenta como perdido.
+  * @param  muestra: muestra decimada
+  * @retval None
+  */
+static void agregarContinua(uint16_t muestra) {
+	armado.muestras[llenas++] = muestra;
+	if (llenas < CAPT_BLOQUE) return;
+	llenas = 0;
+	armado.secuencia = secuencia++;		// También avanza si se pierde: el host ve el salto
+	contadores.bloques++;
+	if (ringPut(&cola, &armado) != true) contadores.perdidos++;
+}
+
+/*******************************************************************************
+  * @brief  Envía un bloque por UART y lleva la cuenta del caudal.
+  * @param  bloque: bloque con encabezado completo
+  * @retval None
+  */
+static void enviarBloque(bloqueCaptura_t * bloque) {
+	uint16_t largo = (uint16_t) (LARGO_ENCABEZADO + bloque->cantidad * sizeof(uint16_t));
+	if (bytesEnviados == 0) inicioEnvio = HAL_GetTick();
+	uartSendStringSize((uint8_t *) bloque, largo);
+	bytesEnviados += largo;
+	contadores.enviados++;
+}
@@ -0,0 +1,117 @@
+/*******************************************************************************
+  * @file		API_comandos.c
+  * @brief      Intérprete de comandos de texto (estilo SCPI) por tabla
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_comandos.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static const comando_t * tablaComandos = NULL;
+static uint8_t cantidadComandos = 0;
+static char linea[CMD_LARGO_LINEA];		// Línea en curso
+static uint8_t posicion = 0;
+static bool_t enLinea = false;
+static bool_t desbordada = false;
+
+/*******************************************************************************
+  * @brief  Registra la tabla de comandos y verifica que esté ordenada
+  *         (la búsqueda binaria depende de eso).
+  * @param  tabla: comandos ordenados por nombre (strcmp)
+  * @param  cantidad: entradas de la tabla
+  * @retval false si la tabla no está ordenada o tiene nombres repetidos
+  */
+bool_t Cmd_Init(const comando_t * tabla, uint8_t cantidad) {
+	if (tabla == NULL) return false;
+	for (uint8_t i=1; i<cantidad; i++) {
+		if (strcmp(tabla[i - 1].nombre, tabla[i].nombre) >= 0) return false;
+	}
+	tablaComandos = tabla;
+	cantidadComandos = cantidad;
+	posicion = 0;
+	enLinea = false;
+	desbordada = false;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Procesa un byte recibido. Las letras se pasan a mayúsculas.
+  * @param  byte: caracter recibido
+  * @retval CMD_NO_CONSUMIDO si el byte no pertenece a una línea de comando;
+  *         si no, el estado de la línea
+  */
+estadoCmd_t Cmd_Byte(uint8_t byte) {
+	if (!enLinea) {
+		// Una línea de comando empieza con letra o '*' (p.ej. *IDN?)
+		bool_t letra = (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z');
+		if (!letra && byte != '*') return CMD_NO_CONSUMIDO;
+		enLinea = true;
+		posicion = 0;
+		desbordada = false;
+	}
+
+	if (byte == '\n' || byte == '\r') {
+		enLinea = false;
+		if (desbordada) return CMD_DESBORDE;
+		linea[posicion] = '\0';
+		return Cmd_Ejecutar(linea);
+	}
+
+	if (posicion < CMD_LARGO_LINEA - 1) {
+		linea[posicion++] = (byte >= 'a' && byte <= 'z') ? (char) (byte - 'a' + 'A') : (char) byte;
+	} else {
+		desbordada = true;
+	}
+	return CMD_EN_CURSO;
+}
+
+/*******************************************************************************
+  * @brief  Ejecuta una línea completa: "<NOMBRE> [argumentos]".
+  * @param  linea: terminada en '\0' (se modifica)
+  * @retval CMD_EJECUTADO o CMD_DESCONOCIDO
+  */
+estadoCmd_t Cmd_Ejecutar(char * linea) {
+	char * argumentos = strchr(linea, ' ');
+	if (argumentos != NULL) {
+		*argumentos = '\0';
+		argumentos++;
+	} else {
+		argumentos = &linea[strlen(linea)];		// Cadena vacía
+	}
+
+	const comando_t * comando = Cmd_Buscar(linea);
+	if (comando == NULL) return CMD_DESCONOCIDO;
+	comando->accion(argumentos);
+	return CMD_EJECUTADO;
+}
+
+/*******************************************************************************
+  * @brief  Búsqueda binaria en la tabla: log2(cantidad) comparaciones.
+  * @param  nombre: nombre del comando
+  * @retval Entrada de la tabla o NULL
+  */
+const comando_t * Cmd_Buscar(const char * nombre) {
+	int16_t bajo = 0;
+	int16_t alto = (int16_t) cantidadComandos - 1;
+
+	while (bajo <= alto) {
+		int16_t medio = (int16_t) ((bajo + alto) / 2);
+		int comparacion = strcmp(nombre, tablaComandos[medio].nombre);
+		if (comparacion == 0) return &tablaComandos[medio];
+		if (comparacion < 0) alto = (int16_t) (medio - 1);
+		else bajo = (int16_t) (medio + 1);
+	}
+	return NULL;
+}
+
+/*******************************************************************************
+  * @brief  Devuelve la tabla registrada (para listar la ayuda).
+  * @param  cantidad: destino de la cantidad de entradas
+  * @retval Tabla de comandos
+  */
+const comando_t * Cmd_Tabla(uint8_t * cantidad) {
+	*cantidad = cantidadComandos;
+	return tablaComandos;
+}
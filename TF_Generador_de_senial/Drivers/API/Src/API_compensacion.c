@@ -0,0 +1,199 @@
+/*******************************************************************************
+  * @file		API_compensacion.c
+  * @brief      Compensación de la retención de orden cero del DAC: FIR
+  *             inverso de sinc, circular, en punto fijo
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_compensacion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define REDONDEO			(1L << (ZOH_BITS - 1))
+#define DISENIOS			4			// 3, 5, 7 y 9 coeficientes
+#define PLANICIDAD_SIN		312			// Caída de sinc en ZOH_BANDA: centésimas de dB
+
+/* Variables privadas --------------------------------------------------------*/
+// Mitad de cada FIR, del coeficiente central hacia afuera (Q14). Minimax
+// del error relativo de sinc(f / fs) x H(f) entre 0 y ZOH_BANDA; el
+// central se ajusta después de redondear para que la suma dé 1 exacto.
+static const int16_t Disenios[DISENIOS][ZOH_MITAD_MAXIMA + 1] = {
+	{ 19824, -1720 },
+	{ 18652, -1648,  514 },
+	{ 19186, -1663,  480, -218 },
+	{ 18944, -1678,  492, -202, 108 },
+};
+
+// Peor desvío de sinc(f / fs) x H(f) hasta ZOH_BANDA: centésimas de dB
+// (redondeado hacia arriba; lo recalcula Herramientas/retencion_bench.c)
+static const uint16_t Planicidad[DISENIOS] = { 79, 37, 18, 10 };
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t llenar(const compensacion_t * c, const uint16_t * senial, uint32_t largo,
+		               uint32_t escritas, uint32_t indice, int16_t * destino, uint32_t cantidad);
+static uint32_t convolucionar(const compensacion_t * c, uint16_t * destino, uint32_t cantidad);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Coeficientes de un diseño
+  * @param  taps: 3, 5, 7 o 9
+  * @retval taps / 2 + 1 coeficientes Q14, del central hacia afuera; NULL si
+  *         no hay diseño con esos taps
+  */
+const int16_t * Zoh_Coeficientes(uint32_t taps) {
+	if (taps < 3 || taps > ZOH_MAX_TAPS || (taps & 1) == 0) return NULL;
+	return Disenios[taps / 2 - 1];
+}
+
+/*******************************************************************************
+  * @brief  Planicidad de la salida (sinc del DAC por el FIR) hasta ZOH_BANDA
+  * @param  taps: 0 (sin compensar), 3, 5, 7 o 9
+  * @retval Peor desvío en centésimas de dB (0 si no hay diseño)
+  */
+uint32_t Zoh_Planicidad(uint32_t taps) {
+	if (taps == 0) return PLANICIDAD_SIN;
+	if (Zoh_Coeficientes(taps) == NULL) return 0;
+	return Planicidad[taps / 2 - 1];
+}
+
+/*******************************************************************************
+  * @brief  Elige el FIR y empaqueta sus coeficientes de a dos. Con un
+  *         número impar de taps el último par lleva un cero.
+  * @param  c: compensación
+  * @param  taps: 0 (sin compensar), 3, 5, 7 o 9
+  * @retval false si no hay diseño con esos taps (c no cambia)
+  */
+bool_t Zoh_Preparar(compensacion_t * c, uint32_t taps) {
+	int16_t h[ZOH_MAX_TAPS + 1] = { 0 };
+
+	if (taps == 0) {
+		c->taps = 0;
+		c->pares = 0;
+		return true;
+	}
+	const int16_t * mitad = Zoh_Coeficientes(taps);
+	if (mitad == NULL) return false;
+
+	uint32_t centro = taps / 2;
+	for (uint32_t k=0; k<=centro; k++) {
+		h[centro - k] = mitad[k];
+		h[centro + k] = mitad[k];
+	}
+	c->taps = taps;
+	c->pares = (taps + 1) / 2;
+	for (uint32_t j=0; j<c->pares; j++) {
+		c->coeficientes[j] = __PKHBT(h[2 * j], h[2 * j + 1], 16);
+	}
+	memset(c->ventana, 0, sizeof(c->ventana));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Convolución circular en el lugar: senial[n] pasa a ser
+  *         sum h[k] senial[(n + k - taps/2) mod largo]. Se recorre de a
+  *         bloques; la ventana arrastra las taps - 1 vecinas del bloque
+  *         anterior, ya que esas posiciones de senial están sobreescritas.
+  * @param  c: compensación preparada
+  * @param  senial: un período, 0..4095; se reemplaza por la compensada
+  * @param  largo: muestras del período
+  * @retval Muestras saturadas a 0..4095
+  */
+uint32_t Zoh_Compensar(compensacion_t * c, uint16_t * senial, uint32_t largo) {
+	if (c->taps == 0 || largo == 0) return 0;
+
+	uint32_t mitad = c->taps / 2;
+	uint32_t vecinas = c->taps - 1;
+	uint32_t saturadas = 0;
+
+	// Las primeras muestras se guardan: las necesita el final del período
+	for (uint32_t k=0; k<mitad && k<largo; k++) c->cabeza[k] = (int16_t) senial[k];
+
+	uint32_t cantidad = (largo < ZOH_BLOQUE) ? largo : ZOH_BLOQUE;
+	uint32_t indice = (largo - mitad % largo) % largo;
+	indice = llenar(c, senial, largo, 0, indice, c->ventana, cantidad + vecinas);
+	for (uint32_t escritas=0; ; ) {
+		saturadas += convolucionar(c, &senial[escritas], cantidad);
+		escritas += cantidad;
+		if (escritas >= largo) break;
+
+		memmove(c->ventana, &c->ventana[cantidad], vecinas * sizeof(c->ventana[0]));
+		cantidad = (largo - escritas < ZOH_BLOQUE) ? largo - escritas : ZOH_BLOQUE;
+		indice = llenar(c, senial, largo, escritas, indice, &c->ventana[vecinas], cantidad);
+	}
+	return saturadas;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Copia muestras originales a la ventana, recorriendo el período
+  *         en forma circular. Las posiciones ya escritas se leen de la
+  *         cabeza: al volver al principio sólo se piden las taps/2 primeras.
+  * @param  c: compensación
+  * @param  senial: período en proceso
+  * @param  largo: muestras del período
+  * @param  escritas: posiciones de senial que ya tienen la salida
+  * @param  indice: primera posición a copiar
+  * @param  destino: lugar en la ventana
+  * @param  cantidad: muestras a copiar
+  * @retval Posición siguiente a la última copiada
+  */
+static uint32_t llenar(const compensacion_t * c, const uint16_t * senial, uint32_t largo,
+		               uint32_t escritas, uint32_t indice, int16_t * destino, uint32_t cantidad) {
+	for (uint32_t k=0; k<cantidad; k++) {
+		destino[k] = (indice < escritas) ? c->cabeza[indice] : (int16_t) senial[indice];
+		if (++indice == largo) indice = 0;
+	}
+	return indice;
+}
+
+/*******************************************************************************
+  * @brief  FIR sobre la ventana: destino[n] = sum h[k] ventana[n + k].
+  *         Como en API_filtro.c, dos salidas por vuelta: la segunda arma
+  *         sus pares de muestras con las mitades de dos lecturas (PKHBT).
+  *         El último coeficiente puede ser el cero de relleno: la muestra
+  *         que multiplica existe en la ventana y no cambia el resultado.
+  * @param  c: compensación con pares > 0
+  * @param  destino: salida del bloque
+  * @param  cantidad: muestras del bloque
+  * @retval Muestras saturadas a 0..4095
+  */
+static uint32_t convolucionar(const compensacion_t * c, uint16_t * destino, uint32_t cantidad) {
+	const int16_t * v = c->ventana;
+	uint32_t saturadas = 0;
+	uint32_t n = 0;
+	uint32_t a, b;
+	int32_t y;
+
+	// memcpy: el Cortex-M4 lee palabras no alineadas con LDR
+	for (; n + 1 < cantidad; n += 2) {
+		int32_t acumulado0 = REDONDEO, acumulado1 = REDONDEO;
+		memcpy(&a, &v[n], sizeof(a));
+		for (uint32_t j=0; j<c->pares; j++) {
+			uint32_t h = c->coeficientes[j];
+			memcpy(&b, &v[n + 2 * j + 2], sizeof(b));
+			acumulado0 = (int32_t) __SMLAD(a, h, (uint32_t) acumulado0);
+			acumulado1 = (int32_t) __SMLAD(__PKHBT(a >> 16, b, 16), h, (uint32_t) acumulado1);
+			a = b;
+		}
+		y = acumulado0 >> ZOH_BITS;
+		destino[n] = (uint16_t) __USAT(y, 12);
+		saturadas += (destino[n] != y);
+		y = acumulado1 >> ZOH_BITS;
+		destino[n + 1] = (uint16_t) __USAT(y, 12);
+		saturadas += (destino[n + 1] != y);
+	}
+	if (n < cantidad) {
+		int32_t acumulado = REDONDEO;
+		for (uint32_t j=0; j<c->pares; j++) {
+			memcpy(&a, &v[n + 2 * j], sizeof(a));
+			acumulado = (int32_t) __SMLAD(a, c->coeficientes[j], (uint32_t) acumulado);
+		}
+		y = acumulado >> ZOH_BITS;
+		destino[n] = (uint16_t) __USAT(y, 12);
+		saturadas += (destino[n] != y);
+	}
+	return saturadas;
+}
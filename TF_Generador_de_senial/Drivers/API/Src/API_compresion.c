@@ -0,0 +1,109 @@
+/*******************************************************************************
+  * @file		API_compresion.c
+  * @brief      Decodificador incremental de señales comprimidas
+  *             (delta + zig-zag varint + repetición, elegido por bloque)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_compresion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_DESPLAZAMIENTO	14		// A lo sumo 3 bytes de varint (|delta| <= 4095 usa 2)
+
+/* Prototipos privados -------------------------------------------------------*/
+static bool_t escribir(decodificador_t * d, int32_t delta, uint8_t veces);
+
+/*******************************************************************************
+  * @brief  Prepara la decodificación de una señal de 'largo' muestras.
+  * @param  d: decodificador
+  * @param  destino: lugar para 'largo' muestras
+  * @param  largo: N
+  * @retval None
+  */
+void Comp_Iniciar(decodificador_t * d, uint16_t * destino, uint32_t largo) {
+	d->destino = destino;
+	d->largo = largo;
+	d->escritas = 0;
+	d->bytes = 0;
+	d->anterior = 0;
+	d->tipo = COMP_LITERAL;
+	d->restantes = 0;
+	d->varint = 0;
+	d->desplazamiento = 0;
+	d->estado = (largo > 0) ? COMP_EN_CURSO : COMP_ERROR;
+}
+
+/*******************************************************************************
+  * @brief  Procesa los bytes recibidos. Se puede llamar con cualquier
+  *         partición de la entrada (incluso de a un byte). Los bytes que
+  *         lleguen después de completar la señal se ignoran.
+  * @param  d: decodificador
+  * @param  datos: bytes comprimidos
+  * @param  cantidad: bytes disponibles
+  * @retval Estado de la decodificación
+  */
+estadoComp_t Comp_Decodificar(decodificador_t * d, const uint8_t * datos, uint32_t cantidad) {
+	for (uint32_t i=0; i<cantidad && d->estado == COMP_EN_CURSO; i++) {
+		uint8_t byte = datos[i];
+		d->bytes++;
+
+		// Cabecera de bloque
+		if (d->restantes == 0) {
+			d->tipo = byte & COMP_MASCARA_TIPO;
+			d->restantes = (byte & COMP_MASCARA_CANTIDAD) + 1;
+			if (d->tipo != COMP_LITERAL && d->tipo != COMP_REPETIR) d->estado = COMP_ERROR;
+			continue;
+		}
+
+		// Varint: 7 bits por byte, el menos significativo primero
+		d->varint |= (uint32_t) (byte & 0x7F) << d->desplazamiento;
+		if (byte & 0x80) {
+			d->desplazamiento += 7;
+			if (d->desplazamiento > MAX_DESPLAZAMIENTO) d->estado = COMP_ERROR;
+			continue;
+		}
+
+		// Zig-zag -> delta con signo
+		int32_t delta = (int32_t) (d->varint >> 1) ^ -(int32_t) (d->varint & 1);
+		d->varint = 0;
+		d->desplazamiento = 0;
+
+		uint8_t veces = (d->tipo == COMP_REPETIR) ? d->restantes : 1;
+		if (escribir(d, delta, veces) != true) {
+			d->estado = COMP_ERROR;
+		} else if (d->escritas >= d->largo) {
+			d->estado = COMP_COMPLETO;
+		}
+	}
+	return d->estado;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Suma 'delta' a la muestra anterior 'veces' veces y escribe cada
+  *         resultado. El bloque no puede pasarse de N ni salir de 0..4095.
+  */
+static bool_t escribir(decodificador_t * d, int32_t delta, uint8_t veces) {
+	if (d->escritas + veces > d->largo) return false;
+
+	// Basta con verificar los extremos: la secuencia es monótona.
+	// El primero acota el delta, así el producto no desborda.
+	int32_t primero = d->anterior + delta;
+	if (primero < 0 || primero > COMP_MAX_VALOR) return false;
+	int32_t ultimo = d->anterior + delta * veces;
+	if (ultimo < 0 || ultimo > COMP_MAX_VALOR) return false;
+
+	uint16_t * p = &d->destino[d->escritas];
+	int32_t v = d->anterior;
+	for (uint8_t k=0; k<veces; k++) {
+		v += delta;
+		p[k] = (uint16_t) v;
+	}
+	d->anterior = v;
+	d->escritas += veces;
+	d->restantes -= veces;
+	return true;
+}
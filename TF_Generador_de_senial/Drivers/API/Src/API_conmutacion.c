@@ -0,0 +1,194 @@
+/*******************************************************************************
+  * @file		API_conmutacion.c
+  * @brief      Cambio de señal en marcha sin saltos (ver API_conmutacion.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_conmutacion.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static const char * const NombrePolitica[CONM_POLITICAS] = {
+	[CONM_REINICIO] = "OFF", [CONM_INMEDIATO] = "IMM", [CONM_PERIODO] = "PERIOD",
+	[CONM_COINCIDENCIA] = "MATCH", [CONM_FUNDIDO] = "FADE"
+};
+
+/* Prototipos privados -------------------------------------------------------*/
+static bool_t cambiar(estadoConmutacion_t * e, uint32_t posicion, uint16_t nueva);
+static uint32_t distancia(uint16_t a, uint16_t b);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Parámetros por defecto: sin conmutación (la salida se reinicia,
+  *         como antes), tolerancia de 64 cuentas y fundido de 32 muestras.
+  * @param  c: parámetros a inicializar
+  * @retval None
+  */
+void Conm_Defecto(conmutacion_t * c) {
+	c->politica = CONM_REINICIO;
+	c->tolerancia = 64;
+	c->fundido = 32;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[OFF|IMM|PERIOD|MATCH|FADE] [TOL=..] [K=..]". Lo que
+  *         no aparece conserva su valor. Modifica el texto (strtok). Que K
+  *         no pase del largo de la señal lo verifica Conm_Preparar().
+  * @param  texto: argumentos del comando
+  * @param  c: parámetros a modificar
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Conm_Interpretar(char * texto, conmutacion_t * c) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		uint8_t i;
+		for (i=0; i<CONM_POLITICAS; i++) {
+			if (strcmp(token, NombrePolitica[i]) == 0) break;
+		}
+		if (i < CONM_POLITICAS) {
+			c->politica = (politicaConmutacion_t) i;
+		} else if (strncmp(token, "TOL=", 4) == 0) {
+			if (Num_Leer(token + 4, 0, CONM_MAX_TOLERANCIA, &valor, NULL) != true) return false;
+			c->tolerancia = (uint32_t) valor;
+		} else if (strncmp(token, "K=", 2) == 0) {
+			if (Num_Leer(token + 2, 1, CONM_MAX_FUNDIDO, &valor, NULL) != true) return false;
+			c->fundido = (uint32_t) valor;
+		} else return false;
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Prepara una conmutación hacia 'nueva'
+  * @param  e: estado de la conmutación
+  * @param  c: política y parámetros
+  * @param  nueva: señal nueva, ya lista para el DAC (debe quedar quieta)
+  * @param  largo: muestras del período, las mismas que las del anillo
+  * @retval false sin política, sin muestras o con K mayor que el largo
+  */
+bool_t Conm_Preparar(estadoConmutacion_t * e, const conmutacion_t * c, const uint16_t * nueva, uint32_t largo) {
+	if (c->politica == CONM_REINICIO || c->politica >= CONM_POLITICAS) return false;
+	if (nueva == NULL || largo == 0) return false;
+	if (c->politica == CONM_FUNDIDO && (c->fundido == 0 || c->fundido > largo)) return false;
+
+	e->p = *c;
+	e->nueva = nueva;
+	e->largo = largo;
+	e->fase = CONM_ESPERANDO;
+	e->revisadas = 0;
+	e->mezcladas = 0;
+	e->pesoPaso = (c->politica == CONM_FUNDIDO) ? 65536u / c->fundido : 0;
+	e->puras = 0;
+	e->escritas = 0;
+	e->posicion = 0;
+	e->forzada = false;
+	e->primera = true;
+	e->anterior = 0;
+	e->escalon = 0;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Reescribe un tramo del anillo que el DAC acaba de leer. Los
+  *         tramos llegan en el orden de salida (mitad tras mitad). Hasta
+  *         el cambio deja la señal anterior tal cual; del cambio al fin del
+  *         fundido anota el mayor salto entre muestras seguidas (el escalón
+  *         de la conmutación; después sólo sale la nueva con sus propios
+  *         saltos). Tiempo fijo por muestra:
+  *         se puede llamar desde la interrupción del DMA.
+  * @param  e: estado de la conmutación
+  * @param  anillo: buffer que recorre el DMA (tiene 'largo' muestras)
+  * @param  posicion: primera posición del tramo
+  * @param  cantidad: muestras del tramo (posicion + cantidad <= largo)
+  * @retval true si la conmutación terminó: el anillo es la señal nueva
+  */
+bool_t Conm_Generar(estadoConmutacion_t * e, uint16_t * anillo, uint32_t posicion, uint32_t cantidad) {
+	if (e->fase == CONM_TERMINADA) return true;
+	if (e->primera) {
+		// Lo último que salió antes de este tramo
+		e->anterior = anillo[((posicion == 0) ? e->largo : posicion) - 1];
+		e->primera = false;
+	}
+
+	for (uint32_t p=posicion; p<posicion+cantidad; p++) {
+		uint16_t vieja = anillo[p];
+		uint16_t nueva = e->nueva[p];
+		uint16_t salida = nueva;
+
+		if (e->fase == CONM_ESPERANDO) {
+			if (cambiar(e, p, nueva) != true) {
+				e->escritas++;
+				e->anterior = vieja;
+				continue;
+			}
+			e->posicion = p;
+			e->fase = (e->p.politica == CONM_FUNDIDO) ? CONM_FUNDIENDO : CONM_COMPLETANDO;
+		}
+		if (e->fase == CONM_FUNDIENDO) {
+			// Peso de la nueva: m / K, en Q16 (la última del fundido ya es la nueva)
+			if (++e->mezcladas < e->p.fundido) {
+				int32_t peso = (int32_t) (e->mezcladas * e->pesoPaso);
+				salida = (uint16_t) (vieja + ((((int32_t) nueva - (int32_t) vieja) * peso) >> 16));
+			} else {
+				e->fase = CONM_COMPLETANDO;
+			}
+		}
+
+		anillo[p] = salida;
+		if (e->puras == 0) {
+			uint32_t salto = distancia(salida, e->anterior);
+			if (salto > e->escalon) e->escalon = salto;
+		}
+		e->anterior = salida;
+		if (e->fase == CONM_COMPLETANDO && ++e->puras >= e->largo) {
+			e->fase = CONM_TERMINADA;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*******************************************************************************
+  * @brief  Nombre de la política (como en el comando SWITCH)
+  * @param  politica: política de conmutación
+  * @retval Texto
+  */
+const char * Conm_Nombre(politicaConmutacion_t politica) {
+	return (politica < CONM_POLITICAS) ? NombrePolitica[politica] : "?";
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Decide si la nueva señal entra en esta posición
+  * @param  e: estado de la conmutación (en CONM_ESPERANDO)
+  * @param  posicion: posición del anillo
+  * @param  nueva: muestra de la señal nueva en esa posición
+  * @retval true para cambiar acá
+  */
+static bool_t cambiar(estadoConmutacion_t * e, uint32_t posicion, uint16_t nueva) {
+	switch (e->p.politica) {
+	case CONM_PERIODO:
+		return posicion == 0;
+	case CONM_COINCIDENCIA:
+		// Sin coincidencia en un período entero: al comienzo del siguiente
+		if (e->forzada) return posicion == 0;
+		if (distancia(nueva, e->anterior) <= e->p.tolerancia) return true;
+		if (++e->revisadas >= e->largo) e->forzada = true;
+		return false;
+	default:
+		return true;
+	}
+}
+
+/*******************************************************************************
+  * @brief  Diferencia absoluta entre dos códigos
+  */
+static uint32_t distancia(uint16_t a, uint16_t b) {
+	return (a > b) ? (uint32_t) (a - b) : (uint32_t) (b - a);
+}
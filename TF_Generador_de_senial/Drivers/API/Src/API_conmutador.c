@@ -0,0 +1,181 @@
+/*******************************************************************************
+  * @file		API_conmutador.c
+  * @brief      Cambio de señal en marcha por el DAC2 (ver API_conmutador.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_conmutador.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static estadoConmutacion_t estado;
+static volatile conmContadores_t contadores;
+static volatile bool_t terminada = false;
+static bool_t enMarcha = false;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void recargar(uint16_t * mitad, uint32_t cantidad);
+static uint32_t saltoMaximo(const uint16_t * senial, uint32_t largo);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Empieza a conmutar la salida hacia 'nueva'. La salida debe estar
+  *         generando con un buffer del mismo largo que no sea 'nueva'.
+  * @param  c: política y parámetros
+  * @param  nueva: señal nueva, ya lista para el DAC (quieta hasta terminar)
+  * @param  largo: muestras del período
+  * @retval false si los parámetros no sirven para ese largo (ya informado)
+  */
+bool_t Conmutador_Iniciar(const conmutacion_t * c, const uint16_t * nueva, uint32_t largo) {
+	if (enMarcha) Conmutador_Cancelar();
+	if (Conm_Preparar(&estado, c, nueva, largo) != true) {
+		uartSendLiteral("Conmutacion invalida para este largo (K=1..N).\n");
+		return false;
+	}
+	memset((void *) &contadores, 0, sizeof(contadores));
+	contadores.natural = saltoMaximo(nueva, largo);
+	terminada = false;
+	enMarcha = true;
+	Fijar_Recarga_DAC_DMA(recargar);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Desde el lazo principal: si la conmutación terminó quita la
+  *         recarga e informa:
+  *         "FIN SWITCH <política> escalon= natural= espera= ciclos="
+  * @param  None
+  * @retval true si terminó en esta llamada
+  */
+bool_t Conmutador_Procesar(void) {
+	if (!enMarcha || !terminada) return false;
+	Fijar_Recarga_DAC_DMA(NULL);
+	enMarcha = false;
+
+	char informe[96];
+	char * fin = Num_AgregarTexto(informe, "FIN SWITCH ");
+	fin = Num_AgregarTexto(fin, Conm_Nombre(estado.p.politica));
+	fin = Num_AgregarTexto(fin, " escalon=");
+	fin = Num_AgregarDecimal(fin, contadores.escalon);
+	fin = Num_AgregarTexto(fin, " natural=");
+	fin = Num_AgregarDecimal(fin, contadores.natural);
+	fin = Num_AgregarTexto(fin, " espera=");
+	fin = Num_AgregarDecimal(fin, contadores.espera);
+	if (contadores.forzada) fin = Num_AgregarTexto(fin, " (sin coincidencia)");
+	fin = Num_AgregarTexto(fin, " ciclos=");
+	fin = Num_AgregarDecimal(fin, contadores.ciclosMaximo);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Abandona la conmutación (la salida se va a detener)
+  * @param  None
+  * @retval None
+  */
+void Conmutador_Cancelar(void) {
+	if (!enMarcha) return;
+	Fijar_Recarga_DAC_DMA(NULL);
+	enMarcha = false;
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay una conmutación en curso
+  * @param  None
+  * @retval true mientras la interrupción reescribe el buffer
+  */
+bool_t Conmutador_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Informa la política y lo medido en la última conmutación:
+  *         "SWITCH=<política> TOL= K= EN_CURSO=0|1 TRAMOS= ESCALON=
+  *          NATURAL= ESPERA= FORZADA=0|1 CICLOS_MAX= PLAZO= MARGEN=<%>"
+  *         ESCALON es el mayor salto entre muestras seguidas del cambio al
+  *         fin del fundido y NATURAL el mayor de la señal nueva sola: con
+  *         ESCALON <= NATURAL el cambio no agrega saltos. PLAZO son los
+  *         ciclos de media señal a la fs actual.
+  * @param  c: política vigente
+  * @retval None
+  */
+void Conmutador_Informar(const conmutacion_t * c) {
+	char informe[200];
+	conmContadores_t m;
+
+	__disable_irq();
+	m = contadores;
+	__enable_irq();
+	uint32_t plazo = (estado.largo / 2) * Leer_Ciclos_Muestra_DAC_DMA();
+	uint32_t peor = (m.ciclosMaximo > 0) ? m.ciclosMaximo : 1;
+
+	char * fin = Num_AgregarTexto(informe, "SWITCH=");
+	fin = Num_AgregarTexto(fin, Conm_Nombre(c->politica));
+	fin = Num_AgregarTexto(fin, " TOL=");
+	fin = Num_AgregarDecimal(fin, c->tolerancia);
+	fin = Num_AgregarTexto(fin, " K=");
+	fin = Num_AgregarDecimal(fin, c->fundido);
+	fin = Num_AgregarTexto(fin, enMarcha ? " EN_CURSO=1" : " EN_CURSO=0");
+	fin = Num_AgregarTexto(fin, " TRAMOS=");
+	fin = Num_AgregarDecimal(fin, m.tramos);
+	fin = Num_AgregarTexto(fin, " ESCALON=");
+	fin = Num_AgregarDecimal(fin, m.escalon);
+	fin = Num_AgregarTexto(fin, " NATURAL=");
+	fin = Num_AgregarDecimal(fin, m.natural);
+	fin = Num_AgregarTexto(fin, " ESPERA=");
+	fin = Num_AgregarDecimal(fin, m.espera);
+	fin = Num_AgregarTexto(fin, m.forzada ? " FORZADA=1" : " FORZADA=0");
+	fin = Num_AgregarTexto(fin, " CICLOS_MAX=");
+	fin = Num_AgregarDecimal(fin, m.ciclosMaximo);
+	fin = Num_AgregarTexto(fin, " PLAZO=");
+	fin = Num_AgregarDecimal(fin, plazo);
+	fin = Num_AgregarTexto(fin, " MARGEN=");
+	fin = Num_AgregarDecimal(fin, (peor < plazo) ? (uint32_t) ((uint64_t) (plazo - peor) * 100 / plazo) : 0);
+	fin = Num_AgregarTexto(fin, "%\n");
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Recarga de media transferencia: reescribe la mitad que el DAC
+  *         acaba de leer. Contexto de interrupción.
+  * @param  mitad: comienzo de la mitad dentro del buffer en curso
+  * @param  cantidad: muestras de la mitad
+  * @retval None
+  */
+static void recargar(uint16_t * mitad, uint32_t cantidad) {
+	if (terminada) return;
+	uint32_t inicio = medicionCiclos();
+	uint16_t * anillo = Leer_Datos_DAC_DMA();
+	bool_t listo = Conm_Generar(&estado, anillo, (uint32_t) (mitad - anillo), cantidad);
+	uint32_t ciclos = medicionCiclos() - inicio;
+
+	contadores.tramos++;
+	if (ciclos > contadores.ciclosMaximo) contadores.ciclosMaximo = ciclos;
+	contadores.escalon = estado.escalon;
+	contadores.espera = estado.escritas;
+	contadores.forzada = estado.forzada;
+	if (listo) terminada = true;
+}
+
+/*******************************************************************************
+  * @brief  Mayor salto entre muestras seguidas de una señal periódica
+  *         (incluye el paso de la última a la primera)
+  * @param  senial: muestras
+  * @param  largo: muestras del período
+  * @retval Cuentas
+  */
+static uint32_t saltoMaximo(const uint16_t * senial, uint32_t largo) {
+	uint32_t maximo = 0;
+	uint16_t anterior = senial[largo - 1];
+	for (uint32_t i=0; i<largo; i++) {
+		uint32_t salto = (senial[i] > anterior) ? (uint32_t) (senial[i] - anterior) : (uint32_t) (anterior - senial[i]);
+		if (salto > maximo) maximo = salto;
+		anterior = senial[i];
+	}
+	return maximo;
+}
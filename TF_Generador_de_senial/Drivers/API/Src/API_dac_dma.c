@@ -1,147 +1,590 @@
-/*******************************************************************************
-  * @file		main.c
-  * @brief      Generador de señales con entrada por UART
-  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
-  * @detail		Recibe una entrada por UART y la saca por DAC.
-  ******************************************************************************
-  * @attention
-  ******************************************************************************
-  */
-
-/* Includes ------------------------------------------------------------------*/
-#include "API_dac_dma.h"
-
-/* Private define ------------------------------------------------------------*/
-#define N_MUESTRAS			105		// Muestras en un período de señal
-
-/* Private variables HAL ------------------------------------------------------*/
-DAC_HandleTypeDef hdac;
-DMA_HandleTypeDef hdma_dac2;
-TIM_HandleTypeDef htim2;
-
-/* Private function prototypes -----------------------------------------------*/
-static void MX_DMA_Init(void);
-static void MX_DAC_Init(void);
-static void MX_TIM2_Init(void);
-
-/* Funciones públicas --------------------------------------------------------*/
-
-/**
-  * @brief Inicializa DMA, DAC2 y Timer 2.
-  *        Inicia el conteo de Timer 2
-  * @param None
-  * @retval None
-  */
-void Inicializar_DAC_DMA(void){
-	MX_DMA_Init();
-	MX_DAC_Init();
-	MX_TIM2_Init();
-    HAL_TIM_Base_Start(&htim2);
-}
-
-/**
-  * @brief Comienza a enviar Datos a salida por DAC
-  * @param Puntero a Datos y cantidad de datos Num_Datos
-  * @retval None
-  */
-void Comenzar_DAC_DMA(uint32_t * Datos, uint32_t Num_Datos) {
-	HAL_DAC_Start_DMA(&hdac, DAC_CHANNEL_2, Datos, Num_Datos, DAC_ALIGN_12B_R);
-}
-
-/**
-  * @brief Para el envío de Datos a salida por DAC
-  * @param None
-  * @retval None
-  */
-void Parar_DAC_DMA(void) {
-	HAL_DAC_Stop_DMA(&hdac, DAC_CHANNEL_2);
-}
-
-/* Funciones privadas --------------------------------------------------------*/
-
-/**
-  * @brief DAC Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_DAC_Init(void)
-{
-  DAC_ChannelConfTypeDef sConfig = {0};
-
-  /** DAC Initialization   */
-  hdac.Instance = DAC;
-  if (HAL_DAC_Init(&hdac) != HAL_OK)
-  {
-    Error_Handler();
-  }
-
-  /** DAC channel OUT2 config   */
-  sConfig.DAC_Trigger = DAC_TRIGGER_T2_TRGO;
-  sConfig.DAC_OutputBuffer = DAC_OUTPUTBUFFER_ENABLE;
-  if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_2) != HAL_OK)
-  {
-    Error_Handler();
-  }
-}
-
-/**
-  * @brief TIM2 Initialization Function
-  * @param None
-  * @retval None
-  */
-static void MX_TIM2_Init(void)
-{
-
-  /* USER CODE BEGIN TIM2_Init 0 */
-
-  /* USER CODE END TIM2_Init 0 */
-
-  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
-  TIM_MasterConfigTypeDef sMasterConfig = {0};
-
-  /* USER CODE BEGIN TIM2_Init 1 */
-
-  /* USER CODE END TIM2_Init 1 */
-  htim2.Instance = TIM2;
-  htim2.Init.Prescaler = 0;
-  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim2.Init.Period = 7;
-  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
-  if (HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
-  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  /* USER CODE BEGIN TIM2_Init 2 */
-
-  /* USER CODE END TIM2_Init 2 */
-
-}
-
-/**
-  * Enable DMA controller clock
-  */
-static void MX_DMA_Init(void)
-{
-
-  /* DMA controller clock enable */
-  __HAL_RCC_DMA1_CLK_ENABLE();
-
-  /* DMA interrupt init */
-  /* DMA1_Stream6_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
-
-}
-
+/*******************************************************************************
+  * @file		API_dac_dma.c
+  * @brief      Manejo de DAC2 con DMA y Timer 2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  * @detail		Saca por el DAC2 un buffer circular de muestras.
+  *             El DMA trabaja en modo doble buffer (DBM) con las dos memorias
+  *             apuntando al mismo buffer: se comporta como el modo circular,
+  *             pero permite cambiar de buffer en el límite de un período sin
+  *             detener la salida (ver Cambiar_Datos_DAC_DMA).
+  ******************************************************************************
+  * @attention
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_dac_dma.h"
+#include "API_medicion.h"
+
+/* Private define ------------------------------------------------------------*/
+#define N_MUESTRAS			105		// Muestras en un período de señal
+#define N_EVENTOS			8		// Eventos pendientes (potencia de 2)
+#define REPOSO_MAX_LECTURAS	64		// Lecturas de DOR2 esperando el reposo (basta con 1 o 2)
+
+/* Private variables HAL ------------------------------------------------------*/
+DAC_HandleTypeDef hdac;
+DMA_HandleTypeDef hdma_dac2;
+DMA_HandleTypeDef hdma_tim2_up;		// ARR de cada punto (Comenzar_Puntos_DAC_DMA)
+TIM_HandleTypeDef htim2;
+
+/* Private variables ---------------------------------------------------------*/
+static eventoDAC_t memoriaEventos[N_EVENTOS];
+static ring_t eventos;			// Interrupciones -> lazo principal
+static uint16_t * datosActivos = NULL;		// Buffer que recorre el DMA
+static uint32_t cantidadActiva = 0;
+static volatile recargaDAC_t recargaActiva = NULL;
+static uint16_t * volatile datosPendientes = NULL;	// Cambio de buffer pedido
+static volatile bool_t pendienteEnDMA = false;		// Ya está en la memoria inactiva
+static volatile uint32_t cicloCambio = 0;			// Instante del último cambio (DWT)
+static bool_t conCompuerta = false;				// TIM2 en modo gated (ráfagas)
+static siguienteDAC_t siguienteActivo = NULL;	// Bloques de una secuencia
+static uint32_t periodoPrevio = PERIODO_DAC_DEFECTO;	// ARR antes de los puntos
+static bool_t conPuntos = false;				// El DMA de TIM2 escribe ARR
+
+/* Private function prototypes -----------------------------------------------*/
+static void MX_DMA_Init(void);
+static void MX_DAC_Init(void);
+static void MX_TIM2_Init(void);
+static void mediaTransferencia(DMA_HandleTypeDef * hdma);
+static void transferenciaCompleta(DMA_HandleTypeDef * hdma);
+static void errorTransferencia(DMA_HandleTypeDef * hdma);
+static void bloqueSecuencia(DMA_HandleTypeDef * hdma);
+static void informarEvento(eventoDAC_t evento);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/**
+  * @brief Inicializa DMA, DAC2 y Timer 2.
+  *        Inicia el conteo de Timer 2
+  * @param None
+  * @retval None
+  */
+void Inicializar_DAC_DMA(void){
+	MX_DMA_Init();
+	MX_DAC_Init();
+	MX_TIM2_Init();
+	ringInit(&eventos, memoriaEventos, N_EVENTOS, sizeof(eventoDAC_t));
+    HAL_TIM_Base_Start(&htim2);
+}
+
+/**
+  * @brief Comienza a enviar Datos a salida por DAC
+  *        Las muestras son de 16 bits (12 útiles): el DMA transfiere
+  *        medias palabras al registro DHR12R2. Es lo que hace
+  *        HAL_DAC_Start_DMA(), pero con el DMA en modo doble buffer.
+  * @param Puntero a Datos y cantidad de datos Num_Datos
+  * @retval None
+  */
+void Comenzar_DAC_DMA(uint16_t * Datos, uint32_t Num_Datos) {
+	datosActivos = Datos;
+	cantidadActiva = Num_Datos;
+	datosPendientes = NULL;
+	pendienteEnDMA = false;
+
+	// Las dos mitades de cada memoria llaman a la misma recarga
+	hdma_dac2.XferHalfCpltCallback = mediaTransferencia;
+	hdma_dac2.XferM1HalfCpltCallback = mediaTransferencia;
+	hdma_dac2.XferCpltCallback = transferenciaCompleta;
+	hdma_dac2.XferM1CpltCallback = transferenciaCompleta;
+	hdma_dac2.XferErrorCallback = errorTransferencia;
+
+	SET_BIT(hdac.Instance->CR, DAC_CR_DMAEN2);
+	__HAL_DAC_ENABLE_IT(&hdac, DAC_IT_DMAUDR2);
+	if (HAL_DMAEx_MultiBufferStart_IT(&hdma_dac2, (uint32_t) Datos, (uint32_t) &hdac.Instance->DHR12R2,
+			                          (uint32_t) Datos, Num_Datos) != HAL_OK) Error_Handler();
+	__HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_2);
+}
+
+/**
+  * @brief Pide reemplazar el buffer en curso por otro del mismo largo.
+  *        El cambio ocurre al final de un período (transferencia completa),
+  *        sin cortar la salida; entonces se informa DAC_EVENTO_CAMBIO.
+  *        Datos no se debe modificar hasta ese evento.
+  * @param Datos: nuevo buffer (mismo largo que el actual)
+  * @retval None
+  */
+void Cambiar_Datos_DAC_DMA(uint16_t * Datos) {
+	pendienteEnDMA = false;
+	datosPendientes = Datos;
+}
+
+/**
+  * @brief Devuelve el buffer que recorre el DMA (el último ya cambiado).
+  * @param None
+  * @retval Puntero al buffer
+  */
+uint16_t * Leer_Datos_DAC_DMA(void) {
+	return datosActivos;
+}
+
+/**
+  * @brief Instante del último cambio de buffer, para medir la latencia
+  *        entre un pedido y la salida.
+  * @param None
+  * @retval Contador de ciclos DWT (ver API_medicion.h)
+  */
+uint32_t Leer_Ciclo_Cambio_DAC_DMA(void) {
+	return cicloCambio;
+}
+
+/**
+  * @brief Saca un valor fijo por el DAC2, sin DMA. La salida debe estar
+  *        detenida (Parar_DAC_DMA). El valor pasa a la salida con el
+  *        próximo disparo de TIM2, que sigue contando.
+  * @param Valor: código de 12 bits
+  * @retval None
+  */
+void Fijar_Valor_DAC_DMA(uint16_t Valor) {
+	if (HAL_DAC_SetValue(&hdac, DAC_CHANNEL_2, DAC_ALIGN_12B_R, Valor) != HAL_OK) Error_Handler();
+	__HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_2);
+}
+
+/**
+  * @brief Para el envío de Datos a salida por DAC
+  * @param None
+  * @retval None
+  */
+void Parar_DAC_DMA(void) {
+	HAL_DAC_Stop_DMA(&hdac, DAC_CHANNEL_2);
+}
+
+/**
+  * @brief Entrega el próximo evento informado por las interrupciones
+  * @param Puntero donde se guarda el evento
+  * @retval true si había un evento pendiente
+  */
+bool_t Leer_Evento_DAC_DMA(eventoDAC_t * evento) {
+	return ringGet(&eventos, evento);
+}
+
+/**
+  * @brief Cambia el período de muestreo (ARR de TIM2).
+  *        Frecuencia de muestras = FRECUENCIA_TIM2 / (periodo + 1).
+  *        Detiene el timer un instante para que CNT no quede por encima
+  *        del nuevo ARR (TIM2 es de 32 bits y tardaría 51 s en dar la vuelta).
+  * @param periodo: valor de ARR, mayor o igual a PERIODO_DAC_MINIMO
+  * @retval None
+  */
+void Fijar_Periodo_DAC_DMA(uint32_t periodo) {
+	if (periodo < PERIODO_DAC_MINIMO) Error_Handler();
+	__HAL_TIM_DISABLE(&htim2);
+	__HAL_TIM_SET_AUTORELOAD(&htim2, periodo);
+	__HAL_TIM_SET_COUNTER(&htim2, conCompuerta ? periodo : 0);
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief Devuelve el período de muestreo actual (ARR de TIM2)
+  * @param None
+  * @retval ARR de TIM2
+  */
+uint32_t Leer_Periodo_DAC_DMA(void) {
+	return __HAL_TIM_GET_AUTORELOAD(&htim2);
+}
+
+/**
+  * @brief Ciclos de CPU entre dos disparos de TIM2: lo que tiene la CPU por
+  *        muestra para generar o procesar un bloque a la fs actual
+  * @param None
+  * @retval Ciclos por muestra
+  */
+uint32_t Leer_Ciclos_Muestra_DAC_DMA(void) {
+	return (__HAL_TIM_GET_AUTORELOAD(&htim2) + 1) * (SystemCoreClock / FRECUENCIA_TIM2);
+}
+
+/**
+  * @brief Detiene los disparos de TIM2 sin tocar los DMA: lo que se arranque
+  *        mientras tanto (DAC y ADC) empieza con el mismo disparo.
+  * @param None
+  * @retval None
+  */
+void Detener_Disparo_DAC_DMA(void) {
+	__HAL_TIM_DISABLE(&htim2);
+	__HAL_TIM_SET_COUNTER(&htim2, 0);
+}
+
+/**
+  * @brief Reanuda los disparos de TIM2 (ver Detener_Disparo_DAC_DMA)
+  * @param None
+  * @retval None
+  */
+void Reanudar_Disparo_DAC_DMA(void) {
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief Recorre Datos en modo circular, como Comenzar_DAC_DMA pero sin las
+  *        interrupciones de media transferencia y transferencia completa:
+  *        no hay recarga ni cambio de buffer, y con tablas cortas la CPU no
+  *        atiende una interrupción cada pocas muestras (ráfagas).
+  * @param Datos: buffer de Num_Datos muestras
+  * @param Num_Datos: muestras del buffer
+  * @retval None
+  */
+void Comenzar_Tabla_DAC_DMA(uint16_t * Datos, uint32_t Num_Datos) {
+	datosActivos = Datos;
+	cantidadActiva = Num_Datos;
+	datosPendientes = NULL;
+	pendienteEnDMA = false;
+
+	SET_BIT(hdac.Instance->CR, DAC_CR_DMAEN2);
+	__HAL_DAC_ENABLE_IT(&hdac, DAC_IT_DMAUDR2);
+	if (HAL_DMAEx_MultiBufferStart(&hdma_dac2, (uint32_t) Datos, (uint32_t) &hdac.Instance->DHR12R2,
+			                       (uint32_t) Datos, Num_Datos) != HAL_OK) Error_Handler();
+	__HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_2);
+}
+
+/**
+  * @brief Pone a TIM2 bajo la compuerta de TIM3 (modo gated por ITR2): cuenta,
+  *        y dispara al DAC y al ADC, sólo mientras el TRGO de TIM3 está en
+  *        alto. Con la compuerta el contador espera en ARR: el primer disparo
+  *        sale un ciclo de TIM2 después de abrirla. Sin ella TIM2 vuelve a
+  *        contar libre desde cero.
+  * @param Compuerta: true para el modo gated
+  * @retval None
+  */
+void Fijar_Compuerta_DAC_DMA(bool_t Compuerta) {
+	TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+
+	__HAL_TIM_DISABLE(&htim2);
+	sSlaveConfig.SlaveMode = Compuerta ? TIM_SLAVEMODE_GATED : TIM_SLAVEMODE_DISABLE;
+	sSlaveConfig.InputTrigger = TIM_TS_ITR2;
+	if (HAL_TIM_SlaveConfigSynchro(&htim2, &sSlaveConfig) != HAL_OK) Error_Handler();
+	conCompuerta = Compuerta;
+	__HAL_TIM_SET_COUNTER(&htim2, Compuerta ? __HAL_TIM_GET_AUTORELOAD(&htim2) : 0);
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief Deja el contador de TIM2 a un ciclo del próximo disparo. Al cerrar
+  *        la compuerta TIM2 cuenta unos ciclos más (sincronización entre
+  *        timers): sin esto la latencia de la ráfaga siguiente cambiaría.
+  *        Sólo con la compuerta cerrada.
+  * @param None
+  * @retval None
+  */
+void Preparar_Disparo_DAC_DMA(void) {
+	__HAL_TIM_SET_COUNTER(&htim2, __HAL_TIM_GET_AUTORELOAD(&htim2));
+}
+
+/**
+  * @brief Lleva la salida a Reposo sin esperar un disparo y deja Proxima
+  *        en DHR12R2 para el próximo. Con el disparo deshabilitado lo escrito
+  *        en DHR pasa a DOR en un ciclo de APB1, y el DMA no pide datos: sólo
+  *        los pide un disparo externo. Se usa con TIM2 detenido.
+  *        La espera está acotada: si DOR2 no toma el valor (DAC sin reloj o
+  *        deshabilitado) se informa DAC_EVENTO_REPOSO y el disparo queda
+  *        habilitado igual, como antes de la llamada.
+  * @param Reposo: código de 12 bits que queda en la salida
+  * @param Proxima: código que sale con el próximo disparo
+  * @retval true si la salida quedó en Reposo
+  */
+bool_t Fijar_Reposo_DAC_DMA(uint16_t Reposo, uint16_t Proxima) {
+	uint32_t lecturas = 0;
+
+	CLEAR_BIT(hdac.Instance->CR, DAC_CR_TEN2);
+	hdac.Instance->DHR12R2 = Reposo;
+	while ((hdac.Instance->DOR2 & 0x0FFF) != Reposo && lecturas < REPOSO_MAX_LECTURAS) {
+		lecturas++;		// Un ciclo de APB1
+	}
+	bool_t enReposo = ((hdac.Instance->DOR2 & 0x0FFF) == Reposo);
+	SET_BIT(hdac.Instance->CR, DAC_CR_TEN2);
+	hdac.Instance->DHR12R2 = Proxima;
+
+	if (!enReposo) informarEvento(DAC_EVENTO_REPOSO);
+	return enReposo;
+}
+
+/**
+  * @brief Registra la función que recarga cada mitad del buffer en curso.
+  *        Con NULL el buffer se repite sin cambios (reproducción de tabla).
+  * @param recarga: función a llamar desde la interrupción del DMA
+  * @retval None
+  */
+void Fijar_Recarga_DAC_DMA(recargaDAC_t recarga) {
+	recargaActiva = recarga;
+}
+
+/**
+  * @brief Recorre una secuencia de bloques de Num_Datos muestras: las dos
+  *        memorias del DMA empiezan con Primero y Segundo, y cada vez que
+  *        una termina se la apunta al bloque que entrega Siguiente, mientras
+  *        el DAC lee la otra. No hay media transferencia ni recarga: las
+  *        muestras no se copian. El plazo para cambiar el puntero es lo que
+  *        dura un bloque; si no se llega, el DMA da error y se detiene.
+  * @param Primero: primer bloque
+  * @param Segundo: segundo bloque
+  * @param Num_Datos: muestras de cada bloque (NDTR, igual para las dos)
+  * @param Siguiente: función que entrega el bloque siguiente
+  * @retval None
+  */
+void Comenzar_Secuencia_DAC_DMA(const uint16_t * Primero, const uint16_t * Segundo, uint32_t Num_Datos,
+		                        siguienteDAC_t Siguiente) {
+	datosActivos = (uint16_t *) Primero;
+	cantidadActiva = Num_Datos;
+	datosPendientes = NULL;
+	pendienteEnDMA = false;
+	siguienteActivo = Siguiente;
+
+	hdma_dac2.XferHalfCpltCallback = NULL;
+	hdma_dac2.XferM1HalfCpltCallback = NULL;
+	hdma_dac2.XferCpltCallback = bloqueSecuencia;
+	hdma_dac2.XferM1CpltCallback = bloqueSecuencia;
+	hdma_dac2.XferErrorCallback = errorTransferencia;
+
+	SET_BIT(hdac.Instance->CR, DAC_CR_DMAEN2);
+	__HAL_DAC_ENABLE_IT(&hdac, DAC_IT_DMAUDR2);
+	if (HAL_DMAEx_MultiBufferStart_IT(&hdma_dac2, (uint32_t) Primero, (uint32_t) &hdac.Instance->DHR12R2,
+			                          (uint32_t) Segundo, Num_Datos) != HAL_OK) Error_Handler();
+	__HAL_DMA_DISABLE_IT(&hdma_dac2, DMA_IT_HT);	// Sólo transferencia completa
+	__HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_2);
+}
+
+/**
+  * @brief Recorre una tabla de puntos de duración propia: con cada disparo
+  *        de TIM2 el DMA del DAC carga el valor del punto siguiente y el
+  *        DMA de la actualización de TIM2 (DMA1 Stream7, canal 3) escribe
+  *        su ARR. Con la precarga de ARR (ARPE) el ARR escrito rige desde
+  *        el disparo siguiente: cada punto dura exactamente sus ciclos.
+  *        Las tablas van en el orden en que las toman los DMA (ver
+  *        Pts_Preparar): el primer punto es el último de la tabla y se
+  *        carga acá, antes del primer disparo, que sale a un ciclo.
+  *        Sin interrupciones: las dos tablas son circulares.
+  * @param Valores: códigos del DAC
+  * @param Periodos: ARR de cada punto, al menos PERIODO_PUNTOS_MINIMO
+  * @param Num_Datos: puntos de la tabla
+  * @retval None
+  */
+void Comenzar_Puntos_DAC_DMA(const uint16_t * Valores, const uint32_t * Periodos, uint32_t Num_Datos) {
+	if (Num_Datos == 0 || Periodos[Num_Datos - 1] < PERIODO_PUNTOS_MINIMO) Error_Handler();
+	if (!conPuntos) periodoPrevio = __HAL_TIM_GET_AUTORELOAD(&htim2);
+
+	// ARR del primer punto en el registro activo y en la precarga
+	__HAL_TIM_DISABLE(&htim2);
+	CLEAR_BIT(htim2.Instance->CR1, TIM_CR1_ARPE);
+	__HAL_TIM_SET_AUTORELOAD(&htim2, Periodos[Num_Datos - 1]);
+	SET_BIT(htim2.Instance->CR1, TIM_CR1_ARPE);
+	__HAL_TIM_SET_COUNTER(&htim2, Periodos[Num_Datos - 1]);
+
+	// El primer valor espera en DHR: el DAC lo toma con el primer disparo
+	hdac.Instance->DHR12R2 = Valores[Num_Datos - 1];
+	if (HAL_DMA_Start(&hdma_tim2_up, (uint32_t) Periodos, (uint32_t) &htim2.Instance->ARR,
+			          Num_Datos) != HAL_OK) Error_Handler();
+	__HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	Comenzar_Tabla_DAC_DMA((uint16_t *) Valores, Num_Datos);
+	conPuntos = true;
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief Termina los puntos: detiene los dos DMA (la salida queda en el
+  *        último valor) y TIM2 vuelve al ARR que tenía, sin precarga.
+  * @param None
+  * @retval None
+  */
+void Parar_Puntos_DAC_DMA(void) {
+	if (!conPuntos) return;
+	__HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_UPDATE);
+	if (HAL_DMA_Abort(&hdma_tim2_up) != HAL_OK) Error_Handler();
+	Parar_DAC_DMA();
+
+	__HAL_TIM_DISABLE(&htim2);
+	CLEAR_BIT(htim2.Instance->CR1, TIM_CR1_ARPE);
+	__HAL_TIM_SET_AUTORELOAD(&htim2, periodoPrevio);
+	__HAL_TIM_SET_COUNTER(&htim2, 0);
+	conPuntos = false;
+	__HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief Enciende o apaga el generador propio del DAC2: con cada disparo
+  *        de TIM2 el DAC suma a DHR12R2 un contador triangular que sube de
+  *        0 a 2^Bits - 1 y vuelve a bajar, o Bits bits de un LFSR de 12
+  *        (ruido). DHR lo puede fijar Fijar_Valor_DAC_DMA (sin DMA) o
+  *        recorrerlo el DMA. El manual no garantiza qué sale si la suma
+  *        pasa de 4095: DHR más el pico no debe pasarlo.
+  * @param Onda: ONDA_DAC_NINGUNA apaga el generador
+  * @param Bits: 1..ONDA_DAC_MAX_BITS (MAMP2 = Bits - 1)
+  * @retval None
+  */
+void Fijar_Onda_DAC_DMA(ondaDAC_t Onda, uint32_t Bits) {
+	if (Onda == ONDA_DAC_NINGUNA) {
+		CLEAR_BIT(hdac.Instance->CR, DAC_CR_WAVE2 | DAC_CR_MAMP2);
+		return;
+	}
+	if (Bits == 0 || Bits > ONDA_DAC_MAX_BITS) Error_Handler();
+
+	// DAC_TRIANGLEAMPLITUDE_x y DAC_LFSRUNMASK_x valen (Bits - 1) en MAMP1
+	uint32_t amplitud = (Bits - 1) << DAC_CR_MAMP1_Pos;
+	if (Onda == ONDA_DAC_TRIANGULAR) {
+		if (HAL_DACEx_TriangleWaveGenerate(&hdac, DAC_CHANNEL_2, amplitud) != HAL_OK) Error_Handler();
+	} else {
+		if (HAL_DACEx_NoiseWaveGenerate(&hdac, DAC_CHANNEL_2, amplitud) != HAL_OK) Error_Handler();
+	}
+}
+
+/* Callbacks de HAL (contexto de interrupción) -------------------------------*/
+
+/**
+  * @brief Subejecución del DMA del canal 2: el DAC deja de pedir datos
+  */
+void HAL_DACEx_DMAUnderrunCallbackCh2(DAC_HandleTypeDef *hdac) {
+	informarEvento(DAC_EVENTO_SUBEJECUCION);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/**
+  * @brief El DAC terminó de leer la primera mitad del buffer.
+  *        Si hay un cambio pedido, el nuevo buffer se escribe en la memoria
+  *        que el DMA no está usando: a mitad del período no hay carrera con
+  *        el cambio de memoria del DMA.
+  */
+static void mediaTransferencia(DMA_HandleTypeDef * hdma) {
+	recargaDAC_t recarga = recargaActiva;
+	if (recarga != NULL) recarga(datosActivos, cantidadActiva / 2);
+
+	uint16_t * pendientes = datosPendientes;
+	if (pendientes != NULL && !pendienteEnDMA) {
+		HAL_DMAEx_ChangeMemory(hdma, (uint32_t) pendientes,
+				               (hdma->Instance->CR & DMA_SxCR_CT) ? MEMORY0 : MEMORY1);
+		pendienteEnDMA = true;
+	}
+}
+
+/**
+  * @brief El DAC terminó de leer la segunda mitad del buffer.
+  *        El DMA ya pasó a la otra memoria: si tenía el buffer pedido, el
+  *        cambio está hecho y la memoria que quedó libre también lo apunta.
+  */
+static void transferenciaCompleta(DMA_HandleTypeDef * hdma) {
+	recargaDAC_t recarga = recargaActiva;
+	uint32_t mitad = cantidadActiva / 2;
+	if (recarga != NULL) recarga(datosActivos + mitad, cantidadActiva - mitad);
+
+	if (pendienteEnDMA) {
+		datosActivos = datosPendientes;
+		HAL_DMAEx_ChangeMemory(hdma, (uint32_t) datosActivos,
+				               (hdma->Instance->CR & DMA_SxCR_CT) ? MEMORY0 : MEMORY1);
+		cicloCambio = medicionCiclos();
+		datosPendientes = NULL;
+		pendienteEnDMA = false;
+		informarEvento(DAC_EVENTO_CAMBIO);
+	}
+}
+
+/**
+  * @brief Una memoria terminó su bloque y el DMA ya sigue con la otra: la
+  *        que quedó libre pasa a apuntar al bloque que sigue de la secuencia.
+  */
+static void bloqueSecuencia(DMA_HandleTypeDef * hdma) {
+	uint32_t quedan = __HAL_DMA_GET_COUNTER(hdma);
+	const uint16_t * proximo = siguienteActivo(quedan);
+	HAL_DMAEx_ChangeMemory(hdma, (uint32_t) proximo,
+			               (hdma->Instance->CR & DMA_SxCR_CT) ? MEMORY0 : MEMORY1);
+}
+
+/**
+  * @brief Error de transferencia del DMA del canal 2
+  */
+static void errorTransferencia(DMA_HandleTypeDef * hdma) {
+	informarEvento(DAC_EVENTO_ERROR_DMA);
+}
+
+/**
+  * @brief Deja un evento para el lazo principal
+  */
+static void informarEvento(eventoDAC_t evento) {
+	ringPut(&eventos, &evento);
+}
+
+/**
+  * @brief DAC Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_DAC_Init(void)
+{
+  DAC_ChannelConfTypeDef sConfig = {0};
+
+  /** DAC Initialization   */
+  hdac.Instance = DAC;
+  if (HAL_DAC_Init(&hdac) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** DAC channel OUT2 config   */
+  sConfig.DAC_Trigger = DAC_TRIGGER_T2_TRGO;
+  sConfig.DAC_OutputBuffer = DAC_OUTPUTBUFFER_ENABLE;
+  if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief TIM2 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM2_Init(void)
+{
+
+  /* USER CODE BEGIN TIM2_Init 0 */
+
+  /* USER CODE END TIM2_Init 0 */
+
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* USER CODE BEGIN TIM2_Init 1 */
+
+  /* USER CODE END TIM2_Init 1 */
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = 0;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = PERIODO_DAC_DEFECTO;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN TIM2_Init 2 */
+
+  /* USER CODE END TIM2_Init 2 */
+
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+  /* TIM6_DAC_IRQn: avisos de subejecución del DAC */
+  HAL_NVIC_SetPriority(TIM6_DAC_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(TIM6_DAC_IRQn);
+
+}
+
@@ -1,179 +1,233 @@
-/*******************************************************************************
-* @file    API_debounce.c
-* @author  Guillermo Caporaletti
-* @brief   CESE_Co18 - Práctica 4 - Punto 2:
-*          Implementación de módulo anti-rebote de pulsador.
-*******************************************************************************/
-
-/* Includes ------------------------------------------------------------------*/
-#include "API_debounce.h"
-
-/* Private typedef -----------------------------------------------------------*/
-typedef enum{
-    BUTTON_UP,
-    BUTTON_FALLING,
-    BUTTON_DOWN,
-    BUTTON_RISING
-} debounceState_t;		// Estados posibles de mi MEF antirrebote
-
-/* Private define y const ----------------------------------------------------*/
-const tick_t ventanaAntirrebote = 30;		// El tiempo que debe pasar (en milisegundos)
-											// para validar un cambio de estado del botón.
-const tick_t ventanaPresionadoLargo = 500; 	// Tiempo para considerar que hubo una presión larga
-
-/* Private variables ---------------------------------------------------------*/
-static debounceState_t estadoActual = BUTTON_UP;	// Estado del boton
-static delay_t debounceDelay;						// Estructura para el retardo antirrebote
-static delay_t retardoLargo;						// Estructura para verificar presionado largo
-static bool_t FlancoAscendente = false;
-static bool_t FlancoDescendente = false;
-static bool_t PresionadoLargo = false;
-
-/* Private function prototypes -----------------------------------------------*/
-static void buttonPressed();			// Acción de salida = togglear el LED1
-static void buttonReleased();			// Acción de salida = togglear el LED3
-
-/* Functions -----------------------------------------------------------------*/
-
-/*******************************************************************************
-* @brief  Me devuelve si hubo flanco ascendente y se resetea.
-* @param  None
-* @retval None
-*/
-bool_t readKeyRelease() {
-	bool_t salida = FlancoDescendente;
-	if (FlancoDescendente == true) {
-		// Reseteo registro de flancos
-		FlancoAscendente = false;
-		FlancoDescendente = false;
-	}
-	return salida;
-}
-
-/*******************************************************************************
-* @brief  Me devuelve si hubo flanco descendente y se resetea.
-* @param  None
-* @retval None
-*/
-bool_t readKeyPush() {
-	bool_t salida = FlancoAscendente;
-	if (FlancoAscendente == true) {
-		// Reseteo registro de flancos
-		FlancoAscendente = false;
-		FlancoDescendente = false;
-	}
-	return salida;
-}
-
-bool_t readPresionadoLargo() {
-	bool_t salida = PresionadoLargo;
-	PresionadoLargo = false;
-	return salida;
-}
-
-/*******************************************************************************
-* @brief  Inicializa MEF antirrebote en BUTTON_UP
-* @param  None
-* @retval None
-*/
-void debounceFSM_init() {
-	// Inicializo estado, flanco y retardo de validación
-	estadoActual = BUTTON_UP;
-	FlancoAscendente = false;
-	FlancoDescendente = false;
-	delayInit(&debounceDelay, ventanaAntirrebote);
-	delayInit(&retardoLargo, ventanaPresionadoLargo);
-	// Initialize BSP PB for BUTTON_USER
-	BSP_PB_Init(BUTTON_USER, BUTTON_MODE_GPIO);
-	// También inicializo los leds que uso dentro del módulo
-	//BSP_LED_Init(LED1);
-	//BSP_LED_Init(LED3);
-}
-
-/*******************************************************************************
-* @brief  Actualiza MEF antirrebote:
-*         Lee las entradas, resuelve la lógica de transición
-*         y actualizar las salidas.
-* @param  None
-* @retval None
-*/
-void debounceFSM_update() {
-	bool LecturaBoton = BSP_PB_GetState(BUTTON_USER);
-
-	switch (estadoActual) { // -------------------------------------------------
-
-		case BUTTON_UP:
-			if (LecturaBoton == true) {
-				// Debo cambiar de estado...
-				estadoActual = BUTTON_FALLING;
-		}
-		break;
-
-		case BUTTON_FALLING:
-			if (delayRead(&debounceDelay) == true) {
-				// Terminó el retardo y por lo tanto
-				// debo evaluar cambio de estado...
-				if (LecturaBoton == false) {
-					// ...en definitiva fue un falso descenso
-					estadoActual = BUTTON_UP;
-				} else {
-					// Hay un cambio de estado!!!
-					estadoActual = BUTTON_DOWN;
-					buttonPressed();	// Acción de flanco ascendente de señal.
-				}
-			}
-		break;
-
-		case BUTTON_DOWN:
-			if (LecturaBoton == false) {
-				// Debo cambiar de estado...
-				estadoActual = BUTTON_RISING;
-			}
-		break;
-
-		case BUTTON_RISING:
-			if (delayRead(&debounceDelay) == true) {
-				// Terminó el retardo y por lo tanto
-				// debo evaluar cambio de estado...
-				if (LecturaBoton == true) {
-					// ...en definitiva fue un falso ascenso
-					estadoActual = BUTTON_DOWN;
-				} else {
-					// Hay un cambio de estado!!!
-					estadoActual = BUTTON_UP;
-					buttonReleased();	// Acción de flanco descendente de señal (de 1 a 0).
-				}
-			}
-		break;
-
-		default:
-			Error_Handler();
-		break;
-	} // -------------------------- Fin del switch ----------------------------
-}
-
-/*******************************************************************************
-* @brief  Acción de flanco ascendente: cambia LED1.
-* @param  None
-* @retval None
-*/
-void buttonPressed() {
-	//BSP_LED_Toggle(LED1);
-	FlancoAscendente = true;	// Dejo registrado que hubo flanco ascendente en la señal (de 0 a 1)
-	PresionadoLargo = false;
-	delayRead(&retardoLargo);	// En realidad, no leo: lo hago comenzar a contar
-}
-
-/*******************************************************************************
-* @brief  Acción de flanco descendente: cambia LED3.
-* @param  None
-* @retval None
-*/
-void buttonReleased()  {
-	// BSP_LED_Toggle(LED3);
-	FlancoDescendente = true;	// Dejo registrado que hubo flanco descendente en la señal (de 1 a 0)
-	if (delayRead(&retardoLargo) == true) PresionadoLargo = true;
-	delayReset(&retardoLargo);
-}
-
-/***************************************************************END OF FILE****/
+/*******************************************************************************
+* @file    API_debounce.c
+* @author  Guillermo Caporaletti
+* @brief   Módulo anti-rebote de pulsadores por puerto GPIO completo.
+*          Muestrea el registro IDR desde la interrupción periódica (SysTick)
+*          y resuelve los 16 pines en paralelo con contadores verticales.
+*******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_debounce.h"
+#include "API_medicion.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define y const ----------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static debouncePuerto_t * puertos[DEBOUNCE_MAX_PUERTOS];	// Puertos registrados
+static volatile uint8_t cantidadPuertos = 0;
+static uint8_t divisorTick = 0;								// Cuenta ticks de SysTick
+#if defined(__arm__)
+static debouncePuerto_t pulsadorUsuario;					// Puerto del pulsador de usuario
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void recogerEventos(debouncePuerto_t * p);
+
+/* Functions -----------------------------------------------------------------*/
+
+/*******************************************************************************
+* @brief  Inicializa el antirrebote de un puerto y lo registra para que
+*         debounceTick() lo muestree.
+* @param  p: estructura del antirrebote
+* @param  puerto: puerto GPIO a muestrear (GPIOA, GPIOB, ...)
+* @param  mascara: pines a considerar (GPIO_PIN_x | GPIO_PIN_y ...)
+* @param  activosBajo: pines que se leen '0' cuando están presionados
+* @retval None
+*/
+void debouncePuerto_init(debouncePuerto_t * p, GPIO_TypeDef * puerto,
+		                 uint16_t mascara, uint16_t activosBajo) {
+	if (p == NULL || puerto == NULL) Error_Handler();
+	if (cantidadPuertos >= DEBOUNCE_MAX_PUERTOS) Error_Handler();
+
+	// Todo en reposo: contadores en 3 (ambos planos en 1)
+	p->puerto = puerto;
+	p->mascara = mascara;
+	p->activosBajo = activosBajo & mascara;
+	p->estable = 0;
+	p->cont0 = 0xFFFF;
+	p->cont1 = 0xFFFF;
+	for (uint8_t k=0; k<DEBOUNCE_BITS_LARGO; k++) p->largo[k] = 0;
+	ringInit(&p->eventos, p->memoriaEventos, DEBOUNCE_EVENTOS, sizeof(debounceEvento_t));
+	p->pendientes.presionados = 0;
+	p->pendientes.liberados = 0;
+	p->pendientes.largos = 0;
+	p->eventosPerdidos = 0;
+	p->ciclosUltimo = 0;
+	p->ciclosMaximo = 0;
+
+	// Registro al final, cuando la estructura ya está completa
+	puertos[cantidadPuertos] = p;
+	__DMB();
+	cantidadPuertos++;
+}
+
+/*******************************************************************************
+* @brief  Toma una muestra del puerto y actualiza los contadores verticales.
+*         El trabajo es el mismo para 1 o 16 pines: sólo operaciones de bits.
+* @param  p: estructura del antirrebote
+* @retval None
+*/
+void debouncePuerto_muestrear(debouncePuerto_t * p) {
+	uint32_t inicio = medicionCiclos();
+
+	// Muestra normalizada: 1 = presionado
+	uint16_t muestra = ((uint16_t) p->puerto->IDR ^ p->activosBajo) & p->mascara;
+
+	// Contador vertical de 2 bits: cuenta las muestras consecutivas
+	// distintas del estado estable, y vuelve a 3 si la muestra coincide.
+	uint16_t cambio = muestra ^ p->estable;
+	p->cont0 = ~(p->cont0 & cambio);
+	p->cont1 = p->cont0 ^ (p->cont1 & cambio);
+	cambio &= p->cont0 & p->cont1;		// Pines con 4 muestras distintas seguidas
+	p->estable ^= cambio;
+
+	uint16_t flancoPresion = cambio & p->estable;
+	uint16_t flancoLiberacion = cambio & ~p->estable;
+
+	// Presionado largo: se evalúa al liberar, como con el pulsador original
+	uint16_t lleno = 0xFFFF;
+	for (uint8_t k=0; k<DEBOUNCE_BITS_LARGO; k++) lleno &= p->largo[k];
+	uint16_t largosNuevos = flancoLiberacion & lleno;
+
+	// Contador vertical de tiempo presionado (satura y se borra al liberar)
+	uint16_t acarreo = p->estable & ~lleno;
+	for (uint8_t k=0; k<DEBOUNCE_BITS_LARGO; k++) {
+		uint16_t siguiente = p->largo[k] & acarreo;
+		p->largo[k] = (p->largo[k] ^ acarreo) & p->estable;
+		acarreo = siguiente;
+	}
+
+	// Encolo los eventos para el lazo principal
+	if (cambio != 0) {
+		debounceEvento_t evento = { flancoPresion, flancoLiberacion, largosNuevos };
+		if (ringPut(&p->eventos, &evento) != true) p->eventosPerdidos++;
+	}
+
+	p->ciclosUltimo = medicionCiclos() - inicio;
+	if (p->ciclosUltimo > p->ciclosMaximo) p->ciclosMaximo = p->ciclosUltimo;
+}
+
+/*******************************************************************************
+* @brief  Devuelve y borra los flancos de presión pendientes.
+* @param  p: estructura del antirrebote
+* @param  pines: pines a consultar
+* @retval Máscara con los pines que fueron presionados
+*/
+uint16_t debouncePuerto_leerPresionados(debouncePuerto_t * p, uint16_t pines) {
+	recogerEventos(p);
+	uint16_t salida = p->pendientes.presionados & pines;
+	p->pendientes.presionados &= ~pines;
+	return salida;
+}
+
+/*******************************************************************************
+* @brief  Devuelve y borra los flancos de liberación pendientes.
+* @param  p: estructura del antirrebote
+* @param  pines: pines a consultar
+* @retval Máscara con los pines que fueron liberados
+*/
+uint16_t debouncePuerto_leerLiberados(debouncePuerto_t * p, uint16_t pines) {
+	recogerEventos(p);
+	uint16_t salida = p->pendientes.liberados & pines;
+	p->pendientes.liberados &= ~pines;
+	return salida;
+}
+
+/*******************************************************************************
+* @brief  Devuelve y borra los presionados largos pendientes.
+* @param  p: estructura del antirrebote
+* @param  pines: pines a consultar
+* @retval Máscara con los pines liberados luego de un presionado largo
+*/
+uint16_t debouncePuerto_leerLargos(debouncePuerto_t * p, uint16_t pines) {
+	recogerEventos(p);
+	uint16_t salida = p->pendientes.largos & pines;
+	p->pendientes.largos &= ~pines;
+	return salida;
+}
+
+/*******************************************************************************
+* @brief  Estado antirrebote actual del puerto.
+* @param  p: estructura del antirrebote
+* @retval Máscara con los pines presionados
+*/
+uint16_t debouncePuerto_estado(debouncePuerto_t * p) {
+	return p->estable;
+}
+
+/*******************************************************************************
+* @brief  Base de tiempo del antirrebote. Se llama en cada tick de SysTick
+*         y muestrea todos los puertos registrados cada DEBOUNCE_PERIODO_MS.
+* @param  None
+* @retval None
+*/
+void debounceTick(void) {
+	divisorTick++;
+	if (divisorTick < DEBOUNCE_PERIODO_MS) return;
+	divisorTick = 0;
+
+	for (uint8_t i=0; i<cantidadPuertos; i++) debouncePuerto_muestrear(puertos[i]);
+}
+
+#if defined(__arm__)
+// El pulsador de usuario depende de la placa: no se compila en la PC
+/*******************************************************************************
+* @brief  Inicializa el pulsador de usuario y registra su puerto.
+* @param  None
+* @retval None
+*/
+void debounceFSM_init() {
+	// Initialize BSP PB for BUTTON_USER
+	BSP_PB_Init(BUTTON_USER, BUTTON_MODE_GPIO);
+	medicionInit();
+	debouncePuerto_init(&pulsadorUsuario, USER_BUTTON_GPIO_PORT, USER_BUTTON_PIN, 0);
+}
+
+/*******************************************************************************
+* @brief  Me devuelve si hubo flanco de liberación y se resetea.
+* @param  None
+* @retval None
+*/
+bool_t readKeyRelease() {
+	return debouncePuerto_leerLiberados(&pulsadorUsuario, USER_BUTTON_PIN) != 0;
+}
+
+/*******************************************************************************
+* @brief  Me devuelve si hubo flanco de presión y se resetea.
+* @param  None
+* @retval None
+*/
+bool_t readKeyPush() {
+	return debouncePuerto_leerPresionados(&pulsadorUsuario, USER_BUTTON_PIN) != 0;
+}
+
+/*******************************************************************************
+* @brief  Me devuelve si la última liberación fue de un presionado largo.
+* @param  None
+* @retval None
+*/
+bool_t readPresionadoLargo() {
+	return debouncePuerto_leerLargos(&pulsadorUsuario, USER_BUTTON_PIN) != 0;
+}
+#endif
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+* @brief  Saca del buffer los eventos que dejó la interrupción y los acumula
+*         en 'pendientes', que sólo usa el lazo principal.
+* @param  p: estructura del antirrebote
+* @retval None
+*/
+static void recogerEventos(debouncePuerto_t * p) {
+	debounceEvento_t evento;
+	while (ringGet(&p->eventos, &evento)) {
+		p->pendientes.presionados |= evento.presionados;
+		p->pendientes.liberados |= evento.liberados;
+		p->pendientes.largos |= evento.largos;
+	}
+}
+
+/***************************************************************END OF FILE****/
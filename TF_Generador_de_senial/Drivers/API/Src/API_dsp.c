@@ -0,0 +1,258 @@
+/*******************************************************************************
+  * @file		API_dsp.c
+  * @brief      Procesamiento en tiempo real: ADC1 -> filtro -> DAC2
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * El filtro se calcula en la interrupción del DMA del ADC (prioridad 1); el
+  * lazo principal sólo prepara coeficientes nuevos en el filtro que no está
+  * en uso y lo deja pedido. Los ciclos se miden con el contador DWT.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_dsp.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t entradaADC[2 * DSP_BLOQUE_MAXIMO];		// Lo que llena el DMA del ADC
+static uint16_t salidaDAC[2 * DSP_BLOQUE_MAXIMO];		// Lo que recorre el DMA del DAC
+static filtro_t filtros[2];
+static filtro_t * volatile activo = NULL;		// El que usa la interrupción
+static filtro_t * volatile pendiente = NULL;	// Coeficientes nuevos, para el próximo bloque
+static bool_t enMarcha = false;
+static uint32_t bloque = DSP_BLOQUE_DEFECTO;
+static uint32_t taps = 0, etapas = 0;			// De los últimos coeficientes aplicados
+static uint32_t costoTap = 0;					// Ciclos por coeficiente y por muestra (Q8)
+static volatile dspContadores_t contadores;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void procesarMitad(const uint16_t * mitad, uint32_t cantidad);
+static uint32_t medirFiltro(filtro_t * f);
+static uint32_t medirCostoTap(filtro_t * f);
+
+/*******************************************************************************
+  * @brief  Arranca el procesamiento con la frecuencia de muestras actual de
+  *         TIM2. El DAC y el ADC se arrancan con el timer detenido, así
+  *         empiezan con el mismo disparo. Informa con Dsp_Informar().
+  * @param  c: coeficientes
+  * @param  largo: muestras por bloque (DSP_BLOQUE_MINIMO..DSP_BLOQUE_MAXIMO)
+  * @retval false si no se puede (ya informado por UART)
+  */
+bool_t Dsp_Iniciar(const coefFiltro_t * c, uint32_t largo) {
+	if (enMarcha) Dsp_Parar();
+	if (FRECUENCIA_TIM2 / (Leer_Periodo_DAC_DMA() + 1) > ADC_FS_MAXIMA) {
+		uartSendLiteral("Frecuencia de muestras mayor que la del ADC (RATE >= 59).\n");
+		return false;
+	}
+	if (largo < DSP_BLOQUE_MINIMO || largo > DSP_BLOQUE_MAXIMO) {
+		uartSendLiteral("Bloque invalido.\n");
+		return false;
+	}
+	bloque = largo;
+
+	// Costo por coeficiente (con el filtro de repuesto) y del filtro pedido
+	costoTap = medirCostoTap(&filtros[1]);
+	if (Filtro_Preparar(&filtros[0], c) != true) {
+		uartSendLiteral("FIR invalido: la suma de |h| llega a 32.\n");
+		return false;
+	}
+	memset((void *) &contadores, 0, sizeof(contadores));
+	contadores.bloque.ciclos = medirFiltro(&filtros[0]);
+	Filtro_Preparar(&filtros[0], c);		// La medición dejó estado
+	taps = c->taps;
+	etapas = c->etapas;
+	activo = &filtros[0];
+	pendiente = NULL;
+
+	// Salida en el centro hasta el primer bloque filtrado
+	for (uint32_t i=0; i<2 * bloque; i++) salidaDAC[i] = FILTRO_CENTRO;
+	Detener_Disparo_DAC_DMA();
+	Fijar_Recarga_DAC_DMA(NULL);
+	Comenzar_DAC_DMA(salidaDAC, 2 * bloque);
+	Comenzar_Captura_ADC(DSP_ENTRADA, entradaADC, 2 * bloque, procesarMitad);
+	Reanudar_Disparo_DAC_DMA();
+	enMarcha = true;
+
+	Dsp_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Cambia los coeficientes sin detener el procesamiento: se preparan
+  *         en el filtro que la interrupción no usa y ésta lo toma al comenzar
+  *         el próximo bloque.
+  * @param  c: coeficientes
+  * @retval false si el FIR puede desbordar (se sigue con los anteriores)
+  */
+bool_t Dsp_Aplicar(const coefFiltro_t * c) {
+	if (!enMarcha) return false;
+	pendiente = NULL;				// La interrupción ya no cambia de filtro
+	filtro_t * libre = (activo == &filtros[0]) ? &filtros[1] : &filtros[0];
+	if (Filtro_Preparar(libre, c) != true) return false;
+	taps = c->taps;
+	etapas = c->etapas;
+	pendiente = libre;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene el ADC y el DAC e informa:
+  *         "FIN DSP bloques= sat= atrasos= desbordes="
+  * @param  None
+  * @retval None
+  */
+void Dsp_Parar(void) {
+	if (!enMarcha) return;
+	Parar_Captura_ADC();
+	Bloques_Parar();
+	enMarcha = false;
+	pendiente = NULL;
+
+	char informe[96];
+	char * fin = Num_AgregarTexto(informe, "FIN DSP bloques=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.bloques);
+	fin = Num_AgregarTexto(fin, " sat=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " atrasos=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.atrasos);
+	fin = Num_AgregarTexto(fin, " desbordes=");
+	fin = Num_AgregarDecimal(fin, Leer_Desbordes_ADC());
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si el procesamiento está en marcha
+  * @param  None
+  * @retval true si el ADC y el DAC están filtrando
+  */
+bool_t Dsp_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Muestras por bloque del procesamiento en curso (o el último)
+  * @param  None
+  * @retval Muestras por bloque
+  */
+uint32_t Dsp_Bloque(void) {
+	return bloque;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores del procesamiento en curso (o el último).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Dsp_Contadores(dspContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+	destino->desbordes = Leer_Desbordes_ADC();
+}
+
+/*******************************************************************************
+  * @brief  Informa latencia, costo y margen con la frecuencia actual:
+  *         "DSP=ON FS= BLOQUE= LATENCIA=<muestras> (<us> us) TAPS= BIQUADS=
+  *          CICLOS=<último bloque> MAX=<peor bloque> PRESUPUESTO= (por
+  *          muestra) CARGA=<%> TAPS_MAX= SAT= ATRASOS= DESBORDES="
+  *         TAPS_MAX estima cuántos coeficientes de FIR entrarían en el
+  *         presupuesto con el resto del filtro igual (puede superar
+  *         FILTRO_MAX_TAPS, que es el límite de memoria).
+  * @param  None
+  * @retval None
+  */
+void Dsp_Informar(void) {
+	char informe[192];
+	dspContadores_t c;
+
+	if (!enMarcha) {
+		uartSendLiteral("DSP=OFF\n");
+		return;
+	}
+	Dsp_Contadores(&c);
+	uint32_t periodo = Leer_Periodo_DAC_DMA() + 1;
+	uint32_t latencia = 2 * bloque + 1;
+	uint32_t disponible = Leer_Ciclos_Muestra_DAC_DMA() * bloque;
+
+	// Coeficientes que entran en lo que queda (o que sobran)
+	int64_t margen = ((int64_t) disponible - c.bloque.ciclos) << 8;
+	int64_t tapsMaximo = (int64_t) taps + ((costoTap > 0) ? margen / ((int64_t) costoTap * bloque) : 0);
+
+	char * fin = Num_AgregarTexto(informe, "DSP=ON FS=");
+	fin = Num_AgregarDecimal(fin, FRECUENCIA_TIM2 / periodo);
+	fin = Num_AgregarTexto(fin, " BLOQUE=");
+	fin = Num_AgregarDecimal(fin, bloque);
+	fin = Num_AgregarTexto(fin, " LATENCIA=");
+	fin = Num_AgregarDecimal(fin, latencia);
+	fin = Num_AgregarTexto(fin, " (");
+	fin = Num_AgregarDecimal(fin, (uint32_t) ((uint64_t) latencia * periodo / (FRECUENCIA_TIM2 / 1000000)));
+	fin = Num_AgregarTexto(fin, " us) TAPS=");
+	fin = Num_AgregarDecimal(fin, taps);
+	fin = Num_AgregarTexto(fin, " BIQUADS=");
+	fin = Num_AgregarDecimal(fin, etapas);
+	fin = Bloques_AgregarCosto(fin, &c.bloque, bloque);
+	fin = Num_AgregarTexto(fin, " TAPS_MAX=");
+	fin = Num_AgregarDecimal(fin, (tapsMaximo < 0) ? 0 : (uint32_t) tapsMaximo);
+	fin = Num_AgregarTexto(fin, " SAT=");
+	fin = Num_AgregarDecimal(fin, c.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " ATRASOS=");
+	fin = Num_AgregarDecimal(fin, c.bloque.atrasos);
+	fin = Num_AgregarTexto(fin, " DESBORDES=");
+	fin = Num_AgregarDecimal(fin, c.desbordes);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Filtra la mitad que completó el ADC hacia la misma mitad del
+  *         buffer del DAC. Contexto de interrupción.
+  * @param  mitad: muestras del ADC
+  * @param  cantidad: muestras de esa mitad (un bloque)
+  * @retval None
+  */
+static void procesarMitad(const uint16_t * mitad, uint32_t cantidad) {
+	filtro_t * nuevo = pendiente;
+	if (nuevo != NULL) {
+		activo = nuevo;
+		pendiente = NULL;
+	}
+
+	uint32_t inicio = medicionCiclos();
+	contadores.bloque.saturadas += Filtro_Procesar(activo, mitad, &salidaDAC[mitad - entradaADC], cantidad);
+	Bloques_Registrar(&contadores.bloque, inicio, cantidad);
+}
+
+/*******************************************************************************
+  * @brief  Ciclos que tarda el filtro en un bloque (de entradas en cero).
+  * @param  f: filtro preparado (queda con estado)
+  * @retval Ciclos de CPU
+  */
+static uint32_t medirFiltro(filtro_t * f) {
+	uint32_t inicio = medicionCiclos();
+	Filtro_Procesar(f, entradaADC, salidaDAC, bloque);
+	return medicionCiclos() - inicio;
+}
+
+/*******************************************************************************
+  * @brief  Costo de cada coeficiente del FIR: diferencia entre un FIR de
+  *         FILTRO_MAX_TAPS y uno de 2, en el bloque actual.
+  * @param  f: filtro de repuesto (se pisa)
+  * @retval Ciclos por coeficiente y por muestra, en Q8
+  */
+static uint32_t medirCostoTap(filtro_t * f) {
+	static coefFiltro_t prueba;
+	Filtro_Defecto(&prueba);
+
+	prueba.taps = 2;
+	Filtro_Preparar(f, &prueba);
+	uint32_t corto = medirFiltro(f);
+	prueba.taps = FILTRO_MAX_TAPS;
+	Filtro_Preparar(f, &prueba);
+	uint32_t largo = medirFiltro(f);
+
+	if (largo <= corto) return 0;
+	return ((largo - corto) << 8) / ((FILTRO_MAX_TAPS - 2) * bloque);
+}
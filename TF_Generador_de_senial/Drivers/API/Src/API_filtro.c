@@ -0,0 +1,268 @@
+/*******************************************************************************
+  * @file		API_filtro.c
+  * @brief      Filtros en punto fijo: FIR en Q15 y cascada de biquads en Q14,
+  *             procesados por bloques
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_filtro.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define REDONDEO_FIR		(1L << (FILTRO_BITS_FIR - 1))
+#define REDONDEO_BIQUAD		(1LL << (FILTRO_BITS_BIQUAD - 1))
+#define MAX_COEFICIENTE		32767		// También -a: -(-32768) no entra en 16 bits
+
+/* Prototipos privados -------------------------------------------------------*/
+static void procesarFir(filtro_t * f, uint32_t largo);
+static uint32_t procesarBiquads(filtro_t * f, uint32_t largo);
+static bool_t leerCoeficientes(const char * texto, int16_t * valores, uint32_t maximo,
+		                       uint32_t * cantidad);
+
+/*******************************************************************************
+  * @brief  Coeficientes por defecto: sin FIR ni biquads.
+  * @param  c: coeficientes
+  * @retval None
+  */
+void Filtro_Defecto(coefFiltro_t * c) {
+	memset(c, 0, sizeof(*c));
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "<taps>": nuevo FIR con todos los coeficientes en cero.
+  * @param  texto: argumentos del comando FIR
+  * @param  c: coeficientes
+  * @retval true si la cantidad es válida (0 quita el FIR)
+  */
+bool_t Filtro_Interpretar_Fir(const char * texto, coefFiltro_t * c) {
+	int32_t taps;
+	if (Num_Leer(texto, 0, FILTRO_MAX_TAPS, &taps, NULL) != true) return false;
+	c->taps = (uint32_t) taps;
+	memset(c->fir, 0, sizeof(c->fir));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "<k> <h> [<h> ...]": coeficientes desde h[k], en Q15.
+  *         Si alguno es inválido no se modifica ninguno.
+  * @param  texto: argumentos del comando TAP
+  * @param  c: coeficientes (ya con la cantidad fijada por FIR)
+  * @retval true si todos entran en el FIR
+  */
+bool_t Filtro_Interpretar_Taps(const char * texto, coefFiltro_t * c) {
+	int16_t valores[FILTRO_MAX_TAPS];
+	uint32_t cantidad;
+	int32_t indice;
+	const char * fin;
+
+	if (c->taps == 0) return false;
+	if (Num_Leer(texto, 0, (int32_t) c->taps - 1, &indice, &fin) != true || *fin != ' ') return false;
+	if (leerCoeficientes(fin, valores, c->taps - (uint32_t) indice, &cantidad) != true) return false;
+	if (cantidad == 0) return false;
+	memcpy(&c->fir[indice], valores, cantidad * sizeof(int16_t));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "<e> <b0> <b1> <b2> <a1> <a2>" (Q14) o "CLR".
+  *         Las etapas se cargan en orden: <e> puede ser una existente o la
+  *         siguiente.
+  * @param  texto: argumentos del comando BQ
+  * @param  c: coeficientes
+  * @retval true si la etapa es válida
+  */
+bool_t Filtro_Interpretar_Biquad(const char * texto, coefFiltro_t * c) {
+	int16_t valores[5];
+	uint32_t cantidad;
+	int32_t etapa;
+	const char * fin;
+
+	if (strcmp(texto, "CLR") == 0) {
+		c->etapas = 0;
+		return true;
+	}
+	int32_t maximo = (c->etapas < FILTRO_MAX_ETAPAS) ? (int32_t) c->etapas : FILTRO_MAX_ETAPAS - 1;
+	if (Num_Leer(texto, 0, maximo, &etapa, &fin) != true || *fin != ' ') return false;
+	if (leerCoeficientes(fin, valores, 5, &cantidad) != true || cantidad != 5) return false;
+	memcpy(c->biquad[etapa], valores, sizeof(valores));
+	if ((uint32_t) etapa == c->etapas) c->etapas++;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Norma 1 del FIR: acota la salida para cualquier entrada.
+  * @param  c: coeficientes
+  * @retval sum |h[k]| en Q15 (sin FIR: 0)
+  */
+uint32_t Filtro_Norma(const coefFiltro_t * c) {
+	uint32_t norma = 0;
+	for (uint32_t k=0; k<c->taps; k++) norma += (uint32_t) ((c->fir[k] < 0) ? -c->fir[k] : c->fir[k]);
+	return norma;
+}
+
+/*******************************************************************************
+  * @brief  Empaqueta los coeficientes y pone el estado en cero.
+  *         El FIR se completa a una cantidad par de coeficientes con un cero
+  *         al final y se guarda invertido: el coeficiente de la muestra más
+  *         vieja primero, así la historia se recorre hacia adelante.
+  * @param  f: filtro
+  * @param  c: coeficientes
+  * @retval false si sum |h| >= FILTRO_NORMA_MAXIMA (el acumulador desbordaría)
+  */
+bool_t Filtro_Preparar(filtro_t * f, const coefFiltro_t * c) {
+	if (c->taps > FILTRO_MAX_TAPS || c->etapas > FILTRO_MAX_ETAPAS) return false;
+	if (Filtro_Norma(c) >= FILTRO_NORMA_MAXIMA) return false;
+	memset(f, 0, sizeof(*f));
+
+	f->pares = (c->taps + 1) / 2;
+	uint32_t total = 2 * f->pares;
+	for (uint32_t j=0; j<f->pares; j++) {
+		uint32_t viejo = total - 1 - 2 * j;		// h[total-1] es el cero de relleno si taps es impar
+		int16_t bajo = (viejo < c->taps) ? c->fir[viejo] : 0;
+		f->fir[j] = __PKHBT(bajo, c->fir[viejo - 1], 16);
+	}
+
+	f->etapas = c->etapas;
+	for (uint32_t e=0; e<c->etapas; e++) {
+		const int16_t * b = c->biquad[e];
+		f->biquad[e][0] = __PKHBT(b[0], b[1], 16);
+		f->biquad[e][1] = __PKHBT(b[2], -b[3], 16);
+		f->menosA2[e] = (int16_t) -b[4];
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Filtra un bloque. El estado sigue de un bloque al siguiente.
+  * @param  f: filtro preparado
+  * @param  entrada: muestras de 12 bits (se ignoran los bits de arriba)
+  * @param  salida: muestras de 12 bits (puede ser la misma entrada)
+  * @param  largo: 1..FILTRO_MAX_BLOQUE
+  * @retval Muestras saturadas (en un biquad o en la salida)
+  */
+uint32_t Filtro_Procesar(filtro_t * f, const uint16_t * entrada, uint16_t * salida, uint32_t largo) {
+	uint32_t previas = (f->pares > 0) ? 2 * f->pares - 1 : 0;
+	int16_t * x = &f->historia[previas];
+	uint32_t saturadas = 0;
+
+	for (uint32_t i=0; i<largo; i++) x[i] = (int16_t) ((entrada[i] & FILTRO_MAX_DAC) - FILTRO_CENTRO);
+
+	// Los resultados quedan en historia[0..largo-1]
+	if (f->pares > 0) procesarFir(f, largo);
+	if (f->etapas > 0) saturadas += procesarBiquads(f, largo);
+
+	for (uint32_t i=0; i<largo; i++) {
+		int32_t y = f->historia[i] + FILTRO_CENTRO;
+		uint32_t z = __USAT(y, 12);
+		saturadas += ((int32_t) z != y);
+		salida[i] = (uint16_t) z;
+	}
+
+	// Las últimas entradas son la historia del próximo bloque
+	memmove(f->historia, &f->historia[largo], previas * sizeof(int16_t));
+	return saturadas;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  FIR sobre la historia, en el lugar: la salida n se escribe en la
+  *         posición n, que ninguna salida posterior vuelve a leer.
+  *         Dos salidas por vuelta comparten cada coeficiente: la palabra de
+  *         la segunda se arma con las mitades de dos lecturas (PKHBT).
+  * @param  f: filtro con pares > 0
+  * @param  largo: muestras del bloque
+  * @retval None
+  */
+static void procesarFir(filtro_t * f, uint32_t largo) {
+	int16_t * h = f->historia;
+	uint32_t n = 0;
+	uint32_t a, b;
+
+	// memcpy: el Cortex-M4 lee palabras no alineadas con LDR
+	for (; n + 1 < largo; n += 2) {
+		int32_t acumulado0 = REDONDEO_FIR, acumulado1 = REDONDEO_FIR;
+		memcpy(&a, &h[n], sizeof(a));
+		for (uint32_t j=0; j<f->pares; j++) {
+			uint32_t c = f->fir[j];
+			memcpy(&b, &h[n + 2 * j + 2], sizeof(b));
+			acumulado0 = (int32_t) __SMLAD(a, c, (uint32_t) acumulado0);
+			acumulado1 = (int32_t) __SMLAD(__PKHBT(a >> 16, b, 16), c, (uint32_t) acumulado1);
+			a = b;
+		}
+		h[n] = (int16_t) __SSAT(acumulado0 >> FILTRO_BITS_FIR, 16);
+		h[n + 1] = (int16_t) __SSAT(acumulado1 >> FILTRO_BITS_FIR, 16);
+	}
+	if (n < largo) {
+		int32_t acumulado = REDONDEO_FIR;
+		for (uint32_t j=0; j<f->pares; j++) {
+			memcpy(&a, &h[n + 2 * j], sizeof(a));
+			acumulado = (int32_t) __SMLAD(a, f->fir[j], (uint32_t) acumulado);
+		}
+		h[n] = (int16_t) __SSAT(acumulado >> FILTRO_BITS_FIR, 16);
+	}
+}
+
+/*******************************************************************************
+  * @brief  Cascada de biquads (forma directa I) sobre historia[0..largo-1].
+  * @param  f: filtro con etapas > 0
+  * @param  largo: muestras del bloque
+  * @retval Muestras saturadas a 16 bits
+  */
+static uint32_t procesarBiquads(filtro_t * f, uint32_t largo) {
+	int16_t * h = f->historia;
+	uint32_t saturadas = 0;
+
+	for (uint32_t e=0; e<f->etapas; e++) {
+		uint32_t c0 = f->biquad[e][0], c1 = f->biquad[e][1];
+		int32_t menosA2 = f->menosA2[e];
+		int16_t * s = f->estado[e];
+		int16_t x1 = s[0], x2 = s[1], y1 = s[2], y2 = s[3];
+
+		for (uint32_t n=0; n<largo; n++) {
+			int16_t x = h[n];
+			int64_t acumulado = (int64_t) __SMLALD(__PKHBT(x, x1, 16), c0, (uint64_t) REDONDEO_BIQUAD);
+			acumulado = (int64_t) __SMLALD(__PKHBT(x2, y1, 16), c1, (uint64_t) acumulado);
+			acumulado += (int64_t) menosA2 * y2;
+			int32_t y = (int32_t) (acumulado >> FILTRO_BITS_BIQUAD);
+			int16_t saturado = (int16_t) __SSAT(y, 16);
+			saturadas += (saturado != y);
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = saturado;
+			h[n] = saturado;
+		}
+		s[0] = x1;
+		s[1] = x2;
+		s[2] = y1;
+		s[3] = y2;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Lee enteros de 16 bits separados por espacios.
+  * @param  texto: números (puede empezar con espacios)
+  * @param  valores: destino
+  * @param  maximo: lugar en 'valores'
+  * @param  cantidad: números leídos
+  * @retval false si hay un número inválido o sobran números
+  */
+static bool_t leerCoeficientes(const char * texto, int16_t * valores, uint32_t maximo,
+		                       uint32_t * cantidad) {
+	int32_t valor;
+	*cantidad = 0;
+	while (*texto != '\0') {
+		if (*texto == ' ') {
+			texto++;
+			continue;
+		}
+		if (*cantidad >= maximo) return false;
+		if (Num_Leer(texto, -MAX_COEFICIENTE, MAX_COEFICIENTE, &valor, &texto) != true) return false;
+		if (*texto != ' ' && *texto != '\0') return false;
+		valores[(*cantidad)++] = (int16_t) valor;
+	}
+	return true;
+}
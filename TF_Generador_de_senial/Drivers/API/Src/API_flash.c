@@ -0,0 +1,57 @@
+/*******************************************************************************
+  * @file		API_flash.c
+  * @brief      Datos persistentes en el último sector de la flash
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  * @detail		Borrar el sector tarda 1 a 2 s y la CPU queda detenida si
+  *             ejecuta desde el mismo banco; el sector 23 está en el banco 2
+  *             y el programa en el 1, pero igual sólo se escribe a pedido.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "API_flash.h"
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/**
+  * @brief Devuelve los datos guardados (se leen directamente de la flash).
+  * @param None
+  * @retval Puntero al comienzo del sector: quien lo usa verifica su validez
+  */
+const void * Flash_Leer(void) {
+	return (const void *) FLASH_DATOS_DIRECCION;
+}
+
+/**
+  * @brief Borra el sector y escribe los datos, de a palabras.
+  * @param datos: lo que se guarda
+  * @param largo: bytes (se completa la última palabra)
+  * @retval false si falló el borrado, la escritura o la verificación
+  */
+bool_t Flash_Guardar(const void * datos, uint32_t largo) {
+	FLASH_EraseInitTypeDef borrado = {0};
+	uint32_t sectorConError;
+	const uint8_t * bytes = (const uint8_t *) datos;
+	bool_t correcto = true;
+
+	if (largo > FLASH_DATOS_LARGO) return false;
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+			               FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+	borrado.TypeErase = FLASH_TYPEERASE_SECTORS;
+	borrado.Sector = FLASH_DATOS_SECTOR;
+	borrado.NbSectors = 1;
+	borrado.VoltageRange = FLASH_VOLTAGE_RANGE_3;		// 2,7 a 3,6 V: palabras de 32 bits
+	if (HAL_FLASHEx_Erase(&borrado, &sectorConError) != HAL_OK) correcto = false;
+
+	for (uint32_t i=0; correcto && i<largo; i+=4) {
+		uint32_t palabra = 0xFFFFFFFFUL;
+		memcpy(&palabra, &bytes[i], (largo - i < 4) ? largo - i : 4);
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FLASH_DATOS_DIRECCION + i, palabra) != HAL_OK) correcto = false;
+	}
+	HAL_FLASH_Lock();
+
+	return correcto && memcmp(Flash_Leer(), datos, largo) == 0;
+}
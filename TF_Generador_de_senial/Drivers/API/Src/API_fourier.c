@@ -0,0 +1,334 @@
+/*******************************************************************************
+  * @file		API_fourier.c
+  * @brief      Síntesis de una señal periódica a partir de sus armónicos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_fourier.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define BITS_FRACCION		12		// Punto fijo de la FFT: cuentas del DAC en Q12
+#define CUARTO_DE_VUELTA	0x40000000UL
+
+// El buffer de trabajo sólo lo usa la CPU: va a la CCM RAM (64 KB, sin acceso
+// del DMA) para no ocupar la RAM principal. Se borra antes de cada uso, así
+// que va en la sección NOLOAD: sin valores iniciales, no ocupa lugar en la
+// imagen de la flash (en .ccmram sumaba 32 KB de ceros).
+#if defined(__arm__)
+#define EN_CCMRAM			__attribute__((section(".ccm_sin_carga")))
+#else
+#define EN_CCMRAM
+#endif
+
+/* Typedef privados ----------------------------------------------------------*/
+typedef struct {
+	int32_t re;
+	int32_t im;
+} complejo_t;
+
+/* Variables privadas --------------------------------------------------------*/
+// N/2 puntos complejos: la señal real de N muestras se obtiene con una FFT
+// compleja de la mitad de largo (muestras pares en re, impares en im).
+static complejo_t trabajo[FOURIER_MAX_LARGO / 2] EN_CCMRAM;
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t sintetizarDirecto(const fourier_t * f, uint16_t * destino);
+static uint32_t sintetizarFFT(const fourier_t * f, uint16_t * destino);
+static void ifftRadix2(complejo_t * x, uint32_t largo, uint8_t bits);
+static complejo_t giro(uint32_t fase);
+static complejo_t producto(complejo_t a, complejo_t w);
+static uint32_t invertirBits(uint32_t valor, uint8_t bits);
+static uint8_t log2Exacto(uint32_t valor);
+
+/*******************************************************************************
+  * @brief  Vacía la lista de armónicos y carga valores por defecto.
+  * @param  f: síntesis de Fourier
+  * @retval None
+  */
+void Fourier_Iniciar(fourier_t * f) {
+	f->largo = 1024;
+	f->offset = 2048;
+	f->metodo = FOURIER_AUTOMATICO;
+	f->cantidad = 0;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[N=..] [OFF=..] [MODE=AUTO|DFT|FFT]".
+  * @param  texto: argumentos del comando FOURIER (se modifica)
+  * @param  f: síntesis de Fourier
+  * @retval true si el texto es válido
+  */
+bool_t Fourier_Interpretar(char * texto, fourier_t * f) {
+	char * token = strtok(texto, " ");
+
+	while (token != NULL) {
+		char * igual = strchr(token, '=');
+		if (igual == NULL) return false;
+		*igual = '\0';
+		char * valor = igual + 1;
+		int32_t numero;
+
+		if (strcmp(token, "N") == 0) {
+			if (Num_Leer(valor, 2, FOURIER_MAX_LARGO, &numero, NULL) != true) return false;
+			f->largo = (uint32_t) numero;
+		} else if (strcmp(token, "OFF") == 0) {
+			if (Num_Leer(valor, 0, SINT_MAX_DAC, &numero, NULL) != true) return false;
+			f->offset = numero;
+		} else if (strcmp(token, "MODE") == 0) {
+			if      (strcmp(valor, "AUTO") == 0) f->metodo = FOURIER_AUTOMATICO;
+			else if (strcmp(valor, "DFT") == 0)  f->metodo = FOURIER_DIRECTO;
+			else if (strcmp(valor, "FFT") == 0)  f->metodo = FOURIER_FFT;
+			else return false;
+		}
+		else return false;
+
+		token = strtok(NULL, " ");
+	}
+	return (f->largo >= 2 && f->largo <= FOURIER_MAX_LARGO);
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "<k> <amplitud> [fase]" y agrega el armónico.
+  *         La fase va en grados, con signo (-90 es 270).
+  * @param  texto: argumentos del comando H
+  * @param  f: síntesis de Fourier
+  * @retval true si el armónico es válido y había lugar
+  */
+bool_t Fourier_Interpretar_Armonico(char * texto, fourier_t * f) {
+	const char * fin;
+	int32_t indice, amplitud, fase = 0;		// Fase opcional: 0 si no está
+
+	if (Num_Leer(texto, 1, UINT16_MAX, &indice, &fin) != true || *fin != ' ') return false;
+	if (Num_Leer(fin, 0, FOURIER_MAX_AMPLITUD, &amplitud, &fin) != true) return false;
+	if (*fin != '\0' && Num_Leer(fin, -INT32_MAX, INT32_MAX, &fase, NULL) != true) return false;
+
+	fase %= 360;
+	if (fase < 0) fase += 360;
+	return Fourier_Agregar(f, (uint16_t) indice, (uint16_t) amplitud, (uint16_t) fase);
+}
+
+/*******************************************************************************
+  * @brief  Agrega un armónico a la lista.
+  * @param  f: síntesis de Fourier
+  * @param  indice: múltiplo de la fundamental
+  * @param  amplitud: amplitud pico (hasta FOURIER_MAX_AMPLITUD)
+  * @param  fase: grados
+  * @retval true si había lugar
+  */
+bool_t Fourier_Agregar(fourier_t * f, uint16_t indice, uint16_t amplitud, uint16_t fase) {
+	if (f->cantidad >= FOURIER_MAX_ARMONICOS) return false;
+	if (indice == 0 || amplitud > FOURIER_MAX_AMPLITUD || fase >= 360) return false;
+	f->armonicos[f->cantidad].indice = indice;
+	f->armonicos[f->cantidad].amplitud = amplitud;
+	f->armonicos[f->cantidad].fase = fase;
+	f->cantidad++;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Verifica que los armónicos entren en N (k < N/2) y que el
+  *         método pedido sea posible.
+  * @param  f: síntesis de Fourier
+  * @retval true si se puede sintetizar
+  */
+bool_t Fourier_Valido(const fourier_t * f) {
+	if (f->largo < 2 || f->largo > FOURIER_MAX_LARGO) return false;
+	if (f->metodo == FOURIER_FFT && (f->largo < 4 || log2Exacto(f->largo) == 0)) return false;
+	for (uint8_t h=0; h<f->cantidad; h++) {
+		if (2 * (uint32_t) f->armonicos[h].indice >= f->largo) return false;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Método que usará Fourier_Sintetizar(). En automático elige la FFT
+  *         cuando N es potencia de 2 y hay más de log2(N)/2 armónicos.
+  *         Estimación: el directo cuesta unos 10 ciclos por armónico y por
+  *         muestra, la FFT unos 5 * log2(N) ciclos por muestra.
+  * @param  f: síntesis de Fourier
+  * @retval FOURIER_DIRECTO o FOURIER_FFT
+  */
+metodoFourier_t Fourier_Metodo(const fourier_t * f) {
+	if (f->metodo != FOURIER_AUTOMATICO) return f->metodo;
+	uint8_t bits = log2Exacto(f->largo);
+	if (f->largo >= 4 && bits != 0 && 2 * (uint32_t) f->cantidad > bits) return FOURIER_FFT;
+	return FOURIER_DIRECTO;
+}
+
+/*******************************************************************************
+  * @brief  Genera un período de la señal. Los valores fuera de 0..4095 se
+  *         saturan. Requiere Fourier_Valido().
+  * @param  f: síntesis de Fourier
+  * @param  destino: f->largo muestras
+  * @retval Cantidad de muestras saturadas
+  */
+uint32_t Fourier_Sintetizar(const fourier_t * f, uint16_t * destino) {
+	if (Fourier_Metodo(f) == FOURIER_FFT) return sintetizarFFT(f, destino);
+	return sintetizarDirecto(f, destino);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Suma directa con la tabla de seno: un acumulador de fase por
+  *         armónico, con el mismo avance exacto que en API_sintesis.
+  */
+static uint32_t sintetizarDirecto(const fourier_t * f, uint16_t * destino) {
+	uint32_t fase[FOURIER_MAX_ARMONICOS];
+	uint32_t paso[FOURIER_MAX_ARMONICOS];
+	uint32_t resto[FOURIER_MAX_ARMONICOS];
+	uint32_t error[FOURIER_MAX_ARMONICOS];
+	int32_t amplitud[FOURIER_MAX_ARMONICOS];
+	uint32_t saturadas = 0;
+
+	for (uint8_t h=0; h<f->cantidad; h++) {
+		uint64_t avance = (uint64_t) f->armonicos[h].indice << 32;
+		paso[h] = (uint32_t) (avance / f->largo);
+		resto[h] = (uint32_t) (avance % f->largo);
+		error[h] = 0;
+		fase[h] = Sint_Grados(f->armonicos[h].fase);
+		amplitud[h] = f->armonicos[h].amplitud;
+	}
+
+	for (uint32_t n=0; n<f->largo; n++) {
+		// Suma en Q12 (amplitud * seno Q15 >> 3) para no desbordar con 32 armónicos
+		int32_t suma = 0;
+		for (uint8_t h=0; h<f->cantidad; h++) {
+			suma += (amplitud[h] * Sint_Seno(fase[h])) >> (15 - BITS_FRACCION);
+			fase[h] += paso[h];
+			error[h] += resto[h];
+			if (error[h] >= f->largo) {
+				error[h] -= f->largo;
+				fase[h]++;
+			}
+		}
+		int32_t v = f->offset + ((suma + (1 << (BITS_FRACCION - 1))) >> BITS_FRACCION);
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[n] = (uint16_t) s;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  FFT inversa de una señal real de N muestras con una FFT compleja
+  *         de M = N/2 puntos. El espectro X[k] (hermítico) se arma directamente
+  *         en orden de bits invertidos:
+  *           Z[k] = X[k] + conj(X[M-k]) + j (X[k] - conj(X[M-k])) e^(j2pi k/N)
+  *         y la salida z[m] = x[2m] + j x[2m+1].
+  *         A*sin(2pi k n/N + fi) aporta X[k] = A/2 (sin(fi) - j cos(fi)).
+  */
+static uint32_t sintetizarFFT(const fourier_t * f, uint16_t * destino) {
+	uint32_t mitad = f->largo / 2;
+	uint8_t bits = log2Exacto(mitad);
+	uint8_t bitsN = bits + 1;
+	uint32_t saturadas = 0;
+
+	memset(trabajo, 0, mitad * sizeof(complejo_t));
+
+	for (uint8_t h=0; h<f->cantidad; h++) {
+		uint32_t k = f->armonicos[h].indice;
+		int32_t amplitud = f->armonicos[h].amplitud;
+		uint32_t fase = Sint_Grados(f->armonicos[h].fase);
+
+		// X[k] en Q12: (A/2) * seno Q15 -> >> (15 + 1 - 12)
+		complejo_t X;
+		X.re =  (amplitud * Sint_Seno(fase)) >> (16 - BITS_FRACCION);
+		X.im = -((amplitud * Sint_Seno(fase + CUARTO_DE_VUELTA)) >> (16 - BITS_FRACCION));
+
+		// Aporte a Z[k]: X + j X w_k
+		complejo_t t = producto(X, giro(k << (32 - bitsN)));
+		complejo_t * z = &trabajo[invertirBits(k, bits)];
+		z->re += X.re - t.im;
+		z->im += X.im + t.re;
+
+		// Aporte a Z[M-k]: conj(X) - j conj(X) w_(M-k)
+		complejo_t Xc = { X.re, -X.im };
+		t = producto(Xc, giro((mitad - k) << (32 - bitsN)));
+		z = &trabajo[invertirBits(mitad - k, bits)];
+		z->re += Xc.re + t.im;
+		z->im += Xc.im - t.re;
+	}
+
+	ifftRadix2(trabajo, mitad, bits);
+
+	for (uint32_t m=0; m<mitad; m++) {
+		int32_t par = f->offset + ((trabajo[m].re + (1 << (BITS_FRACCION - 1))) >> BITS_FRACCION);
+		int32_t impar = f->offset + ((trabajo[m].im + (1 << (BITS_FRACCION - 1))) >> BITS_FRACCION);
+		int32_t s = (int32_t) __USAT(par, 12);
+		saturadas += (s != par);
+		destino[2 * m] = (uint16_t) s;
+		s = (int32_t) __USAT(impar, 12);
+		saturadas += (s != impar);
+		destino[2 * m + 1] = (uint16_t) s;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  FFT inversa radix-2 por decimación en el tiempo, en el lugar, sin
+  *         normalizar. La entrada ya está en orden de bits invertidos.
+  *         No escala por etapa: cada salida es una suma parcial de la entrada,
+  *         acotada por la suma de amplitudes (a lo sumo 32 * 4095 en Q12).
+  */
+static void ifftRadix2(complejo_t * x, uint32_t largo, uint8_t bits) {
+	for (uint8_t etapa=1; etapa<=bits; etapa++) {
+		uint32_t tramo = 1UL << etapa;
+		uint32_t medio = tramo >> 1;
+
+		for (uint32_t j=0; j<medio; j++) {
+			// Un giro por posición dentro del tramo: N-1 giros en total
+			complejo_t w = giro(j << (32 - etapa));
+			for (uint32_t i=j; i<largo; i+=tramo) {
+				complejo_t a = x[i];
+				complejo_t t = (j == 0) ? x[i + medio] : producto(x[i + medio], w);
+				x[i].re = a.re + t.re;
+				x[i].im = a.im + t.im;
+				x[i + medio].re = a.re - t.re;
+				x[i + medio].im = a.im - t.im;
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+  * @brief  e^(j fase) en Q15.
+  */
+static complejo_t giro(uint32_t fase) {
+	complejo_t w = { Sint_Seno(fase + CUARTO_DE_VUELTA), Sint_Seno(fase) };
+	return w;
+}
+
+/*******************************************************************************
+  * @brief  a * w, con w en Q15 (multiplicaciones 32x32->64, SMULL en el M4).
+  */
+static complejo_t producto(complejo_t a, complejo_t w) {
+	complejo_t r;
+	r.re = (int32_t) (((int64_t) a.re * w.re - (int64_t) a.im * w.im) >> 15);
+	r.im = (int32_t) (((int64_t) a.re * w.im + (int64_t) a.im * w.re) >> 15);
+	return r;
+}
+
+static uint32_t invertirBits(uint32_t valor, uint8_t bits) {
+	uint32_t r = 0;
+	for (uint8_t b=0; b<bits; b++) {
+		r = (r << 1) | (valor & 1);
+		valor >>= 1;
+	}
+	return r;
+}
+
+/*******************************************************************************
+  * @brief  log2 de una potencia de 2; 0 si no lo es (o si es 1).
+  */
+static uint8_t log2Exacto(uint32_t valor) {
+	if (valor < 2 || (valor & (valor - 1)) != 0) return 0;
+	uint8_t bits = 0;
+	while (valor > 1) {
+		valor >>= 1;
+		bits++;
+	}
+	return bits;
+}
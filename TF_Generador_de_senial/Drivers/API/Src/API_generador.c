@@ -1,175 +1,1120 @@
-/*******************************************************************************
-  * @file		API_generador.c
-  * @brief      Maneja acciones de los estados del
-  *             Generador de señales con entrada por UART
-  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
-  ******************************************************************************
-  */
-
-/* Includes ------------------------------------------------------------------*/
-#include "API_generador.h"
-
-/* Defines privados ----------------------------------------------------------*/
-#define TIEMPO_ENCENDIDO_1	100		// <-- tiempos para parpadeo de leds
-#define TIEMPO_ENCENDIDO_2	500
-#define TIEMPO_PARPADEO_ESPERA		1000
-#define TIEMPO_PARPADEO_CARGADO		750
-#define TIEMPO_PARPADEO_ENCENDIDO	75
-
-/* Private typedef -----------------------------------------------------------*/
-
-// Cada generador tiene estado y senial almacenada
-typedef struct {
-	estadosMEF estado;
-	bool encendido;			// Este bool es redundante
-	bool cargado;			// Este bool es redundante
-	uint32_t senial[N_MUESTRAS];
-} generador_t;
-
-/* Variables privadas USUARIO -------------------------------------------------*/
-generador_t GeneradorDAC2;		// Estructura del generador
-delay_t parpadeoLedAzul;		// Parpadeo en estados Cargado, Generando y Pausa
-delay_t parpadeoLedVerde;		// Parpadeo en estados Espera y Recibiendo
-
-/* Private function prototypes -----------------------------------------------*/
-
-/*******************************************************************************
-  * @brief  Inicializa Generador
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Init(void) {
-	GeneradorDAC2.cargado = false;
-	GeneradorDAC2.encendido = false;
-	GeneradorDAC2.estado = Espera;
-	BSP_LED_Init(LED_BLUE);			// Indicador en estados Cargado en adelante
-	BSP_LED_Init(LED_GREEN);		// Indicador en estados Espera y Recibiendo
-	delayInit( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO);
-	delayInit( &parpadeoLedVerde, TIEMPO_PARPADEO_ESPERA);
-}
-
-/*******************************************************************************
-  * @brief  Establece al generador en espera
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Espera(void) {
-	// Apago led azul     = señal cargada
-	// Parpadeo led verde = en espera
-	BSP_LED_Off(LED_BLUE);
-	delayWrite( &parpadeoLedVerde, TIEMPO_PARPADEO_ESPERA );
-
-	// Actualizo estructura
-	GeneradorDAC2.cargado = false;
-	GeneradorDAC2.estado = Espera;
-
-	// Finalmente corto señal del generador
-	Parar_DAC_DMA();
-
-	// Y envío informe a UART
-    uartClearBuffer();
-    uartSendString((uint8_t *) "Generador vacio y en espera...\n");
-}
-
-/*******************************************************************************
-  * @brief  Pasa a estado de receción de señal
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Recibir(void) {
-	GeneradorDAC2.estado = Recibiendo;
-	BSP_LED_On(LED_GREEN);
-    uartSendString((uint8_t *) "Listo para recibir...\n");
-    uartClearBuffer();
-}
-
-/*******************************************************************************
-  * @brief  Carga señal en el generador
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Cargar(uint32_t Senial[]) {
-	// Chequeo que la Senial tenga todos los datos que necesito
-	for (uint16_t i=0; i<N_MUESTRAS; i++) {
-		// Verifico que Senial[] sea acorde a 12 bits
-		if (Senial[i] > 0x0FFF) Error_Handler();
-	}
-
-	// Copio valores
-	for (uint16_t i=0; i<N_MUESTRAS; i++) GeneradorDAC2.senial[i] = Senial[i];
-
-	// Actualizo el estado
-	GeneradorDAC2.cargado = true;
-	GeneradorDAC2.estado = Cargado;
-
-	// Informo con leds y por UART
-	BSP_LED_Off(LED_GREEN);
-	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO );
-    uartClearBuffer();
-    uartSendString((uint8_t *) "Senial cargada en generador.\n");
-}
-
-/*******************************************************************************
-  * @brief  Enciende el generador
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Encender(void) {
-	// Acelero el parpadeo del led azul
-	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_ENCENDIDO );
-
-	// Actualizo estructura
-	GeneradorDAC2.estado = Generando;
-	GeneradorDAC2.encendido = true;
-
-	// Enciendo generador
-	Comenzar_DAC_DMA(GeneradorDAC2.senial, N_MUESTRAS);
-
-	// Reinicializo índice de carga
-	//MuestraNro = 0;
-
-	// Muestro mensaje de esto.
-	uartSendString((uint8_t *) "Generador 2 encendido.\n\r");
-
-}
-
-/*******************************************************************************
-  * @brief  Pone pausa al generador (sale de pausa con boton de usuario)
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Pausar(void) {
-
-	GeneradorDAC2.estado = Pausa;
-	GeneradorDAC2.encendido = false;
-
-	Parar_DAC_DMA();
-
-	uartSendString((uint8_t *) "Generador 2 en pausa.\n\r");
-	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO );
-}
-
-/*******************************************************************************
-  * @brief  Devuelve el estado del generador
-  * @param  Estructura de datos del generador
-  * @retval estado del generador
-  */
-estadosMEF Gen_Estado(void) {
-	return GeneradorDAC2.estado;
-}
-
-/*******************************************************************************
-  * @brief  Actualiza leds según estado del generador
-  * @param  Estructura de datos del generador
-  * @retval None
-  */
-void Gen_Actualiza_Leds(void) {
-	// Analizo parpadeo LED VERDE:
-	if ( (Gen_Estado() == Espera) && delayRead( &parpadeoLedVerde )) BSP_LED_Toggle(LED_GREEN);
-
-	// Analizo parpadeo LED AZUL:
-	if ( (Gen_Estado() >= Cargado) && delayRead( &parpadeoLedAzul )) BSP_LED_Toggle(LED_BLUE);
-}
-
-
-
+/*******************************************************************************
+  * @file		API_generador.c
+  * @brief      Maneja acciones de los estados del
+  *             Generador de señales con entrada por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_generador.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define TIEMPO_ENCENDIDO_1	100		// <-- tiempos para parpadeo de leds
+#define TIEMPO_ENCENDIDO_2	500
+#define TIEMPO_PARPADEO_ESPERA		1000
+#define TIEMPO_PARPADEO_CARGADO		750
+#define TIEMPO_PARPADEO_ENCENDIDO	75
+#define TIEMPO_ESPERA_COMPRIMIDO	2000	// Sin bytes durante este tiempo: se aborta
+#define LARGO_RX_COMPRIMIDO			64		// Bytes que se leen de la UART por vez
+#define TIEMPO_ASENTAMIENTO			1		// ms entre fijar un código y medirlo
+#define PROMEDIOS_CALIBRACION		64		// Conversiones del ADC por punto
+#define GANANCIA_IDEAL_CAL			(1L << (CAL_BITS_GANANCIA + CAL_BITS_MEDIDA))
+
+/* Private typedef -----------------------------------------------------------*/
+
+// Cada generador tiene estado y senial almacenada.
+// Sólo se modifica desde el lazo principal: lo que ocurre en interrupciones
+// llega a través de Leer_Evento_DAC_DMA().
+typedef struct {
+	estadosMEF estado;
+	bool encendido;			// Este bool es redundante
+	bool cargado;			// Este bool es redundante
+	uint32_t largo;			// Muestras por período
+	int16_t ganancia;		// Q12 (ACOND_GANANCIA_UNO = 1,0)
+	int16_t offset;			// Cuentas
+	uint16_t senial[N_MAX_MUESTRAS];	// Copia maestra: no la modifican ganancia ni offset
+} generador_t;
+
+/* Variables privadas USUARIO -------------------------------------------------*/
+generador_t GeneradorDAC2;		// Estructura del generador
+delay_t parpadeoLedAzul;		// Parpadeo en estados Cargado, Generando y Pausa
+delay_t parpadeoLedVerde;		// Parpadeo en estados Espera y Recibiendo
+delay_t esperaComprimido;		// Corte de una carga comprimida incompleta
+decodificador_t Decodificador;	// Carga comprimida en curso (ver API_compresion.h)
+bool_t Descomprimiendo = false;
+uint32_t CiclosDescompresion;	// Ciclos de CPU dentro del decodificador
+uint16_t Salidas[2][N_MAX_MUESTRAS];	// Señal con ganancia y offset: una la recorre
+										// el DMA y en la otra se calcula el próximo ajuste
+bool_t CambioPendiente = false;	// Ajuste esperando el fin de período (DAC_EVENTO_CAMBIO)
+bool_t Recalcular = false;		// Hubo otro ajuste mientras tanto
+uint32_t InicioAjuste;			// Ciclo DWT del pedido de ajuste
+calibracion_t Calibracion;		// Última calibración válida (ver API_calibracion.h)
+uint16_t TablaCalibracion[CAL_CODIGOS];	// Código deseado -> código del DAC
+bool_t Calibrado = false;		// Hay una calibración válida
+bool_t Corregir = false;		// La salida pasa por TablaCalibracion
+compensacion_t Compensacion;	// Pre-énfasis contra la retención del DAC (ver API_compensacion.h)
+uint32_t CiclosCompensacion = 0;	// Ciclos de CPU de la última compensación
+uint32_t LargoCompensado = 0;	// Muestras de la última compensación (0: no hubo)
+conmutacion_t Conmutacion;		// Cambio de señal en marcha (ver API_conmutacion.h)
+
+/* Private function prototypes -----------------------------------------------*/
+static void Informar_Cargado(void);
+static void Liberar_Buffer(void);
+static bool_t Entrar_Modo(estadosMEF Modo, bool_t Arrancado);
+static void Terminar_Modo(estadosMEF Modo);
+static void Volver_Sin_Salida(void);
+static void Pasar_A_Espera(bool_t Descartar);
+static void Informar_Sintesis(uint32_t Largo, uint32_t Ciclos, uint32_t Saturadas);
+static void Informar_Costo(uint32_t Largo, uint32_t Ciclos, uint32_t Marcadas, const char * Final);
+static uint32_t Acondicionar(uint16_t * Destino);
+static uint16_t * Preparar_Salida(uint32_t * Recortadas);
+static void Aplicar_Ajuste(void);
+static bool_t Conmutar_En_Vivo(uint32_t Largo);
+static void Terminar_Conmutacion(uint32_t Largo, uint32_t Ciclos, uint32_t Saturadas);
+
+/*******************************************************************************
+  * @brief  Inicializa Generador
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Init(void) {
+	GeneradorDAC2.cargado = false;
+	GeneradorDAC2.encendido = false;
+	GeneradorDAC2.estado = Espera;
+	GeneradorDAC2.largo = 0;
+	GeneradorDAC2.ganancia = ACOND_GANANCIA_UNO;
+	GeneradorDAC2.offset = 0;
+	Conm_Defecto(&Conmutacion);
+	Zoh_Preparar(&Compensacion, 0);
+	BSP_LED_Init(LED_BLUE);			// Indicador en estados Cargado en adelante
+	BSP_LED_Init(LED_GREEN);		// Indicador en estados Espera y Recibiendo
+	delayInit( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO);
+	delayInit( &parpadeoLedVerde, TIEMPO_PARPADEO_ESPERA);
+
+	// Calibración guardada en flash (borrada o de otra versión: no se usa)
+	const calibracion_t * guardada = (const calibracion_t *) Flash_Leer();
+	if (Cal_Valida(guardada)) {
+		Calibracion = *guardada;
+		Cal_Tabla(&Calibracion, TablaCalibracion);
+		Calibrado = true;
+		Corregir = true;
+	}
+}
+
+/*******************************************************************************
+  * @brief  Establece al generador en espera
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Espera(void) {
+	Pasar_A_Espera(true);
+}
+
+/*******************************************************************************
+  * @brief  Termina el streaming luego de STREAM_FIN y pasa a espera. Lo que
+  *         siguió a la muestra final queda en la UART: son comandos.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Stream(void) {
+	if (GeneradorDAC2.estado == Reproduciendo) Pasar_A_Espera(false);
+}
+
+/*******************************************************************************
+  * @brief  Establece al generador en espera
+  * @param  Descartar: descarta lo recibido por UART y todavía no leído
+  * @retval None
+  */
+static void Pasar_A_Espera(bool_t Descartar) {
+	// Apago led azul     = señal cargada
+	// Parpadeo led verde = en espera
+	BSP_LED_Off(LED_BLUE);
+	delayWrite( &parpadeoLedVerde, TIEMPO_PARPADEO_ESPERA );
+
+	// Corto el modo en curso (streaming, filtrado, ráfagas, barrido, ...)
+	Liberar_Buffer();
+
+	// Actualizo estructura
+	GeneradorDAC2.cargado = false;
+	GeneradorDAC2.estado = Espera;
+
+	// Finalmente corto señal del generador
+	Parar_DAC_DMA();
+
+	// Y envío informe a UART
+    if (Descartar) uartClearBuffer();
+    uartSendString((uint8_t *) "Generador vacio y en espera...\n");
+}
+
+/*******************************************************************************
+  * @brief  Pasa a estado de receción de señal
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Recibir(void) {
+	GeneradorDAC2.estado = Recibiendo;
+	BSP_LED_On(LED_GREEN);
+    uartSendString((uint8_t *) "Listo para recibir...\n");
+    uartClearBuffer();
+}
+
+/*******************************************************************************
+  * @brief  Carga señal en el generador. Las muestras mayores a 4095 se
+  *         recortan (y se informan) en la misma pasada que las copia.
+  * @param  Senial: muestras de 12 bits
+  * @param  Largo: muestras por período (hasta N_MAX_MUESTRAS)
+  * @retval None
+  */
+void Gen_Cargar(const uint16_t Senial[], uint32_t Largo) {
+	if (Largo == 0 || Largo > N_MAX_MUESTRAS) Error_Handler();
+
+	uint32_t inicio = medicionCiclos();
+	uint32_t recortadas = Acond_Procesar(Senial, GeneradorDAC2.senial, Largo, ACOND_GANANCIA_UNO, 0);
+	uint32_t ciclos = medicionCiclos() - inicio;
+	GeneradorDAC2.largo = Largo;
+
+	Informar_Cargado();
+    uartClearBuffer();
+    uartSendLiteral("Senial cargada en generador: ");
+	Informar_Costo(Largo, ciclos, recortadas, " recortadas.\n");
+}
+
+/*******************************************************************************
+  * @brief  Sintetiza la señal directamente en el buffer del generador
+  *         (sin pasar por la UART) e informa el tiempo de cálculo.
+  * @param  Parametros: forma de onda (ver API_sintesis.h)
+  * @retval None
+  */
+void Gen_Sintetizar(const sintesis_t * Parametros) {
+	if (Parametros->largo < 2 || Parametros->largo > N_MAX_MUESTRAS) {
+		uartSendString((uint8_t *) "Cantidad de muestras invalida.\n");
+		return;
+	}
+	bool_t enVivo = Conmutar_En_Vivo(Parametros->largo);
+	if (!enVivo) Liberar_Buffer();
+
+	uint32_t inicio = medicionCiclos();
+	uint32_t saturadas = Sint_Generar(Parametros, GeneradorDAC2.senial);
+	uint32_t ciclos = medicionCiclos() - inicio;
+
+	if (enVivo) Terminar_Conmutacion(Parametros->largo, ciclos, saturadas);
+	else Informar_Sintesis(Parametros->largo, ciclos, saturadas);
+}
+
+/*******************************************************************************
+  * @brief  Sintetiza la señal a partir de sus armónicos (ver API_fourier.h)
+  *         e informa el método y el tiempo de cálculo.
+  * @param  Armonicos: lista de armónicos y largo del período
+  * @retval None
+  */
+void Gen_Fourier(const fourier_t * Armonicos) {
+	if (Fourier_Valido(Armonicos) != true) {
+		uartSendString((uint8_t *) "Armonicos invalidos para ese N.\n");
+		return;
+	}
+	bool_t enVivo = Conmutar_En_Vivo(Armonicos->largo);
+	if (!enVivo) Liberar_Buffer();
+
+	uint32_t inicio = medicionCiclos();
+	uint32_t saturadas = Fourier_Sintetizar(Armonicos, GeneradorDAC2.senial);
+	uint32_t ciclos = medicionCiclos() - inicio;
+
+	uartSendString((uint8_t *) ((Fourier_Metodo(Armonicos) == FOURIER_FFT) ? "Metodo: FFT.\n" : "Metodo: directo.\n"));
+	if (enVivo) Terminar_Conmutacion(Armonicos->largo, ciclos, saturadas);
+	else Informar_Sintesis(Armonicos->largo, ciclos, saturadas);
+}
+
+/*******************************************************************************
+  * @brief  Expande los puntos de control a un período completo
+  *         (ver API_interpolacion.h) e informa el tiempo de cálculo.
+  * @param  Puntos: puntos de control y largo del período
+  * @retval None
+  */
+void Gen_Interpolar(const interpolacion_t * Puntos) {
+	if (Interp_Valido(Puntos) != true || Puntos->largo > N_MAX_MUESTRAS) {
+		uartSendString((uint8_t *) "Puntos invalidos para ese N.\n");
+		return;
+	}
+	bool_t enVivo = Conmutar_En_Vivo(Puntos->largo);
+	if (!enVivo) Liberar_Buffer();
+
+	uint32_t inicio = medicionCiclos();
+	uint32_t saturadas = Interp_Expandir(Puntos, GeneradorDAC2.senial);
+	uint32_t ciclos = medicionCiclos() - inicio;
+
+	if (enVivo) Terminar_Conmutacion(Puntos->largo, ciclos, saturadas);
+	else Informar_Sintesis(Puntos->largo, ciclos, saturadas);
+}
+
+/*******************************************************************************
+  * @brief  Empieza una carga comprimida de 'Largo' muestras: lo que llegue
+  *         por UART se decodifica a medida que llega directamente en el
+  *         buffer del generador (ver Gen_Procesar_Descompresion).
+  * @param  Largo: muestras por período
+  * @retval None
+  */
+void Gen_Descomprimir(uint32_t Largo) {
+	char anuncio[24];
+
+	if (Largo == 0 || Largo > N_MAX_MUESTRAS) {
+		uartSendString((uint8_t *) "Cantidad de muestras invalida.\n");
+		return;
+	}
+	Liberar_Buffer();
+
+	Comp_Iniciar(&Decodificador, GeneradorDAC2.senial, Largo);
+	CiclosDescompresion = 0;
+	Descomprimiendo = true;
+	GeneradorDAC2.cargado = false;
+	GeneradorDAC2.estado = Recibiendo;
+	delayInit( &esperaComprimido, TIEMPO_ESPERA_COMPRIMIDO );
+
+	char * fin = Num_AgregarDecimal(Num_AgregarTexto(anuncio, "COMP "), Largo);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) anuncio, (uint16_t) (fin - anuncio));
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay una carga comprimida en curso.
+  * @param  None
+  * @retval true mientras los bytes de la UART sean datos comprimidos
+  */
+bool_t Gen_Descomprimiendo(void) {
+	return Descomprimiendo;
+}
+
+/*******************************************************************************
+  * @brief  Decodifica los bytes recibidos. Al completar la señal pasa a
+  *         Cargado e informa la relación de compresión y el costo.
+  * @param  None
+  * @retval None
+  */
+void Gen_Procesar_Descompresion(void) {
+	uint8_t rx[LARGO_RX_COMPRIMIDO];
+	uint16_t leidos;
+	char informe[96];
+
+	if (!Descomprimiendo) return;
+
+	while (Decodificador.estado == COMP_EN_CURSO && (leidos = uartReceiveAvailable(rx, LARGO_RX_COMPRIMIDO)) > 0) {
+		uint32_t inicio = medicionCiclos();
+		Comp_Decodificar(&Decodificador, rx, leidos);
+		CiclosDescompresion += medicionCiclos() - inicio;
+		delayReset( &esperaComprimido );
+	}
+
+	if (Decodificador.estado == COMP_EN_CURSO) {
+		if (delayRead( &esperaComprimido ) != true) return;
+		uartSendString((uint8_t *) "Carga comprimida incompleta.\n");
+		Decodificador.estado = COMP_ERROR;
+	}
+	Descomprimiendo = false;
+
+	if (Decodificador.estado == COMP_ERROR) {
+		// El buffer quedó a medio escribir: no hay señal válida
+		uartClearBuffer();
+		uartSendString((uint8_t *) "Error en los datos comprimidos.\n");
+		GeneradorDAC2.estado = Recibiendo;
+		return;
+	}
+
+	GeneradorDAC2.largo = Decodificador.largo;
+	Informar_Cargado();
+	char * fin = Num_AgregarTexto(informe, "Senial descomprimida: ");
+	fin = Num_AgregarDecimal(fin, Decodificador.largo);
+	fin = Num_AgregarTexto(fin, " muestras en ");
+	fin = Num_AgregarDecimal(fin, Decodificador.bytes);
+	fin = Num_AgregarTexto(fin, " bytes, ");
+	fin = Num_AgregarDecimal(fin, CiclosDescompresion / Decodificador.largo);
+	fin = Num_AgregarTexto(fin, " ciclos/muestra.\n");
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Enciende el generador
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Encender(void) {
+	// Acelero el parpadeo del led azul
+	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_ENCENDIDO );
+
+	// Actualizo estructura
+	GeneradorDAC2.estado = Generando;
+	GeneradorDAC2.encendido = true;
+
+	// Enciendo generador (con la ganancia y el offset actuales)
+	uint32_t recortadas;
+	CambioPendiente = false;
+	Recalcular = false;
+	Comenzar_DAC_DMA(Preparar_Salida(&recortadas), GeneradorDAC2.largo);
+
+	// Reinicializo índice de carga
+	//MuestraNro = 0;
+
+	// Muestro mensaje de esto.
+	uartSendString((uint8_t *) "Generador 2 encendido.\n\r");
+
+}
+
+/*******************************************************************************
+  * @brief  Pone pausa al generador (sale de pausa con boton de usuario)
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Pausar(void) {
+
+	GeneradorDAC2.estado = Pausa;
+	GeneradorDAC2.encendido = false;
+
+	Conmutador_Cancelar();
+	Parar_DAC_DMA();
+
+	uartSendString((uint8_t *) "Generador 2 en pausa.\n\r");
+	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO );
+}
+
+/*******************************************************************************
+  * @brief  Pasa a reproducir muestras continuas recibidas por UART
+  * @param  periodo: ARR de TIM2 para la frecuencia de muestras
+  * @retval None
+  */
+void Gen_Stream(uint32_t periodo) {
+	Liberar_Buffer();
+	GeneradorDAC2.cargado = false;		// El streaming pisa la señal del DMA
+	Entrar_Modo(Reproduciendo, true);
+	Stream_Iniciar(periodo);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a filtrar la entrada del ADC hacia el DAC (ver API_dsp.h).
+  *         La señal cargada se conserva: al terminar se vuelve a Cargado.
+  * @param  Coeficientes: FIR y biquads
+  * @param  Bloque: muestras por bloque
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Filtrar(const coefFiltro_t * Coeficientes, uint32_t Bloque) {
+	Liberar_Buffer();
+	return Entrar_Modo(Filtrando, Dsp_Iniciar(Coeficientes, Bloque));
+}
+
+/*******************************************************************************
+  * @brief  Termina el filtrado: vuelve a Cargado si había una señal, si no
+  *         a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Filtro(void) {
+	Terminar_Modo(Filtrando);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a sacar ráfagas de la señal cargada (ver API_rafaga.h), con
+  *         la ganancia, el offset y la corrección actuales. El reposo es un
+  *         código deseado: también pasa por la corrección.
+  * @param  Parametros: períodos por ráfaga, reposo y fuente de disparo
+  * @retval None
+  */
+void Gen_Rafaga(const rafaga_t * Parametros) {
+	if (!GeneradorDAC2.cargado) {
+		uartSendLiteral("No hay senial cargada.\n");
+		return;
+	}
+	Liberar_Buffer();
+
+	uint32_t recortadas;
+	uint16_t * salida = Preparar_Salida(&recortadas);
+	uint16_t * rotada = (salida == Salidas[0]) ? Salidas[1] : Salidas[0];
+	rafaga_t r = *Parametros;
+	if (Corregir) r.reposo = TablaCalibracion[r.reposo];
+	Rafaga_Iniciar(&r, salida, rotada, GeneradorDAC2.largo);
+	Entrar_Modo(Rafaga, true);
+	Rafaga_Informar();
+}
+
+/*******************************************************************************
+  * @brief  Dispara una ráfaga (comando *TRG o pulsador)
+  * @param  None
+  * @retval None
+  */
+void Gen_Disparar(void) {
+	if (GeneradorDAC2.estado != Rafaga) {
+		uartSendLiteral("No hay rafagas preparadas: usar BURST.\n");
+		return;
+	}
+	if (Rafaga_Disparar() != true) uartSendLiteral("Rafaga en curso: disparo ignorado.\n");
+}
+
+/*******************************************************************************
+  * @brief  Termina las ráfagas y vuelve a Cargado
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Rafaga(void) {
+	Terminar_Modo(Rafaga);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a barrer la frecuencia (ver API_wobulador.h). La señal
+  *         cargada se conserva: al terminar se vuelve a Cargado.
+  * @param  Parametros: tipo, extremos, duración, amplitud y offset
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Barrer(const barrido_t * Parametros) {
+	Liberar_Buffer();
+	return Entrar_Modo(Barriendo, Wob_Iniciar(Parametros));
+}
+
+/*******************************************************************************
+  * @brief  Termina el barrido: vuelve a Cargado si había una señal, si no
+  *         a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Barrido(void) {
+	Terminar_Modo(Barriendo);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a modular (ver API_modulador.h). Con CAR=TABLE la portadora
+  *         es la copia maestra de la señal cargada (sin ganancia, offset ni
+  *         corrección: la escala la dan AMP y OFF). La señal cargada se
+  *         conserva: al terminar se vuelve a Cargado.
+  * @param  Parametros: tipo, frecuencias, índice, amplitud y offset
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Modular(const modulacion_t * Parametros) {
+	if (Parametros->tabla && !GeneradorDAC2.cargado) {
+		uartSendLiteral("No hay senial cargada para CAR=TABLE.\n");
+		return false;
+	}
+	Liberar_Buffer();
+	return Entrar_Modo(Modulando, Modulador_Iniciar(Parametros, GeneradorDAC2.senial, GeneradorDAC2.largo));
+}
+
+/*******************************************************************************
+  * @brief  Termina la modulación: vuelve a Cargado si había una señal, si no
+  *         a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Modulacion(void) {
+	Terminar_Modo(Modulando);
+}
+
+/*******************************************************************************
+  * @brief  Agrega la señal cargada al final de la secuencia, con la
+  *         ganancia, el offset, la compensación y la corrección actuales (quedan fijos en el
+  *         segmento). También con la secuencia en marcha.
+  * @param  Repeticiones: 1..SEQ_MAX_REPETICIONES o SEQ_INFINITO
+  * @retval false si no se pudo agregar (el motivo ya se informó)
+  */
+bool_t Gen_Agregar_Segmento(uint32_t Repeticiones) {
+	if (!GeneradorDAC2.cargado) {
+		uartSendLiteral("No hay senial cargada.\n");
+		return false;
+	}
+	uint16_t * destino = Secuenciador_Reservar(GeneradorDAC2.largo);
+	if (destino == NULL) return false;
+	return Secuenciador_Agregar(Repeticiones, Acondicionar(destino));
+}
+
+/*******************************************************************************
+  * @brief  Pasa a recorrer la secuencia (ver API_secuenciador.h). La señal
+  *         cargada se conserva: al terminar se vuelve a Cargado.
+  * @param  None
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Secuenciar(void) {
+	Liberar_Buffer();
+	return Entrar_Modo(Secuenciando, Secuenciador_Iniciar());
+}
+
+/*******************************************************************************
+  * @brief  Termina la secuencia: vuelve a Cargado si había una señal, si no
+  *         a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Secuencia(void) {
+	Terminar_Modo(Secuenciando);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a recorrer los puntos (ver API_trazador.h). Son códigos del
+  *         DAC: no llevan ganancia, offset ni corrección. La señal cargada
+  *         se conserva: al terminar se vuelve a Cargado.
+  * @param  None
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Trazar(void) {
+	Liberar_Buffer();
+	return Entrar_Modo(Trazando, Trazador_Iniciar());
+}
+
+/*******************************************************************************
+  * @brief  Termina los puntos: vuelve a Cargado si había una señal, si no
+  *         a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Trazado(void) {
+	Terminar_Modo(Trazando);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a sacar la triangular o el ruido del propio DAC2 (ver
+  *         API_ondas_dac.h). Con BASE=SIG se les suma la señal cargada, con
+  *         la ganancia, el offset y la corrección actuales. La señal
+  *         cargada se conserva: al terminar se vuelve a Cargado.
+  * @param  Parametros: onda, bits, base y período de disparo
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Onda_DAC(const ondasDAC_t * Parametros) {
+	uint32_t recortadas;
+	uint16_t * salida = NULL;
+	uint32_t largo = 0;
+
+	Liberar_Buffer();
+	if (Parametros->senial && GeneradorDAC2.cargado) {
+		salida = Preparar_Salida(&recortadas);
+		largo = GeneradorDAC2.largo;
+	}
+	return Entrar_Modo(Autonomo, Ondas_Iniciar(Parametros, salida, largo));
+}
+
+/*******************************************************************************
+  * @brief  Apaga el generador propio del DAC2: vuelve a Cargado si había
+  *         una señal, si no a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Onda_DAC(void) {
+	Terminar_Modo(Autonomo);
+}
+
+/*******************************************************************************
+  * @brief  Pasa a sacar una PRBS o ruido (ver API_ruido.h). La señal
+  *         cargada se conserva: al terminar se vuelve a Cargado.
+  * @param  Parametros: generador, amplitud, offset, CHIP, DEC y semilla
+  * @retval false si no se pudo arrancar (el motivo ya se informó)
+  */
+bool_t Gen_Aleatorio(const aleatorio_t * Parametros) {
+	Liberar_Buffer();
+	return Entrar_Modo(Aleatorio, Ruido_Iniciar(Parametros));
+}
+
+/*******************************************************************************
+  * @brief  Termina la PRBS o el ruido: vuelve a Cargado si había una señal,
+  *         si no a Espera.
+  * @param  None
+  * @retval None
+  */
+void Gen_Terminar_Aleatorio(void) {
+	Terminar_Modo(Aleatorio);
+}
+
+/*******************************************************************************
+  * @brief  Devuelve el estado del generador
+  * @param  Estructura de datos del generador
+  * @retval estado del generador
+  */
+estadosMEF Gen_Estado(void) {
+	return GeneradorDAC2.estado;
+}
+
+/*******************************************************************************
+  * @brief  Devuelve las muestras por período de la señal cargada
+  * @param  None
+  * @retval 0 si no hay señal
+  */
+uint32_t Gen_Largo(void) {
+	return GeneradorDAC2.cargado ? GeneradorDAC2.largo : 0;
+}
+
+/*******************************************************************************
+  * @brief  Fija la ganancia de la salida sin volver a cargar la señal.
+  *         Si está generando, el cambio entra al final de un período.
+  * @param  Ganancia: Q12 (ACOND_GANANCIA_UNO = 1,0)
+  * @retval None
+  */
+void Gen_Fijar_Ganancia(int16_t Ganancia) {
+	GeneradorDAC2.ganancia = Ganancia;
+	Aplicar_Ajuste();
+}
+
+/*******************************************************************************
+  * @brief  Fija el offset de la salida sin volver a cargar la señal.
+  *         Si está generando, el cambio entra al final de un período.
+  * @param  Offset: cuentas que se suman luego de la ganancia
+  * @retval None
+  */
+void Gen_Fijar_Offset(int16_t Offset) {
+	GeneradorDAC2.offset = Offset;
+	Aplicar_Ajuste();
+}
+
+/*******************************************************************************
+  * @brief  Ganancia actual
+  * @param  None
+  * @retval Q12
+  */
+int16_t Gen_Ganancia(void) {
+	return GeneradorDAC2.ganancia;
+}
+
+/*******************************************************************************
+  * @brief  Offset actual
+  * @param  None
+  * @retval Cuentas
+  */
+int16_t Gen_Offset(void) {
+	return GeneradorDAC2.offset;
+}
+
+/*******************************************************************************
+  * @brief  Calibra el DAC2: barre CAL_PUNTOS códigos, mide cada uno con el
+  *         ADC1 (la misma pata PA5), ajusta ganancia, offset e INL, guarda
+  *         el resultado en flash y arma la tabla de corrección.
+  *         La salida se detiene; la señal cargada se conserva.
+  * @param  None
+  * @retval None
+  */
+void Gen_Calibrar(void) {
+	uint16_t medidas[CAL_PUNTOS];
+	calibracion_t nueva;
+
+	Liberar_Buffer();
+	Volver_Sin_Salida();
+	uartSendLiteral("Calibrando...\n");
+
+	for (uint32_t k=0; k<CAL_PUNTOS; k++) {
+		Fijar_Valor_DAC_DMA(Cal_Codigo(k));
+		HAL_Delay(TIEMPO_ASENTAMIENTO);
+		medidas[k] = Medir_ADC(PROMEDIOS_CALIBRACION);
+	}
+	Fijar_Valor_DAC_DMA(0);
+	Parar_DAC_DMA();
+
+	if (Cal_Ajustar(medidas, &nueva) != true) {
+		uartSendLiteral("Calibracion rechazada: el ADC no sigue al DAC.\n");
+		return;
+	}
+	if (Flash_Guardar(&nueva, sizeof(nueva)) != true) {
+		uartSendLiteral("No se pudo guardar la calibracion en flash.\n");
+	}
+	Calibracion = nueva;
+	Cal_Tabla(&Calibracion, TablaCalibracion);
+	Calibrado = true;
+	Corregir = true;
+	Gen_Informar_Calibracion();
+}
+
+/*******************************************************************************
+  * @brief  Activa o desactiva la corrección de la salida. Si está
+  *         generando, el cambio entra al final de un período.
+  * @param  Usar: true para pasar la salida por la tabla de corrección
+  * @retval false si se pidió usarla y no hay calibración
+  */
+bool_t Gen_Usar_Calibracion(bool_t Usar) {
+	if (Usar && !Calibrado) return false;
+	Corregir = Usar;
+	Aplicar_Ajuste();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Informa la calibración:
+  *         "CAL=ON|OFF|NO ERRGAN=<milésimas> ERROFF=<cuentas>
+  *          INL=<décimas de cuenta> UTIL=<mínimo>-<máximo>"
+  * @param  None
+  * @retval None
+  */
+void Gen_Informar_Calibracion(void) {
+	char informe[96];
+	uint16_t minimo, maximo;
+
+	if (!Calibrado) {
+		uartSendLiteral("CAL=NO\n");
+		return;
+	}
+	int64_t errorGanancia = ((int64_t) Calibracion.ganancia - GANANCIA_IDEAL_CAL) * 1000;
+	int32_t inl = Cal_Inl_Maximo(&Calibracion) * 10;
+	Cal_Rango(&Calibracion, &minimo, &maximo);
+
+	char * fin = Num_AgregarTexto(informe, Corregir ? "CAL=ON ERRGAN=" : "CAL=OFF ERRGAN=");
+	fin = Num_AgregarEntero(fin, (int32_t) ((errorGanancia + ((errorGanancia < 0) ? -GANANCIA_IDEAL_CAL : GANANCIA_IDEAL_CAL) / 2) / GANANCIA_IDEAL_CAL));
+	fin = Num_AgregarTexto(fin, " ERROFF=");
+	fin = Num_AgregarEntero(fin, (Calibracion.offset + ((Calibracion.offset < 0) ? -8 : 8)) / (1 << CAL_BITS_MEDIDA));
+	fin = Num_AgregarTexto(fin, " INL=");
+	fin = Num_AgregarDecimal(fin, (uint32_t) (inl + 8) >> CAL_BITS_MEDIDA);
+	fin = Num_AgregarTexto(fin, " UTIL=");
+	fin = Num_AgregarDecimal(fin, minimo);
+	*fin++ = '-';
+	fin = Num_AgregarDecimal(fin, maximo);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Elige el FIR que compensa la retención del DAC (o ninguno). Si
+  *         está generando, el cambio entra al final de un período.
+  * @param  Taps: 0 (sin compensar), 3, 5, 7 o 9
+  * @retval false si no hay diseño con esos taps
+  */
+bool_t Gen_Compensar_Retencion(uint32_t Taps) {
+	if (Zoh_Preparar(&Compensacion, Taps) != true) return false;
+	LargoCompensado = 0;
+	Aplicar_Ajuste();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Informa la compensación de la retención:
+  *         "ZOH=ON|OFF TAPS=<n> PLANO=<dB> SIN=<dB> BANDA=0,45 fs
+  *          [<ciclos> ciclos/1K muestras]"
+  *         PLANO es el peor desvío de la salida hasta la banda con este FIR
+  *         y SIN el de la retención sola; los ciclos son los de la última
+  *         vez que se armó la salida.
+  * @param  None
+  * @retval None
+  */
+void Gen_Informar_Compensacion(void) {
+	char informe[112];
+	uint32_t centesimas;
+
+	char * fin = Num_AgregarTexto(informe, Compensacion.taps ? "ZOH=ON TAPS=" : "ZOH=OFF TAPS=");
+	fin = Num_AgregarDecimal(fin, Compensacion.taps);
+	fin = Num_AgregarTexto(fin, " PLANO=");
+	centesimas = Zoh_Planicidad(Compensacion.taps);
+	fin = Num_AgregarDecimal(fin, centesimas / 100);
+	*fin++ = ',';
+	*fin++ = (char) ('0' + centesimas / 10 % 10);
+	*fin++ = (char) ('0' + centesimas % 10);
+	fin = Num_AgregarTexto(fin, " dB SIN=");
+	centesimas = Zoh_Planicidad(0);
+	fin = Num_AgregarDecimal(fin, centesimas / 100);
+	*fin++ = ',';
+	*fin++ = (char) ('0' + centesimas / 10 % 10);
+	*fin++ = (char) ('0' + centesimas % 10);
+	fin = Num_AgregarTexto(fin, " dB BANDA=0,");
+	fin = Num_AgregarDecimal(fin, ZOH_BANDA / 10);
+	fin = Num_AgregarTexto(fin, " fs");
+	if (Compensacion.taps && LargoCompensado) {
+		*fin++ = ' ';
+		fin = Num_AgregarDecimal(fin, (uint32_t) (((uint64_t) CiclosCompensacion * 1024 + LargoCompensado / 2) / LargoCompensado));
+		fin = Num_AgregarTexto(fin, " ciclos/1K muestras");
+	}
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Fija cómo se cambia la señal cuando se sintetiza otra mientras
+  *         genera (ver Conmutar_En_Vivo)
+  * @param  Politica: política y parámetros (ver API_conmutacion.h)
+  * @retval None
+  */
+void Gen_Fijar_Conmutacion(const conmutacion_t * Politica) {
+	Conmutacion = *Politica;
+}
+
+/*******************************************************************************
+  * @brief  Política de conmutación vigente
+  * @param  None
+  * @retval Puntero de sólo lectura
+  */
+const conmutacion_t * Gen_Conmutacion(void) {
+	return &Conmutacion;
+}
+
+/*******************************************************************************
+  * @brief  Actualiza leds según estado del generador
+  * @param  Estructura de datos del generador
+  * @retval None
+  */
+void Gen_Actualiza_Leds(void) {
+	// Analizo parpadeo LED VERDE:
+	if ( (Gen_Estado() == Espera) && delayRead( &parpadeoLedVerde )) BSP_LED_Toggle(LED_GREEN);
+
+	// Analizo parpadeo LED AZUL:
+	if ( (Gen_Estado() >= Cargado) && delayRead( &parpadeoLedAzul )) BSP_LED_Toggle(LED_BLUE);
+}
+
+/*******************************************************************************
+  * @brief  Atiende los eventos que informaron las interrupciones del DAC/DMA.
+  *         Ante una subejecución o un error de DMA la salida quedó detenida,
+  *         así que el generador pasa a Pausa. Si el DAC no tomó el reposo
+  *         de una ráfaga, la ráfaga termina.
+  * @param  None
+  * @retval None
+  */
+void Gen_Procesar_Eventos(void) {
+	eventoDAC_t evento;
+
+	// Fin de un cambio de señal en marcha: la otra salida queda libre
+	if (Conmutador_Procesar() && Recalcular) {
+		Recalcular = false;
+		Aplicar_Ajuste();
+	}
+
+	while (Leer_Evento_DAC_DMA(&evento)) {
+		if (evento == DAC_EVENTO_CAMBIO) {
+			// Latencia del ajuste: desde el pedido hasta que sale por el DAC
+			if (!CambioPendiente) continue;
+			CambioPendiente = false;
+			uint32_t ciclos = Leer_Ciclo_Cambio_DAC_DMA() - InicioAjuste;
+			char informe[64];
+			char * fin = Num_AgregarTexto(informe, "Ajuste en la salida: ");
+			fin = Num_AgregarDecimal(fin, ciclos);
+			fin = Num_AgregarTexto(fin, " ciclos (");
+			fin = Num_AgregarDecimal(fin, ciclos / (SystemCoreClock / 1000000));
+			fin = Num_AgregarTexto(fin, " us).\n");
+			uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+			if (Recalcular) {
+				Recalcular = false;
+				Aplicar_Ajuste();
+			}
+			continue;
+		}
+		if (evento == DAC_EVENTO_SUBEJECUCION) {
+			uartSendString((uint8_t *) "Subejecucion del DMA del DAC2.\n\r");
+		} else if (evento == DAC_EVENTO_REPOSO) {
+			uartSendString((uint8_t *) "El DAC2 no tomo el valor de reposo.\n\r");
+		} else {
+			uartSendString((uint8_t *) "Error de DMA del DAC2.\n\r");
+		}
+		// En streaming la subejecución ya la contabiliza API_stream
+		if (Gen_Estado() == Generando) Gen_Pausar();
+		else Terminar_Modo(Gen_Estado());
+	}
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Pasa a Cargado y lo indica con los leds.
+  * @param  None
+  * @retval None
+  */
+static void Informar_Cargado(void) {
+	// Actualizo el estado
+	GeneradorDAC2.cargado = true;
+	GeneradorDAC2.estado = Cargado;
+
+	// Informo con leds
+	BSP_LED_Off(LED_GREEN);
+	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_CARGADO );
+}
+
+/*******************************************************************************
+  * @brief  Detiene la salida antes de escribir el buffer que lee el DMA.
+  * @param  None
+  * @retval None
+  */
+static void Liberar_Buffer(void) {
+	if (GeneradorDAC2.estado == Reproduciendo) Stream_Parar();
+	if (GeneradorDAC2.estado == Filtrando) Dsp_Parar();
+	if (GeneradorDAC2.estado == Rafaga) Rafaga_Parar();
+	if (GeneradorDAC2.estado == Barriendo) Wob_Parar();
+	if (GeneradorDAC2.estado == Modulando) Modulador_Parar();
+	if (GeneradorDAC2.estado == Secuenciando) Secuenciador_Parar();
+	if (GeneradorDAC2.estado == Trazando) Trazador_Parar();
+	if (GeneradorDAC2.estado == Autonomo) Ondas_Parar();
+	if (GeneradorDAC2.estado == Aleatorio) Ruido_Parar();
+	Conmutador_Cancelar();
+	if (GeneradorDAC2.estado >= Generando) Parar_DAC_DMA();
+	GeneradorDAC2.encendido = false;
+}
+
+/*******************************************************************************
+  * @brief  Entra a un modo con salida propia, ya arrancado luego de
+  *         Liberar_Buffer(). Si no arrancó, el generador queda sin salida
+  *         (ver Volver_Sin_Salida).
+  * @param  Modo: estado del modo (Reproduciendo en adelante)
+  * @param  Arrancado: lo que devolvió el arranque del modo
+  * @retval Arrancado
+  */
+static bool_t Entrar_Modo(estadosMEF Modo, bool_t Arrancado) {
+	if (Arrancado != true) {
+		Volver_Sin_Salida();
+		return false;
+	}
+	GeneradorDAC2.estado = Modo;
+	GeneradorDAC2.encendido = true;
+
+	BSP_LED_Off(LED_GREEN);
+	delayWrite( &parpadeoLedAzul, TIEMPO_PARPADEO_ENCENDIDO );
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Termina un modo que conserva la señal cargada (Filtrando en
+  *         adelante): vuelve a Cargado si había una señal, si no a Espera.
+  *         En otro estado (o con el streaming, que termina solo) no hace nada.
+  * @param  Modo: estado del modo
+  * @retval None
+  */
+static void Terminar_Modo(estadosMEF Modo) {
+	if (GeneradorDAC2.estado != Modo || Modo < Filtrando) return;
+	Liberar_Buffer();
+	if (GeneradorDAC2.cargado) Informar_Cargado();
+	else Gen_Espera();
+}
+
+/*******************************************************************************
+  * @brief  Con la salida ya detenida (Liberar_Buffer), sale del estado que
+  *         generaba: a Cargado si había una señal, si no a Espera.
+  * @param  None
+  * @retval None
+  */
+static void Volver_Sin_Salida(void) {
+	if (GeneradorDAC2.estado < Generando) return;
+	if (GeneradorDAC2.cargado) Informar_Cargado();
+	else GeneradorDAC2.estado = Espera;
+}
+
+/*******************************************************************************
+  * @brief  Pasa a Cargado luego de una síntesis e informa su costo.
+  * @param  Largo: muestras sintetizadas
+  * @param  Ciclos: ciclos de CPU (contador DWT)
+  * @param  Saturadas: muestras fuera de 0..4095
+  * @retval None
+  */
+static void Informar_Sintesis(uint32_t Largo, uint32_t Ciclos, uint32_t Saturadas) {
+	GeneradorDAC2.largo = Largo;
+	Informar_Cargado();
+	uartSendLiteral("Senial sintetizada: ");
+	Informar_Costo(Largo, Ciclos, Saturadas, " saturadas.\n");
+}
+
+/*******************************************************************************
+  * @brief  Informa el costo de un cálculo sobre la señal:
+  *         "<n> muestras, <c> ciclos (<c/n>/muestra), <m><Final>"
+  * @param  Largo: muestras calculadas
+  * @param  Ciclos: ciclos de CPU (contador DWT)
+  * @param  Marcadas: muestras saturadas o recortadas
+  * @param  Final: texto que sigue a 'Marcadas'
+  * @retval None
+  */
+static void Informar_Costo(uint32_t Largo, uint32_t Ciclos, uint32_t Marcadas, const char * Final) {
+	char informe[96];
+
+	char * fin = Num_AgregarDecimal(informe, Largo);
+	fin = Num_AgregarTexto(fin, " muestras, ");
+	fin = Num_AgregarDecimal(fin, Ciclos);
+	fin = Num_AgregarTexto(fin, " ciclos (");
+	fin = Num_AgregarDecimal(fin, Ciclos / Largo);
+	fin = Num_AgregarTexto(fin, "/muestra), ");
+	fin = Num_AgregarDecimal(fin, Marcadas);
+	fin = Num_AgregarTexto(fin, Final);
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Arma la señal de salida a partir de la copia maestra, en la
+  *         salida que el DMA no está usando. El DMA nunca recorre la copia
+  *         maestra: así se puede sintetizar sobre ella en marcha (ver
+  *         Conmutar_En_Vivo). La compensación y la corrección de la
+  *         calibración se aplican acá, una vez: la reproducción no tiene
+  *         costo adicional.
+  * @param  Recortadas: muestras que quedaron fuera de 0..4095
+  * @retval Buffer para el DMA
+  */
+static uint16_t * Preparar_Salida(uint32_t * Recortadas) {
+	uint16_t * libre = (Leer_Datos_DAC_DMA() == Salidas[0]) ? Salidas[1] : Salidas[0];
+	*Recortadas = Acondicionar(libre);
+	return libre;
+}
+
+/*******************************************************************************
+  * @brief  Copia maestra -> ganancia y offset -> compensación de la
+  *         retención -> corrección de la calibración. La compensación va
+  *         antes de la corrección: ésta deshace la alinealidad del DAC y
+  *         tiene que ver los códigos que se quieren a la salida.
+  * @param  Destino: GeneradorDAC2.largo muestras
+  * @retval Muestras recortadas o saturadas por la compensación
+  */
+static uint32_t Acondicionar(uint16_t * Destino) {
+	uint32_t recortadas = Acond_Procesar(GeneradorDAC2.senial, Destino, GeneradorDAC2.largo,
+			                             GeneradorDAC2.ganancia, GeneradorDAC2.offset);
+	if (Compensacion.taps) {
+		uint32_t inicio = medicionCiclos();
+		recortadas += Zoh_Compensar(&Compensacion, Destino, GeneradorDAC2.largo);
+		CiclosCompensacion = medicionCiclos() - inicio;
+		LargoCompensado = GeneradorDAC2.largo;
+	}
+	if (Corregir) Cal_Corregir(TablaCalibracion, Destino, GeneradorDAC2.largo);
+	return recortadas;
+}
+
+/*******************************************************************************
+  * @brief  Recalcula la salida con la ganancia, el offset y la corrección
+  *         actuales y pide el cambio de buffer al DMA. Fuera de Generando no
+  *         hace nada: la salida se arma al encender.
+  * @param  None
+  * @retval None
+  */
+static void Aplicar_Ajuste(void) {
+	if (GeneradorDAC2.estado != Generando) return;
+	if (CambioPendiente || Conmutador_Activo()) {
+		// El DMA todavía tiene pedido el ajuste anterior o una conmutación
+		// lee la otra salida: no está libre
+		Recalcular = true;
+		return;
+	}
+
+	uint32_t recortadas;
+	InicioAjuste = medicionCiclos();
+	uint16_t * salida = Preparar_Salida(&recortadas);
+	uint32_t ciclos = medicionCiclos() - InicioAjuste;
+	Cambiar_Datos_DAC_DMA(salida);
+	CambioPendiente = true;
+
+	uartSendLiteral("Ajuste calculado: ");
+	Informar_Costo(GeneradorDAC2.largo, ciclos, recortadas, " recortadas.\n");
+}
+
+/*******************************************************************************
+  * @brief  Decide si la próxima síntesis entra sin detener la salida: hace
+  *         falta estar generando con una política distinta de OFF, el mismo
+  *         largo (en doble buffer el DMA comparte la cuenta de las dos
+  *         memorias) y la otra salida libre. Si no, se detiene como siempre.
+  * @param  Largo: muestras de la señal que se va a sintetizar
+  * @retval true si la señal nueva va a entrar en marcha
+  */
+static bool_t Conmutar_En_Vivo(uint32_t Largo) {
+	if (GeneradorDAC2.estado != Generando || Conmutacion.politica == CONM_REINICIO) return false;
+	if (Largo != GeneradorDAC2.largo) {
+		uartSendLiteral("Otro largo: la salida se reinicia.\n");
+		return false;
+	}
+	if (CambioPendiente || Conmutador_Activo()) {
+		uartSendLiteral("Cambio en curso: la salida se reinicia.\n");
+		return false;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Luego de sintetizar en marcha: arma la salida nueva en la salida
+  *         libre y la conmutación la lleva al buffer que recorre el DMA.
+  *         Si la política no sirve para este largo, reinicia la salida.
+  * @param  Largo: muestras sintetizadas
+  * @param  Ciclos: ciclos de CPU de la síntesis
+  * @param  Saturadas: muestras fuera de 0..4095
+  * @retval None
+  */
+static void Terminar_Conmutacion(uint32_t Largo, uint32_t Ciclos, uint32_t Saturadas) {
+	uint32_t recortadas;
+	uint16_t * nueva = Preparar_Salida(&recortadas);
+
+	uartSendLiteral("Senial sintetizada: ");
+	Informar_Costo(Largo, Ciclos, Saturadas, " saturadas.\n");
+	if (Conmutador_Iniciar(&Conmutacion, nueva, Largo) != true) {
+		Liberar_Buffer();
+		Informar_Cargado();
+		Gen_Encender();
+	}
+}
@@ -0,0 +1,187 @@
+/*******************************************************************************
+  * @file		API_interpolacion.c
+  * @brief      Expansión de puntos de control a un período completo
+  *             (interpolación lineal o Catmull-Rom)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_interpolacion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define BITS_PESO			14				// Pesos en Q14: caben en 16 bits con signo
+#define UNO					(1L << BITS_PESO)
+#define BITS_POSICION		16				// Posición en el período: 16.16 (segmento.fracción)
+#define MASCARA_FRACCION	((1UL << BITS_POSICION) - 1)
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t expandirLineal(const interpolacion_t * p, uint16_t * destino);
+static uint32_t expandirCatmullRom(const interpolacion_t * p, uint16_t * destino);
+
+/*******************************************************************************
+  * @brief  Vacía la lista de puntos y carga valores por defecto.
+  * @param  p: interpolación
+  * @retval None
+  */
+void Interp_Iniciar(interpolacion_t * p) {
+	p->largo = 1000;
+	p->metodo = INTERP_CATMULL_ROM;
+	p->cantidad = 0;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[N=..] [MODE=LIN|CR]".
+  * @param  texto: argumentos del comando INTERP (se modifica)
+  * @param  p: interpolación
+  * @retval true si el texto es válido
+  */
+bool_t Interp_Interpretar(char * texto, interpolacion_t * p) {
+	char * token = strtok(texto, " ");
+
+	while (token != NULL) {
+		char * igual = strchr(token, '=');
+		if (igual == NULL) return false;
+		*igual = '\0';
+		char * valor = igual + 1;
+		int32_t numero;
+
+		if (strcmp(token, "N") == 0) {
+			if (Num_Leer(valor, 2, INT32_MAX, &numero, NULL) != true) return false;
+			p->largo = (uint32_t) numero;
+		} else if (strcmp(token, "MODE") == 0) {
+			if      (strcmp(valor, "LIN") == 0) p->metodo = INTERP_LINEAL;
+			else if (strcmp(valor, "CR") == 0)  p->metodo = INTERP_CATMULL_ROM;
+			else return false;
+		}
+		else return false;
+
+		token = strtok(NULL, " ");
+	}
+	return (p->largo >= 2);
+}
+
+/*******************************************************************************
+  * @brief  Agrega un punto de control.
+  * @param  p: interpolación
+  * @param  punto: valor de 12 bits
+  * @retval true si había lugar y el valor es válido
+  */
+bool_t Interp_Agregar(interpolacion_t * p, uint16_t punto) {
+	if (p->cantidad >= INTERP_MAX_PUNTOS || punto > SINT_MAX_DAC) return false;
+	p->puntos[p->cantidad++] = punto;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Verifica que haya al menos 2 puntos y no más que muestras.
+  * @param  p: interpolación
+  * @retval true si se puede expandir
+  */
+bool_t Interp_Valido(const interpolacion_t * p) {
+	return (p->cantidad >= 2 && p->largo >= p->cantidad);
+}
+
+/*******************************************************************************
+  * @brief  Expande los K puntos a N muestras. El punto j cae en la muestra
+  *         j*N/K. Los valores fuera de 0..4095 se saturan.
+  * @param  p: interpolación (Interp_Valido)
+  * @param  destino: p->largo muestras
+  * @retval Cantidad de muestras saturadas
+  */
+uint32_t Interp_Expandir(const interpolacion_t * p, uint16_t * destino) {
+	if (p->metodo == INTERP_LINEAL) return expandirLineal(p, destino);
+	return expandirCatmullRom(p, destino);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*
+ * La posición avanza K/N puntos por muestra en 16.16. El resto de la división
+ * se acumula como en API_sintesis, así la muestra N cae exactamente en el
+ * punto K (= punto 0 del período siguiente).
+ */
+
+/*******************************************************************************
+  * @brief  Lineal: v = P[j] (1 - t) + P[j+1] t, los dos productos con un SMUAD
+  *         sobre los puntos empaquetados (se re-empaquetan al cambiar de tramo).
+  */
+static uint32_t expandirLineal(const interpolacion_t * p, uint16_t * destino) {
+	const uint64_t avance = (uint64_t) p->cantidad << BITS_POSICION;
+	uint32_t paso = (uint32_t) (avance / p->largo);
+	uint32_t resto = (uint32_t) (avance % p->largo);
+	uint32_t error = 0;
+	uint32_t posicion = 0;
+	uint32_t tramo = UINT32_MAX;
+	uint32_t puntos = 0;
+
+	for (uint32_t n=0; n<p->largo; n++) {
+		uint32_t j = posicion >> BITS_POSICION;
+		if (j != tramo) {
+			tramo = j;
+			uint32_t siguiente = (j + 1 < p->cantidad) ? j + 1 : 0;
+			puntos = __PKHBT(p->puntos[j], p->puntos[siguiente], 16);
+		}
+		int32_t t = (int32_t) ((posicion & MASCARA_FRACCION) >> (BITS_POSICION - BITS_PESO));
+		uint32_t pesos = __PKHBT(UNO - t, t, 16);
+		destino[n] = (uint16_t) (((int32_t) __SMUAD(puntos, pesos) + (UNO >> 1)) >> BITS_PESO);
+
+		posicion += paso;
+		error += resto;
+		if (error >= p->largo) {
+			error -= p->largo;
+			posicion++;
+		}
+	}
+	return 0;		// Entre dos valores de 12 bits: nunca satura
+}
+
+/*******************************************************************************
+  * @brief  Catmull-Rom: v = sum P[j-1+i] w_i(t), con los pesos
+  *           w0 = (-t^3 + 2t^2 - t)/2     w1 = (3t^3 - 5t^2 + 2)/2
+  *           w2 = (-3t^3 + 4t^2 + t)/2    w3 = (t^3 - t^2)/2
+  *         Los pesos dependen sólo de t (Q14, caben en 16 bits) y los cuatro
+  *         productos se hacen con un SMUAD y un SMLAD.
+  */
+static uint32_t expandirCatmullRom(const interpolacion_t * p, uint16_t * destino) {
+	const uint64_t avance = (uint64_t) p->cantidad << BITS_POSICION;
+	const uint32_t K = p->cantidad;
+	uint32_t paso = (uint32_t) (avance / p->largo);
+	uint32_t resto = (uint32_t) (avance % p->largo);
+	uint32_t error = 0;
+	uint32_t posicion = 0;
+	uint32_t tramo = UINT32_MAX;
+	uint32_t puntos01 = 0, puntos23 = 0;
+	uint32_t saturadas = 0;
+
+	for (uint32_t n=0; n<p->largo; n++) {
+		uint32_t j = posicion >> BITS_POSICION;
+		if (j != tramo) {
+			tramo = j;
+			puntos01 = __PKHBT(p->puntos[(j + K - 1) % K], p->puntos[j], 16);
+			puntos23 = __PKHBT(p->puntos[(j + 1) % K], p->puntos[(j + 2) % K], 16);
+		}
+		int32_t t = (int32_t) ((posicion & MASCARA_FRACCION) >> (BITS_POSICION - BITS_PESO));
+		int32_t t2 = (t * t) >> BITS_PESO;
+		int32_t t3 = (t2 * t) >> BITS_PESO;
+		int32_t w0 = (-t3 + 2 * t2 - t) >> 1;
+		int32_t w1 = (3 * t3 - 5 * t2 + 2 * UNO) >> 1;
+		int32_t w2 = (-3 * t3 + 4 * t2 + t) >> 1;
+		int32_t w3 = (t3 - t2) >> 1;
+
+		int32_t suma = (int32_t) __SMLAD(puntos23, __PKHBT(w2, w3, 16),
+		                                 __SMUAD(puntos01, __PKHBT(w0, w1, 16)));
+		int32_t v = (suma + (UNO >> 1)) >> BITS_PESO;
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[n] = (uint16_t) s;
+
+		posicion += paso;
+		error += resto;
+		if (error >= p->largo) {
+			error -= p->largo;
+			posicion++;
+		}
+	}
+	return saturadas;
+}
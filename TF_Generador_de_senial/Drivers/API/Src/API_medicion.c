@@ -0,0 +1,35 @@
+/*******************************************************************************
+* @file    API_medicion.c
+* @author  Guillermo Caporaletti
+* @brief   Medición de tiempos de ejecución con el contador de ciclos DWT
+*          del Cortex-M4.
+*******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_medicion.h"
+
+/* Functions -----------------------------------------------------------------*/
+
+/*******************************************************************************
+* @brief  Habilita el trazado y el contador de ciclos CYCCNT.
+*         Las diferencias entre dos lecturas se calculan en uint32_t,
+*         por lo que el desborde del contador no afecta la medición.
+* @param  None
+* @retval None
+*/
+void medicionInit(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*******************************************************************************
+* @brief  Devuelve la cuenta actual de ciclos de CPU.
+* @param  None
+* @retval Ciclos transcurridos desde medicionInit()
+*/
+uint32_t medicionCiclos(void) {
+	return DWT->CYCCNT;
+}
+
+/***************************************************************END OF FILE****/
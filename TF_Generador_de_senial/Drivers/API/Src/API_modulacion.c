@@ -0,0 +1,400 @@
+/*******************************************************************************
+  * @file		API_modulacion.c
+  * @brief      Modulación AM, FM, PM y PWM en punto fijo (ver API_modulacion.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_modulacion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define CENTRO_DAC		2048		// Cero de la portadora de tabla
+#define UNO_Q30			(1L << 30)
+#define CUARTO_CICLO	0x40000000UL
+#define MEDIO_CICLO		0x80000000UL
+
+/* Variables privadas --------------------------------------------------------*/
+static const char * const NombreTipo[MOD_TIPOS] = {
+	[MOD_AM] = "AM", [MOD_FM] = "FM", [MOD_PM] = "PM", [MOD_PWM] = "PWM"
+};
+
+static const char * const NombreForma[] = {
+	[MOD_SENO] = "SINE", [MOD_TRIANGULAR] = "TRIANGLE", [MOD_CUADRADA] = "SQUARE"
+};
+
+/* Prototipos privados -------------------------------------------------------*/
+static void generarModulante(estadoModulacion_t * e, uint32_t cantidad);
+static uint32_t generarAM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa);
+static uint32_t generarFM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa);
+static uint32_t generarPM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa);
+static uint32_t generarPWM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa);
+static inline int32_t portadora(const estadoModulacion_t * e, uint32_t fase);
+static uint32_t pasoDeFrecuencia(uint32_t f, uint32_t reloj, uint32_t divisor);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Parámetros por defecto: AM de un seno de 10 kHz por un seno de
+  *         100 Hz al 50%, con pico a escala completa.
+  * @param  m: parámetros a inicializar
+  * @retval None
+  */
+void Mod_Defecto(modulacion_t * m) {
+	m->tipo = MOD_AM;
+	m->forma = MOD_SENO;
+	m->tabla = false;
+	m->portadora = 10000;
+	m->modulante = 100;
+	m->profundidad = 50;
+	m->desvio = 1000;
+	m->amplitud = 1365;			// 1365 x 1,5 = 2047
+	m->offset = 2048;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[AM|FM|PM|PWM] [FC=..] [FMOD=..] [DEPTH=..] [DEV=..]
+  *         [WAVE=SINE|TRIANGLE|SQUARE] [CAR=SINE|TABLE] [AMP=..] [OFF=..]".
+  *         Lo que no aparece conserva su valor. Modifica el texto (strtok).
+  *         Los límites que dependen de fs los verifica Mod_Calcular().
+  * @param  texto: argumentos del comando
+  * @param  m: parámetros a modificar
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Mod_Interpretar(char * texto, modulacion_t * m) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		uint8_t i;
+		for (i=0; i<MOD_TIPOS; i++) {
+			if (strcmp(token, NombreTipo[i]) == 0) break;
+		}
+		if (i < MOD_TIPOS) {
+			m->tipo = (tipoModulacion_t) i;
+		} else {
+			char * igual = strchr(token, '=');
+			if (igual == NULL) return false;
+			*igual = '\0';
+			const char * textoValor = igual + 1;
+
+			if (strcmp(token, "WAVE") == 0) {
+				for (i=0; i<sizeof(NombreForma)/sizeof(NombreForma[0]); i++) {
+					if (strcmp(textoValor, NombreForma[i]) == 0) break;
+				}
+				if (i == sizeof(NombreForma)/sizeof(NombreForma[0])) return false;
+				m->forma = (formaModulante_t) i;
+			} else if (strcmp(token, "CAR") == 0) {
+				if (strcmp(textoValor, "SINE") == 0) m->tabla = false;
+				else if (strcmp(textoValor, "TABLE") == 0) m->tabla = true;
+				else return false;
+			} else if (strcmp(token, "FC") == 0) {
+				if (Num_Leer(textoValor, 0, MOD_MAX_FRECUENCIA, &valor, NULL) != true) return false;
+				m->portadora = (uint32_t) valor;
+			} else if (strcmp(token, "FMOD") == 0) {
+				if (Num_Leer(textoValor, 0, MOD_MAX_FRECUENCIA, &valor, NULL) != true) return false;
+				m->modulante = (uint32_t) valor;
+			} else if (strcmp(token, "DEPTH") == 0) {
+				if (Num_Leer(textoValor, 0, 100, &valor, NULL) != true) return false;
+				m->profundidad = (uint32_t) valor;
+			} else if (strcmp(token, "DEV") == 0) {
+				if (Num_Leer(textoValor, 0, MOD_MAX_FRECUENCIA, &valor, NULL) != true) return false;
+				m->desvio = (uint32_t) valor;
+			} else if (strcmp(token, "AMP") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				m->amplitud = valor;
+			} else if (strcmp(token, "OFF") == 0) {
+				if (Num_Leer(textoValor, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+				m->offset = valor;
+			} else return false;
+		}
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Convierte los parámetros a pasos de fase para fs = reloj / divisor.
+  * @param  a: resultado
+  * @param  m: parámetros
+  * @param  reloj: Hz del reloj de los disparos (FRECUENCIA_TIM2)
+  * @param  divisor: ciclos de reloj por muestra (ARR + 1)
+  * @retval false si FC o FMOD llegan a fs / 2, si en FM FC + DEV llega a
+  *         fs / 2 o si en PM el desvío pasa de MOD_MAX_GRADOS
+  */
+bool_t Mod_Calcular(ajusteModulacion_t * a, const modulacion_t * m, uint32_t reloj, uint32_t divisor) {
+	if (divisor == 0) return false;
+	if ((uint64_t) m->portadora * divisor * 2 >= reloj) return false;
+	if ((uint64_t) m->modulante * divisor * 2 >= reloj) return false;
+	if (m->profundidad > 100) return false;
+
+	a->p = *m;
+	a->pasoPortadora = pasoDeFrecuencia(m->portadora, reloj, divisor);
+	a->pasoModulante = pasoDeFrecuencia(m->modulante, reloj, divisor);
+	switch (m->tipo) {
+	case MOD_FM:
+		if (((uint64_t) m->portadora + m->desvio) * divisor * 2 >= reloj) return false;
+		a->indice = (int32_t) pasoDeFrecuencia(m->desvio, reloj, divisor);
+		break;
+	case MOD_PM:
+		if (m->desvio > MOD_MAX_GRADOS) return false;
+		a->indice = (int32_t) Sint_Grados(m->desvio);
+		break;
+	default:
+		a->indice = (int32_t) (((int64_t) m->profundidad * UNO_Q30) / 100);
+		break;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Prepara la modulación con las fases en cero y el índice ya en su
+  *         valor (sin rampa de entrada).
+  * @param  e: estado a inicializar
+  * @param  a: parámetros convertidos (Mod_Calcular)
+  * @param  tabla: un período de la portadora, en códigos del DAC
+  *         (sólo con CAR=TABLE)
+  * @param  largo: muestras de la tabla
+  * @retval false si CAR=TABLE y no hay tabla
+  */
+bool_t Mod_Preparar(estadoModulacion_t * e, const ajusteModulacion_t * a, const uint16_t * tabla, uint32_t largo) {
+	if (a->p.tabla && (tabla == NULL || largo == 0)) return false;
+	e->a = *a;
+	e->tabla = a->p.tabla ? tabla : NULL;
+	e->largo = largo;
+	e->fasePortadora = 0;
+	e->faseModulante = 0;
+	e->indice = a->indice;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Cambia frecuencias e índice sin cortar la salida. Las fases
+  *         siguen desde donde estaban; el índice llega al nuevo valor de a
+  *         poco (ver MOD_SUAVIZADO). Tipo, forma, portadora, amplitud y
+  *         offset no cambian.
+  * @param  e: estado en uso
+  * @param  a: parámetros convertidos (Mod_Calcular)
+  * @retval None
+  */
+void Mod_Ajustar(estadoModulacion_t * e, const ajusteModulacion_t * a) {
+	e->a.p.portadora = a->p.portadora;
+	e->a.p.modulante = a->p.modulante;
+	e->a.p.profundidad = a->p.profundidad;
+	e->a.p.desvio = a->p.desvio;
+	e->a.pasoPortadora = a->pasoPortadora;
+	e->a.pasoModulante = a->pasoModulante;
+	e->a.indice = a->indice;
+}
+
+/*******************************************************************************
+  * @brief  Genera las próximas muestras, saturadas a 12 bits.
+  * @param  e: estado (preparado con Mod_Preparar)
+  * @param  destino: muestras para el DAC
+  * @param  cantidad: muestras a generar (cada MOD_BLOQUE_MAXIMO muestras
+  *         hay un paso del suavizado)
+  * @retval Muestras saturadas
+  */
+uint32_t Mod_Generar(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad) {
+	uint32_t saturadas = 0;
+
+	while (cantidad > 0) {
+		uint32_t n = (cantidad < MOD_BLOQUE_MAXIMO) ? cantidad : MOD_BLOQUE_MAXIMO;
+
+		// Suavizado: el índice termina el bloque 1/2^MOD_SUAVIZADO más cerca
+		int32_t falta = e->a.indice - e->indice;
+		int32_t fin = (falta >> MOD_SUAVIZADO == 0) ? e->a.indice : e->indice + (falta >> MOD_SUAVIZADO);
+		int32_t rampa = (fin - e->indice) / (int32_t) n;
+
+		generarModulante(e, n);
+		switch (e->a.p.tipo) {
+		case MOD_AM:  saturadas += generarAM(e, destino, n, rampa);  break;
+		case MOD_FM:  saturadas += generarFM(e, destino, n, rampa);  break;
+		case MOD_PM:  saturadas += generarPM(e, destino, n, rampa);  break;
+		default:      saturadas += generarPWM(e, destino, n, rampa); break;
+		}
+		e->indice = fin;
+		destino += n;
+		cantidad -= n;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Nombre del tipo de modulación (como en el comando MOD)
+  * @param  tipo: tipo de modulación
+  * @retval Texto
+  */
+const char * Mod_Nombre(tipoModulacion_t tipo) {
+	return (tipo < MOD_TIPOS) ? NombreTipo[tipo] : "?";
+}
+
+/*******************************************************************************
+  * @brief  Nombre de la forma de la modulante (como en WAVE=)
+  * @param  forma: forma de la modulante
+  * @retval Texto
+  */
+const char * Mod_Nombre_Forma(formaModulante_t forma) {
+	return (forma <= MOD_CUADRADA) ? NombreForma[forma] : "?";
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Calcula la modulante del bloque (Q15) y avanza su fase.
+  *         La triangular empieza en cero y subiendo, como el seno. Las tres
+  *         tienen media cero: en FM un sesgo de la modulante es un corrimiento
+  *         de la portadora.
+  */
+static void generarModulante(estadoModulacion_t * e, uint32_t cantidad) {
+	uint32_t fase = e->faseModulante;
+	uint32_t paso = e->a.pasoModulante;
+	int16_t * s = e->modulante;
+
+	switch (e->a.p.forma) {
+	case MOD_SENO:
+		for (uint32_t i=0; i<cantidad; i++, fase += paso) s[i] = (int16_t) Sint_Seno(fase);
+		break;
+	case MOD_TRIANGULAR:
+		for (uint32_t i=0; i<cantidad; i++, fase += paso) {
+			uint32_t f = fase + CUARTO_CICLO;
+			uint32_t t = (f & MEDIO_CICLO) ? ~f : f;			// 0 .. 2^31 - 1
+			s[i] = (int16_t) ((int32_t) (t >> 16) * 2 - 32767);
+		}
+		break;
+	default:
+		for (uint32_t i=0; i<cantidad; i++, fase += paso) s[i] = (fase & MEDIO_CICLO) ? -32767 : 32767;
+		break;
+	}
+	e->faseModulante = fase;
+}
+
+/**
+  * @brief AM: envolvente 1 + m x s en Q15 (0 .. 2), m en Q30
+  */
+static uint32_t generarAM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa) {
+	uint32_t saturadas = 0;
+	uint32_t fase = e->fasePortadora;
+	uint32_t paso = e->a.pasoPortadora;
+	int32_t indice = e->indice;
+	int32_t amplitud = e->a.p.amplitud;
+	int32_t offset = e->a.p.offset;
+
+	for (uint32_t i=0; i<cantidad; i++) {
+		int32_t envolvente = 32768 + (((indice >> 15) * e->modulante[i]) >> 15);
+		int32_t c = (portadora(e, fase) * envolvente) >> 15;
+		int32_t valor = offset + ((amplitud * c) >> 15);
+		uint32_t muestra = __USAT(valor, 12);
+		if ((int32_t) muestra != valor) saturadas++;
+		destino[i] = (uint16_t) muestra;
+		fase += paso;
+		indice += rampa;
+	}
+	e->fasePortadora = fase;
+	return saturadas;
+}
+
+/**
+  * @brief FM: el paso de la portadora suma desvío x s
+  */
+static uint32_t generarFM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa) {
+	uint32_t saturadas = 0;
+	uint32_t fase = e->fasePortadora;
+	uint32_t paso = e->a.pasoPortadora;
+	int32_t indice = e->indice;
+	int32_t amplitud = e->a.p.amplitud;
+	int32_t offset = e->a.p.offset;
+
+	for (uint32_t i=0; i<cantidad; i++) {
+		int32_t valor = offset + ((amplitud * portadora(e, fase)) >> 15);
+		uint32_t muestra = __USAT(valor, 12);
+		if ((int32_t) muestra != valor) saturadas++;
+		destino[i] = (uint16_t) muestra;
+		fase += paso + (uint32_t) (int32_t) (((int64_t) indice * e->modulante[i]) >> 15);
+		indice += rampa;
+	}
+	e->fasePortadora = fase;
+	return saturadas;
+}
+
+/**
+  * @brief PM: la fase de la portadora suma desvío x s
+  */
+static uint32_t generarPM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa) {
+	uint32_t saturadas = 0;
+	uint32_t fase = e->fasePortadora;
+	uint32_t paso = e->a.pasoPortadora;
+	int32_t indice = e->indice;
+	int32_t amplitud = e->a.p.amplitud;
+	int32_t offset = e->a.p.offset;
+
+	for (uint32_t i=0; i<cantidad; i++) {
+		uint32_t desplazada = fase + (uint32_t) (int32_t) (((int64_t) indice * e->modulante[i]) >> 15);
+		int32_t valor = offset + ((amplitud * portadora(e, desplazada)) >> 15);
+		uint32_t muestra = __USAT(valor, 12);
+		if ((int32_t) muestra != valor) saturadas++;
+		destino[i] = (uint16_t) muestra;
+		fase += paso;
+		indice += rampa;
+	}
+	e->fasePortadora = fase;
+	return saturadas;
+}
+
+/**
+  * @brief PWM: alto mientras la fase no llega al umbral 2^31 x (1 + m x s),
+  *        m en Q30. Ignora la tabla: la portadora es el pulso.
+  */
+static uint32_t generarPWM(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad, int32_t rampa) {
+	uint32_t saturadas = 0;
+	uint32_t fase = e->fasePortadora;
+	uint32_t paso = e->a.pasoPortadora;
+	int32_t indice = e->indice;
+	int32_t alto = e->a.p.offset + e->a.p.amplitud;
+	int32_t bajo = e->a.p.offset - e->a.p.amplitud;
+
+	// Los dos niveles son fijos: se saturan una vez
+	uint16_t nivelAlto = (uint16_t) __USAT(alto, 12);
+	uint16_t nivelBajo = (uint16_t) __USAT(bajo, 12);
+	bool_t saturaAlto = ((int32_t) nivelAlto != alto);
+	bool_t saturaBajo = ((int32_t) nivelBajo != bajo);
+
+	for (uint32_t i=0; i<cantidad; i++) {
+		uint32_t umbral = MEDIO_CICLO + (uint32_t) (int32_t) (((int64_t) indice * e->modulante[i]) >> 14);
+		if (fase < umbral) {
+			destino[i] = nivelAlto;
+			saturadas += saturaAlto;
+		} else {
+			destino[i] = nivelBajo;
+			saturadas += saturaBajo;
+		}
+		fase += paso;
+		indice += rampa;
+	}
+	e->fasePortadora = fase;
+	return saturadas;
+}
+
+/**
+  * @brief Portadora en Q15: seno, o la tabla con interpolación lineal
+  *        (código - CENTRO_DAC, en Q15). La posición en la tabla sale de
+  *        fase x largo: la tabla puede tener cualquier largo.
+  */
+static inline int32_t portadora(const estadoModulacion_t * e, uint32_t fase) {
+	if (e->tabla == NULL) return Sint_Seno(fase);
+
+	uint64_t posicion = (uint64_t) fase * e->largo;			// Q32: muestras
+	uint32_t i = (uint32_t) (posicion >> 32);
+	uint32_t j = (i + 1 == e->largo) ? 0 : i + 1;
+	int32_t x0 = e->tabla[i];
+	int32_t x1 = e->tabla[j];
+	int32_t fraccion = (int32_t) ((uint32_t) posicion >> 17);	// Q15
+	return ((x0 - CENTRO_DAC) << 4) + (((x1 - x0) * fraccion) >> 11);
+}
+
+/**
+  * @brief Paso de fase Q0.32 de f Hz con fs = reloj / divisor (f < fs / 2)
+  */
+static uint32_t pasoDeFrecuencia(uint32_t f, uint32_t reloj, uint32_t divisor) {
+	return (uint32_t) ((((uint64_t) f * divisor) << 32) / reloj);
+}
@@ -0,0 +1,282 @@
+/*******************************************************************************
+  * @file		API_modulador.c
+  * @brief      Modulación en tiempo real por el DAC2 (ver API_modulador.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_modulador.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static estadoModulacion_t estado;
+static uint16_t bufferDMA[2 * MOD_MITAD];
+static volatile modContadores_t contadores;
+static ajusteModulacion_t ajuste;
+static const ajusteModulacion_t * volatile pendiente = NULL;	// Ajuste para el próximo bloque
+static uint32_t costo[MOD_TIPOS];		// Ciclos por bloque de cada tipo, medidos al arrancar
+static bool_t enMarcha = false;
+static estadoModulacion_t prueba;		// Para medir el costo de cada tipo
+
+// Portadora de tabla para medir sin señal cargada (el costo no depende del largo)
+static const uint16_t tablaPrueba[2] = { 0, 0 };
+
+/* Prototipos privados -------------------------------------------------------*/
+static void recargar(uint16_t * mitad, uint32_t cantidad);
+static void medirCostos(const modulacion_t * m, uint32_t ciclos[MOD_TIPOS]);
+static void generarPrueba(uint16_t * destino, uint32_t cantidad);
+static const char * nombreTipo(uint32_t tipo);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Arranca la modulación con la frecuencia de muestras actual de
+  *         TIM2, luego de medir el costo de cada tipo. Informa con
+  *         Modulador_Informar().
+  * @param  m: parámetros (ver Mod_Interpretar)
+  * @param  tabla: un período de la portadora (CAR=TABLE) o NULL
+  * @param  largo: muestras de la tabla
+  * @retval false si la modulación no entra en la frecuencia de muestras o
+  *         falta la tabla (ya informado por UART)
+  */
+bool_t Modulador_Iniciar(const modulacion_t * m, const uint16_t * tabla, uint32_t largo) {
+	static ajusteModulacion_t nuevo;
+	if (Mod_Calcular(&nuevo, m, FRECUENCIA_TIM2, Leer_Periodo_DAC_DMA() + 1) != true) {
+		uartSendLiteral("Modulacion invalida para la frecuencia de muestras (FC, FMOD y en FM"
+				        " FC + DEV menores que fs/2, PM hasta 179 grados).\n");
+		return false;
+	}
+	if (m->tabla && (tabla == NULL || largo == 0)) {
+		uartSendLiteral("No hay senial cargada para CAR=TABLE.\n");
+		return false;
+	}
+	if (enMarcha) Modulador_Parar();
+	medirCostos(m, costo);
+	if (Mod_Preparar(&estado, &nuevo, tabla, largo) != true) Error_Handler();
+	memset((void *) &contadores, 0, sizeof(contadores));
+	pendiente = NULL;
+
+	Bloques_Comenzar(bufferDMA, MOD_MITAD, recargar);
+	enMarcha = true;
+
+	Modulador_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Indica si los parámetros nuevos se pueden aplicar en marcha:
+  *         mismo tipo, modulante, portadora, amplitud y offset.
+  * @param  m: parámetros nuevos
+  * @retval true si alcanza con Modulador_Aplicar()
+  */
+bool_t Modulador_Compatible(const modulacion_t * m) {
+	const modulacion_t * actual = &estado.a.p;
+	return enMarcha && m->tipo == actual->tipo && m->forma == actual->forma && m->tabla == actual->tabla
+			&& m->amplitud == actual->amplitud && m->offset == actual->offset;
+}
+
+/*******************************************************************************
+  * @brief  Cambia frecuencias, profundidad y desvío sin cortar la salida.
+  *         Entra al comienzo del próximo bloque.
+  * @param  m: parámetros nuevos (compatibles, ver Modulador_Compatible)
+  * @retval false si no hay modulación en marcha o los parámetros no entran
+  *         en la frecuencia de muestras (ya informado por UART)
+  */
+bool_t Modulador_Aplicar(const modulacion_t * m) {
+	if (!enMarcha) return false;
+	pendiente = NULL;				// La interrupción ya no toma el ajuste
+	if (Mod_Calcular(&ajuste, m, FRECUENCIA_TIM2, Leer_Periodo_DAC_DMA() + 1) != true) {
+		uartSendLiteral("Modulacion invalida para la frecuencia de muestras.\n");
+		return false;
+	}
+	pendiente = &ajuste;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene la modulación (la salida queda en la última muestra) e
+  *         informa: "FIN MOD bloques= sat= atrasos= ajustes="
+  * @param  None
+  * @retval None
+  */
+void Modulador_Parar(void) {
+	if (!enMarcha) return;
+	Bloques_Parar();
+	pendiente = NULL;
+	enMarcha = false;
+
+	char informe[80];
+	char * fin = Num_AgregarTexto(informe, "FIN MOD bloques=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.bloques);
+	fin = Num_AgregarTexto(fin, " sat=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " atrasos=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.atrasos);
+	fin = Num_AgregarTexto(fin, " ajustes=");
+	fin = Num_AgregarDecimal(fin, contadores.ajustes);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay una modulación en marcha
+  * @param  None
+  * @retval true si el DAC está modulando
+  */
+bool_t Modulador_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores de la modulación en curso (o la última).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Modulador_Contadores(modContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+}
+
+/*******************************************************************************
+  * @brief  Informa la modulación y su costo con la frecuencia actual:
+  *         "MOD=ON TIPO= FC= FMOD= DEPTH=|DEV= WAVE= CAR= FS= CICLOS=<último
+  *          bloque> MAX=<peor bloque> PRESUPUESTO= (por muestra) CARGA=<%>
+  *          FS_MAX= SAT= ATRASOS= AJUSTES="
+  *         FS_MAX estima la frecuencia de muestras a la que el peor bloque
+  *         ocuparía toda la CPU.
+  * @param  None
+  * @retval None
+  */
+void Modulador_Informar(void) {
+	char informe[224];
+	modContadores_t c;
+
+	if (!enMarcha) {
+		uartSendLiteral("MOD=OFF\n");
+		return;
+	}
+	Modulador_Contadores(&c);
+	const modulacion_t * p = &estado.a.p;
+	uint32_t divisor = Leer_Periodo_DAC_DMA() + 1;
+
+	char * fin = Num_AgregarTexto(informe, "MOD=ON TIPO=");
+	fin = Num_AgregarTexto(fin, Mod_Nombre(p->tipo));
+	fin = Num_AgregarTexto(fin, " FC=");
+	fin = Num_AgregarDecimal(fin, p->portadora);
+	fin = Num_AgregarTexto(fin, " FMOD=");
+	fin = Num_AgregarDecimal(fin, p->modulante);
+	if (p->tipo == MOD_FM || p->tipo == MOD_PM) {
+		fin = Num_AgregarTexto(fin, " DEV=");
+		fin = Num_AgregarDecimal(fin, p->desvio);
+	} else {
+		fin = Num_AgregarTexto(fin, " DEPTH=");
+		fin = Num_AgregarDecimal(fin, p->profundidad);
+	}
+	fin = Num_AgregarTexto(fin, " WAVE=");
+	fin = Num_AgregarTexto(fin, Mod_Nombre_Forma(p->forma));
+	fin = Num_AgregarTexto(fin, p->tabla ? " CAR=TABLE" : " CAR=SINE");
+	fin = Num_AgregarTexto(fin, " FS=");
+	fin = Num_AgregarDecimal(fin, FRECUENCIA_TIM2 / divisor);
+	fin = Bloques_AgregarCosto(fin, &c.bloque, MOD_MITAD);
+	fin = Num_AgregarTexto(fin, " FS_MAX=");
+	fin = Num_AgregarDecimal(fin, Bloques_Fs_Maxima(c.bloque.ciclosMaximo, MOD_MITAD, 100));
+	fin = Num_AgregarTexto(fin, " SAT=");
+	fin = Num_AgregarDecimal(fin, c.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " ATRASOS=");
+	fin = Num_AgregarDecimal(fin, c.bloque.atrasos);
+	fin = Num_AgregarTexto(fin, " AJUSTES=");
+	fin = Num_AgregarDecimal(fin, c.ajustes);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Informa la frecuencia de muestras máxima de cada tipo de
+  *         modulación si puede usar 'porcentaje' de la CPU:
+  *         "FS_MAX CPU=<%> AM= FM= PM= PWM= CICLOS AM= FM= PM= PWM="
+  *         (ciclos por muestra). En marcha usa lo medido al arrancar; si no,
+  *         mide ahora con la portadora y la modulante de 'm'.
+  * @param  m: parámetros (sólo importan la portadora y la modulante)
+  * @param  porcentaje: fracción de la CPU para la modulación, 1..100
+  * @retval None
+  */
+void Modulador_Capacidad(const modulacion_t * m, uint32_t porcentaje) {
+	uint32_t ciclos[MOD_TIPOS];
+	char informe[160];
+
+	if (enMarcha) memcpy(ciclos, costo, sizeof(ciclos));
+	else medirCostos(m, ciclos);
+
+	char * fin = Num_AgregarTexto(informe, "FS_MAX CPU=");
+	fin = Num_AgregarDecimal(fin, porcentaje);
+	fin = Num_AgregarTexto(fin, "%");
+	fin = Bloques_AgregarCapacidad(fin, ciclos, MOD_TIPOS, nombreTipo, porcentaje, MOD_MITAD);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Toma el ajuste pendiente y genera la mitad que el DAC ya leyó.
+  *         Contexto de interrupción (salvo las dos primeras).
+  * @param  mitad: mitad del buffer del DMA
+  * @param  cantidad: muestras de esa mitad (un bloque)
+  * @retval None
+  */
+static void recargar(uint16_t * mitad, uint32_t cantidad) {
+	uint32_t inicio = medicionCiclos();
+	const ajusteModulacion_t * nuevo = pendiente;
+	if (nuevo != NULL) {
+		Mod_Ajustar(&estado, nuevo);
+		pendiente = NULL;
+		contadores.ajustes++;
+	}
+	contadores.bloque.saturadas += Mod_Generar(&estado, mitad, cantidad);
+	Bloques_Registrar(&contadores.bloque, inicio, cantidad);
+}
+
+/*******************************************************************************
+  * @brief  Mide los ciclos de un bloque de cada tipo con la portadora y la
+  *         modulante de 'm'. El costo no depende de las frecuencias: si no
+  *         entran en la fs actual se mide con frecuencias en cero.
+  * @param  m: parámetros
+  * @param  ciclos: ciclos por bloque de MOD_MITAD muestras, por tipo
+  * @retval None
+  */
+static void medirCostos(const modulacion_t * m, uint32_t ciclos[MOD_TIPOS]) {
+	static ajusteModulacion_t a;
+	static uint16_t destino[MOD_MITAD];
+	uint32_t divisor = Leer_Periodo_DAC_DMA() + 1;
+
+	for (uint32_t t=0; t<MOD_TIPOS; t++) {
+		modulacion_t q = *m;
+		q.tipo = (tipoModulacion_t) t;
+		if (Mod_Calcular(&a, &q, FRECUENCIA_TIM2, divisor) != true) {
+			q.portadora = 0;
+			q.modulante = 0;
+			q.desvio = 0;
+			if (Mod_Calcular(&a, &q, FRECUENCIA_TIM2, divisor) != true) Error_Handler();
+		}
+		if (Mod_Preparar(&prueba, &a, tablaPrueba, sizeof(tablaPrueba) / sizeof(tablaPrueba[0])) != true) {
+			Error_Handler();
+		}
+		ciclos[t] = Bloques_Medir(generarPrueba, destino, MOD_MITAD);
+	}
+}
+
+/**
+  * @brief Un bloque con el estado de prueba (ver Bloques_Medir)
+  */
+static void generarPrueba(uint16_t * destino, uint32_t cantidad) {
+	Mod_Generar(&prueba, destino, cantidad);
+}
+
+/**
+  * @brief Nombre de cada tipo para Bloques_AgregarCapacidad
+  */
+static const char * nombreTipo(uint32_t tipo) {
+	return Mod_Nombre((tipoModulacion_t) tipo);
+}
@@ -0,0 +1,143 @@
+/*******************************************************************************
+* @file    API_numeros.c
+* @author  Guillermo Caporaletti
+* @brief   Lectura y escritura de números decimales sin la biblioteca C
+*          (reemplaza atoi, strtol y sprintf en el camino de la UART).
+*          No reserva memoria: todo se escribe en buffers del llamador.
+*******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_numeros.h"
+
+/* Functions -----------------------------------------------------------------*/
+
+/*******************************************************************************
+* @brief  Prepara el acumulador para un número nuevo.
+* @param  a: acumulador
+* @param  maximo: mayor valor admitido (p.ej. 4095 para una muestra)
+* @retval None
+*/
+void Num_Iniciar(acumuladorDecimal_t * a, uint32_t maximo) {
+	a->valor = 0;
+	a->maximo = maximo;
+	a->digitos = 0;
+	a->fueraDeRango = false;
+}
+
+/*******************************************************************************
+* @brief  Agrega un dígito. Una vez que el número supera 'maximo' se deja de
+*         acumular, así nunca desborda (sin importar cuántos dígitos lleguen).
+* @param  a: acumulador
+* @param  caracter: '0'..'9'
+* @retval false si el caracter no es un dígito
+*/
+bool_t Num_Digito(acumuladorDecimal_t * a, uint8_t caracter) {
+	uint32_t digito = (uint32_t) caracter - '0';
+	if (digito > 9) return false;
+
+	a->digitos++;
+	if (!a->fueraDeRango) {
+		// valor * 10 + digito > maximo, sin calcular valor * 10
+		if (digito > a->maximo || a->valor > (a->maximo - digito) / 10) {
+			a->fueraDeRango = true;
+		} else {
+			a->valor = a->valor * 10 + digito;
+		}
+	}
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Indica si el acumulador tiene un número válido.
+* @param  a: acumulador
+* @retval true si llegó al menos un dígito y no se pasó del máximo
+*/
+bool_t Num_Valido(const acumuladorDecimal_t * a) {
+	return (a->digitos > 0 && !a->fueraDeRango);
+}
+
+/*******************************************************************************
+* @brief  Lee un entero decimal con signo opcional. Saltea espacios previos.
+* @param  texto: cadena terminada en '\0'
+* @param  minimo, maximo: rango admitido
+* @param  valor: destino
+* @param  fin: si es NULL el número debe ocupar todo el texto; si no, recibe
+*         el primer caracter que no se leyó
+* @retval true si el número es válido y está en rango
+*/
+bool_t Num_Leer(const char * texto, int32_t minimo, int32_t maximo, int32_t * valor,
+		        const char ** fin) {
+	acumuladorDecimal_t a;
+	bool_t negativo = false;
+
+	while (*texto == ' ') texto++;
+	if (*texto == '-' || *texto == '+') {
+		negativo = (*texto == '-');
+		texto++;
+	}
+
+	// El módulo del extremo del rango acota la acumulación
+	uint32_t limite = negativo ? (uint32_t) 0 - (uint32_t) minimo : (uint32_t) maximo;
+	if (negativo && minimo >= 0) limite = 0;
+	if (!negativo && maximo < 0) return false;
+	Num_Iniciar(&a, limite);
+	while (Num_Digito(&a, (uint8_t) *texto)) texto++;
+
+	if (fin != NULL) *fin = texto;
+	else if (*texto != '\0') return false;
+	if (!Num_Valido(&a)) return false;
+
+	int32_t resultado = negativo ? (int32_t) ((uint32_t) 0 - a.valor) : (int32_t) a.valor;
+	if (resultado < minimo || resultado > maximo) return false;
+	*valor = resultado;
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Escribe un entero sin signo en decimal y termina con '\0'.
+* @param  destino: lugar para al menos NUM_MAX_DIGITOS + 1 caracteres
+* @param  valor: número
+* @retval Puntero al '\0' final (para seguir agregando)
+*/
+char * Num_AgregarDecimal(char * destino, uint32_t valor) {
+	char invertido[NUM_MAX_DIGITOS];
+	uint8_t n = 0;
+
+	// Dígitos del menos significativo al más significativo
+	do {
+		invertido[n++] = (char) ('0' + valor % 10);
+		valor /= 10;
+	} while (valor != 0);
+
+	while (n > 0) *destino++ = invertido[--n];
+	*destino = '\0';
+	return destino;
+}
+
+/*******************************************************************************
+* @brief  Escribe un entero con signo en decimal y termina con '\0'.
+* @param  destino: lugar para al menos NUM_MAX_DIGITOS + 1 caracteres
+* @param  valor: número
+* @retval Puntero al '\0' final
+*/
+char * Num_AgregarEntero(char * destino, int32_t valor) {
+	if (valor < 0) {
+		*destino++ = '-';
+		return Num_AgregarDecimal(destino, (uint32_t) 0 - (uint32_t) valor);
+	}
+	return Num_AgregarDecimal(destino, (uint32_t) valor);
+}
+
+/*******************************************************************************
+* @brief  Copia un texto y termina con '\0'.
+* @param  destino: buffer del llamador
+* @param  texto: cadena terminada en '\0'
+* @retval Puntero al '\0' final
+*/
+char * Num_AgregarTexto(char * destino, const char * texto) {
+	while (*texto != '\0') *destino++ = *texto++;
+	*destino = '\0';
+	return destino;
+}
+
+/***************************************************************END OF FILE****/
@@ -0,0 +1,206 @@
+/*******************************************************************************
+  * @file		API_ondas_dac.c
+  * @brief      Triangular y ruido con los generadores propios del DAC2
+  *             (ver API_ondas_dac.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_ondas_dac.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static const char * const NombreOnda[] = {
+	[ONDA_DAC_NINGUNA] = "OFF", [ONDA_DAC_TRIANGULAR] = "TRI", [ONDA_DAC_RUIDO] = "NOISE"
+};
+static bool_t conDMA = false;		// BASE=SIG: el DMA recorre la señal
+
+/* Prototipos privados -------------------------------------------------------*/
+static char * agregarMilesimas(char * destino, uint64_t milesimas);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Triangular de escala completa desde 0, al RATE actual
+  * @param  o: parámetros a completar
+  * @retval None
+  */
+void Ondas_Defecto(ondasDAC_t * o) {
+	o->onda = ONDA_DAC_TRIANGULAR;
+	o->bits = ONDA_DAC_MAX_BITS;
+	o->base = 0;
+	o->senial = false;
+	o->periodo = 0;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[TRI|NOISE] [BITS=..] [BASE=<cuentas>|SIG] [RATE=..]".
+  *         Lo que no aparece conserva su valor. Modifica el texto (strtok).
+  * @param  texto: argumentos del comando
+  * @param  o: parámetros (entrada y salida)
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Ondas_Interpretar(char * texto, ondasDAC_t * o) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		char * igual = strchr(token, '=');
+		if (igual == NULL) {
+			if      (strcmp(token, "TRI") == 0)   o->onda = ONDA_DAC_TRIANGULAR;
+			else if (strcmp(token, "NOISE") == 0) o->onda = ONDA_DAC_RUIDO;
+			else return false;
+			token = strtok(NULL, " ");
+			continue;
+		}
+		*igual = '\0';
+		const char * textoValor = igual + 1;
+
+		if (strcmp(token, "BITS") == 0) {
+			if (Num_Leer(textoValor, 1, ONDA_DAC_MAX_BITS, &valor, NULL) != true) return false;
+			o->bits = (uint32_t) valor;
+		} else if (strcmp(token, "BASE") == 0) {
+			if (strcmp(textoValor, "SIG") == 0) {
+				o->senial = true;
+			} else {
+				if (Num_Leer(textoValor, 0, ONDAS_MAX_DAC, &valor, NULL) != true) return false;
+				o->base = (uint16_t) valor;
+				o->senial = false;
+			}
+		} else if (strcmp(token, "RATE") == 0) {
+			if (Num_Leer(textoValor, PERIODO_DAC_MINIMO, INT32_MAX, &valor, NULL) != true) return false;
+			o->periodo = (uint32_t) valor;
+		} else return false;
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Mayor valor que el generador suma a DHR
+  * @param  o: parámetros
+  * @retval 2^BITS - 1 cuentas
+  */
+uint32_t Ondas_Pico(const ondasDAC_t * o) {
+	return (1UL << o->bits) - 1;
+}
+
+/*******************************************************************************
+  * @brief  Arranca el generador del DAC2. La salida debe estar detenida.
+  *         Con BASE=SIG el DMA recorre 'senial' en círculo, sin
+  *         interrupciones; si no, DHR queda fijo y no se usa el DMA.
+  * @param  o: parámetros
+  * @param  senial: señal lista para el DAC (sólo con BASE=SIG)
+  * @param  largo: muestras de la señal (0 si no hay)
+  * @retval false si la suma puede pasar de 4095 o falta la señal (informado)
+  */
+bool_t Ondas_Iniciar(const ondasDAC_t * o, uint16_t * senial, uint32_t largo) {
+	uint32_t maximo = o->base;
+
+	if (o->senial) {
+		if (senial == NULL || largo == 0) {
+			uartSendLiteral("BASE=SIG necesita una senial cargada.\n");
+			return false;
+		}
+		maximo = 0;
+		for (uint32_t i=0; i<largo; i++) {
+			if (senial[i] > maximo) maximo = senial[i];
+		}
+	}
+	if (maximo + Ondas_Pico(o) > ONDAS_MAX_DAC) {
+		char informe[72];
+		char * fin = Num_AgregarTexto(informe, "Base ");
+		fin = Num_AgregarDecimal(fin, maximo);
+		fin = Num_AgregarTexto(fin, " + pico ");
+		fin = Num_AgregarDecimal(fin, Ondas_Pico(o));
+		fin = Num_AgregarTexto(fin, " pasa de 4095: bajar BITS o BASE.\n");
+		uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+		return false;
+	}
+
+	if (o->periodo != 0) Fijar_Periodo_DAC_DMA(o->periodo);
+	Fijar_Onda_DAC_DMA(o->onda, o->bits);
+	conDMA = o->senial;
+	if (conDMA) Comenzar_Tabla_DAC_DMA(senial, largo);
+	else Fijar_Valor_DAC_DMA(o->base);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Apaga el generador del DAC2 y el DMA si lo usaba. La salida
+  *         queda en la base.
+  * @param  None
+  * @retval None
+  */
+void Ondas_Parar(void) {
+	Fijar_Onda_DAC_DMA(ONDA_DAC_NINGUNA, 0);
+	if (conDMA) Parar_DAC_DMA();
+	conDMA = false;
+}
+
+/*******************************************************************************
+  * @brief  Informa la configuración y lo que resulta al RATE actual:
+  *         "HW=ON|OFF ONDA=TRI|NOISE BITS= PICO= BASE=<cuentas>|SIG RATE= FS=
+  *          PERIODO=<disparos> F=<Hz con 3 decimales> DMA=0|1"
+  *         PERIODO es lo que dura la triangular o lo que tarda el ruido en
+  *         repetirse, y F su inversa. En marcha rige el RATE actual (se
+  *         puede cambiar con el comando RATE).
+  * @param  o: parámetros
+  * @param  activa: el generador está en marcha
+  * @retval None
+  */
+void Ondas_Informar(const ondasDAC_t * o, bool_t activa) {
+	char informe[160];
+	uint32_t periodo = (o->periodo != 0 && !activa) ? o->periodo : Leer_Periodo_DAC_DMA();
+	uint32_t fs = FRECUENCIA_TIM2 / (periodo + 1);
+	uint32_t disparos = (o->onda == ONDA_DAC_TRIANGULAR) ? 2 * Ondas_Pico(o) : ONDAS_LARGO_LFSR;
+	if (disparos == 0) disparos = 1;
+
+	char * fin = Num_AgregarTexto(informe, activa ? "HW=ON ONDA=" : "HW=OFF ONDA=");
+	fin = Num_AgregarTexto(fin, Ondas_Nombre(o->onda));
+	fin = Num_AgregarTexto(fin, " BITS=");
+	fin = Num_AgregarDecimal(fin, o->bits);
+	fin = Num_AgregarTexto(fin, " PICO=");
+	fin = Num_AgregarDecimal(fin, Ondas_Pico(o));
+	fin = Num_AgregarTexto(fin, " BASE=");
+	if (o->senial) fin = Num_AgregarTexto(fin, "SIG");
+	else fin = Num_AgregarDecimal(fin, o->base);
+	fin = Num_AgregarTexto(fin, " RATE=");
+	fin = Num_AgregarDecimal(fin, periodo);
+	fin = Num_AgregarTexto(fin, " FS=");
+	fin = Num_AgregarDecimal(fin, fs);
+	fin = Num_AgregarTexto(fin, " PERIODO=");
+	fin = Num_AgregarDecimal(fin, disparos);
+	fin = Num_AgregarTexto(fin, " F=");
+	fin = agregarMilesimas(fin, (uint64_t) FRECUENCIA_TIM2 * 1000 / ((uint64_t) (periodo + 1) * disparos));
+	fin = Num_AgregarTexto(fin, o->senial ? " DMA=1\n" : " DMA=0\n");
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Nombre de la onda (como en el comando HW)
+  * @param  onda: generador del DAC
+  * @retval Texto
+  */
+const char * Ondas_Nombre(ondaDAC_t onda) {
+	return (onda <= ONDA_DAC_RUIDO) ? NombreOnda[onda] : "?";
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Escribe un valor en milésimas como "<entero>.<3 decimales>"
+  * @param  destino: dónde escribir
+  * @param  milesimas: valor x 1000 (la parte entera debe entrar en 32 bits)
+  * @retval Puntero al final
+  */
+static char * agregarMilesimas(char * destino, uint64_t milesimas) {
+	uint32_t resto = (uint32_t) (milesimas % 1000);
+	char * fin = Num_AgregarDecimal(destino, (uint32_t) (milesimas / 1000));
+	*fin++ = '.';
+	*fin++ = (char) ('0' + resto / 100);
+	*fin++ = (char) ('0' + (resto / 10) % 10);
+	*fin++ = (char) ('0' + resto % 10);
+	*fin = '\0';
+	return fin;
+}
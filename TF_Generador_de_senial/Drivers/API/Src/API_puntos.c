@@ -0,0 +1,171 @@
+/*******************************************************************************
+  * @file		API_puntos.c
+  * @brief      Tabla de puntos con duración propia (ver API_puntos.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_puntos.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define NS_POR_SEGUNDO			1000000000u
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint64_t aCiclos(uint64_t nanosegundos, uint32_t reloj);
+static uint32_t mcd(uint32_t a, uint32_t b);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Deja la tabla sin puntos
+  * @param  p: tabla
+  * @retval None
+  */
+void Pts_Vaciar(puntos_t * p) {
+	p->cantidad = 0;
+	p->nanosegundos = 0;
+	p->ciclos = 0;
+	p->mcd = 0;
+	p->rotado = false;
+}
+
+/*******************************************************************************
+  * @brief  Agrega un punto al final. Sus ciclos son los que faltan para
+  *         llegar a la suma de las duraciones, redondeada al ciclo.
+  * @param  p: tabla (si estaba preparada vuelve al orden natural)
+  * @param  nanosegundos: duración, 1..PTS_MAX_DURACION
+  * @param  valor: código del DAC, 0..PTS_MAX_VALOR
+  * @param  reloj: Hz del contador de TIM2
+  * @retval false si la tabla está llena, algo está fuera de rango o el
+  *         punto no llega a PTS_CICLOS_MINIMO (la tabla no cambia)
+  */
+bool_t Pts_Agregar(puntos_t * p, uint32_t nanosegundos, uint16_t valor, uint32_t reloj) {
+	if (p->cantidad >= PTS_MAX_PUNTOS || valor > PTS_MAX_VALOR || reloj == 0) return false;
+	if (nanosegundos == 0 || nanosegundos > PTS_MAX_DURACION) return false;
+
+	uint64_t fin = aCiclos(p->nanosegundos + nanosegundos, reloj);
+	uint64_t ciclos = fin - p->ciclos;
+	if (ciclos < PTS_CICLOS_MINIMO || ciclos > UINT32_MAX) return false;
+
+	if (p->rotado) Pts_Restaurar(p);
+	p->valores[p->cantidad] = valor;
+	p->periodos[p->cantidad] = (uint32_t) ciclos - 1;
+	p->cantidad++;
+	p->nanosegundos += nanosegundos;
+	p->ciclos = fin;
+	p->mcd = mcd((uint32_t) ciclos, p->mcd);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Agrega los pares "<ns> <valor>" de un texto, separados por
+  *         espacios. Es todo o nada: con un par inválido no agrega ninguno.
+  * @param  texto: uno o más pares
+  * @param  p: tabla
+  * @param  reloj: Hz del contador de TIM2
+  * @retval false si algún par no se pudo agregar (ver Pts_Agregar)
+  */
+bool_t Pts_Interpretar(const char * texto, puntos_t * p, uint32_t reloj) {
+	uint32_t cantidad = p->cantidad;
+	uint64_t nanosegundos = p->nanosegundos;
+	uint64_t ciclos = p->ciclos;
+	uint32_t divisor = p->mcd;
+	int32_t duracion, valor;
+
+	while (*texto == ' ') texto++;
+	if (*texto == '\0') return false;
+	while (*texto != '\0') {
+		if (Num_Leer(texto, 1, PTS_MAX_DURACION, &duracion, &texto) != true || *texto != ' '
+				|| Num_Leer(texto, 0, PTS_MAX_VALOR, &valor, &texto) != true
+				|| (*texto != ' ' && *texto != '\0')
+				|| Pts_Agregar(p, (uint32_t) duracion, (uint16_t) valor, reloj) != true) {
+			p->cantidad = cantidad;
+			p->nanosegundos = nanosegundos;
+			p->ciclos = ciclos;
+			p->mcd = divisor;
+			return false;
+		}
+		while (*texto == ' ') texto++;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Deja la tabla en el orden de los DMA: el disparo k saca el punto
+  *         k y carga el valor y el ARR del punto k+1, así que los dos
+  *         arreglos se corren un lugar y el primer punto queda al final
+  *         (lo carga Comenzar_Puntos_DAC_DMA antes del primer disparo).
+  * @param  p: tabla
+  * @retval false si no hay puntos
+  */
+bool_t Pts_Preparar(puntos_t * p) {
+	if (p->cantidad == 0) return false;
+	if (p->rotado) return true;
+
+	uint32_t ultimo = p->cantidad - 1;
+	uint16_t valor = p->valores[0];
+	uint32_t periodo = p->periodos[0];
+	memmove(&p->valores[0], &p->valores[1], ultimo * sizeof(p->valores[0]));
+	memmove(&p->periodos[0], &p->periodos[1], ultimo * sizeof(p->periodos[0]));
+	p->valores[ultimo] = valor;
+	p->periodos[ultimo] = periodo;
+	p->rotado = true;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Vuelve la tabla al orden natural (deshace Pts_Preparar)
+  * @param  p: tabla
+  * @retval None
+  */
+void Pts_Restaurar(puntos_t * p) {
+	if (!p->rotado || p->cantidad == 0) {
+		p->rotado = false;
+		return;
+	}
+	uint32_t ultimo = p->cantidad - 1;
+	uint16_t valor = p->valores[ultimo];
+	uint32_t periodo = p->periodos[ultimo];
+	memmove(&p->valores[1], &p->valores[0], ultimo * sizeof(p->valores[0]));
+	memmove(&p->periodos[1], &p->periodos[0], ultimo * sizeof(p->periodos[0]));
+	p->valores[0] = valor;
+	p->periodos[0] = periodo;
+	p->rotado = false;
+}
+
+/*******************************************************************************
+  * @brief  Muestras que necesitaría la misma señal con paso fijo: el paso
+  *         más largo que divide la duración de todos los puntos.
+  * @param  p: tabla
+  * @retval Ciclos totales / mcd de los ciclos (0 sin puntos)
+  */
+uint64_t Pts_Muestras_Uniformes(const puntos_t * p) {
+	return (p->mcd == 0) ? 0 : p->ciclos / p->mcd;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Pasa ns a ciclos de reloj, redondeando, sin desbordar 64 bits
+  * @param  nanosegundos: tiempo desde el comienzo de la tabla
+  * @param  reloj: Hz
+  * @retval Ciclos
+  */
+static uint64_t aCiclos(uint64_t nanosegundos, uint32_t reloj) {
+	uint64_t segundos = nanosegundos / NS_POR_SEGUNDO;
+	uint64_t resto = nanosegundos % NS_POR_SEGUNDO;
+	return segundos * reloj + (resto * reloj + NS_POR_SEGUNDO / 2) / NS_POR_SEGUNDO;
+}
+
+/*******************************************************************************
+  * @brief  Máximo común divisor (mcd(a, 0) = a)
+  */
+static uint32_t mcd(uint32_t a, uint32_t b) {
+	while (b != 0) {
+		uint32_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
@@ -0,0 +1,365 @@
+/*******************************************************************************
+  * @file		API_rafaga.c
+  * @brief      Ráfagas de K períodos por disparo (ver API_rafaga.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_rafaga.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define CICLOS_POR_US		(FRECUENCIA_TIM2 / 1000000)	// TIM5 también está en APB1
+
+/* Private variables HAL ------------------------------------------------------*/
+TIM_HandleTypeDef htim3;		// Cuenta períodos y abre la compuerta de TIM2
+TIM_HandleTypeDef htim5;		// Base de tiempo y captura del flanco en PA0
+
+/* Variables privadas --------------------------------------------------------*/
+static rafaga_t parametros;
+static uint32_t largoActivo = 0;
+static uint16_t primera = 0;				// Muestra que espera en DHR entre ráfagas
+static bool_t activa = false;
+static volatile bool_t ocupada = false;		// Ráfaga en curso
+static volatile rafagaContadores_t contadores;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void MX_TIM3_Init(void);
+static void MX_TIM5_Init(void);
+static void abrirCompuerta(void);
+static char * agregarNanosegundos(char * fin, const char * nombre, uint32_t ciclos);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Inicializa TIM3 (compuerta cerrada) y TIM5 (captura en PA0, sin
+  *         interrupción hasta que una ráfaga la pida).
+  * @param  None
+  * @retval None
+  */
+void Inicializar_Rafaga(void) {
+	MX_TIM3_Init();
+	MX_TIM5_Init();
+	if (HAL_TIM_IC_Start(&htim5, TIM_CHANNEL_1) != HAL_OK) Error_Handler();
+}
+
+/*******************************************************************************
+  * @brief  Parámetros por defecto: un período, reposo a mitad de escala y
+  *         disparo sólo por comando o pulsador.
+  * @param  r: parámetros a inicializar
+  * @retval None
+  */
+void Rafaga_Defecto(rafaga_t * r) {
+	r->periodos = 1;
+	r->reposo = RAFAGA_REPOSO_DEFECTO;
+	r->pin = false;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "[K=<periodos>] [IDLE=<codigo>] [SRC=SW|PIN]". Lo que
+  *         no aparece conserva su valor. Modifica el texto (strtok).
+  * @param  texto: argumentos del comando
+  * @param  r: parámetros a modificar
+  * @retval false si algún parámetro es inválido
+  */
+bool_t Rafaga_Interpretar(char * texto, rafaga_t * r) {
+	char * token = strtok(texto, " ");
+	int32_t valor;
+
+	while (token != NULL) {
+		char * igual = strchr(token, '=');
+		if (igual == NULL) return false;
+		*igual = '\0';
+		const char * textoValor = igual + 1;
+
+		if (strcmp(token, "SRC") == 0) {
+			if      (strcmp(textoValor, "SW") == 0)  r->pin = false;
+			else if (strcmp(textoValor, "PIN") == 0) r->pin = true;
+			else return false;
+		} else if (strcmp(token, "K") == 0) {
+			if (Num_Leer(textoValor, 1, RAFAGA_MAX_PERIODOS, &valor, NULL) != true) return false;
+			r->periodos = (uint32_t) valor;
+		} else if (strcmp(token, "IDLE") == 0) {
+			if (Num_Leer(textoValor, 0, 0x0FFF, &valor, NULL) != true) return false;
+			r->reposo = (uint16_t) valor;
+		} else return false;
+		token = strtok(NULL, " ");
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Prepara las ráfagas y deja la salida en reposo esperando un
+  *         disparo. La salida debe estar detenida.
+  * @param  r: parámetros válidos (ver Rafaga_Interpretar), reposo ya corregido
+  * @param  senial: un período, tal como debe salir
+  * @param  buffer: 'largo' muestras para el DMA (no se toca hasta Rafaga_Parar)
+  * @param  largo: muestras por período (2 a RAFAGA_MAX_LARGO)
+  * @retval None
+  */
+void Rafaga_Iniciar(const rafaga_t * r, const uint16_t * senial, uint16_t * buffer, uint32_t largo) {
+	if (largo < 2 || largo > RAFAGA_MAX_LARGO) Error_Handler();
+	if (r->periodos < 1 || r->periodos > RAFAGA_MAX_PERIODOS) Error_Handler();
+	if (activa) Rafaga_Parar();
+
+	parametros = *r;
+	largoActivo = largo;
+	memset((void *) &contadores, 0, sizeof(contadores));
+	contadores.latenciaMinima = UINT32_MAX;
+	ocupada = false;
+
+	// El disparo k saca DHR y el DMA carga buffer[k - 1]: buffer es la señal
+	// rotada una muestra y senial[0] espera en DHR
+	memcpy(buffer, senial + 1, (largo - 1) * sizeof(uint16_t));
+	buffer[largo - 1] = senial[0];
+	primera = senial[0];
+
+	// TIM3: un paso por período, compuerta abierta hasta llegar a K.
+	// UG carga el prescaler y CCR1 (precargados) y pone CNT en cero: se
+	// hace con TIM2 detenido y luego CNT = K cierra la compuerta.
+	Detener_Disparo_DAC_DMA();
+	__HAL_TIM_SET_PRESCALER(&htim3, largo - 1);
+	__HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, parametros.periodos);
+	htim3.Instance->EGR = TIM_EGR_UG;
+	__HAL_TIM_SET_COUNTER(&htim3, parametros.periodos);
+	__HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_CC1);
+	__HAL_TIM_ENABLE_IT(&htim3, TIM_IT_CC1);
+	__HAL_TIM_ENABLE(&htim3);
+	Fijar_Compuerta_DAC_DMA(true);
+
+	Comenzar_Tabla_DAC_DMA(buffer, largo);
+	Fijar_Reposo_DAC_DMA(parametros.reposo, primera);
+	activa = true;
+
+	if (parametros.pin) {
+		__HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_CC1);
+		__HAL_TIM_ENABLE_IT(&htim5, TIM_IT_CC1);
+	}
+}
+
+/*******************************************************************************
+  * @brief  Disparo por software (comando o pulsador): la primera muestra
+  *         sale un ciclo de TIM2 después de abrir la compuerta.
+  * @param  None
+  * @retval false si no hay ráfagas preparadas o hay una en curso
+  */
+bool_t Rafaga_Disparar(void) {
+	bool_t libre;
+
+	if (!activa) return false;
+	__disable_irq();				// El flanco en PA0 también dispara
+	libre = !ocupada;
+	if (libre) abrirCompuerta();
+	else contadores.ignorados++;
+	__enable_irq();
+	return libre;
+}
+
+/*******************************************************************************
+  * @brief  Corta la salida (aunque haya una ráfaga en curso) y devuelve TIM2
+  *         a su marcha libre, como lo esperan los demás modos.
+  * @param  None
+  * @retval None
+  */
+void Rafaga_Parar(void) {
+	if (!activa) return;
+	__HAL_TIM_DISABLE_IT(&htim5, TIM_IT_CC1);
+	__HAL_TIM_DISABLE_IT(&htim3, TIM_IT_CC1);
+	Parar_DAC_DMA();
+	__HAL_TIM_DISABLE(&htim3);
+	Fijar_Compuerta_DAC_DMA(false);
+	ocupada = false;
+	activa = false;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores
+  * @param  destino
+  * @retval None
+  */
+void Rafaga_Contadores(rafagaContadores_t * destino) {
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+}
+
+/*******************************************************************************
+  * @brief  Informa parámetros y contadores:
+  *         "RAFAGA K= N= MUESTRAS= REPOSO= SRC= DISPAROS= EMITIDAS= IGNORADOS="
+  *         y, si hubo disparos por PA0, la latencia del flanco a la compuerta:
+  *         "LAT_MIN= LAT_MAX= JITTER=" (ns).
+  * @param  None
+  * @retval None
+  */
+void Rafaga_Informar(void) {
+	rafagaContadores_t c;
+	char informe[192];
+
+	Rafaga_Contadores(&c);
+	char * fin = Num_AgregarTexto(informe, "RAFAGA K=");
+	fin = Num_AgregarDecimal(fin, parametros.periodos);
+	fin = Num_AgregarTexto(fin, " N=");
+	fin = Num_AgregarDecimal(fin, largoActivo);
+	fin = Num_AgregarTexto(fin, " MUESTRAS=");
+	fin = Num_AgregarDecimal(fin, parametros.periodos * largoActivo);
+	fin = Num_AgregarTexto(fin, " REPOSO=");
+	fin = Num_AgregarDecimal(fin, parametros.reposo);
+	fin = Num_AgregarTexto(fin, parametros.pin ? " SRC=PIN" : " SRC=SW");
+	fin = Num_AgregarTexto(fin, " DISPAROS=");
+	fin = Num_AgregarDecimal(fin, c.disparos);
+	fin = Num_AgregarTexto(fin, " EMITIDAS=");
+	fin = Num_AgregarDecimal(fin, c.emitidas);
+	fin = Num_AgregarTexto(fin, " IGNORADOS=");
+	fin = Num_AgregarDecimal(fin, c.ignorados);
+	if (c.medidos > 0) {
+		fin = agregarNanosegundos(fin, " LAT_MIN=", c.latenciaMinima);
+		fin = agregarNanosegundos(fin, " LAT_MAX=", c.latenciaMaxima);
+		fin = agregarNanosegundos(fin, " JITTER=", c.latenciaMaxima - c.latenciaMinima);
+	}
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Interrupciones ------------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Fin de ráfaga (CC1 de TIM3): la compuerta ya se cerró. Prepara
+  *         TIM2 para la próxima y lleva la salida al reposo; la última
+  *         muestra dura lo que tarda esta interrupción.
+  */
+void rafagaFinIRQHandler(void) {
+	if (__HAL_TIM_GET_FLAG(&htim3, TIM_FLAG_CC1) == RESET) return;
+	__HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_CC1);
+	Preparar_Disparo_DAC_DMA();
+	Fijar_Reposo_DAC_DMA(parametros.reposo, primera);
+	contadores.emitidas++;
+	ocupada = false;
+}
+
+/*******************************************************************************
+  * @brief  Flanco ascendente en PA0 (captura de TIM5): abre la compuerta y
+  *         mide cuánto tardó desde el flanco.
+  */
+void rafagaPinIRQHandler(void) {
+	if (__HAL_TIM_GET_FLAG(&htim5, TIM_FLAG_CC1) == RESET) return;
+	uint32_t flanco = __HAL_TIM_GET_COMPARE(&htim5, TIM_CHANNEL_1);	// Leer CCR1 borra CC1IF
+	if (ocupada) {
+		contadores.ignorados++;
+		return;
+	}
+	abrirCompuerta();
+	uint32_t latencia = __HAL_TIM_GET_COUNTER(&htim5) - flanco;
+
+	contadores.medidos++;
+	if (latencia < contadores.latenciaMinima) contadores.latenciaMinima = latencia;
+	if (latencia > contadores.latenciaMaxima) contadores.latenciaMaxima = latencia;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/**
+  * @brief Pone TIM3 en cero: su OC1REF sube y TIM2 empieza a contar.
+  *        Con las interrupciones deshabilitadas o desde una interrupción.
+  */
+static void abrirCompuerta(void) {
+	ocupada = true;
+	contadores.disparos++;
+	htim3.Instance->EGR = TIM_EGR_UG;
+}
+
+/**
+  * @brief Agrega "<nombre><ns>" con los ciclos de TIM5 pasados a ns
+  */
+static char * agregarNanosegundos(char * fin, const char * nombre, uint32_t ciclos) {
+	fin = Num_AgregarTexto(fin, nombre);
+	return Num_AgregarDecimal(fin, ciclos * 1000 / CICLOS_POR_US);
+}
+
+/**
+  * @brief TIM3 Initialization Function
+  *        Reloj: TRGO de TIM2 (ITR1). TRGO: OC1REF, en alto mientras
+  *        CNT < CCR1 (PWM 1). Con CCR1 = 0 la compuerta queda cerrada.
+  * @param None
+  * @retval None
+  */
+static void MX_TIM3_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  htim3.Instance = TIM3;
+  htim3.Init.Prescaler = 0;
+  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim3.Init.Period = 0xFFFF;
+  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_ITR1;
+  if (HAL_TIM_ConfigClockSource(&htim3, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_PWM_Init(&htim3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC1REF;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigOC.OCMode = TIM_OCMODE_PWM1;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if (HAL_TIM_PWM_ConfigChannel(&htim3, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief TIM5 Initialization Function
+  *        32 bits a 84 MHz, libre. Canal 1: captura del flanco ascendente
+  *        en PA0, sin filtro (la señal de disparo debe ser limpia).
+  * @param None
+  * @retval None
+  */
+static void MX_TIM5_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_IC_InitTypeDef sConfigIC = {0};
+
+  htim5.Instance = TIM5;
+  htim5.Init.Prescaler = 0;
+  htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim5.Init.Period = 0xFFFFFFFF;
+  htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim5, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_IC_Init(&htim5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+  sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+  sConfigIC.ICFilter = 0;
+  if (HAL_TIM_IC_ConfigChannel(&htim5, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* @file    API_ring.c
+* @author  Guillermo Caporaletti
+* @brief   Buffer circular de un productor y un consumidor (SPSC) sin bloqueo.
+*
+*          Productor: escribe el dato, __DMB(), publica cabeza.
+*          Consumidor: lee cabeza, __DMB(), lee el dato, __DMB(), libera cola.
+*          En el Cortex-M4 (un solo núcleo) la barrera además impide que el
+*          compilador reordene los accesos a memoria alrededor del índice.
+*******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_ring.h"
+
+/* Functions -----------------------------------------------------------------*/
+
+/*******************************************************************************
+* @brief  Inicializa un buffer circular vacío.
+* @param  r: estructura del buffer
+* @param  memoria: capacidad * largoRegistro bytes provistos por el usuario
+* @param  capacidad: cantidad de registros (potencia de 2)
+* @param  largoRegistro: bytes por registro
+* @retval None
+*/
+void ringInit(ring_t * r, void * memoria, uint32_t capacidad, uint16_t largoRegistro) {
+	if (r == NULL || memoria == NULL || largoRegistro == 0) Error_Handler();
+	if (capacidad == 0 || (capacidad & (capacidad - 1)) != 0) Error_Handler();
+
+	r->datos = (uint8_t *) memoria;
+	r->mascara = capacidad - 1;
+	r->largoRegistro = largoRegistro;
+	r->cabeza = 0;
+	r->cola = 0;
+}
+
+/*******************************************************************************
+* @brief  Agrega un byte (lado productor).
+* @param  r: estructura del buffer
+* @param  dato: byte a agregar
+* @retval true si había lugar
+*/
+bool_t ringPutByte(ring_t * r, uint8_t dato) {
+	uint32_t cabeza = r->cabeza;
+	if (cabeza - r->cola > r->mascara) return false;	// Lleno
+
+	r->datos[cabeza & r->mascara] = dato;
+	__DMB();				// El dato queda escrito antes de publicarlo
+	r->cabeza = cabeza + 1;
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Saca un byte (lado consumidor).
+* @param  r: estructura del buffer
+* @param  dato: donde se guarda el byte leído
+* @retval true si había datos
+*/
+bool_t ringGetByte(ring_t * r, uint8_t * dato) {
+	uint32_t cola = r->cola;
+	if (r->cabeza == cola) return false;				// Vacío
+
+	__DMB();				// Leo el dato después de ver la cabeza
+	*dato = r->datos[cola & r->mascara];
+	__DMB();				// Termino de leer antes de liberar el lugar
+	r->cola = cola + 1;
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Agrega hasta 'cantidad' bytes con una sola publicación de cabeza.
+* @param  r: estructura del buffer
+* @param  datos: bytes a agregar
+* @param  cantidad: bytes a agregar
+* @retval Bytes efectivamente agregados
+*/
+uint32_t ringPutBytes(ring_t * r, const uint8_t * datos, uint32_t cantidad) {
+	uint32_t cabeza = r->cabeza;
+	uint32_t libres = (r->mascara + 1) - (cabeza - r->cola);
+	if (cantidad > libres) cantidad = libres;
+
+	// Copio en a lo sumo dos tramos (antes y después de dar la vuelta)
+	uint32_t inicio = cabeza & r->mascara;
+	uint32_t tramo = r->mascara + 1 - inicio;
+	if (tramo > cantidad) tramo = cantidad;
+	memcpy(&r->datos[inicio], datos, tramo);
+	memcpy(&r->datos[0], datos + tramo, cantidad - tramo);
+
+	__DMB();
+	r->cabeza = cabeza + cantidad;
+	return cantidad;
+}
+
+/*******************************************************************************
+* @brief  Saca hasta 'cantidad' bytes con una sola liberación de cola.
+* @param  r: estructura del buffer
+* @param  datos: destino de los bytes
+* @param  cantidad: bytes a sacar
+* @retval Bytes efectivamente leídos
+*/
+uint32_t ringGetBytes(ring_t * r, uint8_t * datos, uint32_t cantidad) {
+	uint32_t cola = r->cola;
+	uint32_t ocupados = r->cabeza - cola;
+	if (cantidad > ocupados) cantidad = ocupados;
+
+	__DMB();
+	uint32_t inicio = cola & r->mascara;
+	uint32_t tramo = r->mascara + 1 - inicio;
+	if (tramo > cantidad) tramo = cantidad;
+	memcpy(datos, &r->datos[inicio], tramo);
+	memcpy(datos + tramo, &r->datos[0], cantidad - tramo);
+
+	__DMB();
+	r->cola = cola + cantidad;
+	return cantidad;
+}
+
+/*******************************************************************************
+* @brief  Agrega un registro de largoRegistro bytes (lado productor).
+* @param  r: estructura del buffer
+* @param  registro: registro a copiar
+* @retval true si había lugar
+*/
+bool_t ringPut(ring_t * r, const void * registro) {
+	uint32_t cabeza = r->cabeza;
+	if (cabeza - r->cola > r->mascara) return false;
+
+	memcpy(&r->datos[(cabeza & r->mascara) * r->largoRegistro], registro, r->largoRegistro);
+	__DMB();
+	r->cabeza = cabeza + 1;
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Saca un registro de largoRegistro bytes (lado consumidor).
+* @param  r: estructura del buffer
+* @param  registro: destino del registro
+* @retval true si había datos
+*/
+bool_t ringGet(ring_t * r, void * registro) {
+	uint32_t cola = r->cola;
+	if (r->cabeza == cola) return false;
+
+	__DMB();
+	memcpy(registro, &r->datos[(cola & r->mascara) * r->largoRegistro], r->largoRegistro);
+	__DMB();
+	r->cola = cola + 1;
+	return true;
+}
+
+/*******************************************************************************
+* @brief  Cantidad de registros almacenados.
+* @param  r: estructura del buffer
+* @retval Registros ocupados
+*/
+uint32_t ringCount(ring_t * r) {
+	return r->cabeza - r->cola;
+}
+
+/*******************************************************************************
+* @brief  Cantidad de registros libres.
+* @param  r: estructura del buffer
+* @retval Registros libres
+*/
+uint32_t ringFree(ring_t * r) {
+	return (r->mascara + 1) - (r->cabeza - r->cola);
+}
+
+/*******************************************************************************
+* @brief  Descarta todo lo almacenado. Sólo puede llamarla el consumidor.
+* @param  r: estructura del buffer
+* @retval None
+*/
+void ringFlush(ring_t * r) {
+	__DMB();
+	r->cola = r->cabeza;
+}
+
+/***************************************************************END OF FILE****/
@@ -0,0 +1,214 @@
+/*******************************************************************************
+  * @file		API_ruido.c
+  * @brief      PRBS y ruido en tiempo real por el DAC2 (ver API_ruido.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_ruido.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static estadoAleatorio_t estado;
+static uint16_t bufferDMA[2 * RUIDO_MITAD];
+static volatile ruidoContadores_t contadores;
+static uint32_t costo[ALEA_TIPOS];		// Ciclos por bloque de cada generador, medidos al arrancar
+static bool_t enMarcha = false;
+static estadoAleatorio_t prueba;		// Para medir el costo de cada generador
+
+/* Prototipos privados -------------------------------------------------------*/
+static void recargar(uint16_t * mitad, uint32_t cantidad);
+static void medirCostos(const aleatorio_t * a, uint32_t ciclos[ALEA_TIPOS]);
+static void generarPrueba(uint16_t * destino, uint32_t cantidad);
+static const char * nombreTipo(uint32_t tipo);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Arranca el generador desde su semilla con la frecuencia de
+  *         muestras actual de TIM2, luego de medir el costo de cada tipo.
+  *         Informa con Ruido_Informar().
+  * @param  a: parámetros (ver Alea_Interpretar)
+  * @retval false si los parámetros son inválidos (ya informado por UART)
+  */
+bool_t Ruido_Iniciar(const aleatorio_t * a) {
+	if (Alea_Preparar(&estado, a) != true) {
+		uartSendLiteral("Parametros de RAND invalidos.\n");
+		return false;
+	}
+	if (enMarcha) Ruido_Parar();
+	medirCostos(a, costo);
+	if (Alea_Preparar(&estado, a) != true) Error_Handler();
+	memset((void *) &contadores, 0, sizeof(contadores));
+
+	Bloques_Comenzar(bufferDMA, RUIDO_MITAD, recargar);
+	enMarcha = true;
+
+	Ruido_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene el generador (la salida queda en la última muestra) e
+  *         informa: "FIN RAND bloques= sat= atrasos="
+  * @param  None
+  * @retval None
+  */
+void Ruido_Parar(void) {
+	if (!enMarcha) return;
+	Bloques_Parar();
+	enMarcha = false;
+
+	char informe[64];
+	char * fin = Num_AgregarTexto(informe, "FIN RAND bloques=");
+	fin = Num_AgregarDecimal(fin, contadores.bloques);
+	fin = Num_AgregarTexto(fin, " sat=");
+	fin = Num_AgregarDecimal(fin, contadores.saturadas);
+	fin = Num_AgregarTexto(fin, " atrasos=");
+	fin = Num_AgregarDecimal(fin, contadores.atrasos);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si el generador está en marcha
+  * @param  None
+  * @retval true si el DAC está sacando PRBS o ruido
+  */
+bool_t Ruido_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores del generador en curso (o el último).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Ruido_Contadores(ruidoContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+}
+
+/*******************************************************************************
+  * @brief  Informa el generador y su costo con la frecuencia actual:
+  *         "RAND=ON TIPO= AMP= OFF= CHIP= DEC= PERIODO=<bits, PRBS> BW=<Hz>
+  *          FS= CICLOS=<último bloque> MAX=<peor bloque> PRESUPUESTO= (por
+  *          muestra) CARGA=<%> FS_MAX= SAT= ATRASOS="
+  * @param  None
+  * @retval None
+  */
+void Ruido_Informar(void) {
+	char informe[224];
+	ruidoContadores_t c;
+
+	if (!enMarcha) {
+		uartSendLiteral("RAND=OFF\n");
+		return;
+	}
+	Ruido_Contadores(&c);
+	const aleatorio_t * p = &estado.p;
+	uint32_t fs = FRECUENCIA_TIM2 / (Leer_Periodo_DAC_DMA() + 1);
+
+	char * fin = Num_AgregarTexto(informe, "RAND=ON TIPO=");
+	fin = Num_AgregarTexto(fin, Alea_Nombre(p->tipo));
+	fin = Num_AgregarTexto(fin, " AMP=");
+	fin = Num_AgregarDecimal(fin, p->amplitud);
+	fin = Num_AgregarTexto(fin, " OFF=");
+	fin = Num_AgregarDecimal(fin, p->offset);
+	if (Alea_Periodo_Bits(p->tipo) > 0) {
+		fin = Num_AgregarTexto(fin, " CHIP=");
+		fin = Num_AgregarDecimal(fin, p->chip);
+		fin = Num_AgregarTexto(fin, " PERIODO=");
+		fin = Num_AgregarDecimal(fin, Alea_Periodo_Bits(p->tipo));
+	}
+	fin = Num_AgregarTexto(fin, " DEC=");
+	fin = Num_AgregarDecimal(fin, p->decimacion);
+	fin = Num_AgregarTexto(fin, " BW=");
+	fin = Num_AgregarDecimal(fin, Alea_Ancho_Banda(p, fs));
+	fin = Num_AgregarTexto(fin, " FS=");
+	fin = Num_AgregarDecimal(fin, fs);
+	fin = Bloques_AgregarCosto(fin, &c, RUIDO_MITAD);
+	fin = Num_AgregarTexto(fin, " FS_MAX=");
+	fin = Num_AgregarDecimal(fin, Bloques_Fs_Maxima(c.ciclosMaximo, RUIDO_MITAD, 100));
+	fin = Num_AgregarTexto(fin, " SAT=");
+	fin = Num_AgregarDecimal(fin, c.saturadas);
+	fin = Num_AgregarTexto(fin, " ATRASOS=");
+	fin = Num_AgregarDecimal(fin, c.atrasos);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Informa la frecuencia de muestras máxima de cada generador si
+  *         puede usar 'porcentaje' de la CPU:
+  *         "FS_MAX CPU=<%> DEC= PRBS7= ... GAUSS= CICLOS PRBS7= ... GAUSS="
+  *         (ciclos por muestra). En marcha usa lo medido al arrancar; si no,
+  *         mide ahora con el filtro y el CHIP de 'a'.
+  * @param  a: parámetros (sólo importan DEC y CHIP)
+  * @param  porcentaje: fracción de la CPU para el generador, 1..100
+  * @retval None
+  */
+void Ruido_Capacidad(const aleatorio_t * a, uint32_t porcentaje) {
+	uint32_t ciclos[ALEA_TIPOS];
+	char informe[200];
+
+	if (enMarcha) memcpy(ciclos, costo, sizeof(ciclos));
+	else medirCostos(a, ciclos);
+
+	char * fin = Num_AgregarTexto(informe, "FS_MAX CPU=");
+	fin = Num_AgregarDecimal(fin, porcentaje);
+	fin = Num_AgregarTexto(fin, "% DEC=");
+	fin = Num_AgregarDecimal(fin, enMarcha ? estado.p.decimacion : a->decimacion);
+	fin = Bloques_AgregarCapacidad(fin, ciclos, ALEA_TIPOS, nombreTipo, porcentaje, RUIDO_MITAD);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Genera la mitad que el DAC ya leyó. Contexto de interrupción
+  *         (salvo las dos primeras).
+  * @param  mitad: mitad del buffer del DMA
+  * @param  cantidad: muestras de esa mitad (un bloque)
+  * @retval None
+  */
+static void recargar(uint16_t * mitad, uint32_t cantidad) {
+	uint32_t inicio = medicionCiclos();
+	contadores.saturadas += Alea_Generar(&estado, mitad, cantidad);
+	Bloques_Registrar(&contadores, inicio, cantidad);
+}
+
+/*******************************************************************************
+  * @brief  Mide los ciclos de un bloque de cada generador con el DEC y el
+  *         CHIP de 'a' (el costo no depende de la amplitud ni de la semilla)
+  * @param  a: parámetros
+  * @param  ciclos: ciclos por bloque de RUIDO_MITAD muestras, por tipo
+  * @retval None
+  */
+static void medirCostos(const aleatorio_t * a, uint32_t ciclos[ALEA_TIPOS]) {
+	static uint16_t destino[RUIDO_MITAD];
+
+	for (uint32_t t=0; t<ALEA_TIPOS; t++) {
+		aleatorio_t q = *a;
+		q.tipo = (tipoAleatorio_t) t;
+		if (Alea_Preparar(&prueba, &q) != true) Error_Handler();
+		ciclos[t] = Bloques_Medir(generarPrueba, destino, RUIDO_MITAD);
+	}
+}
+
+/**
+  * @brief Un bloque con el estado de prueba (ver Bloques_Medir)
+  */
+static void generarPrueba(uint16_t * destino, uint32_t cantidad) {
+	Alea_Generar(&prueba, destino, cantidad);
+}
+
+/**
+  * @brief Nombre de cada generador para Bloques_AgregarCapacidad
+  */
+static const char * nombreTipo(uint32_t tipo) {
+	return Alea_Nombre((tipoAleatorio_t) tipo);
+}
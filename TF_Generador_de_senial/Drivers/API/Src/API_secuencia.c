@@ -0,0 +1,150 @@
+/*******************************************************************************
+  * @file		API_secuencia.c
+  * @brief      Secuencia de segmentos con repeticiones (ver API_secuencia.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_secuencia.h"
+
+/* Prototipos privados -------------------------------------------------------*/
+static void entrarSegmento(secuencia_t * s, uint32_t indice);
+static uint32_t mcd(uint32_t a, uint32_t b);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Deja la secuencia sin segmentos
+  * @param  s: secuencia
+  * @retval None
+  */
+void Seq_Vaciar(secuencia_t * s) {
+	s->cantidad = 0;
+	s->granulo = 0;
+	s->actual = 0;
+	s->proximo = NULL;
+	s->fin = NULL;
+	s->restantes = 0;
+	s->vueltas = 0;
+	s->avanzar = false;
+}
+
+/*******************************************************************************
+  * @brief  Agrega un segmento al final. Los datos no se copian: deben
+  *         quedar quietos mientras se use la secuencia.
+  * @param  s: secuencia
+  * @param  datos: muestras del segmento
+  * @param  largo: muestras, múltiplo del gránulo que se vaya a usar
+  * @param  repeticiones: 1..SEQ_MAX_REPETICIONES o SEQ_INFINITO
+  * @retval false si la lista está llena o los parámetros no valen
+  */
+bool_t Seq_Agregar(secuencia_t * s, const uint16_t * datos, uint32_t largo, uint32_t repeticiones) {
+	if (s->cantidad >= SEQ_MAX_SEGMENTOS || datos == NULL || largo == 0) return false;
+	if (repeticiones > SEQ_MAX_REPETICIONES) return false;
+
+	segmento_t * nuevo = &s->segmentos[s->cantidad];
+	nuevo->datos = datos;
+	nuevo->largo = largo;
+	nuevo->repeticiones = repeticiones;
+	s->cantidad++;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Gránulo más largo que divide a todos los segmentos
+  * @param  s: secuencia
+  * @retval Máximo común divisor de los largos (0 sin segmentos)
+  */
+uint32_t Seq_Granulo(const secuencia_t * s) {
+	uint32_t g = 0;
+	for (uint32_t i=0; i<s->cantidad; i++) g = mcd(s->segmentos[i].largo, g);
+	return g;
+}
+
+/*******************************************************************************
+  * @brief  Fija el gránulo y vuelve al comienzo del primer segmento
+  * @param  s: secuencia
+  * @param  granulo: muestras por transferencia, SEQ_GRANULO_MINIMO..
+  *         SEQ_MAX_GRANULO; debe dividir el largo de todos los segmentos
+  * @retval false si no hay segmentos o el gránulo no sirve
+  */
+bool_t Seq_Preparar(secuencia_t * s, uint32_t granulo) {
+	if (s->cantidad == 0) return false;
+	if (granulo < SEQ_GRANULO_MINIMO || granulo > SEQ_MAX_GRANULO) return false;
+	for (uint32_t i=0; i<s->cantidad; i++) {
+		if (s->segmentos[i].largo % granulo != 0) return false;
+	}
+	s->granulo = granulo;
+	s->vueltas = 0;
+	s->avanzar = false;
+	entrarSegmento(s, 0);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Entrega el próximo gránulo y avanza: al final de una pasada
+  *         repite el segmento o pasa al siguiente (el último sigue con el
+  *         primero). Tiempo constante: se llama desde la interrupción.
+  * @param  s: secuencia preparada (Seq_Preparar)
+  * @retval Primera de las 'granulo' muestras
+  */
+const uint16_t * Seq_Siguiente(secuencia_t * s) {
+	const uint16_t * granulo = s->proximo;
+	s->proximo += s->granulo;
+	if (s->proximo == s->fin) {
+		const segmento_t * seg = &s->segmentos[s->actual];
+		if (s->avanzar) {
+			s->avanzar = false;
+		} else if (seg->repeticiones == SEQ_INFINITO) {
+			s->proximo = seg->datos;
+			return granulo;
+		} else if (s->restantes > 0) {
+			s->restantes--;
+			s->proximo = seg->datos;
+			return granulo;
+		}
+		if (s->actual + 1 < s->cantidad) {
+			entrarSegmento(s, s->actual + 1);
+		} else {
+			s->vueltas++;
+			entrarSegmento(s, 0);
+		}
+	}
+	return granulo;
+}
+
+/*******************************************************************************
+  * @brief  Pide dejar el segmento en curso al terminar su pasada, aunque le
+  *         queden repeticiones (única salida de uno SEQ_INFINITO)
+  * @param  s: secuencia
+  * @retval None
+  */
+void Seq_Avanzar(secuencia_t * s) {
+	s->avanzar = true;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Se ubica al comienzo de la primera pasada de un segmento
+  */
+static void entrarSegmento(secuencia_t * s, uint32_t indice) {
+	const segmento_t * seg = &s->segmentos[indice];
+	s->actual = indice;
+	s->proximo = seg->datos;
+	s->fin = seg->datos + seg->largo;
+	s->restantes = (seg->repeticiones == SEQ_INFINITO) ? 0 : seg->repeticiones - 1;
+}
+
+/*******************************************************************************
+  * @brief  Máximo común divisor (Euclides); mcd(a, 0) = a
+  */
+static uint32_t mcd(uint32_t a, uint32_t b) {
+	while (b != 0) {
+		uint32_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
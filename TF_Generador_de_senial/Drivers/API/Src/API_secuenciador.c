@@ -0,0 +1,289 @@
+/*******************************************************************************
+  * @file		API_secuenciador.c
+  * @brief      Secuencias de segmentos por el DAC2 (ver API_secuenciador.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_secuenciador.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static secuencia_t secuencia;
+static uint16_t memoria[SEQ_MEMORIA];
+static uint32_t usado = 0;				// Muestras de la memoria ya asignadas
+static uint32_t reservado = 0;			// Largo del segmento que se está armando
+static volatile seqContadores_t contadores;
+static bool_t enMarcha = false;
+
+/* Prototipos privados -------------------------------------------------------*/
+static const uint16_t * siguiente(uint32_t quedan);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Reserva lugar para un segmento nuevo. Se llena y después se
+  *         agrega con Secuenciador_Agregar(): recién entonces lo puede
+  *         tomar la interrupción, aunque la secuencia esté en marcha.
+  * @param  largo: muestras del segmento; en marcha, múltiplo del gránulo
+  * @retval Donde escribir las muestras, o NULL (ya informado por UART)
+  */
+uint16_t * Secuenciador_Reservar(uint32_t largo) {
+	reservado = 0;
+	if (secuencia.cantidad >= SEQ_MAX_SEGMENTOS) {
+		uartSendLiteral("Secuencia llena: SEQ CLR primero.\n");
+		return NULL;
+	}
+	if (largo > SEQ_MEMORIA - usado) {
+		uartSendLiteral("No queda memoria para el segmento: SEQ CLR primero.\n");
+		return NULL;
+	}
+	if (enMarcha && largo % secuencia.granulo != 0) {
+		uartSendLiteral("En marcha el largo debe ser multiplo del granulo (ver SEQ?).\n");
+		return NULL;
+	}
+	reservado = largo;
+	return memoria + usado;
+}
+
+/*******************************************************************************
+  * @brief  Agrega al final de la secuencia el segmento reservado e informa:
+  *         "Segmento <i>: <largo> muestras x<repeticiones|INF>, <r>
+  *          recortadas, <libres> muestras libres."
+  * @param  repeticiones: 1..SEQ_MAX_REPETICIONES o SEQ_INFINITO
+  * @param  recortadas: muestras recortadas al armarlo (sólo se informan)
+  * @retval false si no había un segmento reservado
+  */
+bool_t Secuenciador_Agregar(uint32_t repeticiones, uint32_t recortadas) {
+	if (reservado == 0) return false;
+
+	__disable_irq();
+	bool_t agregado = Seq_Agregar(&secuencia, memoria + usado, reservado, repeticiones);
+	__enable_irq();
+	if (agregado != true) Error_Handler();
+	usado += (reservado + 1) & ~1UL;	// De a pares: el acondicionamiento usa palabras
+	reservado = 0;
+
+	const segmento_t * seg = &secuencia.segmentos[secuencia.cantidad - 1];
+	char informe[96];
+	char * fin = Num_AgregarTexto(informe, "Segmento ");
+	fin = Num_AgregarDecimal(fin, secuencia.cantidad - 1);
+	fin = Num_AgregarTexto(fin, ": ");
+	fin = Num_AgregarDecimal(fin, seg->largo);
+	fin = Num_AgregarTexto(fin, " muestras x");
+	if (seg->repeticiones == SEQ_INFINITO) fin = Num_AgregarTexto(fin, "INF");
+	else fin = Num_AgregarDecimal(fin, seg->repeticiones);
+	fin = Num_AgregarTexto(fin, ", ");
+	fin = Num_AgregarDecimal(fin, recortadas);
+	fin = Num_AgregarTexto(fin, " recortadas, ");
+	fin = Num_AgregarDecimal(fin, SEQ_MEMORIA - usado);
+	fin = Num_AgregarTexto(fin, " muestras libres.\n");
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Borra todos los segmentos y libera la memoria
+  * @param  None
+  * @retval false si la secuencia está en marcha (ya informado por UART)
+  */
+bool_t Secuenciador_Vaciar(void) {
+	if (enMarcha) {
+		uartSendLiteral("Secuencia en marcha: SEQ OFF primero.\n");
+		return false;
+	}
+	Seq_Vaciar(&secuencia);
+	usado = 0;
+	reservado = 0;
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Arranca la secuencia desde el primer segmento con la frecuencia
+  *         de muestras actual de TIM2 e informa con Secuenciador_Informar().
+  *         El gránulo es el máximo común divisor de los largos.
+  * @param  None
+  * @retval false si no hay segmentos o el gránulo es menor que
+  *         SEQ_GRANULO_MINIMO (ya informado por UART)
+  */
+bool_t Secuenciador_Iniciar(void) {
+	if (secuencia.cantidad == 0) {
+		uartSendLiteral("Secuencia vacia: usar SEQ ADD.\n");
+		return false;
+	}
+	if (enMarcha) Secuenciador_Parar();
+	uint32_t granulo = Seq_Granulo(&secuencia);
+	if (Seq_Preparar(&secuencia, granulo) != true) {
+		char informe[96];
+		char * fin = Num_AgregarTexto(informe, "Los largos de los segmentos tienen MCD=");
+		fin = Num_AgregarDecimal(fin, granulo);
+		fin = Num_AgregarTexto(fin, ": debe ser al menos ");
+		fin = Num_AgregarDecimal(fin, SEQ_GRANULO_MINIMO);
+		fin = Num_AgregarTexto(fin, ".\n");
+		uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+		return false;
+	}
+	memset((void *) &contadores, 0, sizeof(contadores));
+
+	// Los dos primeros gránulos van a las dos memorias antes del primer disparo
+	Detener_Disparo_DAC_DMA();
+	const uint16_t * primero = Seq_Siguiente(&secuencia);
+	const uint16_t * segundo = Seq_Siguiente(&secuencia);
+	Comenzar_Secuencia_DAC_DMA(primero, segundo, granulo, siguiente);
+	Reanudar_Disparo_DAC_DMA();
+	enMarcha = true;
+
+	Secuenciador_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Pasa al segmento siguiente cuando termine la pasada en curso,
+  *         aunque le queden repeticiones (sale de un segmento INF).
+  * @param  None
+  * @retval None
+  */
+void Secuenciador_Avanzar(void) {
+	if (!enMarcha) {
+		uartSendLiteral("No hay secuencia en marcha.\n");
+		return;
+	}
+	Seq_Avanzar(&secuencia);
+}
+
+/*******************************************************************************
+  * @brief  Detiene la secuencia (la salida queda en la última muestra) e
+  *         informa: "FIN SEQ bloques= vueltas= respuesta="
+  * @param  None
+  * @retval None
+  */
+void Secuenciador_Parar(void) {
+	if (!enMarcha) return;
+	Parar_DAC_DMA();
+	enMarcha = false;
+
+	char informe[80];
+	char * fin = Num_AgregarTexto(informe, "FIN SEQ bloques=");
+	fin = Num_AgregarDecimal(fin, contadores.bloques);
+	fin = Num_AgregarTexto(fin, " vueltas=");
+	fin = Num_AgregarDecimal(fin, secuencia.vueltas);
+	fin = Num_AgregarTexto(fin, " respuesta=");
+	fin = Num_AgregarDecimal(fin, contadores.respuestaMaxima);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay una secuencia en marcha
+  * @param  None
+  * @retval true si el DAC está recorriendo la secuencia
+  */
+bool_t Secuenciador_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores de la secuencia en curso (o la última).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Secuenciador_Contadores(seqContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+}
+
+/*******************************************************************************
+  * @brief  Informa la secuencia y, en marcha, lo medido:
+  *         "SEQ=ON|OFF SEGMENTOS= GRANULO= MEMORIA=<usadas> EN_CURSO= VUELTAS=
+  *          BLOQUES= FS= CICLOS=<último> MAX=<peor> DEMORA=<muestras>
+  *          RESPUESTA=<ciclos> PLAZO=<ciclos> MARGEN=<%> TASA_MAX=<gránulos/s>
+  *          FS_MAX="
+  *         y un renglón por segmento: "<i>: <largo> x<repeticiones|INF>".
+  *         TASA_MAX es la tasa de gránulos a la que la peor respuesta
+  *         ocuparía todo el plazo; FS_MAX = TASA_MAX x GRANULO (el DAC no
+  *         pasa de 10,5 Msps).
+  * @param  None
+  * @retval None
+  */
+void Secuenciador_Informar(void) {
+	char informe[256];
+	seqContadores_t c;
+
+	Secuenciador_Contadores(&c);
+	uint32_t granulo = enMarcha ? secuencia.granulo : Seq_Granulo(&secuencia);
+	char * fin = Num_AgregarTexto(informe, enMarcha ? "SEQ=ON" : "SEQ=OFF");
+	fin = Num_AgregarTexto(fin, " SEGMENTOS=");
+	fin = Num_AgregarDecimal(fin, secuencia.cantidad);
+	fin = Num_AgregarTexto(fin, " GRANULO=");
+	fin = Num_AgregarDecimal(fin, granulo);
+	fin = Num_AgregarTexto(fin, " MEMORIA=");
+	fin = Num_AgregarDecimal(fin, usado);
+	if (enMarcha) {
+		uint32_t plazo = granulo * Leer_Ciclos_Muestra_DAC_DMA();
+		uint32_t respuesta = (c.respuestaMaxima > 0) ? c.respuestaMaxima : 1;
+		fin = Num_AgregarTexto(fin, " EN_CURSO=");
+		fin = Num_AgregarDecimal(fin, secuencia.actual);
+		fin = Num_AgregarTexto(fin, " VUELTAS=");
+		fin = Num_AgregarDecimal(fin, secuencia.vueltas);
+		fin = Num_AgregarTexto(fin, " BLOQUES=");
+		fin = Num_AgregarDecimal(fin, c.bloques);
+		fin = Num_AgregarTexto(fin, " FS=");
+		fin = Num_AgregarDecimal(fin, FRECUENCIA_TIM2 / (Leer_Periodo_DAC_DMA() + 1));
+		fin = Num_AgregarTexto(fin, " CICLOS=");
+		fin = Num_AgregarDecimal(fin, c.ciclos);
+		fin = Num_AgregarTexto(fin, " MAX=");
+		fin = Num_AgregarDecimal(fin, c.ciclosMaximo);
+		fin = Num_AgregarTexto(fin, " DEMORA=");
+		fin = Num_AgregarDecimal(fin, c.demoraMaxima);
+		fin = Num_AgregarTexto(fin, " RESPUESTA=");
+		fin = Num_AgregarDecimal(fin, c.respuestaMaxima);
+		fin = Num_AgregarTexto(fin, " PLAZO=");
+		fin = Num_AgregarDecimal(fin, plazo);
+		fin = Num_AgregarTexto(fin, " MARGEN=");
+		fin = Num_AgregarDecimal(fin, (respuesta < plazo) ? (uint32_t) ((uint64_t) (plazo - respuesta) * 100 / plazo) : 0);
+		fin = Num_AgregarTexto(fin, "% TASA_MAX=");
+		fin = Num_AgregarDecimal(fin, SystemCoreClock / respuesta);
+		fin = Num_AgregarTexto(fin, " FS_MAX=");
+		fin = Num_AgregarDecimal(fin, (uint32_t) ((uint64_t) SystemCoreClock * granulo / respuesta));
+	}
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+
+	for (uint32_t i=0; i<secuencia.cantidad; i++) {
+		const segmento_t * seg = &secuencia.segmentos[i];
+		fin = Num_AgregarDecimal(informe, i);
+		fin = Num_AgregarTexto(fin, ": ");
+		fin = Num_AgregarDecimal(fin, seg->largo);
+		fin = Num_AgregarTexto(fin, " x");
+		if (seg->repeticiones == SEQ_INFINITO) fin = Num_AgregarTexto(fin, "INF");
+		else fin = Num_AgregarDecimal(fin, seg->repeticiones);
+		*fin++ = '\n';
+		uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+	}
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Entrega el gránulo siguiente y mide la respuesta: las muestras que
+  *         ya salieron de la memoria nueva al entrar (resolución de una
+  *         muestra) más los ciclos hasta entregar. Contexto de interrupción.
+  * @param  quedan: muestras que le faltan a la memoria que empezó
+  * @retval Gránulo para la memoria que quedó libre
+  */
+static const uint16_t * siguiente(uint32_t quedan) {
+	uint32_t inicio = medicionCiclos();
+	const uint16_t * granulo = Seq_Siguiente(&secuencia);
+	uint32_t ciclos = medicionCiclos() - inicio;
+
+	uint32_t demora = secuencia.granulo - quedan;
+	uint32_t respuesta = demora * Leer_Ciclos_Muestra_DAC_DMA() + ciclos;
+	contadores.bloques++;
+	contadores.ciclos = ciclos;
+	if (ciclos > contadores.ciclosMaximo) contadores.ciclosMaximo = ciclos;
+	if (demora > contadores.demoraMaxima) contadores.demoraMaxima = demora;
+	if (respuesta > contadores.respuestaMaxima) contadores.respuestaMaxima = respuesta;
+	return granulo;
+}
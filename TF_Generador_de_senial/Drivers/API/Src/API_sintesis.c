@@ -0,0 +1,381 @@
+/*******************************************************************************
+  * @file		API_sintesis.c
+  * @brief      Síntesis de formas de onda en el dispositivo
+  *             (seno, cuadrada, triangular, sierra, continua y ruido)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_sintesis.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define LARGO_TABLA			(1 << SINT_BITS_TABLA)
+#define CUATRO_SOBRE_PI_Q16	83443		// 4/pi
+#define DOS_SOBRE_PI_Q16	41722		// 2/pi
+#define BITS_COEFICIENTE	8			// Amplitud de cada armónico en cuentas Q8
+
+/* Variables privadas --------------------------------------------------------*/
+// sin(2*pi*i/256) en Q15, con un valor extra para interpolar el último tramo
+static const int16_t TablaSeno[LARGO_TABLA + 1] = {
+		0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+		9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+		18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+		25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+		30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+		32609, 32678, 32728, 32757, 32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+		32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268,
+		28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+		23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151,
+		15446, 14732, 14010, 13279, 12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+		6393, 5602, 4808, 4011, 3212, 2410, 1608, 804, 0, -804, -1608, -2410,
+		-3212, -4011, -4808, -5602, -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+		-12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+		-20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+		-27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+		-31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+		-32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+		-31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+		-27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+		-20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+		-12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179, -6393, -5602, -4808, -4011,
+		-3212, -2410, -1608, -804, 0
+
+};
+
+// Amplitud (Q8) y fase de cada armónico de BL
+static int32_t Coeficientes[SINT_BL_MAX_ARMONICOS + 1];
+static uint32_t Fases[SINT_BL_MAX_ARMONICOS + 1];
+
+// Nombres de las formas para el comando GEN
+static const char * const NombreForma[] = {
+	[SINT_SENO]       = "SINE",
+	[SINT_CUADRADA]   = "SQUARE",
+	[SINT_TRIANGULAR] = "TRIANGLE",
+	[SINT_SIERRA]     = "SAW",
+	[SINT_CONTINUA]   = "DC",
+	[SINT_RUIDO]      = "NOISE"
+};
+
+/* Prototipos privados -------------------------------------------------------*/
+static uint32_t generarSeno(const sintesis_t * p, uint16_t * destino);
+static uint32_t generarCuadrada(const sintesis_t * p, uint16_t * destino);
+static uint32_t generarRampa(const sintesis_t * p, uint32_t subida, uint16_t * destino);
+static uint32_t generarRuido(const sintesis_t * p, uint16_t * destino);
+static uint32_t generarLimitada(const sintesis_t * p, uint32_t armonicos, uint16_t * destino);
+static uint32_t desplazamiento(const sintesis_t * p);
+
+/*******************************************************************************
+  * @brief  Carga parámetros por defecto: seno de 105 muestras a plena escala.
+  * @param  p: parámetros
+  * @retval None
+  */
+void Sint_Defecto(sintesis_t * p) {
+	p->forma = SINT_SENO;
+	p->largo = 105;
+	p->amplitud = 2047;
+	p->offset = 2048;
+	p->fase = 0;
+	p->ciclo = 50;
+	p->semilla = 1;
+	p->armonicos = 0;
+}
+
+/*******************************************************************************
+  * @brief  Interpreta "<FORMA> [N=..] [AMP=..] [OFF=..] [PHASE=..] [DUTY=..]
+  *         [SYM=..] [SEED=..] [BL=<K>|MAX|OFF]". Los parámetros omitidos
+  *         quedan como estaban.
+  * @param  texto: argumentos del comando GEN (se modifica)
+  * @param  p: parámetros a completar
+  * @retval true si el texto es válido
+  */
+bool_t Sint_Interpretar(char * texto, sintesis_t * p) {
+	char * token = strtok(texto, " ");
+	if (token == NULL) return false;
+
+	// Forma de onda
+	uint8_t i;
+	for (i=0; i<sizeof(NombreForma)/sizeof(NombreForma[0]); i++) {
+		if (strcmp(token, NombreForma[i]) == 0) break;
+	}
+	if (i >= sizeof(NombreForma)/sizeof(NombreForma[0])) return false;
+	p->forma = (formaOnda_t) i;
+
+	// Parámetros CLAVE=valor: número entero, en rango y sin nada detrás
+	while ((token = strtok(NULL, " ")) != NULL) {
+		char * igual = strchr(token, '=');
+		if (igual == NULL) return false;
+		*igual = '\0';
+		const char * texto = igual + 1;
+		int32_t valor;
+
+		if (strcmp(token, "BL") == 0) {
+			if (strcmp(texto, "MAX") == 0) p->armonicos = SINT_BL_NYQUIST;
+			else if (strcmp(texto, "OFF") == 0) p->armonicos = 0;
+			else if (Num_Leer(texto, 1, SINT_BL_MAX_ARMONICOS, &valor, NULL)) p->armonicos = (uint32_t) valor;
+			else return false;
+		} else if (strcmp(token, "N") == 0) {
+			if (Num_Leer(texto, 2, SINT_MAX_LARGO, &valor, NULL) != true) return false;
+			p->largo = (uint32_t) valor;
+		} else if (strcmp(token, "AMP") == 0) {
+			if (Num_Leer(texto, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+			p->amplitud = valor;
+		} else if (strcmp(token, "OFF") == 0) {
+			if (Num_Leer(texto, 0, SINT_MAX_DAC, &valor, NULL) != true) return false;
+			p->offset = valor;
+		} else if (strcmp(token, "PHASE") == 0) {
+			// Con signo: -90 es 270
+			if (Num_Leer(texto, -INT32_MAX, INT32_MAX, &valor, NULL) != true) return false;
+			valor %= 360;
+			p->fase = (uint32_t) ((valor < 0) ? valor + 360 : valor);
+		} else if (strcmp(token, "DUTY") == 0 || strcmp(token, "SYM") == 0) {
+			if (Num_Leer(texto, 0, 100, &valor, NULL) != true) return false;
+			p->ciclo = (uint32_t) valor;
+		} else if (strcmp(token, "SEED") == 0) {
+			if (Num_Leer(texto, 0, INT32_MAX, &valor, NULL) != true) return false;
+			p->semilla = (uint32_t) valor;
+		} else {
+			return false;
+		}
+	}
+
+	return (p->largo >= 2 && p->ciclo <= 100 && p->amplitud >= 0);
+}
+
+/*******************************************************************************
+  * @brief  Genera un período de la forma de onda.
+  *         Los valores fuera de 0..4095 se saturan.
+  * @param  p: parámetros
+  * @param  destino: p->largo muestras
+  * @retval Cantidad de muestras saturadas
+  */
+uint32_t Sint_Generar(const sintesis_t * p, uint16_t * destino) {
+	uint32_t armonicos = Sint_Armonicos(p);
+	if (armonicos > 0) return generarLimitada(p, armonicos, destino);
+
+	switch (p->forma) {
+	case SINT_SENO:			return generarSeno(p, destino);
+	case SINT_CUADRADA:		return generarCuadrada(p, destino);
+	case SINT_TRIANGULAR:	return generarRampa(p, (p->largo * p->ciclo) / 100, destino);
+	case SINT_SIERRA:		return generarRampa(p, p->largo, destino);
+	case SINT_RUIDO:		return generarRuido(p, destino);
+	case SINT_CONTINUA:
+	default: {
+		int32_t v = (int32_t) __USAT(p->offset, 12);
+		for (uint32_t k=0; k<p->largo; k++) destino[k] = (uint16_t) v;
+		return (v != p->offset) ? p->largo : 0;
+	}
+	}
+}
+
+/*******************************************************************************
+  * @brief  Último armónico que suma la síntesis de banda limitada: el de BL,
+  *         sin llegar a N/2 (fs/2 al reproducir la tabla) ni pasar de
+  *         SINT_BL_MAX_ARMONICOS.
+  * @param  p: parámetros
+  * @retval K, o 0 si la forma se genera directamente (sin BL, o no es una
+  *         cuadrada ni una sierra)
+  */
+uint32_t Sint_Armonicos(const sintesis_t * p) {
+	if (p->armonicos == 0 || (p->forma != SINT_CUADRADA && p->forma != SINT_SIERRA)) return 0;
+	uint32_t armonicos = (p->largo - 1) / 2;
+	if (armonicos > SINT_BL_MAX_ARMONICOS) armonicos = SINT_BL_MAX_ARMONICOS;
+	if (p->armonicos < armonicos) armonicos = p->armonicos;
+	return armonicos;
+}
+
+/*******************************************************************************
+  * @brief  Seno de tabla con interpolación lineal.
+  * @param  fase: 32 bits, 2^32 = una vuelta
+  * @retval sin(fase) en Q15
+  */
+int32_t Sint_Seno(uint32_t fase) {
+	uint32_t indice = fase >> (32 - SINT_BITS_TABLA);
+	int32_t fraccion = (int32_t) ((fase >> (16 - SINT_BITS_TABLA)) & 0xFFFF);
+	int32_t a = TablaSeno[indice];
+	int32_t b = TablaSeno[indice + 1];
+	return a + (((b - a) * fraccion + 0x8000) >> 16);	// Redondeo: media cero
+}
+
+/*******************************************************************************
+  * @brief  Convierte grados a fase de 32 bits.
+  * @param  grados: 0..359
+  * @retval Fase (2^32 = 360°)
+  */
+uint32_t Sint_Grados(uint32_t grados) {
+	return (uint32_t) ((((uint64_t) (grados % 360)) << 32) / 360);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Seno: la fase avanza 2^32/N por muestra. El resto de esa división
+  *         se acumula (como en Bresenham) para que el período cierre exacto.
+  */
+static uint32_t generarSeno(const sintesis_t * p, uint16_t * destino) {
+	const uint64_t vuelta = (uint64_t) 1 << 32;
+	uint32_t paso = (uint32_t) (vuelta / p->largo);
+	uint32_t resto = (uint32_t) (vuelta % p->largo);
+	uint32_t error = 0;
+	uint32_t fase = Sint_Grados(p->fase);
+	uint32_t saturadas = 0;
+
+	for (uint32_t k=0; k<p->largo; k++) {
+		int32_t v = p->offset + ((p->amplitud * Sint_Seno(fase)) >> 15);
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[k] = (uint16_t) s;
+
+		fase += paso;
+		error += resto;
+		if (error >= p->largo) {
+			error -= p->largo;
+			fase++;
+		}
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Cuadrada: alto durante DUTY % del período y bajo el resto.
+  */
+static uint32_t generarCuadrada(const sintesis_t * p, uint16_t * destino) {
+	int32_t alto = p->offset + p->amplitud;
+	int32_t bajo = p->offset - p->amplitud;
+	uint16_t altoSat = (uint16_t) __USAT(alto, 12);
+	uint16_t bajoSat = (uint16_t) __USAT(bajo, 12);
+	uint32_t transicion = (p->largo * p->ciclo) / 100;
+	uint32_t j = desplazamiento(p);
+	uint32_t saturadas = 0;
+
+	for (uint32_t k=0; k<p->largo; k++) {
+		if (j < transicion) {
+			destino[k] = altoSat;
+			saturadas += (altoSat != alto);
+		} else {
+			destino[k] = bajoSat;
+			saturadas += (bajoSat != bajo);
+		}
+		if (++j >= p->largo) j = 0;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Rampa de subida en 'subida' muestras y de bajada en el resto.
+  *         Con subida = N es una sierra. El acumulador es la altura sobre
+  *         el valle en 16.16 sin signo: va de 0 a 2 AMP, así que no se
+  *         desplazan valores negativos (el valle puede estar bajo cero).
+  */
+static uint32_t generarRampa(const sintesis_t * p, uint32_t subida, uint16_t * destino) {
+	int32_t bajo = p->offset - p->amplitud;
+	uint32_t excursion = (uint32_t) (2 * p->amplitud) << 16;	// Pico a pico (AMP <= 4095)
+	uint32_t bajada = p->largo - subida;
+	uint32_t pasoSubida = (subida > 0) ? excursion / subida : 0;
+	uint32_t pasoBajada = (bajada > 0) ? excursion / bajada : 0;
+	uint32_t j = desplazamiento(p);
+	uint32_t saturadas = 0;
+
+	// Altura inicial según la fase: nunca pasa de la excursión
+	uint32_t altura = (j < subida)
+			? pasoSubida * j
+			: excursion - pasoBajada * (j - subida);
+
+	for (uint32_t k=0; k<p->largo; k++) {
+		int32_t v = bajo + (int32_t) (altura >> 16);
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[k] = (uint16_t) s;
+
+		j++;
+		if (j < subida) {
+			altura += pasoSubida;
+		} else if (j == subida) {
+			altura = (bajada == 0) ? 0 : excursion;			// Pico exacto
+		} else if (j < p->largo) {
+			altura -= pasoBajada;
+		}
+		if (j >= p->largo) {
+			j = 0;
+			altura = (subida > 0) ? 0 : excursion;		// Sin subida arranca en el pico
+		}
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Ruido uniforme en [OFF - AMP, OFF + AMP] con xorshift32.
+  */
+static uint32_t generarRuido(const sintesis_t * p, uint16_t * destino) {
+	uint32_t x = (p->semilla != 0) ? p->semilla : 1;
+	uint32_t rango = (uint32_t) (2 * p->amplitud + 1);
+	uint32_t saturadas = 0;
+
+	for (uint32_t k=0; k<p->largo; k++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		int32_t v = p->offset - p->amplitud + (int32_t) (((x >> 16) * rango) >> 16);
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[k] = (uint16_t) s;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Cuadrada o sierra de banda limitada: la serie de Fourier de la
+  *         forma ideal cortada en el armónico K (ver Sint_Armonicos).
+  *          - Pulso de ciclo D entre -AMP y +AMP: media AMP (2D - 1) y
+  *            armónicos (4 AMP / pi k) sin(pi k D) cos(2 pi k t - pi k D).
+  *            D sale exacto de DUTY aunque N D no sea entero.
+  *          - Sierra de -AMP a +AMP: -(2 AMP / pi k) sin(2 pi k t).
+  *         PHASE corre el arranque como en la forma directa. En los flancos
+  *         la serie pasa por el punto medio y oscila (Gibbs): el pico llega
+  *         a cerca de 1,18 AMP, lo que pase de 0..4095 se satura.
+  *         Amplitudes Q8 por seno Q15 acumulados en 64 bits (SMLAL).
+  */
+static uint32_t generarLimitada(const sintesis_t * p, uint32_t armonicos, uint16_t * destino) {
+	uint32_t j = desplazamiento(p);
+	int32_t media = 0;
+	uint32_t saturadas = 0;
+
+	if (p->forma == SINT_CUADRADA) media = (p->amplitud * (2 * (int32_t) p->ciclo - 100)) / 100;
+	for (uint32_t k=1; k<=armonicos; k++) {
+		// Corrimiento de PHASE: k j / N de vuelta
+		uint32_t corrimiento = (uint32_t) ((((uint64_t) k * j) % p->largo << 32) / p->largo);
+		if (p->forma == SINT_CUADRADA) {
+			// pi k D como fase de 32 bits: k D / 2 vueltas
+			uint32_t medioCiclo = (uint32_t) (((uint64_t) k * p->ciclo << 31) / 100);
+			int64_t escala = (int64_t) p->amplitud * Sint_Seno(medioCiclo) * CUATRO_SOBRE_PI_Q16;
+			Coeficientes[k] = (int32_t) ((escala >> (15 + 16 - BITS_COEFICIENTE)) / (int32_t) k);
+			Fases[k] = 0x40000000u - medioCiclo + corrimiento;		// cos(x) = sin(x + 90°)
+		} else {
+			Coeficientes[k] = -(int32_t) ((((int64_t) p->amplitud * DOS_SOBRE_PI_Q16) >> (16 - BITS_COEFICIENTE)) / k);
+			Fases[k] = corrimiento;
+		}
+	}
+
+	for (uint32_t n=0; n<p->largo; n++) {
+		// Fase de la fundamental en la muestra n; la de k se acumula
+		uint32_t paso = (uint32_t) ((((uint64_t) n << 32) + p->largo / 2) / p->largo);
+		uint32_t fase = 0;
+		int64_t suma = 0;
+		for (uint32_t k=1; k<=armonicos; k++) {
+			fase += paso;
+			suma += (int64_t) Coeficientes[k] * Sint_Seno(fase + Fases[k]);
+		}
+		int32_t v = p->offset + media + (int32_t) ((suma + (1 << (14 + BITS_COEFICIENTE))) >> (15 + BITS_COEFICIENTE));
+		int32_t s = (int32_t) __USAT(v, 12);
+		saturadas += (s != v);
+		destino[n] = (uint16_t) s;
+	}
+	return saturadas;
+}
+
+/*******************************************************************************
+  * @brief  Índice de arranque dentro del período según PHASE.
+  */
+static uint32_t desplazamiento(const sintesis_t * p) {
+	return (uint32_t) (((uint64_t) p->largo * p->fase) / 360);
+}
@@ -0,0 +1,221 @@
+/*******************************************************************************
+  * @file		API_stream.c
+  * @brief      Reproducción continua (streaming) de muestras recibidas por UART
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * El lazo principal arma las muestras con los bytes de la UART y las pone en
+  * un buffer circular (productor). La interrupción de media transferencia del
+  * DMA las saca para recargar la mitad del buffer que el DAC ya leyó
+  * (consumidor). La tasa sostenida queda limitada por el enlace:
+  * UART_BAUDIOS / 10 / 2 muestras por segundo.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_stream.h"
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t memoriaMuestras[STREAM_CAPACIDAD];
+static ring_t muestras;							// Lazo principal -> DMA
+static uint16_t bufferDMA[2 * STREAM_MITAD];	// Lo que recorre el DAC
+
+static bool_t activo = false;
+static bool_t reproduciendo = false;		// DMA en marcha
+static volatile bool_t finRecibido = false;
+static volatile bool_t terminado = false;	// Lo marca la interrupción
+static volatile uint32_t sacadas = 0;		// Muestras que salieron del buffer circular
+static volatile uint8_t mitadesVacias = 0;	// Recargas sin datos luego del final
+static uint16_t ultimaMuestra = 0;
+static uint32_t acreditadas = 0;			// Muestras ya devueltas como créditos
+static uint8_t byteBajo = 0;				// Primer byte de una muestra en curso
+static bool_t mitadMuestra = false;
+static streamContadores_t contadores;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void recargar(uint16_t * mitad, uint32_t cantidad);
+static void guardarMuestra(uint16_t muestra);
+static void enviarCreditos(void);
+
+/*******************************************************************************
+  * @brief  Prepara el streaming y anuncia la capacidad al host.
+  *         La salida arranca cuando se completa el primer buffer del DMA.
+  * @param  periodo: ARR de TIM2 para la frecuencia de muestras
+  * @retval None
+  */
+void Stream_Iniciar(uint32_t periodo) {
+	ringInit(&muestras, memoriaMuestras, STREAM_CAPACIDAD, sizeof(uint16_t));
+	contadores.recibidas = 0;
+	contadores.reproducidas = 0;
+	contadores.subejecuciones = 0;
+	contadores.sobreescrituras = 0;
+	contadores.recortadas = 0;
+	sacadas = 0;
+	acreditadas = 0;
+	mitadesVacias = 0;
+	mitadMuestra = false;
+	finRecibido = false;
+	terminado = false;
+	reproduciendo = false;
+	activo = true;
+
+	Fijar_Periodo_DAC_DMA(periodo);
+	if (FRECUENCIA_TIM2 / (periodo + 1) > UART_BAUDIOS / 20) {
+		uartSendString((uint8_t *) "Aviso: frecuencia de muestras mayor que la del enlace.\n");
+	}
+
+	// Anuncio: "STREAM <capacidad> <credito>\n"
+	char anuncio[32];
+	char * fin = Num_AgregarDecimal(Num_AgregarTexto(anuncio, "STREAM "), STREAM_CAPACIDAD);
+	*fin++ = ' ';
+	fin = Num_AgregarDecimal(fin, STREAM_CREDITO);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) anuncio, (uint16_t) (fin - anuncio));
+}
+
+/*******************************************************************************
+  * @brief  Atiende el streaming desde el lazo principal: pasa los bytes
+  *         recibidos al buffer circular, arranca la salida y devuelve créditos.
+  * @param  None
+  * @retval false cuando el stream terminó (ya se detuvo la salida)
+  */
+bool_t Stream_Procesar(void) {
+	if (!activo) return false;
+
+	// 1) Bytes recibidos -> muestras. Se leen de a una muestra para no
+	//    consumir lo que sigue a STREAM_FIN: son comandos
+	uint8_t rx[2];
+	uint16_t leidos;
+	while (!finRecibido && (leidos = uartReceiveAvailable(rx, mitadMuestra ? 1 : 2)) > 0) {
+		for (uint16_t i=0; i<leidos; i++) {
+			if (!mitadMuestra) {
+				byteBajo = rx[i];
+				mitadMuestra = true;
+			} else {
+				guardarMuestra((uint16_t) (byteBajo | (rx[i] << 8)));
+				mitadMuestra = false;
+			}
+		}
+	}
+
+	// 2) Arranque: con el primer buffer completo (o con un stream corto)
+	if (!reproduciendo && (ringCount(&muestras) >= 2 * STREAM_MITAD || finRecibido)) {
+		recargar(bufferDMA, 2 * STREAM_MITAD);
+		Fijar_Recarga_DAC_DMA(recargar);
+		Comenzar_DAC_DMA(bufferDMA, 2 * STREAM_MITAD);
+		reproduciendo = true;
+	}
+
+	// 3) Créditos al host
+	if (!finRecibido) enviarCreditos();
+
+	// 4) Final: la interrupción avisa cuando ya salió todo
+	if (terminado) {
+		Stream_Parar();
+		return false;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene el streaming y restituye el período por defecto.
+  *         Informa los contadores por UART.
+  * @param  None
+  * @retval None
+  */
+void Stream_Parar(void) {
+	if (!activo) return;
+	Parar_DAC_DMA();
+	Fijar_Recarga_DAC_DMA(NULL);
+	Fijar_Periodo_DAC_DMA(PERIODO_DAC_DEFECTO);
+	activo = false;
+	reproduciendo = false;
+
+	char informe[96];
+	char * fin = Num_AgregarTexto(informe, "FIN STREAM recibidas=");
+	fin = Num_AgregarDecimal(fin, contadores.recibidas);
+	fin = Num_AgregarTexto(fin, " reproducidas=");
+	fin = Num_AgregarDecimal(fin, sacadas);
+	fin = Num_AgregarTexto(fin, " sub=");
+	fin = Num_AgregarDecimal(fin, contadores.subejecuciones);
+	fin = Num_AgregarTexto(fin, " sobre=");
+	fin = Num_AgregarDecimal(fin, contadores.sobreescrituras);
+	fin = Num_AgregarTexto(fin, " recortadas=");
+	fin = Num_AgregarDecimal(fin, contadores.recortadas);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores del stream actual (o del último).
+  * @param  contadores: destino
+  * @retval None
+  */
+void Stream_Contadores(streamContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	*destino = contadores;
+	destino->reproducidas = sacadas;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Recarga una mitad del buffer del DMA con el buffer circular.
+  *         Contexto de interrupción (salvo la primera carga completa).
+  *         Si faltan muestras repite la última: subejecución.
+  * @param  mitad: mitad del buffer que el DAC ya leyó
+  * @param  cantidad: muestras de esa mitad
+  * @retval None
+  */
+static void recargar(uint16_t * mitad, uint32_t cantidad) {
+	uint16_t muestra;
+	uint32_t i = 0;
+
+	while (i < cantidad && ringGet(&muestras, &muestra)) {
+		mitad[i++] = muestra;
+		ultimaMuestra = muestra;
+	}
+	sacadas += i;
+
+	if (i < cantidad) {
+		if (!finRecibido) {
+			contadores.subejecuciones += cantidad - i;
+		} else if (i == 0) {
+			// Luego del final, dos recargas vacías: el DAC ya sacó todo
+			mitadesVacias++;
+			if (mitadesVacias >= 2) terminado = true;
+		}
+		for (; i < cantidad; i++) mitad[i] = ultimaMuestra;
+	}
+}
+
+/*******************************************************************************
+  * @brief  Guarda una muestra recibida en el buffer circular.
+  * @param  muestra: valor recibido
+  * @retval None
+  */
+static void guardarMuestra(uint16_t muestra) {
+	if (muestra == STREAM_FIN) {
+		finRecibido = true;
+		return;
+	}
+	contadores.recibidas++;
+	if (muestra > 0x0FFF) {
+		contadores.recortadas++;
+		muestra = 0x0FFF;
+	}
+	if (ringPut(&muestras, &muestra) != true) contadores.sobreescrituras++;
+}
+
+/*******************************************************************************
+  * @brief  Devuelve al host un crédito por cada STREAM_CREDITO muestras
+  *         que la interrupción sacó del buffer circular.
+  * @param  None
+  * @retval None
+  */
+static void enviarCreditos(void) {
+	static const uint8_t credito = STREAM_BYTE_CREDITO;
+	while (sacadas - acreditadas >= STREAM_CREDITO) {
+		uartSendStringSize((uint8_t *) &credito, 1);
+		acreditadas += STREAM_CREDITO;
+	}
+}
@@ -0,0 +1,187 @@
+/*******************************************************************************
+  * @file		API_trazador.c
+  * @brief      Salida punto por punto (ver API_trazador.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_trazador.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define BYTES_POR_PUNTO			(sizeof(uint16_t) + sizeof(uint32_t))
+#define BYTES_POR_MUESTRA		sizeof(uint16_t)
+
+/* Variables privadas --------------------------------------------------------*/
+static puntos_t puntos;
+static bool_t enMarcha = false;
+
+/* Prototipos privados -------------------------------------------------------*/
+static char * agregarDecimal64(char * destino, uint64_t valor);
+static uint32_t microsegundos(uint64_t ciclos);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Agrega al final de la tabla los pares "<ns> <valor>" del texto e
+  *         informa: "Puntos: <n>, <duración> us, <libres> libres."
+  * @param  texto: uno o más pares separados por espacios
+  * @retval false si la tabla está en marcha o algún par no vale (no se
+  *         agrega ninguno; ya informado por UART)
+  */
+bool_t Trazador_Agregar(const char * texto) {
+	if (enMarcha) {
+		uartSendLiteral("Puntos en marcha: PTS OFF primero.\n");
+		return false;
+	}
+	if (Pts_Interpretar(texto, &puntos, FRECUENCIA_TIM2) != true) {
+		uartSendLiteral("Puntos invalidos: pares <ns> <valor> con ns 1..1000000000, valor 0..4095,\n"
+				        "al menos 16 ciclos de TIM2 (191 ns) por punto y hasta 2048 puntos.\n");
+		return false;
+	}
+
+	char informe[80];
+	char * fin = Num_AgregarTexto(informe, "Puntos: ");
+	fin = Num_AgregarDecimal(fin, puntos.cantidad);
+	fin = Num_AgregarTexto(fin, ", ");
+	fin = Num_AgregarDecimal(fin, microsegundos(puntos.ciclos));
+	fin = Num_AgregarTexto(fin, " us, ");
+	fin = Num_AgregarDecimal(fin, PTS_MAX_PUNTOS - puntos.cantidad);
+	fin = Num_AgregarTexto(fin, " libres.\n");
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Borra todos los puntos
+  * @param  None
+  * @retval false si la tabla está en marcha (ya informado por UART)
+  */
+bool_t Trazador_Vaciar(void) {
+	if (enMarcha) {
+		uartSendLiteral("Puntos en marcha: PTS OFF primero.\n");
+		return false;
+	}
+	Pts_Vaciar(&puntos);
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Arranca la tabla desde el primer punto e informa con
+  *         Trazador_Informar(). Mientras tanto TIM2 no tiene un período
+  *         fijo; al terminar vuelve al que tenía.
+  * @param  None
+  * @retval false si no hay puntos (ya informado por UART)
+  */
+bool_t Trazador_Iniciar(void) {
+	if (enMarcha) Trazador_Parar();
+	if (Pts_Preparar(&puntos) != true) {
+		uartSendLiteral("No hay puntos: usar PTS ADD.\n");
+		return false;
+	}
+	Comenzar_Puntos_DAC_DMA(puntos.valores, puntos.periodos, puntos.cantidad);
+	enMarcha = true;
+
+	Trazador_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene la tabla (la salida queda en el último punto) e informa:
+  *         "FIN PTS RATE=<ARR restituido>"
+  * @param  None
+  * @retval None
+  */
+void Trazador_Parar(void) {
+	if (!enMarcha) return;
+	Parar_Puntos_DAC_DMA();
+	Pts_Restaurar(&puntos);
+	enMarcha = false;
+
+	char informe[40];
+	char * fin = Num_AgregarTexto(informe, "FIN PTS RATE=");
+	fin = Num_AgregarDecimal(fin, Leer_Periodo_DAC_DMA());
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si la tabla está en marcha
+  * @param  None
+  * @retval true si el DAC está recorriendo los puntos
+  */
+bool_t Trazador_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Informa la tabla:
+  *         "PTS=ON|OFF PUNTOS= DURACION=<us> CICLO_MIN= CICLO_MAX= PASO=<mcd>
+  *          MEMORIA=<bytes> UNIFORME=<muestras> MEMORIA_UNIFORME=<bytes>"
+  *         CICLO_MIN y CICLO_MAX son los ciclos de TIM2 del punto más corto
+  *         y del más largo. UNIFORME es lo que ocuparía la misma señal con
+  *         paso fijo: un paso de PASO ciclos, que divide a todos los puntos.
+  * @param  None
+  * @retval None
+  */
+void Trazador_Informar(void) {
+	char informe[200];
+	uint32_t minimo = UINT32_MAX, maximo = 0;
+
+	for (uint32_t i=0; i<puntos.cantidad; i++) {
+		if (puntos.periodos[i] < minimo) minimo = puntos.periodos[i];
+		if (puntos.periodos[i] > maximo) maximo = puntos.periodos[i];
+	}
+	uint64_t uniforme = Pts_Muestras_Uniformes(&puntos);
+	char * fin = Num_AgregarTexto(informe, enMarcha ? "PTS=ON" : "PTS=OFF");
+	fin = Num_AgregarTexto(fin, " PUNTOS=");
+	fin = Num_AgregarDecimal(fin, puntos.cantidad);
+	fin = Num_AgregarTexto(fin, " DURACION=");
+	fin = Num_AgregarDecimal(fin, microsegundos(puntos.ciclos));
+	if (puntos.cantidad > 0) {
+		fin = Num_AgregarTexto(fin, " CICLO_MIN=");
+		fin = Num_AgregarDecimal(fin, minimo + 1);
+		fin = Num_AgregarTexto(fin, " CICLO_MAX=");
+		fin = Num_AgregarDecimal(fin, maximo + 1);
+	}
+	fin = Num_AgregarTexto(fin, " PASO=");
+	fin = Num_AgregarDecimal(fin, puntos.mcd);
+	fin = Num_AgregarTexto(fin, " MEMORIA=");
+	fin = Num_AgregarDecimal(fin, puntos.cantidad * BYTES_POR_PUNTO);
+	fin = Num_AgregarTexto(fin, " UNIFORME=");
+	fin = agregarDecimal64(fin, uniforme);
+	fin = Num_AgregarTexto(fin, " MEMORIA_UNIFORME=");
+	fin = agregarDecimal64(fin, uniforme * BYTES_POR_MUESTRA);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Como Num_AgregarDecimal, para valores de 64 bits
+  * @param  destino: lugar para al menos 2 x NUM_MAX_DIGITOS + 1 caracteres
+  * @param  valor: número
+  * @retval Puntero al '\0' final
+  */
+static char * agregarDecimal64(char * destino, uint64_t valor) {
+	if (valor <= UINT32_MAX) return Num_AgregarDecimal(destino, (uint32_t) valor);
+
+	// Parte alta y los nueve dígitos de abajo, con ceros a la izquierda
+	destino = Num_AgregarDecimal(destino, (uint32_t) (valor / 1000000000u));
+	uint32_t resto = (uint32_t) (valor % 1000000000u);
+	for (uint32_t peso = 100000000u; peso > 0; peso /= 10) {
+		*destino++ = (char) ('0' + (resto / peso) % 10);
+	}
+	*destino = '\0';
+	return destino;
+}
+
+/*******************************************************************************
+  * @brief  Pasa ciclos de TIM2 a microsegundos
+  * @param  ciclos: ciclos de TIM2
+  * @retval us (redondeado hacia abajo)
+  */
+static uint32_t microsegundos(uint64_t ciclos) {
+	return (uint32_t) (ciclos * 1000000u / FRECUENCIA_TIM2);
+}
@@ -0,0 +1,328 @@
+/*******************************************************************************
+  * @file		API_wobulador.c
+  * @brief      Barridos de frecuencia en tiempo real (ver API_wobulador.h)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "API_wobulador.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define DISPAROS_HASTA_DAC	2	// La muestra k sale con el disparo k + 2 de TIM2
+#define MARGEN_MARCA		2	// Disparos mínimos para programar una marca a tiempo
+
+/* Private variables HAL ------------------------------------------------------*/
+TIM_HandleTypeDef htim4;		// Cuenta disparos de TIM2 y saca las marcas
+
+/* Variables privadas --------------------------------------------------------*/
+static estadoBarrido_t estado;
+static uint16_t bufferDMA[2 * WOB_MITAD];
+static volatile wobContadores_t contadores;
+static volatile bool_t armada = false;			// CCR1 tiene una marca por salir
+static volatile bool_t haySiguiente = false;	// Y hay otra esperando
+static volatile uint16_t siguiente;
+static volatile uint32_t bloquesEnOff = 0;		// Bloques generados después de un ONCE
+static bool_t enMarcha = false;
+
+/* Prototipos privados -------------------------------------------------------*/
+static void MX_TIM4_Init(void);
+static void recargar(uint16_t * mitad, uint32_t cantidad);
+static void programarMarca(uint32_t muestra);
+static void armarMarca(uint16_t comparador);
+static void desarmarMarca(void);
+
+/* Funciones públicas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Inicializa TIM4 detenido y con la marca desarmada
+  * @param  None
+  * @retval None
+  */
+void Inicializar_Wobulador(void) {
+	MX_TIM4_Init();
+	if (HAL_TIM_OC_Start(&htim4, TIM_CHANNEL_1) != HAL_OK) Error_Handler();
+	__HAL_TIM_DISABLE(&htim4);
+}
+
+/*******************************************************************************
+  * @brief  Arranca el barrido con la frecuencia de muestras actual de TIM2.
+  *         Se arranca con el timer detenido: TIM4 empieza en cero con el
+  *         primer disparo. Informa con Wob_Informar().
+  * @param  b: parámetros (ver Barrido_Interpretar)
+  * @retval false si el barrido no entra en la frecuencia de muestras (ya
+  *         informado por UART)
+  */
+bool_t Wob_Iniciar(const barrido_t * b) {
+	static estadoBarrido_t nuevo;
+	if (Barrido_Preparar(&nuevo, b, FRECUENCIA_TIM2, Leer_Periodo_DAC_DMA() + 1) != true) {
+		uartSendLiteral("Barrido invalido para la frecuencia de muestras (F < fs/2, T de al menos"
+				        " 2 muestras, LOG hasta 1/4 de octava cada 64 muestras).\n");
+		return false;
+	}
+	if (enMarcha) Wob_Parar();
+	estado = nuevo;
+	memset((void *) &contadores, 0, sizeof(contadores));
+	bloquesEnOff = 0;
+
+	Detener_Disparo_DAC_DMA();
+	desarmarMarca();
+	haySiguiente = false;
+	__HAL_TIM_SET_COUNTER(&htim4, 0);
+	__HAL_TIM_CLEAR_FLAG(&htim4, TIM_FLAG_CC1);
+	__HAL_TIM_ENABLE_IT(&htim4, TIM_IT_CC1);
+	__HAL_TIM_ENABLE(&htim4);
+
+	// TIM4 en cero: las marcas de las dos primeras mitades cuentan desde el primer disparo
+	Bloques_Comenzar(bufferDMA, WOB_MITAD, recargar);
+	enMarcha = true;
+
+	Wob_Informar();
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Detiene el barrido (la salida queda en la última muestra) e
+  *         informa: "FIN SWEEP barridos= marcas= perdidas= sat= atrasos="
+  * @param  None
+  * @retval None
+  */
+void Wob_Parar(void) {
+	if (!enMarcha) return;
+	Bloques_Parar();
+	__HAL_TIM_DISABLE_IT(&htim4, TIM_IT_CC1);
+	__HAL_TIM_DISABLE(&htim4);
+	desarmarMarca();
+	haySiguiente = false;
+	enMarcha = false;
+
+	char informe[96];
+	char * fin = Num_AgregarTexto(informe, "FIN SWEEP barridos=");
+	fin = Num_AgregarDecimal(fin, estado.barridos);
+	fin = Num_AgregarTexto(fin, " marcas=");
+	fin = Num_AgregarDecimal(fin, contadores.marcas);
+	fin = Num_AgregarTexto(fin, " perdidas=");
+	fin = Num_AgregarDecimal(fin, contadores.perdidas);
+	fin = Num_AgregarTexto(fin, " sat=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " atrasos=");
+	fin = Num_AgregarDecimal(fin, contadores.bloque.atrasos);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/*******************************************************************************
+  * @brief  Indica si hay un barrido en marcha
+  * @param  None
+  * @retval true si el DAC está barriendo
+  */
+bool_t Wob_Activo(void) {
+	return enMarcha;
+}
+
+/*******************************************************************************
+  * @brief  Atiende el barrido desde el lazo principal. Un barrido ONCE
+  *         termina cuando las dos mitades del buffer ya están en OFF, o
+  *         sea, cuando salió la última muestra.
+  * @param  None
+  * @retval false cuando el barrido terminó (ya se detuvo la salida)
+  */
+bool_t Wob_Procesar(void) {
+	if (!enMarcha) return false;
+	if (bloquesEnOff >= 2) {
+		Wob_Parar();
+		return false;
+	}
+	return true;
+}
+
+/*******************************************************************************
+  * @brief  Copia los contadores del barrido en curso (o el último).
+  * @param  destino: contadores
+  * @retval None
+  */
+void Wob_Contadores(wobContadores_t * destino) {
+	if (destino == NULL) Error_Handler();
+	__disable_irq();
+	*destino = contadores;
+	__enable_irq();
+}
+
+/*******************************************************************************
+  * @brief  Informa el barrido y su costo con la frecuencia actual:
+  *         "SWEEP=ON TIPO= F1= F2= T= [STEPS=] FS= F=<actual> BARRIDOS=
+  *          MARCAS= PERDIDAS= CICLOS=<último bloque> MAX=<peor bloque>
+  *          PRESUPUESTO= (por muestra) CARGA=<%> FS_MAX= SAT= ATRASOS="
+  *         FS_MAX estima la frecuencia de muestras a la que el peor bloque
+  *         ocuparía toda la CPU.
+  * @param  None
+  * @retval None
+  */
+void Wob_Informar(void) {
+	char informe[224];
+	wobContadores_t c;
+
+	if (!enMarcha) {
+		uartSendLiteral("SWEEP=OFF\n");
+		return;
+	}
+	Wob_Contadores(&c);
+	uint32_t divisor = Leer_Periodo_DAC_DMA() + 1;
+
+	char * fin = Num_AgregarTexto(informe, "SWEEP=ON TIPO=");
+	fin = Num_AgregarTexto(fin, Barrido_Nombre(estado.p.tipo));
+	fin = Num_AgregarTexto(fin, " F1=");
+	fin = Num_AgregarDecimal(fin, estado.p.f1);
+	fin = Num_AgregarTexto(fin, " F2=");
+	fin = Num_AgregarDecimal(fin, estado.p.f2);
+	fin = Num_AgregarTexto(fin, " T=");
+	fin = Num_AgregarDecimal(fin, estado.p.tiempo);
+	if (estado.p.tipo == BARRIDO_PASOS || estado.p.tipo == BARRIDO_PASOS_LOG) {
+		fin = Num_AgregarTexto(fin, " STEPS=");
+		fin = Num_AgregarDecimal(fin, estado.p.pasos);
+	}
+	fin = Num_AgregarTexto(fin, estado.p.repetir ? "" : " ONCE");
+	fin = Num_AgregarTexto(fin, " FS=");
+	fin = Num_AgregarDecimal(fin, FRECUENCIA_TIM2 / divisor);
+	fin = Num_AgregarTexto(fin, " F=");
+	fin = Num_AgregarDecimal(fin, Barrido_Frecuencia(&estado, FRECUENCIA_TIM2, divisor));
+	fin = Num_AgregarTexto(fin, " BARRIDOS=");
+	fin = Num_AgregarDecimal(fin, estado.barridos);
+	fin = Num_AgregarTexto(fin, " MARCAS=");
+	fin = Num_AgregarDecimal(fin, c.marcas);
+	fin = Num_AgregarTexto(fin, " PERDIDAS=");
+	fin = Num_AgregarDecimal(fin, c.perdidas);
+	fin = Bloques_AgregarCosto(fin, &c.bloque, WOB_MITAD);
+	fin = Num_AgregarTexto(fin, " FS_MAX=");
+	fin = Num_AgregarDecimal(fin, Bloques_Fs_Maxima(c.bloque.ciclosMaximo, WOB_MITAD, 100));
+	fin = Num_AgregarTexto(fin, " SAT=");
+	fin = Num_AgregarDecimal(fin, c.bloque.saturadas);
+	fin = Num_AgregarTexto(fin, " ATRASOS=");
+	fin = Num_AgregarDecimal(fin, c.bloque.atrasos);
+	*fin++ = '\n';
+	uartSendStringSize((uint8_t *) informe, (uint16_t) (fin - informe));
+}
+
+/* Interrupciones ------------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Salió una marca (CC1 de TIM4): arma la siguiente, si hay.
+  *         Misma prioridad que la interrupción del DMA del DAC: no se
+  *         interrumpen entre sí.
+  */
+void wobuladorMarcaIRQHandler(void) {
+	if (__HAL_TIM_GET_FLAG(&htim4, TIM_FLAG_CC1) == RESET) return;
+	__HAL_TIM_CLEAR_FLAG(&htim4, TIM_FLAG_CC1);
+	if (!armada) return;			// Comparación sin marca (modo congelado)
+
+	contadores.marcas++;
+	desarmarMarca();
+	if (haySiguiente) {
+		haySiguiente = false;
+		armarMarca(siguiente);
+	}
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Genera la mitad que el DAC ya leyó y programa su marca.
+  *         Contexto de interrupción (salvo las dos primeras).
+  * @param  mitad: mitad del buffer del DMA
+  * @param  cantidad: muestras de esa mitad (un bloque)
+  * @retval None
+  */
+static void recargar(uint16_t * mitad, uint32_t cantidad) {
+	uint32_t inicio = medicionCiclos();
+	uint32_t marcas = estado.marcas;
+	contadores.bloque.saturadas += Barrido_Generar(&estado, mitad, cantidad);
+	if (estado.marcas != marcas) {
+		contadores.perdidas += estado.marcas - marcas - 1;	// Más de una por bloque
+		programarMarca(estado.marca);
+	}
+	if (estado.terminado) bloquesEnOff++;
+	Bloques_Registrar(&contadores.bloque, inicio, cantidad);
+}
+
+/*******************************************************************************
+  * @brief  Programa la marca de la muestra indicada, o la deja esperando
+  *         si todavía no salió la anterior.
+  * @param  muestra: número de muestra desde el comienzo del barrido
+  * @retval None
+  */
+static void programarMarca(uint32_t muestra) {
+	uint16_t comparador = (uint16_t) (muestra + DISPAROS_HASTA_DAC);
+	if (!armada) {
+		armarMarca(comparador);
+	} else if (!haySiguiente) {
+		siguiente = comparador;
+		haySiguiente = true;
+	} else {
+		contadores.perdidas++;
+	}
+}
+
+/**
+  * @brief Carga CCR1 y pasa el canal a toggle, si el contador todavía no
+  *        llegó. La comparación vieja pudo dejar CC1 pendiente: se borra.
+  */
+static void armarMarca(uint16_t comparador) {
+	__HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_1, comparador);
+	__HAL_TIM_CLEAR_FLAG(&htim4, TIM_FLAG_CC1);
+	int16_t faltan = (int16_t) (comparador - (uint16_t) __HAL_TIM_GET_COUNTER(&htim4));
+	if (faltan < MARGEN_MARCA) {
+		contadores.perdidas++;
+		return;
+	}
+	MODIFY_REG(htim4.Instance->CCMR1, TIM_CCMR1_OC1M, TIM_OCMODE_TOGGLE);
+	armada = true;
+}
+
+/**
+  * @brief Canal 1 congelado: las comparaciones no cambian PD12
+  */
+static void desarmarMarca(void) {
+	MODIFY_REG(htim4.Instance->CCMR1, TIM_CCMR1_OC1M, TIM_OCMODE_TIMING);
+	armada = false;
+}
+
+/**
+  * @brief TIM4 Initialization Function
+  *        Reloj: TRGO de TIM2 (ITR1), 16 bits. Canal 1 a PD12, congelado
+  *        hasta que se arma una marca.
+  * @param None
+  * @retval None
+  */
+static void MX_TIM4_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  htim4.Instance = TIM4;
+  htim4.Init.Prescaler = 0;
+  htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim4.Init.Period = 0xFFFF;
+  htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_ITR1;
+  if (HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_OC_Init(&htim4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigOC.OCMode = TIM_OCMODE_TIMING;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if (HAL_TIM_OC_ConfigChannel(&htim4, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+  * @file		acond_bench.c
+  * @brief      Verificación y medición en la PC del acondicionamiento de muestras
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_acondicionamiento.c del firmware (con equivalentes en C
+  * de las instrucciones SIMD), lo compara bit a bit contra una versión escalar
+  * directa, con entradas fuera de rango, ganancias y offsets que saturan y
+  * largos impares, y mide el tiempo por muestra para N = 105, 4096 y 65536.
+  * En el dispositivo, la carga informa los ciclos medidos con el contador DWT.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o acond_bench acond_bench.c \
+  *               ../Drivers/API/Src/API_acondicionamiento.c
+  * Uso:       ./acond_bench
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "API_acondicionamiento.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_MUESTRAS	65536
+#define MUESTRAS_BENCH	(16 * 1024 * 1024)	// Muestras procesadas por medición
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t entrada[MAX_MUESTRAS + 1];
+static uint16_t salida[MAX_MUESTRAS + 1];
+static uint16_t esperada[MAX_MUESTRAS + 1];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Referencia escalar: la misma cuenta, una muestra por vez
+static uint32_t referencia(const uint16_t * origen, uint16_t * destino, uint32_t largo,
+		                   int16_t ganancia, int16_t offset) {
+	uint32_t recortadas = 0;
+	for (uint32_t i=0; i<largo; i++) {
+		int32_t x = (origen[i] > ACOND_MAX_DAC) ? ACOND_MAX_DAC : origen[i];
+		int32_t y = ((x * ganancia) >> ACOND_BITS_GANANCIA) + offset;
+		int32_t z = (y < 0) ? 0 : (y > ACOND_MAX_DAC) ? ACOND_MAX_DAC : y;
+		if (origen[i] > ACOND_MAX_DAC || z != y) recortadas++;
+		destino[i] = (uint16_t) z;
+	}
+	return recortadas;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(void) {
+	static const int16_t ganancias[] = { ACOND_GANANCIA_UNO, 2048, 6000, 32767, -4096, 0 };
+	static const int16_t offsets[] = { 0, 100, -300, 2048, 4095, -32768, 32767 };
+	static const uint32_t largos[] = { 1, 2, 3, 104, 105, 4096, 4097, MAX_MUESTRAS };
+	static const uint32_t medidos[] = { 105, 4096, MAX_MUESTRAS };
+	int errores = 0;
+
+	// 1) Igualdad bit a bit (y de la cuenta de recortadas) contra la referencia
+	srand(1);
+	for (uint32_t i=0; i<=MAX_MUESTRAS; i++) {
+		// Mayoría en rango, algunas apenas encima y algunas muy grandes
+		int r = rand() % 16;
+		entrada[i] = (uint16_t) ((r == 0) ? rand() % 65536 : (r == 1) ? 4090 + rand() % 12 : rand() % 4096);
+	}
+	for (unsigned g=0; g<sizeof(ganancias)/sizeof(ganancias[0]); g++) {
+		for (unsigned o=0; o<sizeof(offsets)/sizeof(offsets[0]); o++) {
+			for (unsigned l=0; l<sizeof(largos)/sizeof(largos[0]); l++) {
+				uint32_t n = largos[l];
+				salida[n] = 0xBEEF;
+				uint32_t a = Acond_Procesar(entrada, salida, n, ganancias[g], offsets[o]);
+				uint32_t b = referencia(entrada, esperada, n, ganancias[g], offsets[o]);
+				for (uint32_t i=0; i<n; i++) {
+					if (salida[i] != esperada[i]) { errores++; break; }
+				}
+				if (a != b || salida[n] != 0xBEEF) errores++;
+			}
+		}
+	}
+	// Origen desalineado y en el mismo lugar que el destino
+	referencia(&entrada[1], esperada, 4095, 3000, 77);
+	for (uint32_t i=0; i<4096; i++) salida[i] = entrada[i];
+	Acond_Procesar(&salida[1], &salida[1], 4095, 3000, 77);
+	for (uint32_t i=0; i<4095; i++) if (salida[i + 1] != esperada[i]) { errores++; break; }
+	printf("verificacion: %s\n", errores ? "ERROR" : "bit a bit igual a la referencia");
+
+	// 2) Tiempo por muestra
+	printf("%8s %14s %14s %14s\n", "N", "recorte ns/m", "gan+off ns/m", "escalar ns/m");
+	for (unsigned l=0; l<sizeof(medidos)/sizeof(medidos[0]); l++) {
+		uint32_t n = medidos[l];
+		uint32_t repeticiones = MUESTRAS_BENCH / n;
+		volatile uint32_t sumidero = 0;
+		double t[3];
+		for (int k=0; k<3; k++) {
+			double inicio = ahora();
+			for (uint32_t r=0; r<repeticiones; r++) {
+				if (k == 0) sumidero += Acond_Procesar(entrada, salida, n, ACOND_GANANCIA_UNO, 0);
+				if (k == 1) sumidero += Acond_Procesar(entrada, salida, n, 3000, 77);
+				if (k == 2) sumidero += referencia(entrada, salida, n, 3000, 77);
+			}
+			t[k] = (ahora() - inicio) * 1e9 / repeticiones / n;
+		}
+		printf("%8u %14.3f %14.3f %14.3f\n", (unsigned) n, t[0], t[1], t[2]);
+	}
+	return errores != 0;
+}
@@ -0,0 +1,383 @@
+/*******************************************************************************
+  * @file		aleatorio_bench.c
+  * @brief      Verificación y medición en la PC de las PRBS y el ruido (RAND)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_aleatorio.c del firmware y verifica:
+  *  - PRBS7, PRBS15 y PRBS23: el registro vuelve al inicio justo a los
+  *    2^n - 1 bits y no antes, con 2^(n-1) unos por período; en PRBS15 la
+  *    autocorrelación periódica vale -1 en todo retardo (secuencia m).
+  *    PRBS31: vuelve a los 2^31 - 1 bits (primo: no hay período menor).
+  *  - UNIF y GAUSS: media, desvío, curtosis y, en GAUSS, la fracción de
+  *    muestras a 1, 2 y 3 desvíos, sin filtro y con el CIC (la corrección
+  *    de ganancia conserva el desvío pedido).
+  *  - El ancho de banda a -3 dB (espectro promediado con ventana de Hann)
+  *    contra el que informa Alea_Ancho_Banda().
+  *  - La misma semilla repite la secuencia.
+  * y mide el tiempo por muestra de cada generador. En el dispositivo,
+  * RAND? informa los ciclos medidos con el contador DWT y la fs máxima de
+  * cada generador para una fracción de la CPU.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o aleatorio_bench aleatorio_bench.c \
+  *               ../Drivers/API/Src/API_aleatorio.c ../Drivers/API/Src/API_sintesis.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./aleatorio_bench [-31]    (-31: recorre también el período de PRBS31)
+  *            ./aleatorio_bench "<argumentos de RAND>" <muestras> > traza.txt
+  *            (traza: muestra, código del DAC)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_aleatorio.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define BLOQUE			128			// RUIDO_MITAD
+#define MUESTRAS_ESTAD	(1u << 22)
+#define N_FFT_MAXIMO	(1u << 17)
+#define MUESTRAS_FFT	(1u << 23)	// Muestras por medición de ancho de banda
+#define BINS_CRUCE		128			// La FFT se elige para que el cruce caiga por aquí
+#define SUAVIZADO		8			// Bins a cada lado al buscar el cruce
+#define MUESTRAS_TIEMPO	(1u << 24)
+
+/* Variables -----------------------------------------------------------------*/
+static estadoAleatorio_t Estado;
+static uint16_t Bloque[BLOQUE];
+static uint16_t Secuencia[1u << 15];
+
+/* Prototipos ----------------------------------------------------------------*/
+static bool_t probarPeriodo(tipoAleatorio_t tipo);
+static bool_t probarPrbs31(void);
+static bool_t probarAutocorrelacion(void);
+static bool_t probarEstadistica(tipoAleatorio_t tipo, int32_t amp, uint32_t dec);
+static bool_t probarAncho(tipoAleatorio_t tipo, uint32_t chip, uint32_t dec);
+static bool_t probarSemilla(void);
+static void medirTiempos(void);
+static void fft(double * re, double * im, uint32_t n);
+static aleatorio_t parametros(tipoAleatorio_t tipo, int32_t amp, uint32_t chip, uint32_t dec);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	bool_t bien = true;
+
+	if (argc > 2) {
+		// Traza de un RAND cualquiera
+		aleatorio_t a;
+		Alea_Defecto(&a);
+		if (Alea_Interpretar(argv[1], &a) != true || Alea_Preparar(&Estado, &a) != true) {
+			fprintf(stderr, "parametros invalidos\n");
+			return 2;
+		}
+		uint32_t total = (uint32_t) atol(argv[2]);
+		for (uint32_t n=0; n<total; n+=BLOQUE) {
+			Alea_Generar(&Estado, Bloque, BLOQUE);
+			for (uint32_t k=0; k<BLOQUE && n + k < total; k++) printf("%u, %u\n", n + k, Bloque[k]);
+		}
+		return 0;
+	}
+
+	printf("Periodo de las PRBS\n");
+	bien &= probarPeriodo(ALEA_PRBS7);
+	bien &= probarPeriodo(ALEA_PRBS15);
+	bien &= probarPeriodo(ALEA_PRBS23);
+	if (argc > 1 && strcmp(argv[1], "-31") == 0) bien &= probarPrbs31();
+	else printf("  PRBS31   (se recorre con -31)\n");
+	bien &= probarAutocorrelacion();
+
+	printf("\nEstadistica (%u muestras)\n", MUESTRAS_ESTAD);
+	bien &= probarEstadistica(ALEA_UNIFORME, 1000, 1);
+	bien &= probarEstadistica(ALEA_UNIFORME, 400, 16);
+	bien &= probarEstadistica(ALEA_GAUSS, 300, 1);
+	bien &= probarEstadistica(ALEA_GAUSS, 300, 16);
+	bien &= probarEstadistica(ALEA_GAUSS, 300, 256);
+
+	printf("\nAncho de banda a -3 dB (fracciones de fs)\n");
+	bien &= probarAncho(ALEA_GAUSS, 1, 1);
+	bien &= probarAncho(ALEA_GAUSS, 1, 2);
+	bien &= probarAncho(ALEA_GAUSS, 1, 4);
+	bien &= probarAncho(ALEA_GAUSS, 1, 16);
+	bien &= probarAncho(ALEA_UNIFORME, 1, 64);
+	bien &= probarAncho(ALEA_UNIFORME, 1, 256);
+	bien &= probarAncho(ALEA_PRBS23, 8, 1);
+	bien &= probarAncho(ALEA_PRBS23, 1, 8);
+
+	printf("\n");
+	bien &= probarSemilla();
+
+	printf("\nTiempo por muestra en esta PC (bloques de %u)\n", BLOQUE);
+	medirTiempos();
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+static aleatorio_t parametros(tipoAleatorio_t tipo, int32_t amp, uint32_t chip, uint32_t dec) {
+	aleatorio_t a;
+	Alea_Defecto(&a);
+	a.tipo = tipo;
+	a.amplitud = amp;
+	a.chip = chip;
+	a.decimacion = dec;
+	return a;
+}
+
+/*******************************************************************************
+  * @brief  El registro vuelve al inicio a los 2^n - 1 bits y no antes; un
+  *         período tiene 2^(n-1) unos
+  */
+static bool_t probarPeriodo(tipoAleatorio_t tipo) {
+	aleatorio_t a = parametros(tipo, 1, 1, 1);
+	if (Alea_Preparar(&Estado, &a) != true) return false;
+	uint32_t inicial = Estado.registro;
+	uint32_t esperado = Alea_Periodo_Bits(tipo);
+	uint32_t periodo = 0, unos = 0;
+	uint16_t muestra;
+
+	do {
+		Alea_Generar(&Estado, &muestra, 1);
+		unos += (muestra > 2048);
+		periodo++;
+	} while (Estado.registro != inicial && periodo <= esperado);
+
+	bool_t bien = (periodo == esperado && unos == (esperado + 1) / 2);
+	printf("  %-8s periodo=%u (esperado %u) unos=%u  %s\n", Alea_Nombre(tipo), periodo, esperado, unos,
+		   bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  PRBS31: vuelve al inicio a los 2^31 - 1 bits. Primo: si vuelve
+  *         ahí, no pudo volver antes.
+  */
+static bool_t probarPrbs31(void) {
+	aleatorio_t a = parametros(ALEA_PRBS31, 1, 1, 1);
+	if (Alea_Preparar(&Estado, &a) != true) return false;
+	uint32_t inicial = Estado.registro;
+	uint32_t esperado = Alea_Periodo_Bits(ALEA_PRBS31);
+	uint64_t unos = 0;
+	uint32_t n = 0;
+
+	while (esperado - n >= BLOQUE) {
+		Alea_Generar(&Estado, Bloque, BLOQUE);
+		for (uint32_t k=0; k<BLOQUE; k++) unos += (Bloque[k] > 2048);
+		n += BLOQUE;
+	}
+	Alea_Generar(&Estado, Bloque, esperado - n);
+	for (uint32_t k=0; k<esperado - n; k++) unos += (Bloque[k] > 2048);
+
+	bool_t bien = (Estado.registro == inicial && unos == (esperado + 1) / 2);
+	printf("  %-8s periodo=%u %s unos=%llu  %s\n", "PRBS31", esperado,
+		   (Estado.registro == inicial) ? "(vuelve)" : "(NO VUELVE)", (unsigned long long) unos, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  Autocorrelación periódica de PRBS15 en +-1: N en 0, -1 en el resto
+  */
+static bool_t probarAutocorrelacion(void) {
+	aleatorio_t a = parametros(ALEA_PRBS15, 1, 1, 1);
+	uint32_t p = Alea_Periodo_Bits(ALEA_PRBS15);
+	if (Alea_Preparar(&Estado, &a) != true) return false;
+	Alea_Generar(&Estado, Secuencia, p);
+
+	int32_t peor = -1;
+	for (uint32_t retardo=1; retardo<p; retardo++) {
+		int32_t suma = 0;
+		for (uint32_t n=0; n<p; n++) {
+			int32_t x = (Secuencia[n] > 2048) ? 1 : -1;
+			int32_t y = (Secuencia[(n + retardo) % p] > 2048) ? 1 : -1;
+			suma += x * y;
+		}
+		if (abs(suma + 1) > abs(peor + 1)) peor = suma;
+	}
+	bool_t bien = (peor == -1);
+	printf("  %-8s autocorrelacion fuera de 0: %d (esperado -1)  %s\n", "PRBS15", peor, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  Media, desvío y curtosis; en GAUSS, fracción a 1, 2 y 3 desvíos
+  */
+static bool_t probarEstadistica(tipoAleatorio_t tipo, int32_t amp, uint32_t dec) {
+	aleatorio_t a = parametros(tipo, amp, 1, dec);
+	if (Alea_Preparar(&Estado, &a) != true) return false;
+	double s1 = 0, s2 = 0, s4 = 0;
+	uint32_t dentro[3] = { 0, 0, 0 }, saturadas = 0;
+	int32_t minimo = 4095, maximo = 0;
+	double desvioPedido = (tipo == ALEA_GAUSS) ? amp : amp / sqrt(3.0);
+
+	// El filtro arranca vacío: se descarta el primer bloque
+	saturadas = Alea_Generar(&Estado, Bloque, BLOQUE);
+	for (uint32_t n=0; n<MUESTRAS_ESTAD; n+=BLOQUE) {
+		saturadas += Alea_Generar(&Estado, Bloque, BLOQUE);
+		for (uint32_t k=0; k<BLOQUE; k++) {
+			double x = (double) Bloque[k] - a.offset;
+			s1 += x;
+			s2 += x * x;
+			s4 += x * x * x * x;
+			if (Bloque[k] < minimo) minimo = Bloque[k];
+			if (Bloque[k] > maximo) maximo = Bloque[k];
+			for (uint32_t j=0; j<3; j++) dentro[j] += (fabs(x) <= (j + 1) * desvioPedido);
+		}
+	}
+	double media = s1 / MUESTRAS_ESTAD;
+	double varianza = s2 / MUESTRAS_ESTAD - media * media;
+	double desvio = sqrt(varianza);
+	double curtosis = (s4 / MUESTRAS_ESTAD) / (varianza * varianza);
+	double errorDesvio = 100.0 * (desvio / desvioPedido - 1.0);
+
+	// Uniforme: curtosis 1,8 sin filtro; el CIC la acerca a la gaussiana
+	bool_t bien = fabs(media) < 0.01 * desvioPedido && fabs(errorDesvio) < 1.5 && saturadas == 0;
+	if (tipo == ALEA_GAUSS) bien &= fabs(curtosis - 3.0) < 0.06;
+	if (tipo == ALEA_UNIFORME && dec == 1) bien &= (minimo == a.offset - amp && maximo == a.offset + amp);
+
+	printf("  %-6s AMP=%4d DEC=%3u media=%+6.2f desvio=%7.2f (pedido %7.2f, %+5.2f%%) curtosis=%5.3f",
+		   Alea_Nombre(tipo), amp, dec, media, desvio, desvioPedido, errorDesvio, curtosis);
+	if (tipo == ALEA_GAUSS) {
+		double f[3];
+		for (uint32_t j=0; j<3; j++) f[j] = 100.0 * dentro[j] / MUESTRAS_ESTAD;
+		bien &= fabs(f[0] - 68.27) < 0.3 && fabs(f[1] - 95.45) < 0.15 && fabs(f[2] - 99.73) < 0.05;
+		printf(" 1s=%5.2f%% 2s=%5.2f%% 3s=%5.3f%%", f[0], f[1], f[2]);
+	} else {
+		printf(" min=%d max=%d", minimo, maximo);
+	}
+	printf("  %s\n", bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  Frecuencia donde el espectro promediado cae a la mitad de la
+  *         potencia de las frecuencias bajas, contra Alea_Ancho_Banda()
+  */
+static bool_t probarAncho(tipoAleatorio_t tipo, uint32_t chip, uint32_t dec) {
+	static double re[N_FFT_MAXIMO], im[N_FFT_MAXIMO], potencia[N_FFT_MAXIMO / 2], ventana[N_FFT_MAXIMO];
+	static uint16_t muestras[N_FFT_MAXIMO];
+	const uint32_t fs = 1000000;
+	aleatorio_t a = parametros(tipo, 300, chip, dec);
+	if (Alea_Preparar(&Estado, &a) != true) return false;
+	double informado = (double) Alea_Ancho_Banda(&a, fs) / fs;
+
+	uint32_t n = 1024;
+	while (n < N_FFT_MAXIMO && n * informado < BINS_CRUCE) n <<= 1;
+	for (uint32_t k=0; k<n; k++) ventana[k] = 0.5 - 0.5 * cos(2 * M_PI * k / n);
+
+	memset(potencia, 0, sizeof(potencia));
+	Alea_Generar(&Estado, muestras, n);		// Filtro lleno
+	for (uint32_t p=0; p<MUESTRAS_FFT / n; p++) {
+		Alea_Generar(&Estado, muestras, n);
+		for (uint32_t k=0; k<n; k++) {
+			re[k] = ((double) muestras[k] - a.offset) * ventana[k];
+			im[k] = 0;
+		}
+		fft(re, im, n);
+		for (uint32_t k=0; k<n / 2; k++) potencia[k] += re[k] * re[k] + im[k] * im[k];
+	}
+
+	// Referencia: los bins 1..8 (la ventana ensucia el 0). El cruce se busca
+	// en el promedio de +-SUAVIZADO bins y se interpola
+	double referencia = 0, anterior = 0;
+	for (uint32_t k=1; k<=8; k++) referencia += potencia[k] / 8;
+	double medido = 0.5;
+	for (uint32_t k=1 + SUAVIZADO; k<n / 2 - SUAVIZADO; k++) {
+		double suave = 0;
+		for (int32_t j=-SUAVIZADO; j<=SUAVIZADO; j++) suave += potencia[k + j] / (2 * SUAVIZADO + 1);
+		if (suave < referencia / 2) {
+			double t = (anterior - referencia / 2) / (anterior - suave);
+			medido = (k - 1 + t) / n;
+			break;
+		}
+		anterior = suave;
+	}
+	double error = 100.0 * (medido / informado - 1.0);
+	bool_t bien = (informado == 0.5) ? (medido == 0.5) : (fabs(error) < 5.0);
+	printf("  %-7s CHIP=%u DEC=%3u FFT=%6u medido=%.5f informado=%.5f (%+5.1f%%)  %s\n",
+		   Alea_Nombre(tipo), chip, dec, n, medido, informado, (informado == 0.5) ? 0.0 : error, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  La misma semilla da la misma secuencia; otra semilla, otra
+  */
+static bool_t probarSemilla(void) {
+	static uint16_t primera[4096], segunda[4096];
+	bool_t bien = true;
+
+	for (uint32_t t=0; t<ALEA_TIPOS; t++) {
+		aleatorio_t a = parametros((tipoAleatorio_t) t, 1000, 1, 4);
+		a.semilla = 12345;
+		Alea_Preparar(&Estado, &a);
+		Alea_Generar(&Estado, primera, 4096);
+		Alea_Preparar(&Estado, &a);
+		Alea_Generar(&Estado, segunda, 4096);
+		bool_t igual = (memcmp(primera, segunda, sizeof(primera)) == 0);
+		a.semilla = 54321;
+		Alea_Preparar(&Estado, &a);
+		Alea_Generar(&Estado, segunda, 4096);
+		bool_t distinta = (memcmp(primera, segunda, sizeof(primera)) != 0);
+		if (!igual || !distinta) {
+			printf("  %-7s semilla: %s %s  ERROR\n", Alea_Nombre((tipoAleatorio_t) t),
+				   igual ? "" : "no repite", distinta ? "" : "otra semilla repite");
+			bien = false;
+		}
+	}
+	if (bien) printf("Semilla: la misma repite la secuencia, otra la cambia  ok\n");
+	return bien;
+}
+
+/*******************************************************************************
+  * @brief  ns por muestra de cada generador, sin filtro y con DEC=16
+  */
+static void medirTiempos(void) {
+	static const uint32_t decimaciones[] = { 1, 16 };
+	for (uint32_t d=0; d<2; d++) {
+		for (uint32_t t=0; t<ALEA_TIPOS; t++) {
+			aleatorio_t a = parametros((tipoAleatorio_t) t, 500, 1, decimaciones[d]);
+			Alea_Preparar(&Estado, &a);
+			uint32_t control = 0;
+			clock_t inicio = clock();
+			for (uint32_t n=0; n<MUESTRAS_TIEMPO; n+=BLOQUE) {
+				Alea_Generar(&Estado, Bloque, BLOQUE);
+				control += Bloque[n & (BLOQUE - 1)];
+			}
+			double ns = 1e9 * (double) (clock() - inicio) / CLOCKS_PER_SEC / MUESTRAS_TIEMPO;
+			printf("  %-7s DEC=%2u %6.2f ns/muestra (control %u)\n", Alea_Nombre((tipoAleatorio_t) t),
+				   decimaciones[d], ns, control & 0xFF);
+		}
+	}
+}
+
+/*******************************************************************************
+  * @brief  FFT radix 2 en el lugar, n potencia de 2
+  */
+static void fft(double * re, double * im, uint32_t n) {
+	for (uint32_t i=1, j=0; i<n; i++) {
+		uint32_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+	for (uint32_t largo=2; largo<=n; largo<<=1) {
+		double angulo = -2 * M_PI / largo;
+		for (uint32_t k=0; k<largo / 2; k++) {
+			double c = cos(angulo * k), s = sin(angulo * k);
+			for (uint32_t i=0; i<n; i+=largo) {
+				double ur = re[i + k], ui = im[i + k];
+				double vr = re[i + k + largo / 2] * c - im[i + k + largo / 2] * s;
+				double vi = re[i + k + largo / 2] * s + im[i + k + largo / 2] * c;
+				re[i + k] = ur + vr;
+				im[i + k] = ui + vi;
+				re[i + k + largo / 2] = ur - vr;
+				im[i + k + largo / 2] = ui - vi;
+			}
+		}
+	}
+}
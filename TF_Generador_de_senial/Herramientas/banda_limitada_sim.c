@@ -0,0 +1,312 @@
+/*******************************************************************************
+  * @file		banda_limitada_sim.c
+  * @brief      Simulación en la PC de la cuadrada, el pulso y la sierra de
+  *             banda limitada (GEN ... BL=)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_sintesis.c del firmware y, para cada forma y largo,
+  * compara la tabla directa (flancos muestreados) con la de banda limitada:
+  *  - El espectro de un período con una FFT de largo N cualquiera
+  *    (Bluestein sobre una radix 2): la tabla es periódica, así que no
+  *    hace falta ventana y cada bin es un armónico exacto.
+  *  - Contra la serie de Fourier de la forma ideal hasta fs/2, el error de
+  *    cada armónico (amplitud y fase): en la tabla directa es el aliasing
+  *    de los armónicos que pasan de fs/2, que caen sobre otros (con N
+  *    impar la cuadrada del 50% tiene además armónicos pares). SFDR =
+  *    fundamental / mayor error, en dBc.
+  *  - Que la tabla de banda limitada no se aparte más de 2 cuentas de la
+  *    misma serie calculada en doble precisión.
+  * El retenedor de orden cero del DAC multiplica los dos espectros por el
+  * mismo sinc: no cambia la comparación.
+  * Mide también el tiempo por muestra de la síntesis.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o banda_limitada_sim banda_limitada_sim.c \
+  *               ../Drivers/API/Src/API_sintesis.c ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./banda_limitada_sim
+  *            ./banda_limitada_sim "<argumentos de GEN>" > tabla.txt
+  *            (tabla: muestra, código del DAC)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_sintesis.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LARGO_MAXIMO	16384
+#define FFT_MAXIMA		(1u << 16)		// Radix 2 de Bluestein: >= 2 N - 1
+#define REPETICIONES	200				// Para medir el tiempo
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	double sfdr;			// dBc
+	uint32_t peor;			// Armónico del mayor error
+	double pares;			// Mayor armónico par, dBc (cuadrada del 50%)
+} calidad_t;
+
+/* Variables -----------------------------------------------------------------*/
+static uint16_t Directa[LARGO_MAXIMO];
+static uint16_t Limitada[LARGO_MAXIMO];
+static double Re[LARGO_MAXIMO], Im[LARGO_MAXIMO];
+
+/* Prototipos ----------------------------------------------------------------*/
+static void ideal(const sintesis_t * p, uint32_t k, double * re, double * im);
+static calidad_t medir(const sintesis_t * p, const uint16_t * tabla);
+static double errorSerie(const sintesis_t * p, const uint16_t * tabla, uint32_t armonicos);
+static void dft(const uint16_t * x, uint32_t n);
+static void fft2(double * re, double * im, uint32_t n, int signo);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	static const struct { formaOnda_t forma; uint32_t largo; uint32_t ciclo; uint32_t fase; } casos[] = {
+		{ SINT_CUADRADA, 105, 50, 0 }, { SINT_CUADRADA, 105, 20, 0 }, { SINT_SIERRA, 105, 50, 0 },
+		{ SINT_CUADRADA, 105, 20, 45 }, { SINT_SIERRA, 105, 50, 90 },
+		{ SINT_CUADRADA, 32, 50, 0 }, { SINT_SIERRA, 32, 50, 0 },
+		{ SINT_CUADRADA, 1000, 50, 0 }, { SINT_CUADRADA, 1000, 10, 0 }, { SINT_SIERRA, 1000, 50, 0 },
+	};
+	bool_t bien = true;
+
+	if (argc > 1) {
+		sintesis_t p;
+		char texto[256];
+		Sint_Defecto(&p);
+		snprintf(texto, sizeof(texto), "%s", argv[1]);
+		if (Sint_Interpretar(texto, &p) != true || p.largo > LARGO_MAXIMO) {
+			fprintf(stderr, "parametros invalidos\n");
+			return 2;
+		}
+		Sint_Generar(&p, Directa);
+		for (uint32_t n=0; n<p.largo; n++) printf("%u, %u\n", n, Directa[n]);
+		return 0;
+	}
+
+	printf("AMP=1600 OFF=2048 (el pico de Gibbs, 1,18 AMP, entra en 0..4095)\n\n");
+	printf("%-28s %4s %8s %6s %8s %6s %8s %9s %s\n", "forma", "K", "directa", "peor", "BL", "peor",
+		   "mejora", "error BL", "pares directa / BL");
+	for (uint32_t i=0; i<sizeof(casos)/sizeof(casos[0]); i++) {
+		sintesis_t p;
+		char nombre[32];
+		Sint_Defecto(&p);
+		p.forma = casos[i].forma;
+		p.largo = casos[i].largo;
+		p.ciclo = casos[i].ciclo;
+		p.fase = casos[i].fase;
+		p.amplitud = 1600;
+
+		uint32_t saturadas = Sint_Generar(&p, Directa);
+		p.armonicos = SINT_BL_NYQUIST;
+		uint32_t armonicos = Sint_Armonicos(&p);
+		saturadas += Sint_Generar(&p, Limitada);
+
+		calidad_t d = medir(&p, Directa);
+		calidad_t l = medir(&p, Limitada);
+		double error = errorSerie(&p, Limitada, armonicos);
+		bool_t caso = (saturadas == 0 && error <= 2.0 && l.sfdr > d.sfdr + 10.0);
+		bien &= caso;
+
+		if (p.forma == SINT_CUADRADA) snprintf(nombre, sizeof(nombre), "SQUARE N=%u DUTY=%u", p.largo, p.ciclo);
+		else snprintf(nombre, sizeof(nombre), "SAW N=%u", p.largo);
+		if (p.fase != 0) snprintf(nombre + strlen(nombre), sizeof(nombre) - strlen(nombre), " PH=%u", p.fase);
+		printf("%-28s %4u %6.1fdB %6u %6.1fdB %6u %6.1fdB %7.2f", nombre, armonicos, d.sfdr, d.peor, l.sfdr,
+			   l.peor, l.sfdr - d.sfdr, error);
+		if (p.forma == SINT_CUADRADA && p.ciclo == 50) {
+			if (d.pares > -200) printf("   %6.1f / %6.1f dBc", d.pares, l.pares);
+			else printf("   (N par: sin pares)");
+		}
+		printf("  %s\n", caso ? "ok" : "ERROR");
+	}
+
+	// Corte más bajo: por encima de K no queda nada (salvo la cuantización)
+	sintesis_t p;
+	Sint_Defecto(&p);
+	p.forma = SINT_CUADRADA;
+	p.largo = 1000;
+	p.amplitud = 1600;
+	p.armonicos = 15;
+	Sint_Generar(&p, Limitada);
+	dft(Limitada, p.largo);
+	double fundamental = hypot(Re[1], Im[1]), resto = 0;
+	for (uint32_t k=16; k<=p.largo / 2; k++) resto = fmax(resto, hypot(Re[k], Im[k]));
+	double arriba = 20 * log10(resto / fundamental);
+	bool_t corte = arriba < -70.0;
+	bien &= corte;
+	printf("\nSQUARE N=1000 BL=15: mayor armonico sobre K = %.1f dBc  %s\n", arriba, corte ? "ok" : "ERROR");
+
+	// Tiempo por muestra
+	printf("\nTiempo por muestra en esta PC\n");
+	static const uint32_t largos[] = { 105, 1000, 4096 };
+	for (uint32_t i=0; i<3; i++) {
+		Sint_Defecto(&p);
+		p.forma = SINT_CUADRADA;
+		p.largo = largos[i];
+		for (uint32_t modo=0; modo<2; modo++) {
+			p.armonicos = modo ? SINT_BL_NYQUIST : 0;
+			uint32_t repeticiones = (uint32_t) (REPETICIONES * 1000ULL / largos[i]) + 1;
+			clock_t inicio = clock();
+			for (uint32_t r=0; r<repeticiones; r++) Sint_Generar(&p, Limitada);
+			double ns = 1e9 * (double) (clock() - inicio) / CLOCKS_PER_SEC / ((double) repeticiones * p.largo);
+			printf("  SQUARE N=%-5u %-7s K=%3u %9.2f ns/muestra\n", p.largo, modo ? "BL=MAX" : "directa",
+				   Sint_Armonicos(&p), ns);
+		}
+	}
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Armónico k de la forma ideal (amplitud compleja en cuentas, como
+  *         2 X_k / N), con el corrimiento de PHASE de la tabla
+  */
+static void ideal(const sintesis_t * p, uint32_t k, double * re, double * im) {
+	double j = (double) (uint32_t) (((uint64_t) p->largo * p->fase) / 360);
+	double giro = 2 * M_PI * k * j / p->largo;
+	double a, fase;			// a cos(2 pi k t + fase)
+
+	if (p->forma == SINT_CUADRADA) {
+		double d = p->ciclo / 100.0;
+		a = 4.0 * p->amplitud / (M_PI * k) * sin(M_PI * k * d);
+		fase = -M_PI * k * d;
+	} else {
+		a = 2.0 * p->amplitud / (M_PI * k);
+		fase = M_PI / 2;				// -sin(x) = cos(x + 90°)
+	}
+	*re = a * cos(fase + giro);
+	*im = a * sin(fase + giro);
+}
+
+/*******************************************************************************
+  * @brief  SFDR de la tabla contra la forma ideal hasta fs/2
+  */
+static calidad_t medir(const sintesis_t * p, const uint16_t * tabla) {
+	calidad_t c = { 0, 0, -200 };
+	double fundamental, peor = 0;
+	double re, im;
+
+	dft(tabla, p->largo);
+	ideal(p, 1, &re, &im);
+	fundamental = hypot(re, im);
+	for (uint32_t k=1; k<=p->largo / 2; k++) {
+		double er = Re[k], ei = Im[k];
+		if (2 * k < p->largo) {
+			ideal(p, k, &re, &im);
+			er -= re;
+			ei -= im;
+		}
+		double error = hypot(er, ei);
+		if (error > peor) {
+			peor = error;
+			c.peor = k;
+		}
+		if ((k & 1) == 0 && hypot(Re[k], Im[k]) > 0) {
+			double par = 20 * log10(hypot(Re[k], Im[k]) / fundamental);
+			if (par > c.pares) c.pares = par;
+		}
+	}
+	c.sfdr = 20 * log10(fundamental / peor);
+	return c;
+}
+
+/*******************************************************************************
+  * @brief  Mayor diferencia, en cuentas, con la serie en doble precisión
+  */
+static double errorSerie(const sintesis_t * p, const uint16_t * tabla, uint32_t armonicos) {
+	double media = (p->forma == SINT_CUADRADA) ? p->amplitud * (2.0 * p->ciclo - 100) / 100 : 0;
+	double peor = 0;
+
+	for (uint32_t n=0; n<p->largo; n++) {
+		double v = p->offset + media;
+		for (uint32_t k=1; k<=armonicos; k++) {
+			double re, im;
+			ideal(p, k, &re, &im);
+			double x = 2 * M_PI * k * n / p->largo;
+			v += re * cos(x) - im * sin(x);
+		}
+		peor = fmax(peor, fabs(tabla[n] - v));
+	}
+	return peor;
+}
+
+/*******************************************************************************
+  * @brief  Espectro de un período de largo n cualquiera, con el algoritmo de
+  *         Bluestein (chirp-z) sobre FFT radix 2. Deja 2 X_k / n en Re, Im.
+  */
+static void dft(const uint16_t * x, uint32_t n) {
+	static double ar[FFT_MAXIMA], ai[FFT_MAXIMA], br[FFT_MAXIMA], bi[FFT_MAXIMA];
+	static double cr[LARGO_MAXIMO], ci[LARGO_MAXIMO];
+	uint32_t m = 1;
+	while (m < 2 * n - 1) m <<= 1;
+
+	// Chirp w_k = exp(-i pi k^2 / n); k^2 módulo 2n para no perder precisión
+	for (uint32_t k=0; k<n; k++) {
+		double angulo = M_PI * (double) (((uint64_t) k * k) % (2 * n)) / n;
+		cr[k] = cos(angulo);
+		ci[k] = -sin(angulo);
+	}
+	memset(ar, 0, m * sizeof(double));
+	memset(ai, 0, m * sizeof(double));
+	memset(br, 0, m * sizeof(double));
+	memset(bi, 0, m * sizeof(double));
+	for (uint32_t k=0; k<n; k++) {
+		ar[k] = x[k] * cr[k];
+		ai[k] = x[k] * ci[k];
+		br[k] = cr[k];
+		bi[k] = -ci[k];
+		if (k > 0) {
+			br[m - k] = cr[k];
+			bi[m - k] = -ci[k];
+		}
+	}
+	fft2(ar, ai, m, -1);
+	fft2(br, bi, m, -1);
+	for (uint32_t k=0; k<m; k++) {
+		double r = ar[k] * br[k] - ai[k] * bi[k];
+		double i = ar[k] * bi[k] + ai[k] * br[k];
+		ar[k] = r;
+		ai[k] = i;
+	}
+	fft2(ar, ai, m, 1);
+	for (uint32_t k=0; k<n; k++) {
+		double r = (ar[k] * cr[k] - ai[k] * ci[k]) / m;
+		double i = (ar[k] * ci[k] + ai[k] * cr[k]) / m;
+		Re[k] = 2 * r / n;
+		Im[k] = 2 * i / n;
+	}
+}
+
+/*******************************************************************************
+  * @brief  FFT radix 2 en el lugar, n potencia de 2; signo -1 directa, +1
+  *         inversa (sin escalar)
+  */
+static void fft2(double * re, double * im, uint32_t n, int signo) {
+	for (uint32_t i=1, j=0; i<n; i++) {
+		uint32_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+	for (uint32_t largo=2; largo<=n; largo<<=1) {
+		double angulo = signo * 2 * M_PI / largo;
+		for (uint32_t k=0; k<largo / 2; k++) {
+			double c = cos(angulo * k), s = sin(angulo * k);
+			for (uint32_t i=0; i<n; i+=largo) {
+				uint32_t a = i + k, b = i + k + largo / 2;
+				double vr = re[b] * c - im[b] * s;
+				double vi = re[b] * s + im[b] * c;
+				re[b] = re[a] - vr;
+				im[b] = im[a] - vi;
+				re[a] += vr;
+				im[a] += vi;
+			}
+		}
+	}
+}
@@ -0,0 +1,262 @@
+/*******************************************************************************
+  * @file		barrido_sim.c
+  * @brief      Simulación en la PC de los barridos de frecuencia (SWEEP)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_barrido.c del firmware y lo genera de a bloques del
+  * tamaño del modo SWEEP, como la interrupción del DMA. Cada muestra se
+  * compara contra un modelo ideal en doble precisión:
+  *  - frecuencia instantánea (el paso de fase) contra f(t) ideal,
+  *  - fase acumulada contra la suma ideal de f(t) / fs (continuidad: no
+  *    puede haber saltos en los bordes de bloque, de tramo ni de paso),
+  *  - la muestra del DAC contra offset + amp x sin(fase ideal), en LSB,
+  *  - las marcas (muestra en que empieza cada paso) y la salida en OFF al
+  *    terminar un barrido ONCE.
+  * Incluye los barridos más rápidos que admite el firmware (T = 1 ms de
+  * 0 a casi fs / 2, LOG en BARRIDO_MAX_OCTAVAS_TRAMO), verifica los
+  * rechazos y mide el tiempo por muestra.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o barrido_sim barrido_sim.c \
+  *               ../Drivers/API/Src/API_barrido.c ../Drivers/API/Src/API_sintesis.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./barrido_sim
+  *            ./barrido_sim "<argumentos de SWEEP>" [periodo] > traza.txt
+  *            (traza: muestra, frecuencia en Hz, código del DAC)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_barrido.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define RELOJ			84000000	// FRECUENCIA_TIM2
+#define BLOQUE			128			// WOB_MITAD
+#define MAX_ERROR_F		5e-5		// Error de frecuencia admitido, relativo a fs / 2
+#define MAX_ERROR_FASE	1e-3		// Ciclos
+#define MAX_ERROR_LSB	3			// Tabla de seno interpolada + redondeo
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	const char * nombre;
+	const char * argumentos;		// Como en el comando SWEEP
+	uint32_t periodo;				// ARR de TIM2
+} caso_t;
+
+typedef struct {
+	double errorF;					// Relativo a fs / 2
+	double errorFase;				// Ciclos
+	int32_t errorLsb;
+	uint32_t marcasMal;
+	uint32_t muestras;
+} resultado_t;
+
+/* Casos ---------------------------------------------------------------------*/
+static const caso_t Casos[] = {
+	{ "LIN subida",            "LIN F1=100 F2=10000 T=50",                 83 },
+	{ "LIN bajada",            "LIN F1=20000 F2=10 T=20",                  83 },
+	{ "LIN maxima (1 ms)",     "LIN F1=0 F2=5249000 T=1",                   7 },
+	{ "LIN desde 0 Hz",        "LIN F1=0 F2=1000 T=10 AMP=2047 OFF=2048",  839 },
+	{ "LOG subida",            "LOG F1=20 F2=20000 T=100",                 83 },
+	{ "LOG bajada",            "LOG F1=1000000 F2=1000 T=5",                7 },
+	{ "LOG maxima (1 ms)",     "LOG F1=1 F2=5249000 T=1",                   7 },
+	{ "LOG en el limite",      "LOG F1=20 F2=400000 T=4",                  83 },
+	{ "LOG corto (<64)",       "LOG F1=1000 F2=1010 T=1",                1679 },
+	{ "STEP",                  "STEP F1=1000 F2=10000 STEPS=10 T=2",       83 },
+	{ "STEP bajada",           "STEP F1=9000 F2=1000 STEPS=7 T=3",        83 },
+	{ "STEP 1 muestra",        "STEP F1=1 F2=400 STEPS=1000 T=1",      83999 },
+	{ "STEPLOG",               "STEPLOG F1=10 F2=100000 STEPS=41 T=1",     83 },
+	{ "STEPLOG bajada",        "STEPLOG F1=5000000 F2=50 STEPS=100 T=1",    7 },
+	{ "LIN ONCE",              "LIN F1=500 F2=1500 T=2 ONCE AMP=1000",     83 },
+	{ "STEPLOG ONCE",          "STEPLOG F1=100 F2=800 STEPS=4 T=1 ONCE",   83 },
+};
+
+/* Prototipos ----------------------------------------------------------------*/
+static bool_t preparar(const char * argumentos, uint32_t periodo, barrido_t * b, estadoBarrido_t * e);
+static double frecuenciaIdeal(const barrido_t * b, const estadoBarrido_t * e, uint64_t n);
+static resultado_t simular(const barrido_t * b, estadoBarrido_t * e, uint32_t periodo, uint32_t barridos, FILE * traza);
+static bool_t verificarLimites(void);
+static void medirTiempo(void);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	barrido_t b;
+	static estadoBarrido_t e;
+
+	if (argc >= 2) {
+		uint32_t periodo = (argc >= 3) ? (uint32_t) atoi(argv[2]) : 83;
+		if (!preparar(argv[1], periodo, &b, &e)) {
+			fprintf(stderr, "Parametros invalidos o fuera de rango para fs = %.0f\n", (double) RELOJ / (periodo + 1));
+			return 1;
+		}
+		resultado_t r = simular(&b, &e, periodo, 1, stdout);
+		fprintf(stderr, "%u muestras, error de f %.2e, de fase %.2e ciclos, %d LSB\n",
+				r.muestras, r.errorF, r.errorFase, r.errorLsb);
+		return 0;
+	}
+
+	bool_t bien = true;
+	printf("%-20s %9s %9s %10s %10s %4s %6s\n", "caso", "fs", "muestras", "err f", "err fase", "LSB", "marcas");
+	for (size_t i=0; i<sizeof(Casos)/sizeof(Casos[0]); i++) {
+		const caso_t * c = &Casos[i];
+		if (!preparar(c->argumentos, c->periodo, &b, &e)) {
+			printf("%-20s RECHAZADO\n", c->nombre);
+			bien = false;
+			continue;
+		}
+		resultado_t r = simular(&b, &e, c->periodo, 3, NULL);
+		bool_t ok = (r.errorF < MAX_ERROR_F && r.errorFase < MAX_ERROR_FASE
+				     && r.errorLsb <= MAX_ERROR_LSB && r.marcasMal == 0);
+		printf("%-20s %9.0f %9u %10.2e %10.2e %4d %6u %s\n", c->nombre, (double) RELOJ / (c->periodo + 1),
+				r.muestras, r.errorF, r.errorFase, r.errorLsb, r.marcasMal, ok ? "ok" : "FALLA");
+		bien = bien && ok;
+	}
+	bien = verificarLimites() && bien;
+	medirTiempo();
+	printf(bien ? "\nTodo bien.\n" : "\nHAY FALLAS.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+static bool_t preparar(const char * argumentos, uint32_t periodo, barrido_t * b, estadoBarrido_t * e) {
+	char texto[128];
+	strncpy(texto, argumentos, sizeof(texto) - 1);
+	texto[sizeof(texto) - 1] = '\0';
+	Barrido_Defecto(b);
+	if (!Barrido_Interpretar(texto, b)) return false;
+	return Barrido_Preparar(e, b, RELOJ, periodo + 1);
+}
+
+/**
+  * @brief Frecuencia ideal con que avanza la fase la muestra n del barrido
+  */
+static double frecuenciaIdeal(const barrido_t * b, const estadoBarrido_t * e, uint64_t n) {
+	double f1 = b->f1, f2 = b->f2;
+	double k = (double) (n / e->largo);		// Paso
+
+	switch (b->tipo) {
+	case BARRIDO_LIN:
+		return f1 + (f2 - f1) * (double) n / e->largo;
+	case BARRIDO_LOG:
+		return f1 * pow(f2 / f1, (double) n / e->largo);
+	case BARRIDO_PASOS:
+		return f1 + (f2 - f1) * k / (b->pasos - 1);
+	default:
+		return f1 * pow(f2 / f1, k / (b->pasos - 1));
+	}
+}
+
+/**
+  * @brief Genera 'barridos' barridos completos (y unos bloques más) de a
+  *        bloques y compara cada muestra con el modelo ideal.
+  *        Cada bloque se genera también de a una muestra, sobre una copia
+  *        del estado, para ver la fase y el paso de cada una: debe dar lo
+  *        mismo que el bloque entero.
+  */
+static resultado_t simular(const barrido_t * b, estadoBarrido_t * e, uint32_t periodo, uint32_t barridos, FILE * traza) {
+	resultado_t r = {0};
+	double fs = (double) RELOJ / (periodo + 1);
+	bool_t pasos = (b->tipo == BARRIDO_PASOS || b->tipo == BARRIDO_PASOS_LOG);
+	uint64_t porBarrido = pasos ? (uint64_t) e->largo * b->pasos : e->largo;
+	uint64_t total = (traza != NULL) ? porBarrido : porBarrido * barridos;
+	double faseIdeal = 0;					// Ciclos, módulo 1
+	uint32_t marcasEsperadas = 0;
+	uint16_t bloque[BLOQUE], unaPorUna[BLOQUE];
+	estadoBarrido_t copia;
+
+	total += 3 * BLOQUE;					// Con ONCE: la salida en OFF
+	for (uint64_t n=0; n<total; n+=BLOQUE) {
+		copia = *e;
+		Barrido_Generar(e, bloque, BLOQUE);
+
+		for (uint32_t i=0; i<BLOQUE; i++) {
+			uint64_t m = n + i;
+			uint64_t enBarrido = m % porBarrido;
+			bool_t fuera = (!b->repetir && m >= porBarrido);
+			uint64_t faseAntes = copia.fase;
+			uint32_t marcasAntes = copia.marcas;
+
+			Barrido_Generar(&copia, &unaPorUna[i], 1);
+			double fReal = ldexp((double) (copia.fase - faseAntes), -64) * fs;
+
+			// Marcas: al comienzo de cada barrido y de cada paso
+			bool_t marca = !fuera && (enBarrido == 0 || (pasos && enBarrido % e->largo == 0));
+			if (marca) marcasEsperadas++;
+			if (copia.marcas != marcasAntes && (!marca || copia.marca != (uint32_t) m)) r.marcasMal++;
+
+			// Fase: la del firmware contra la suma ideal
+			double diferencia = fabs(ldexp((double) faseAntes, -64) - faseIdeal);
+			if (diferencia > 0.5) diferencia = 1 - diferencia;
+			if (!fuera && diferencia > r.errorFase) r.errorFase = diferencia;
+
+			// Frecuencia con que avanzó la fase en esta muestra
+			double fIdeal = fuera ? 0 : frecuenciaIdeal(b, e, enBarrido);
+			double errorF = fabs(fReal - fIdeal) / (fs / 2);
+			if (errorF > r.errorF) r.errorF = errorF;
+
+			// Muestra del DAC contra la fase ideal
+			double ideal = fuera ? b->offset : b->offset + floor(b->amplitud * sin(2 * M_PI * faseIdeal));
+			if (ideal < 0) ideal = 0;
+			if (ideal > SINT_MAX_DAC) ideal = SINT_MAX_DAC;
+			int32_t errorLsb = abs((int32_t) bloque[i] - (int32_t) ideal);
+			if (errorLsb > r.errorLsb) r.errorLsb = errorLsb;
+
+			if (traza != NULL) fprintf(traza, "%llu %.3f %u\n", (unsigned long long) m, fReal, bloque[i]);
+			faseIdeal += fIdeal / fs;
+			faseIdeal -= floor(faseIdeal);
+		}
+		if (memcmp(unaPorUna, bloque, sizeof(bloque)) != 0 || copia.fase != e->fase) r.marcasMal++;
+		r.muestras += BLOQUE;
+	}
+	if (e->marcas != marcasEsperadas) r.marcasMal++;
+	return r;
+}
+
+/**
+  * @brief Parámetros que el firmware debe rechazar
+  */
+static bool_t verificarLimites(void) {
+	static const struct { const char * argumentos; uint32_t periodo; } Rechazos[] = {
+		{ "LIN F1=0 F2=5250000 T=1", 7 },		// Justo fs / 2
+		{ "LIN F1=0 F2=100000 T=1", 1679 },		// Más de fs / 2 con fs = 50 kHz
+		{ "LOG F1=0 F2=1000 T=10", 83 },		// LOG desde 0 Hz
+		{ "STEPLOG F1=10 F2=0 T=10", 83 },
+		{ "LOG F1=20 F2=400000 T=3", 83 },		// Más de 1/4 de octava por tramo
+		{ "LIN F1=0 F2=10 T=1", 83999 },		// Menos de dos muestras
+		{ "STEP STEPS=1", 83 },
+		{ "LIN T=0", 83 },
+		{ "SAW F1=10", 83 },
+		{ "LIN F1=10 X", 83 },
+	};
+	barrido_t b;
+	static estadoBarrido_t e;
+	bool_t bien = true;
+
+	for (size_t i=0; i<sizeof(Rechazos)/sizeof(Rechazos[0]); i++) {
+		if (preparar(Rechazos[i].argumentos, Rechazos[i].periodo, &b, &e)) {
+			printf("No rechazo: %s (periodo %u)\n", Rechazos[i].argumentos, Rechazos[i].periodo);
+			bien = false;
+		}
+	}
+	printf("\nRechazos: %s\n", bien ? "ok" : "FALLA");
+	return bien;
+}
+
+static void medirTiempo(void) {
+	barrido_t b;
+	static estadoBarrido_t e;
+	static uint16_t salida[BLOQUE];
+	const uint32_t vueltas = 200000;
+
+	preparar("LOG F1=10 F2=5000000 T=100", 7, &b, &e);
+	clock_t inicio = clock();
+	for (uint32_t i=0; i<vueltas; i++) Barrido_Generar(&e, salida, BLOQUE);
+	double segundos = (double) (clock() - inicio) / CLOCKS_PER_SEC;
+	printf("Tiempo en la PC: %.2f ns/muestra (en el dispositivo: SWEEP? CICLOS=)\n",
+		   segundos * 1e9 / ((double) vueltas * BLOQUE));
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+  * @file		cal_sim.c
+  * @brief      Simulación en la PC de la calibración del DAC (prueba de regresión)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Modela un DAC no ideal (error de ganancia y offset, INL en arco, un salto
+  * de DNL en la mitad de la escala y el buffer de salida que no llega a los
+  * rieles) y un ADC con ruido que se promedia como Medir_ADC(). Corre el mismo
+  * API_calibracion.c del firmware y verifica que, dentro del rango útil, la
+  * salida corregida quede a menos de ERROR_MAXIMO cuentas de la deseada.
+  * También verifica que sin lazo DAC->ADC la calibración se rechace y que la
+  * suma de verificación detecte una copia corrupta.
+  * Termina con código distinto de cero si algo falla.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o cal_sim cal_sim.c \
+  *               ../Drivers/API/Src/API_calibracion.c -lm
+  * Uso:       ./cal_sim
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "API_calibracion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define PROMEDIOS		64		// Conversiones por punto (como en el firmware)
+#define ERROR_MAXIMO	1.5		// Cuentas: tolerancia de la salida corregida
+
+/* Typedef privados ----------------------------------------------------------*/
+typedef struct {
+	const char * nombre;
+	double ganancia;		// Cuentas del ADC por código
+	double offset;			// Cuentas
+	double arco;			// INL máxima (cuentas) en el centro de la escala
+	double salto;			// DNL: escalón a partir del código 2048
+	double piso, techo;		// Rieles del buffer de salida (cuentas)
+	double ruido;			// Desvío del ruido del ADC (cuentas)
+	int conectado;			// 0: la entrada del ADC no ve la salida
+} dac_t;
+
+/* Funciones privadas --------------------------------------------------------*/
+
+// Salida del DAC simulado, en cuentas del ADC
+static double salidaDAC(const dac_t * dac, int codigo) {
+	double v = dac->offset + dac->ganancia * codigo
+	         + dac->arco * sin(M_PI * codigo / 4095.0)
+	         + ((codigo >= 2048) ? dac->salto : 0.0);
+	if (v < dac->piso) v = dac->piso;
+	if (v > dac->techo) v = dac->techo;
+	return v;
+}
+
+// Ruido gaussiano (Box-Muller)
+static double gauss(void) {
+	double u = (rand() + 1.0) / (RAND_MAX + 2.0), w = (rand() + 1.0) / (RAND_MAX + 2.0);
+	return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * w);
+}
+
+// Lo mismo que Medir_ADC(): promedio de conversiones, en cuentas x 16
+static uint16_t medir(const dac_t * dac, int codigo) {
+	uint32_t suma = 0;
+	for (int i=0; i<PROMEDIOS; i++) {
+		double v = dac->conectado ? salidaDAC(dac, codigo) + dac->ruido * gauss() : 0.0;
+		long c = lround(v);
+		suma += (uint32_t) ((c < 0) ? 0 : (c > 4095) ? 4095 : c);
+	}
+	return (uint16_t) (((suma << CAL_BITS_MEDIDA) + PROMEDIOS / 2) / PROMEDIOS);
+}
+
+// Calibra un DAC simulado y devuelve la cantidad de errores
+static int probar(const dac_t * dac) {
+	uint16_t medidas[CAL_PUNTOS];
+	static uint16_t tabla[CAL_CODIGOS];
+	calibracion_t cal, copia;
+	uint16_t minimo, maximo;
+
+	for (int k=0; k<CAL_PUNTOS; k++) medidas[k] = medir(dac, Cal_Codigo(k));
+	bool_t ajustada = Cal_Ajustar(medidas, &cal);
+	if (!dac->conectado) {
+		printf("%-22s %s\n", dac->nombre, ajustada ? "ERROR: se acepto sin lazo" : "rechazada (correcto)");
+		return ajustada ? 1 : 0;
+	}
+	if (!ajustada || !Cal_Valida(&cal)) {
+		printf("%-22s ERROR: ajuste rechazado\n", dac->nombre);
+		return 1;
+	}
+
+	// La copia (como la de la flash) sigue siendo válida; con un byte cambiado, no
+	int errores = 0;
+	memcpy(&copia, &cal, sizeof(cal));
+	if (!Cal_Valida(&copia)) errores++;
+	((uint8_t *) &copia)[20] ^= 0x01;
+	if (Cal_Valida(&copia)) errores++;
+
+	Cal_Tabla(&cal, tabla);
+	Cal_Rango(&cal, &minimo, &maximo);
+
+	// Error de la salida sin corregir y corregida, dentro del rango útil
+	double antes = 0.0, despues = 0.0;
+	for (int d=minimo; d<=maximo; d++) {
+		double e0 = fabs(salidaDAC(dac, d) - d);
+		double e1 = fabs(salidaDAC(dac, tabla[d]) - d);
+		if (e0 > antes) antes = e0;
+		if (e1 > despues) despues = e1;
+	}
+	if (despues > ERROR_MAXIMO) errores++;
+	for (int d=1; d<CAL_CODIGOS; d++) if (tabla[d] < tabla[d - 1]) { errores++; break; }
+
+	printf("%-22s gan %+7.2f%% off %+6.1f INL %5.2f rango %4u-%4u error %6.2f -> %4.2f %s\n",
+	       dac->nombre, (cal.ganancia / 65536.0 / (1 << CAL_BITS_MEDIDA) - 1.0) * 100.0,
+	       cal.offset / (double) (1 << CAL_BITS_MEDIDA), Cal_Inl_Maximo(&cal) / (double) (1 << CAL_BITS_MEDIDA),
+	       minimo, maximo, antes, despues, errores ? "ERROR" : "ok");
+	return errores;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(void) {
+	static const dac_t casos[] = {
+		//  nombre                  gan    off    arco  salto  piso   techo  ruido  lazo
+		{ "ideal",                 1.000,   0.0,  0.0,  0.0,   0.0, 4095.0, 0.0, 1 },
+		{ "ganancia y offset",     0.985,  18.0,  0.0,  0.0,   0.0, 4095.0, 1.0, 1 },
+		{ "offset negativo",       1.012, -25.0,  0.0,  0.0,   0.0, 4095.0, 1.0, 1 },
+		{ "INL en arco",           1.000,   5.0,  6.0,  0.0,   0.0, 4095.0, 1.0, 1 },
+		{ "salto de DNL",          0.995,   3.0,  0.0,  1.0,   0.0, 4095.0, 1.0, 1 },
+		{ "buffer (rieles)",       0.990,  10.0,  2.0,  0.8, 248.0, 3847.0, 1.5, 1 },
+		{ "peor caso",             0.970,  40.0, -8.0,  1.0, 248.0, 3847.0, 2.5, 1 },
+		{ "sin lazo DAC->ADC",     1.000,   0.0,  0.0,  0.0,   0.0, 4095.0, 1.0, 0 },
+	};
+	int errores = 0;
+
+	srand(1);
+	for (unsigned i=0; i<sizeof(casos)/sizeof(casos[0]); i++) errores += probar(&casos[i]);
+	printf("%s\n", errores ? "HAY ERRORES" : "calibracion verificada");
+	return errores != 0;
+}
@@ -0,0 +1,199 @@
+/*******************************************************************************
+  * @file		captura_cliente.c
+  * @brief      Cliente de captura (modo osciloscopio) del generador (lado PC, POSIX)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Envía "CAPT <argumentos>", separa los textos de los bloques binarios
+  * (0xA5 0x5A, secuencia, cantidad y muestras, little-endian), guarda las
+  * muestras en un archivo (una por línea) y cuenta los bloques perdidos por
+  * los saltos de secuencia. Con CONT captura durante <segundos> y envía
+  * "CAPT STOP". Informa el caudal medido en la PC y el informe del equipo.
+  *
+  * Compilar:  cc -O2 -o captura_cliente captura_cliente.c
+  * Uso:       ./captura_cliente <puerto> <baudios> <salida> "<argumentos>" [segundos]
+  * Ejemplos:  ./captura_cliente /dev/ttyACM0 9600 resp.txt "PRE=100 POST=900 TRIG=2048"
+  *            ./captura_cliente /dev/ttyACM0 9600 cont.txt "CONT DEC=1000" 30
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+/* Defines privados ----------------------------------------------------------*/
+#define SINCRONISMO_1	0xA5		// Igual que CAPT_SINCRONISMO_1
+#define SINCRONISMO_2	0x5A		// Igual que CAPT_SINCRONISMO_2
+#define MAX_BLOQUE		128			// Igual que CAPT_BLOQUE
+#define LARGO_LINEA		160
+
+/* Typedef privados ----------------------------------------------------------*/
+typedef enum { TEXTO, SINCRONISMO, ENCABEZADO, MUESTRAS } estadoLectura_t;
+
+/* Variables privadas --------------------------------------------------------*/
+static int puerto;
+static FILE * salida;
+static estadoLectura_t estado = TEXTO;
+static char linea[LARGO_LINEA];
+static int lineaPos = 0;
+static uint8_t encabezado[4];
+static uint8_t datos[2 * MAX_BLOQUE];
+static int posicion = 0;			// Bytes leídos del encabezado o de las muestras
+static unsigned cantidad = 0;		// Muestras del bloque en curso
+static long bloques = 0, muestras = 0, perdidos = 0, bytes = 0;
+static long esperada = -1;			// Próxima secuencia esperada
+static int terminado = 0;
+static char informe[LARGO_LINEA] = "";
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+static speed_t velocidad(long baudios) {
+	switch (baudios) {
+	case 9600:   return B9600;
+	case 19200:  return B19200;
+	case 38400:  return B38400;
+	case 57600:  return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	default:     return 0;
+	}
+}
+
+static int abrirPuerto(const char * nombre, long baudios) {
+	struct termios tio;
+	int fd = open(nombre, O_RDWR | O_NOCTTY);
+	if (fd < 0) return -1;
+	if (tcgetattr(fd, &tio) != 0) return -1;
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, velocidad(baudios));
+	cfsetospeed(&tio, velocidad(baudios));
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tio) != 0) return -1;
+	tcflush(fd, TCIOFLUSH);
+	return fd;
+}
+
+// Un bloque completo: salto de secuencia = bloques perdidos en el equipo
+static void bloqueCompleto(void) {
+	unsigned secuencia = encabezado[0] | (encabezado[1] << 8);
+	if (esperada >= 0) perdidos += (long) ((secuencia - (unsigned) esperada) & 0xFFFF);
+	esperada = (secuencia + 1) & 0xFFFF;
+	for (unsigned k=0; k<cantidad; k++) fprintf(salida, "%u\n", datos[2 * k] | (datos[2 * k + 1] << 8));
+	bloques++;
+	muestras += cantidad;
+}
+
+// Separa texto y bloques binarios, byte a byte
+static void procesarByte(uint8_t b) {
+	bytes++;
+	switch (estado) {
+	case TEXTO:
+		if (b == SINCRONISMO_1 && lineaPos == 0) {
+			estado = SINCRONISMO;
+		} else if (b == '\n' || b == '\r') {
+			if (lineaPos == 0) break;
+			linea[lineaPos] = '\0';
+			lineaPos = 0;
+			fprintf(stderr, "< %s\n", linea);
+			if (strncmp(linea, "FIN CAPT", 8) == 0) {
+				strcpy(informe, linea);
+				terminado = 1;
+			}
+		} else if (lineaPos < LARGO_LINEA - 1) {
+			linea[lineaPos++] = (char) b;
+		}
+		break;
+	case SINCRONISMO:
+		estado = (b == SINCRONISMO_2) ? ENCABEZADO : TEXTO;
+		posicion = 0;
+		break;
+	case ENCABEZADO:
+		encabezado[posicion++] = b;
+		if (posicion < 4) break;
+		cantidad = encabezado[2] | (encabezado[3] << 8);
+		posicion = 0;
+		estado = (cantidad >= 1 && cantidad <= MAX_BLOQUE) ? MUESTRAS : TEXTO;
+		break;
+	case MUESTRAS:
+		datos[posicion++] = b;
+		if (posicion < (int) (2 * cantidad)) break;
+		bloqueCompleto();
+		estado = TEXTO;
+		break;
+	}
+}
+
+static void atenderEntrada(int espera_ms) {
+	fd_set lectura;
+	struct timeval t = { espera_ms / 1000, (espera_ms % 1000) * 1000 };
+	uint8_t rx[512];
+
+	FD_ZERO(&lectura);
+	FD_SET(puerto, &lectura);
+	if (select(puerto + 1, &lectura, NULL, NULL, &t) <= 0) return;
+	ssize_t n = read(puerto, rx, sizeof(rx));
+	for (ssize_t i = 0; i < n; i++) procesarByte(rx[i]);
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	char comando[LARGO_LINEA];
+
+	if (argc < 5) {
+		fprintf(stderr, "Uso: %s <puerto> <baudios> <salida> \"<argumentos>\" [segundos]\n", argv[0]);
+		return 1;
+	}
+	long baudios = atol(argv[2]);
+	double segundos = (argc > 5) ? atof(argv[5]) : 10.0;
+	int continua = (strstr(argv[4], "CONT") != NULL);
+	if (velocidad(baudios) == 0) { fprintf(stderr, "Baudios no soportados\n"); return 1; }
+
+	salida = fopen(argv[3], "w");
+	if (salida == NULL) { perror(argv[3]); return 1; }
+	puerto = abrirPuerto(argv[1], baudios);
+	if (puerto < 0) { perror(argv[1]); return 1; }
+
+	snprintf(comando, sizeof(comando), "CAPT %s\n", argv[4]);
+	if (write(puerto, comando, strlen(comando)) < 0) { perror("write"); return 1; }
+
+	double inicio = ahora();
+	int parado = 0;
+	while (!terminado) {
+		atenderEntrada(100);
+		double transcurrido = ahora() - inicio;
+		if (continua && !parado && transcurrido >= segundos) {
+			if (write(puerto, "CAPT STOP\n", 10) < 0) { perror("write"); return 1; }
+			parado = 1;
+		}
+		// Sin CONT el equipo termina solo; si no dispara, se corta igual
+		if (!continua && !parado && transcurrido >= segundos + 60.0) {
+			if (write(puerto, "CAPT STOP\n", 10) < 0) { perror("write"); return 1; }
+			parado = 1;
+		}
+		if (parado && transcurrido >= segundos + 65.0) break;
+	}
+	double duracion = ahora() - inicio;
+
+	printf("bloques=%ld muestras=%ld perdidos=%ld segundos=%.3f caudal=%.1f B/s limite_enlace=%.1f B/s\n",
+	       bloques, muestras, perdidos, duracion, bytes / duracion, baudios / 10.0);
+	if (informe[0] != '\0') printf("%s\n", informe);
+
+	fclose(salida);
+	close(puerto);
+	return 0;
+}
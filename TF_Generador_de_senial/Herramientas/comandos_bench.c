@@ -0,0 +1,95 @@
+/*******************************************************************************
+  * @file		comandos_bench.c
+  * @brief      Medición en la PC del intérprete de comandos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_comandos.c del firmware con una tabla de los mismos
+  * nombres que Tabla_Comandos (main.c) y acciones vacías. Mide el costo de
+  * despacho de cada comando y el caudal del intérprete de a un byte.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o comandos_bench comandos_bench.c \
+  *               ../Drivers/API/Src/API_comandos.c
+  * Uso:       ./comandos_bench
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "API_comandos.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define REPETICIONES	1000000
+
+/* Variables privadas --------------------------------------------------------*/
+static volatile uint32_t ejecutados = 0;
+
+static void accion(char * argumentos) {
+	(void) argumentos;
+	ejecutados++;
+}
+
+// Mismos nombres que Tabla_Comandos en Core/Src/main.c
+static const comando_t tabla[] = {
+	{ "*IDN?", accion, "" }, { "AMP", accion, "" },     { "COMP", accion, "" },
+	{ "FOURIER", accion, "" }, { "GEN", accion, "" },   { "H", accion, "" },
+	{ "HELP", accion, "" },  { "INTERP", accion, "" },  { "LEN", accion, "" },
+	{ "LOAD", accion, "" },  { "OFF", accion, "" },     { "RATE", accion, "" },
+	{ "RATE?", accion, "" }, { "RESET", accion, "" },   { "SLOT", accion, "" },
+	{ "START", accion, "" }, { "STAT?", accion, "" },   { "STOP", accion, "" },
+	{ "STREAM", accion, "" },
+};
+
+static const char * const lineas[] = {
+	"gen sine n=1000 amp=2000 off=2048 phase=90\n", "stat?\n", "rate 83\n",
+	"start\n", "stop\n", "h 3 500 0\n", "desconocido 1 2 3\n",
+};
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(void) {
+	uint8_t cantidad = sizeof(tabla) / sizeof(tabla[0]);
+	char linea[CMD_LARGO_LINEA];
+
+	if (!Cmd_Init(tabla, cantidad)) {
+		fprintf(stderr, "La tabla no esta ordenada\n");
+		return 1;
+	}
+
+	// Despacho por comando (línea ya armada, sin argumentos)
+	printf("%-8s %12s\n", "comando", "ns/despacho");
+	for (uint8_t i=0; i<cantidad; i++) {
+		double inicio = ahora();
+		for (long r=0; r<REPETICIONES; r++) {
+			strcpy(linea, tabla[i].nombre);
+			Cmd_Ejecutar(linea);
+		}
+		printf("%-8s %12.1f\n", tabla[i].nombre, (ahora() - inicio) * 1e9 / REPETICIONES);
+	}
+
+	// Caudal de a un byte, como llegan por UART
+	long bytes = 0;
+	uint32_t desconocidos = 0;
+	double inicio = ahora();
+	for (long r=0; r<REPETICIONES / 10; r++) {
+		for (size_t l=0; l<sizeof(lineas)/sizeof(lineas[0]); l++) {
+			for (const char * c = lineas[l]; *c != '\0'; c++) {
+				if (Cmd_Byte((uint8_t) *c) == CMD_DESCONOCIDO) desconocidos++;
+				bytes++;
+			}
+		}
+	}
+	double segundos = ahora() - inicio;
+	printf("caudal: %.1f MB/s (%.1f ns/byte), %u desconocidos, %u ejecutados\n",
+	       bytes / segundos / 1e6, segundos * 1e9 / bytes, desconocidos, ejecutados);
+	return 0;
+}
@@ -0,0 +1,235 @@
+/*******************************************************************************
+  * @file		comp_codificador.c
+  * @brief      Codificador de señales comprimidas para el generador (lado PC)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Comprime un archivo de muestras (números separados por coma, como los de
+  * la carpeta Seniales) con el formato de API_compresion.h, lo verifica con
+  * el mismo decodificador del firmware (de a un byte, como llega por UART) e
+  * informa la tasa de compresión y el tiempo de decodificación por muestra.
+  * Opcionalmente lo envía al generador con el comando COMP.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o comp_codificador comp_codificador.c \
+  *               ../Drivers/API/Src/API_compresion.c
+  * Uso:       ./comp_codificador <archivo> [salida.bin] [puerto baudios]
+  * Ejemplo:   ./comp_codificador ../Seniales/senoidal.txt - /dev/ttyACM0 9600
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include "API_compresion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_MUESTRAS	16384		// Igual que N_MAX_MUESTRAS
+#define MIN_REPETIR		2			// Muestras con igual delta que justifican un bloque
+#define REPETICIONES	2000
+#define LARGO_LINEA		128
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t muestras[MAX_MUESTRAS];
+static uint16_t decodificadas[MAX_MUESTRAS];
+static uint8_t comprimido[4 * MAX_MUESTRAS];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Lee los números del archivo y cuenta los bytes de la carga en ASCII
+static long leerArchivo(const char * nombre, long * bytesAscii) {
+	FILE * f = fopen(nombre, "r");
+	long n = 0;
+	int c, enNumero = 0, digitos = 0;
+	unsigned valor = 0;
+	*bytesAscii = 0;
+	if (f == NULL) return -1;
+	while ((c = fgetc(f)) != EOF && n < MAX_MUESTRAS) {
+		if (c >= '0' && c <= '9') {
+			valor = valor * 10 + (unsigned) (c - '0');
+			enNumero = 1;
+			digitos++;
+		} else if (enNumero) {
+			muestras[n++] = (uint16_t) (valor > COMP_MAX_VALOR ? COMP_MAX_VALOR : valor);
+			*bytesAscii += digitos + 1;			// Número y coma
+			valor = 0;
+			enNumero = 0;
+			digitos = 0;
+		}
+	}
+	if (enNumero && n < MAX_MUESTRAS) {
+		muestras[n++] = (uint16_t) valor;
+		*bytesAscii += digitos + 1;
+	}
+	fclose(f);
+	return n;
+}
+
+static size_t escribirVarint(int32_t delta, uint8_t * salida) {
+	uint32_t z = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);	// Zig-zag
+	size_t n = 0;
+	while (z >= 0x80) {
+		salida[n++] = (uint8_t) (z | 0x80);
+		z >>= 7;
+	}
+	salida[n++] = (uint8_t) z;
+	return n;
+}
+
+// Muestras consecutivas desde 'i' con el mismo delta (a lo sumo un bloque)
+static long largoRepeticion(long i, long n, int32_t anterior) {
+	int32_t delta = muestras[i] - anterior;
+	long r = 1;
+	while (i + r < n && r < COMP_MAX_BLOQUE && muestras[i + r] - muestras[i + r - 1] == delta) r++;
+	return r;
+}
+
+/*
+ * Elige el tipo de bloque en forma golosa: si desde la muestra actual hay una
+ * repetición de delta, un bloque COMP_REPETIR; si no, un literal que se
+ * extiende hasta la próxima repetición.
+ */
+static size_t codificar(long n) {
+	size_t largo = 0;
+	int32_t anterior = 0;
+	long i = 0;
+
+	while (i < n) {
+		long r = largoRepeticion(i, n, anterior);
+		if (r >= MIN_REPETIR) {
+			comprimido[largo++] = (uint8_t) (COMP_REPETIR | (r - 1));
+			largo += escribirVarint(muestras[i] - anterior, &comprimido[largo]);
+			anterior = muestras[i + r - 1];
+			i += r;
+			continue;
+		}
+
+		size_t cabecera = largo++;
+		long cantidad = 0;
+		do {
+			largo += escribirVarint(muestras[i] - anterior, &comprimido[largo]);
+			anterior = muestras[i];
+			i++;
+			cantidad++;
+		} while (i < n && cantidad < COMP_MAX_BLOQUE && largoRepeticion(i, n, anterior) < MIN_REPETIR + 1);
+		comprimido[cabecera] = (uint8_t) (COMP_LITERAL | (cantidad - 1));
+	}
+	return largo;
+}
+
+static int abrirPuerto(const char * nombre, long baudios) {
+	struct termios tio;
+	speed_t v = (baudios == 115200) ? B115200 : (baudios == 57600) ? B57600 :
+	            (baudios == 38400) ? B38400 : (baudios == 19200) ? B19200 : B9600;
+	int fd = open(nombre, O_RDWR | O_NOCTTY);
+	if (fd < 0) return -1;
+	if (tcgetattr(fd, &tio) != 0) return -1;
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, v);
+	cfsetospeed(&tio, v);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tio) != 0) return -1;
+	tcflush(fd, TCIOFLUSH);
+	return fd;
+}
+
+// Muestra lo que responde el generador hasta una línea que empiece con 'prefijo'
+static int esperarLinea(int fd, const char * prefijo, int espera_ms) {
+	char linea[LARGO_LINEA];
+	int pos = 0;
+	double limite = ahora() + espera_ms / 1000.0;
+	while (ahora() < limite) {
+		fd_set lectura;
+		struct timeval t = { 0, 50000 };
+		uint8_t c;
+		FD_ZERO(&lectura);
+		FD_SET(fd, &lectura);
+		if (select(fd + 1, &lectura, NULL, NULL, &t) <= 0 || read(fd, &c, 1) != 1) continue;
+		if (c == '\n' || c == '\r') {
+			if (pos == 0) continue;
+			linea[pos] = '\0';
+			pos = 0;
+			fprintf(stderr, "< %s\n", linea);
+			if (strncmp(linea, prefijo, strlen(prefijo)) == 0) return 1;
+		} else if (pos < LARGO_LINEA - 1) {
+			linea[pos++] = (char) c;
+		}
+	}
+	return 0;
+}
+
+static int enviar(const char * puerto, long baudios, long n, size_t largo) {
+	char comando[32];
+	int fd = abrirPuerto(puerto, baudios);
+	if (fd < 0) { perror(puerto); return 1; }
+
+	// El generador debe estar en Recibiendo o Cargado
+	snprintf(comando, sizeof(comando), "COMP N=%ld\n", n);
+	if (write(fd, comando, strlen(comando)) < 0) { perror("write"); return 1; }
+	if (!esperarLinea(fd, "COMP ", 3000)) {
+		fprintf(stderr, "El generador no respondio al comando COMP\n");
+		return 1;
+	}
+	if (write(fd, comprimido, largo) < 0) { perror("write"); return 1; }
+	tcdrain(fd);
+	esperarLinea(fd, "Senial", 5000 + (int) (largo * 10000 / baudios));
+	close(fd);
+	return 0;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	long bytesAscii;
+	decodificador_t d;
+
+	if (argc < 2) {
+		fprintf(stderr, "Uso: %s <archivo> [salida.bin] [puerto baudios]\n", argv[0]);
+		return 1;
+	}
+	long n = leerArchivo(argv[1], &bytesAscii);
+	if (n <= 0) { fprintf(stderr, "No se pudo leer %s\n", argv[1]); return 1; }
+	size_t largo = codificar(n);
+
+	// Verificación con el decodificador del firmware, de a un byte
+	Comp_Iniciar(&d, decodificadas, (uint32_t) n);
+	for (size_t i=0; i<largo && d.estado == COMP_EN_CURSO; i++) Comp_Decodificar(&d, &comprimido[i], 1);
+	if (d.estado != COMP_COMPLETO || memcmp(muestras, decodificadas, n * sizeof(uint16_t)) != 0) {
+		fprintf(stderr, "Error: la decodificacion no coincide\n");
+		return 1;
+	}
+
+	// Tiempo de decodificación (todo el bloque de una vez)
+	double inicio = ahora();
+	for (int r=0; r<REPETICIONES; r++) {
+		Comp_Iniciar(&d, decodificadas, (uint32_t) n);
+		Comp_Decodificar(&d, comprimido, (uint32_t) largo);
+	}
+	double ns = (ahora() - inicio) * 1e9 / REPETICIONES / n;
+
+	printf("%s: muestras=%ld ascii=%ld binario=%ld comprimido=%zu relacion_ascii=%.1f:1 "
+	       "relacion_binario=%.1f:1 decodificacion=%.2f ns/muestra\n",
+	       argv[1], n, bytesAscii, 2 * n, largo, (double) bytesAscii / largo,
+	       2.0 * n / largo, ns);
+
+	if (argc > 2 && strcmp(argv[2], "-") != 0) {
+		FILE * f = fopen(argv[2], "wb");
+		if (f == NULL || fwrite(comprimido, 1, largo, f) != largo) { perror(argv[2]); return 1; }
+		fclose(f);
+	}
+	if (argc > 4) return enviar(argv[3], atol(argv[4]), n, largo);
+	return 0;
+}
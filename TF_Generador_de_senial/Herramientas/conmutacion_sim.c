@@ -0,0 +1,245 @@
+/*******************************************************************************
+  * @file		conmutacion_sim.c
+  * @brief      Simulación en la PC del cambio de señal en marcha (SWITCH)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_conmutacion.c del firmware y lo recorre con un
+  * modelo del DMA circular del DAC2: el DAC lee el anillo mitad tras mitad
+  * y, al terminar cada mitad, la recarga la reescribe (lo escrito sale un
+  * período después). El pedido llega en una muestra al azar.
+  * Para cada par de señales y cada política informa, sobre PRUEBAS pedidos:
+  *  - el peor y el promedio del escalón (mayor salto entre muestras
+  *    seguidas del cambio al fin del fundido) y en cuántos pedidos no pasó
+  *    el mayor salto propio de la nueva (el cambio no agregó saltos),
+  *  - la espera media y la peor, en muestras, del pedido al cambio,
+  * y verifica muestra a muestra que antes del cambio salga la anterior,
+  * después la nueva (pasado el fundido), que el anillo termine igual a la
+  * nueva y que el escalón que cuenta el firmware sea el de la salida.
+  * OFF es el reinicio de siempre: la salida queda quieta mientras se
+  * sintetiza y arranca desde la primera muestra; IMM es cambiar el buffer
+  * en cualquier muestra, la referencia ingenua.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o conmutacion_sim conmutacion_sim.c \
+  *               ../Drivers/API/Src/API_conmutacion.c ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./conmutacion_sim [largo]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "API_conmutacion.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LARGO_DEFECTO	1000
+#define LARGO_MAXIMO	16384
+#define PRUEBAS			500
+#define PERIODOS		8			// Tope de períodos simulados por pedido
+#define MAX_SALIDA		(PERIODOS * LARGO_MAXIMO)
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef enum { SENO, CUADRADA, SIERRA, TRIANGULAR, SENO3 } forma_t;
+
+typedef struct {
+	uint32_t peor;					// Escalón
+	double medio;
+	double espera;					// Muestras del pedido al cambio
+	uint32_t esperaPeor;
+	uint32_t limpios;				// Pedidos con escalón <= salto propio de la nueva
+	uint32_t errores;
+} resultado_t;
+
+/* Variables -----------------------------------------------------------------*/
+static uint16_t Anterior[LARGO_MAXIMO];
+static uint16_t Nueva[LARGO_MAXIMO];
+static uint16_t Anillo[LARGO_MAXIMO];
+static uint16_t Salida[MAX_SALIDA];
+static uint32_t Largo = LARGO_DEFECTO;
+
+/* Prototipos ----------------------------------------------------------------*/
+static void llenar(uint16_t * senial, forma_t forma);
+static uint32_t saltoMaximo(const uint16_t * senial);
+static bool_t probar(const conmutacion_t * c, resultado_t * r);
+static void reiniciar(resultado_t * r);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	static const char * nombres[] = { "seno", "cuadrada", "sierra", "triangular", "seno x3" };
+	static const forma_t pares[][2] = {
+		{ SENO, CUADRADA }, { CUADRADA, SENO }, { SIERRA, TRIANGULAR }, { SENO, SENO3 }, { TRIANGULAR, SIERRA }
+	};
+	static const conmutacion_t politicas[] = {
+		{ CONM_INMEDIATO, 0, 0 },
+		{ CONM_PERIODO, 0, 0 },
+		{ CONM_COINCIDENCIA, 64, 0 },
+		{ CONM_COINCIDENCIA, 8, 0 },
+		{ CONM_FUNDIDO, 0, 32 },
+		{ CONM_FUNDIDO, 0, 256 },
+	};
+	bool_t bien = true;
+
+	if (argc > 1) Largo = (uint32_t) atoi(argv[1]);
+	if (Largo < 4 || Largo > LARGO_MAXIMO || (Largo & 1)) {
+		fprintf(stderr, "largo: par, de 4 a %u\n", LARGO_MAXIMO);
+		return 2;
+	}
+	srand(1);
+
+	for (uint32_t i=0; i<sizeof(pares)/sizeof(pares[0]); i++) {
+		llenar(Anterior, pares[i][0]);
+		llenar(Nueva, pares[i][1]);
+		printf("\n%s -> %s, N=%u, salto propio de la nueva=%u\n", nombres[pares[i][0]], nombres[pares[i][1]],
+			   Largo, saltoMaximo(Nueva));
+
+		// OFF: la salida queda en la última muestra y arranca en la primera de la nueva
+		resultado_t r;
+		reiniciar(&r);
+		for (uint32_t k=0; k<PRUEBAS; k++) {
+			uint16_t quieta = Anterior[(uint32_t) rand() % Largo];
+			uint32_t salto = (quieta > Nueva[0]) ? (uint32_t) (quieta - Nueva[0]) : (uint32_t) (Nueva[0] - quieta);
+			if (salto > r.peor) r.peor = salto;
+			if (salto <= saltoMaximo(Nueva)) r.limpios++;
+			r.medio += salto;
+		}
+		printf("  %-12s escalon peor=%4u medio=%7.1f limpios=%3u%%  (la salida se corta mientras sintetiza)\n",
+			   "OFF", r.peor, r.medio / PRUEBAS, r.limpios * 100 / PRUEBAS);
+
+		for (uint32_t j=0; j<sizeof(politicas)/sizeof(politicas[0]); j++) {
+			char nombre[24];
+			const conmutacion_t * c = &politicas[j];
+			if (c->politica == CONM_COINCIDENCIA) snprintf(nombre, sizeof(nombre), "MATCH TOL=%u", c->tolerancia);
+			else if (c->politica == CONM_FUNDIDO) snprintf(nombre, sizeof(nombre), "FADE K=%u", c->fundido);
+			else snprintf(nombre, sizeof(nombre), "%s", Conm_Nombre(c->politica));
+			if (c->politica == CONM_FUNDIDO && c->fundido > Largo) {
+				printf("  %-12s K mayor que N: no se prueba\n", nombre);
+				continue;
+			}
+
+			if (probar(c, &r) != true) {
+				printf("  %-12s NO SE PUDO PREPARAR\n", nombre);
+				bien = false;
+				continue;
+			}
+			printf("  %-12s escalon peor=%4u medio=%7.1f limpios=%3u%%  espera media=%8.1f peor=%6u  %s\n",
+				   nombre, r.peor, r.medio, r.limpios * 100 / PRUEBAS, r.espera, r.esperaPeor,
+				   r.errores ? "ERRORES" : "ok");
+			if (r.errores) bien = false;
+		}
+	}
+
+	// K mayor que el largo no entra: el anillo se lee una sola vez
+	estadoConmutacion_t e;
+	conmutacion_t largoDeMas = { CONM_FUNDIDO, 0, Largo + 1 };
+	bool_t rechazado = (Conm_Preparar(&e, &largoDeMas, Nueva, Largo) != true);
+	printf("\n%-24s %s\n", "K mayor que N", rechazado ? "rechazado" : "ACEPTADO (error)");
+	if (!rechazado) bien = false;
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+/*******************************************************************************
+  * @brief  Un período de la forma pedida, 0..4095
+  */
+static void llenar(uint16_t * senial, forma_t forma) {
+	for (uint32_t n=0; n<Largo; n++) {
+		double x = (double) n / Largo;
+		double v;
+		switch (forma) {
+		case SENO:       v = 0.5 + 0.5 * sin(2 * M_PI * x); break;
+		case CUADRADA:   v = (x < 0.5) ? 1.0 : 0.0; break;
+		case SIERRA:     v = x; break;
+		case TRIANGULAR: v = (x < 0.5) ? 2 * x : 2 - 2 * x; break;
+		default:         v = 0.5 + 0.5 * sin(6 * M_PI * x + 1.0); break;
+		}
+		senial[n] = (uint16_t) lround(v * 4095);
+	}
+}
+
+/*******************************************************************************
+  * @brief  Mayor salto entre muestras seguidas de un período (circular)
+  */
+static uint32_t saltoMaximo(const uint16_t * senial) {
+	uint32_t maximo = 0;
+	for (uint32_t n=0; n<Largo; n++) {
+		uint16_t a = senial[n], b = senial[(n + 1) % Largo];
+		uint32_t salto = (a > b) ? (uint32_t) (a - b) : (uint32_t) (b - a);
+		if (salto > maximo) maximo = salto;
+	}
+	return maximo;
+}
+
+static void reiniciar(resultado_t * r) {
+	memset(r, 0, sizeof(*r));
+}
+
+/*******************************************************************************
+  * @brief  PRUEBAS pedidos en muestras al azar con una política
+  * @retval false si Conm_Preparar la rechaza
+  */
+static bool_t probar(const conmutacion_t * c, resultado_t * r) {
+	uint32_t mitad = Largo / 2;
+	reiniciar(r);
+
+	for (uint32_t k=0; k<PRUEBAS; k++) {
+		estadoConmutacion_t e;
+		if (Conm_Preparar(&e, c, Nueva, Largo) != true) return false;
+		memcpy(Anillo, Anterior, Largo * sizeof(uint16_t));
+
+		// El pedido llega durante la muestra 'pedido' del primer período
+		uint32_t pedido = (uint32_t) rand() % Largo;
+		uint32_t inicio = 0;			// Salida donde empieza el primer tramo reescrito
+		bool_t instalada = false, terminada = false;
+		uint32_t t = 0;
+
+		// El DAC lee cada mitad y luego la interrupción la reescribe
+		while (t + mitad <= MAX_SALIDA && !(terminada && t >= inicio + 3 * Largo)) {
+			uint32_t posicion = t % Largo;
+			memcpy(&Salida[t], &Anillo[posicion], mitad * sizeof(uint16_t));
+			t += mitad;
+			if (!instalada && t > pedido) {
+				instalada = true;
+				inicio = t - mitad;
+			}
+			if (instalada && !terminada) terminada = Conm_Generar(&e, Anillo, posicion, mitad);
+		}
+		if (!terminada) {
+			r->errores++;
+			continue;
+		}
+
+		// Cambio en la salida: lo escrito sale un período después
+		uint32_t cambio = inicio + Largo + e.escritas;
+		uint32_t fundido = (c->politica == CONM_FUNDIDO) ? c->fundido - 1 : 0;
+		uint32_t escalon = 0;
+		for (uint32_t n=0; n<t; n++) {
+			uint16_t esperada;
+			if (n < cambio) esperada = Anterior[n % Largo];
+			else if (n < cambio + fundido) esperada = Salida[n];		// Mezcla: sólo su salto
+			else esperada = Nueva[n % Largo];
+			if (Salida[n] != esperada) r->errores++;
+			// El firmware cuenta desde el cambio hasta la primera muestra pura
+			if (n >= cambio && n > 0 && n <= cambio + fundido) {
+				uint32_t salto = (Salida[n] > Salida[n - 1]) ? (uint32_t) (Salida[n] - Salida[n - 1])
+						                                      : (uint32_t) (Salida[n - 1] - Salida[n]);
+				if (salto > escalon) escalon = salto;
+			}
+		}
+		if (memcmp(Anillo, Nueva, Largo * sizeof(uint16_t)) != 0) r->errores++;
+		if (escalon != e.escalon) r->errores++;
+
+		uint32_t espera = cambio - pedido;
+		if (escalon > r->peor) r->peor = escalon;
+		if (escalon <= saltoMaximo(Nueva)) r->limpios++;
+		r->medio += escalon;
+		r->espera += espera;
+		if (espera > r->esperaPeor) r->esperaPeor = espera;
+	}
+	r->medio /= PRUEBAS;
+	r->espera /= PRUEBAS;
+	return true;
+}
@@ -0,0 +1,182 @@
+/*******************************************************************************
+  * @file		debounce_bench.c
+  * @brief      Verificación y costo por muestra del antirrebote por puerto
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_debounce.c del firmware sobre un puerto simulado.
+  *  - Verificación: 16 pines con rebotes al azar (algunos activos en bajo)
+  *    contra un modelo de un pin por vez, con contadores enteros: el pin
+  *    cambia de estado con 4 muestras distintas seguidas y la liberación
+  *    es "larga" si estuvo presionado 63 muestras o más. Se comparan el
+  *    estado y los eventos de cada muestra.
+  *  - Costo: ns por llamada a debouncePuerto_muestrear() con la máscara de
+  *    un pin y con GPIO_PIN_All. En el dispositivo el mismo número queda
+  *    en los campos ciclosUltimo / ciclosMaximo (contador DWT).
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o debounce_bench debounce_bench.c \
+  *               ../Drivers/API/Src/API_debounce.c ../Drivers/API/Src/API_ring.c
+  * Uso:       ./debounce_bench [millones de muestras]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "API_debounce.h"
+#include "API_medicion.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define MUESTRAS_VALIDAR	2000000u
+#define VALIDAR_CAMBIO		4			// Muestras distintas para cambiar de estado
+#define LARGO_MUESTRAS		((1u << DEBOUNCE_BITS_LARGO) - 1)
+#define ACTIVOS_BAJO		0xA5A5
+#define ENTRADAS			(1u << 16)	// Muestras de puerto pregeneradas (potencia de 2)
+#define PASADAS				5
+
+/* Variables -----------------------------------------------------------------*/
+static GPIO_TypeDef puertoSimulado;
+static volatile uint32_t contadorCiclos;
+
+/* Reemplazo de API_medicion.c -----------------------------------------------*/
+// En la PC no hay DWT: una lectura de memoria, como la de CYCCNT
+void medicionInit(void) {
+	contadorCiclos = 0;
+}
+
+uint32_t medicionCiclos(void) {
+	return contadorCiclos;
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static inline uint32_t xorshift(uint32_t * s) {
+	*s ^= *s << 13;
+	*s ^= *s >> 17;
+	*s ^= *s << 5;
+	return *s;
+}
+
+// Un pin que rebota: cada tanto cambia de nivel y durante unas muestras
+// lee al azar; la duración de cada nivel va de 1 a 150 muestras.
+static uint16_t senialConRebotes(uint32_t * s) {
+	static uint16_t nivel = 0;
+	static uint8_t rebote[16], resta[16];
+	uint16_t salida = 0;
+	for (uint32_t pin=0; pin<16; pin++) {
+		uint16_t bit = 1u << pin;
+		if (resta[pin] == 0) {
+			nivel ^= bit;
+			resta[pin] = 1 + xorshift(s) % 150;
+			rebote[pin] = xorshift(s) % 6;
+		}
+		resta[pin]--;
+		uint16_t leido = nivel & bit;
+		if (rebote[pin] > 0) {
+			rebote[pin]--;
+			if (xorshift(s) & 1) leido ^= bit;
+		}
+		salida |= leido;
+	}
+	return salida;
+}
+
+static int validar(void) {
+	debouncePuerto_t p;
+	uint32_t semilla = 2024;
+	uint8_t distintas[16] = { 0 }, presionado[16] = { 0 };
+	uint32_t tiempo[16] = { 0 };
+	uint32_t errores = 0, presiones = 0, largos = 0;
+
+	debouncePuerto_init(&p, &puertoSimulado, GPIO_PIN_All, ACTIVOS_BAJO);
+	puertoSimulado.IDR = ACTIVOS_BAJO;			// Todo suelto
+	for (uint32_t n=0; n<MUESTRAS_VALIDAR; n++) {
+		uint16_t fisico = senialConRebotes(&semilla);
+		puertoSimulado.IDR = fisico ^ ACTIVOS_BAJO;
+		debouncePuerto_muestrear(&p);
+
+		uint16_t esperadoPresion = 0, esperadoLiberacion = 0, esperadoLargo = 0, esperadoEstado = 0;
+		for (uint32_t pin=0; pin<16; pin++) {
+			uint8_t muestra = (fisico >> pin) & 1;
+			uint32_t anterior = tiempo[pin];
+			if (muestra != presionado[pin]) {
+				if (++distintas[pin] == VALIDAR_CAMBIO) {
+					distintas[pin] = 0;
+					presionado[pin] = muestra;
+					if (muestra) esperadoPresion |= 1u << pin;
+					else {
+						esperadoLiberacion |= 1u << pin;
+						if (anterior >= LARGO_MUESTRAS) esperadoLargo |= 1u << pin;
+					}
+				}
+			} else {
+				distintas[pin] = 0;
+			}
+			tiempo[pin] = presionado[pin] ? ((anterior < LARGO_MUESTRAS) ? anterior + 1 : anterior) : 0;
+			esperadoEstado |= presionado[pin] << pin;
+		}
+
+		// Se leen los eventos en cada muestra: el buffer no se llena
+		uint16_t presion = debouncePuerto_leerPresionados(&p, GPIO_PIN_All);
+		uint16_t liberacion = debouncePuerto_leerLiberados(&p, GPIO_PIN_All);
+		uint16_t largo = debouncePuerto_leerLargos(&p, GPIO_PIN_All);
+		if (presion != esperadoPresion || liberacion != esperadoLiberacion ||
+			largo != esperadoLargo || debouncePuerto_estado(&p) != esperadoEstado) {
+			if (errores++ < 5) {
+				printf("muestra %u: presion %04X/%04X liberacion %04X/%04X largo %04X/%04X estado %04X/%04X\n",
+					   n, presion, esperadoPresion, liberacion, esperadoLiberacion,
+					   largo, esperadoLargo, debouncePuerto_estado(&p), esperadoEstado);
+			}
+		}
+		presiones += __builtin_popcount(esperadoPresion);
+		largos += __builtin_popcount(esperadoLargo);
+	}
+	printf("verificacion: %u muestras x 16 pines, %u presiones, %u largas, %u errores, %u eventos perdidos: %s\n",
+		   MUESTRAS_VALIDAR, presiones, largos, errores, p.eventosPerdidos,
+		   (errores == 0 && p.eventosPerdidos == 0) ? "ok" : "ERROR");
+	return errores == 0 && p.eventosPerdidos == 0;
+}
+
+static double medir(debouncePuerto_t * p, uint16_t mascara, uint32_t muestras) {
+	static uint16_t entradas[ENTRADAS];
+	uint32_t semilla = 99;
+	double mejor = 1e9;
+
+	for (uint32_t n=0; n<ENTRADAS; n++) entradas[n] = senialConRebotes(&semilla);
+	debouncePuerto_init(p, &puertoSimulado, mascara, 0);
+
+	// La mejor de varias pasadas: descarta las interrupciones del sistema
+	for (uint32_t pasada=0; pasada<PASADAS; pasada++) {
+		double inicio = ahora();
+		for (uint32_t n=0; n<muestras; n++) {
+			puertoSimulado.IDR = entradas[n & (ENTRADAS - 1)];
+			debouncePuerto_muestrear(p);
+			if ((n & 7) == 7) debouncePuerto_leerPresionados(p, mascara);	// Vacía el buffer
+		}
+		double ns = (ahora() - inicio) * 1e9 / muestras;
+		if (ns < mejor) mejor = ns;
+	}
+	return mejor;
+}
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	uint32_t millones = (argc > 1) ? (uint32_t) atoi(argv[1]) : 2;
+	static debouncePuerto_t unPin, todos;
+
+	// debouncePuerto_init registra cada puerto: hay lugar para DEBOUNCE_MAX_PUERTOS
+	int bien = validar();
+
+	uint32_t muestras = millones * 1000000u;
+	double costoUno = medir(&unPin, 0x0001, muestras);
+	double costoTodos = medir(&todos, GPIO_PIN_All, muestras);
+	printf("costo por muestra (PC): 1 pin %.2f ns, 16 pines %.2f ns (%.2f ns por pin)\n",
+		   costoUno, costoTodos, costoTodos / 16);
+	return bien ? 0 : 1;
+}
@@ -0,0 +1,552 @@
+/*******************************************************************************
+  * @file		espectro.c
+  * @brief      Analizador espectral de la salida del DAC2 (lado PC): THD,
+  *             SFDR, SNR, SINAD, ENOB y error de frecuencia, en JSON
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * La traza son los códigos que el DMA le da al DAC2, muestra a muestra:
+  *  - -gen "<argumentos de GEN>": simula la reproducción en la PC. El mismo
+  *    API_sintesis.c del firmware arma la tabla (con -comp <taps>, además
+  *    la compensación de la retención de API_compensacion.c, como ZOH ON)
+  *    y el DMA la recorre en forma circular: la traza es la tabla repetida.
+  *  - -traza <archivo>: una traza grabada. En texto, el último número de
+  *    cada renglón (sirven la salida de captura_cliente y la de
+  *    banda_limitada_sim "<GEN>"); si termina en .bin, uint16 little endian.
+  * Modelo del DAC: los códigos ya están cuantizados a 12 bits (los que se
+  * salen de 0..4095 se saturan y se cuentan). La retención de orden cero
+  * multiplica el espectro por sinc(f / fs); con -retencion R > 1 cada
+  * código se repite R veces y se analiza hasta R fs / 2, con las imágenes.
+  *
+  * Análisis: ventana de Blackman-Harris de 4 términos (lóbulos laterales
+  * a -92 dB, debajo del ruido de 12 bits) sobre la mayor potencia de 2 de
+  * muestras, FFT real (compleja de la mitad de largo, radix 2 iterativa
+  * con tabla de giros). Cada tono es la suma de su lóbulo (+-LOBULO bins).
+  *  - Fundamental: el mayor lóbulo a +-2% de la frecuencia objetivo (o
+  *    de todo el espectro si no hay objetivo); su frecuencia, el centroide
+  *    del lóbulo. error = medida - objetivo.
+  *  - THD: armónicos 2..K (plegados a 0..fs/2) sobre la fundamental.
+  *  - SFDR: fundamental sobre el mayor lóbulo que no es ella ni continua.
+  *  - SNR: fundamental sobre el resto, sin armónicos ni continua (el ruido
+  *    se escala a toda la banda por los bins excluidos). SINAD incluye los
+  *    armónicos. ENOB = (SINAD - 1,76 - nivel dBFS) / 6,02: referido a
+  *    plena escala (amplitud 2048).
+  * Con umbrales (-min-sfdr, -max-thd, -min-snr, -min-enob, -max-ppm) el
+  * JSON dice qué no pasó y el programa termina con 1: sirve de prueba de
+  * regresión. Sin argumentos, se prueba contra señales conocidas.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o espectro espectro.c \
+  *               ../Drivers/API/Src/API_sintesis.c ../Drivers/API/Src/API_compensacion.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./espectro
+  *            ./espectro -gen "SINE N=105 AMP=2000" [-comp 9] [-rate 7] [-muestras 4194304]
+  *            ./espectro -traza captura.txt -fs 10500000 -f 100000 [-armonicos 9]
+  *            opciones: -retencion R, -guardar <archivo> (traza simulada, texto),
+  *                      -min-sfdr dB, -max-thd dBc, -min-snr dB, -min-enob bits, -max-ppm ppm
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_sintesis.h"
+#include "API_compensacion.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define FRECUENCIA_TIM2		84000000.0	// Hz (API_dac_dma.h)
+#define PERIODO_DAC_DEFECTO	7			// ARR de TIM2: 10,5 Msps (API_dac_dma.h)
+#define LARGO_MAXIMO		16384		// N_MAX_MUESTRAS (API_generador.h)
+#define MUESTRAS_DEFECTO	(1u << 20)
+#define MUESTRAS_MINIMAS	1024
+#define MUESTRAS_MAXIMAS	(1u << 25)	// Con la retención repetida
+#define ARMONICOS_DEFECTO	9
+#define ARMONICOS_MAXIMOS	50
+#define LOBULO				6			// Bins a cada lado: el lóbulo principal son 4
+#define BUSQUEDA			0.02		// Fundamental a +-2% del objetivo
+#define PLENA_ESCALA		2048.0		// Amplitud de la senoidal de 0 dBFS
+#define MAX_DAC				4095
+#define PI					3.14159265358979323846
+#define SIN_UMBRAL			NAN
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	double fs;				// Hz de la traza (con la retención repetida)
+	double objetivo;		// Hz; 0: el mayor tono
+	uint32_t armonicos;		// K: THD con 2..K
+	uint32_t retencion;		// R: repeticiones de cada código (1: sinc analítico)
+	double minSfdr, maxThd, minSnr, minEnob, maxPpm;	// NAN: sin umbral
+} configuracion_t;
+
+typedef struct {
+	uint32_t fft;			// Muestras analizadas
+	double frecuencia;		// Hz medidos
+	double nivel;			// dBFS
+	double thd, sfdr, snr, sinad, enob;
+	double espurio;			// Hz del mayor espurio
+	double armonico[ARMONICOS_MAXIMOS + 1];	// dBc; NAN si cae sobre la fundamental
+	double segundos;		// Ventana + FFT + análisis
+} analisis_t;
+
+/* Variables -----------------------------------------------------------------*/
+static uint16_t Tabla[LARGO_MAXIMO];
+static compensacion_t Compensacion;
+
+/* Prototipos ----------------------------------------------------------------*/
+static double ahora(void);
+static uint32_t leerTraza(const char * nombre, uint16_t ** traza, uint32_t * recortadas);
+static uint32_t simularTraza(const char * gen, uint32_t taps, uint32_t muestras, uint16_t ** traza,
+		                     uint32_t * recortadas, uint32_t * largo);
+static int analizar(const uint16_t * traza, uint32_t largo, const configuracion_t * c, analisis_t * a);
+static void fft(double * re, double * im, uint32_t n, const double * giroRe, const double * giroIm,
+		        uint32_t paso);
+static double lobulo(const double * p, uint32_t bins, uint32_t centro, double * momento);
+static void marcar(uint8_t * marca, uint32_t bins, uint32_t centro);
+static uint32_t pico(const double * p, uint32_t bins, uint32_t desde, uint32_t hasta);
+static int informar(const char * origen, uint32_t muestras, uint32_t recortadas,
+		            const configuracion_t * c, const analisis_t * a);
+static int autoprueba(void);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	configuracion_t c = { 0.0, 0.0, ARMONICOS_DEFECTO, 1,
+			              SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL };
+	const char * gen = NULL, * archivo = NULL, * guardar = NULL;
+	uint32_t taps = 0, muestras = MUESTRAS_DEFECTO, periodo = PERIODO_DAC_DEFECTO;
+
+	if (argc == 1) return autoprueba();
+
+	for (int i=1; i<argc; i++) {
+		const char * o = argv[i];
+		if (i + 1 >= argc) { fprintf(stderr, "falta el valor de %s\n", o); return 2; }
+		const char * v = argv[++i];
+		if (strcmp(o, "-gen") == 0) gen = v;
+		else if (strcmp(o, "-traza") == 0) archivo = v;
+		else if (strcmp(o, "-guardar") == 0) guardar = v;
+		else if (strcmp(o, "-comp") == 0) taps = (uint32_t) atoi(v);
+		else if (strcmp(o, "-muestras") == 0) muestras = (uint32_t) atol(v);
+		else if (strcmp(o, "-rate") == 0) periodo = (uint32_t) atoi(v);
+		else if (strcmp(o, "-fs") == 0) c.fs = atof(v);
+		else if (strcmp(o, "-f") == 0) c.objetivo = atof(v);
+		else if (strcmp(o, "-armonicos") == 0) c.armonicos = (uint32_t) atoi(v);
+		else if (strcmp(o, "-retencion") == 0) c.retencion = (uint32_t) atoi(v);
+		else if (strcmp(o, "-min-sfdr") == 0) c.minSfdr = atof(v);
+		else if (strcmp(o, "-max-thd") == 0) c.maxThd = atof(v);
+		else if (strcmp(o, "-min-snr") == 0) c.minSnr = atof(v);
+		else if (strcmp(o, "-min-enob") == 0) c.minEnob = atof(v);
+		else if (strcmp(o, "-max-ppm") == 0) c.maxPpm = atof(v);
+		else { fprintf(stderr, "opcion desconocida: %s\n", o); return 2; }
+	}
+	if ((gen == NULL) == (archivo == NULL)) {
+		fprintf(stderr, "hace falta -gen o -traza (uno solo)\n");
+		return 2;
+	}
+	if (c.armonicos < 2 || c.armonicos > ARMONICOS_MAXIMOS || c.retencion < 1
+			|| muestras < MUESTRAS_MINIMAS || (uint64_t) muestras * c.retencion > MUESTRAS_MAXIMAS) {
+		fprintf(stderr, "opciones fuera de rango\n");
+		return 2;
+	}
+
+	uint16_t * traza;
+	uint32_t recortadas, largo, n;
+	if (gen != NULL) {
+		n = simularTraza(gen, taps, muestras, &traza, &recortadas, &largo);
+		if (n == 0) { fprintf(stderr, "parametros de GEN o -comp invalidos\n"); return 2; }
+		if (c.fs == 0.0) c.fs = FRECUENCIA_TIM2 / (periodo + 1);
+		if (c.objetivo == 0.0) c.objetivo = c.fs / largo;
+		if (guardar != NULL) {
+			FILE * f = fopen(guardar, "w");
+			if (f == NULL) { perror(guardar); return 2; }
+			for (uint32_t i=0; i<n; i++) fprintf(f, "%u\n", traza[i]);
+			fclose(f);
+		}
+	} else {
+		n = leerTraza(archivo, &traza, &recortadas);
+		if (n < MUESTRAS_MINIMAS) { fprintf(stderr, "%s: faltan muestras\n", archivo); return 2; }
+		if (c.fs == 0.0) c.fs = FRECUENCIA_TIM2 / (periodo + 1);
+	}
+
+	analisis_t a;
+	if (analizar(traza, n, &c, &a) != 0) { fprintf(stderr, "traza demasiado larga\n"); return 2; }
+	free(traza);
+	return informar((gen != NULL) ? gen : archivo, n, recortadas, &c, &a);
+}
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Traza grabada: texto (último número del renglón) o .bin (uint16 LE)
+static uint32_t leerTraza(const char * nombre, uint16_t ** traza, uint32_t * recortadas) {
+	size_t largo = strlen(nombre);
+	int binario = (largo > 4 && strcmp(nombre + largo - 4, ".bin") == 0);
+	FILE * f = fopen(nombre, binario ? "rb" : "r");
+	uint32_t n = 0, capacidad = MUESTRAS_DEFECTO;
+	*recortadas = 0;
+	if (f == NULL) return 0;
+	*traza = malloc(capacidad * sizeof(uint16_t));
+
+	unsigned valor = 0;
+	int c = 0, enNumero = 0, hay = 0;
+	uint8_t par[2];
+	for (;;) {
+		if (binario) {
+			if (fread(par, 1, 2, f) != 2) break;
+			valor = par[0] | (par[1] << 8);
+			hay = 1;
+		} else {
+			c = fgetc(f);
+			if (c >= '0' && c <= '9') {
+				if (!enNumero) valor = 0;
+				valor = (valor > 100000) ? valor : valor * 10 + (unsigned) (c - '0');
+				enNumero = 1;
+				continue;
+			}
+			if (enNumero) hay = 1;				// El número terminó: queda en 'valor'
+			enNumero = 0;
+			if (c != '\n' && c != EOF) continue;
+		}
+		if (hay) {
+			if (n == capacidad) {
+				if (capacidad >= MUESTRAS_MAXIMAS) break;
+				capacidad *= 2;
+				*traza = realloc(*traza, capacidad * sizeof(uint16_t));
+			}
+			if (valor > MAX_DAC) { valor = MAX_DAC; (*recortadas)++; }
+			(*traza)[n++] = (uint16_t) valor;
+			hay = 0;
+		}
+		if (!binario && c == EOF) break;
+	}
+	fclose(f);
+	return n;
+}
+
+// Reproducción simulada: la tabla de GEN (y la compensación) recorrida por el DMA
+static uint32_t simularTraza(const char * gen, uint32_t taps, uint32_t muestras, uint16_t ** traza,
+		                     uint32_t * recortadas, uint32_t * largo) {
+	sintesis_t p;
+	char texto[256];
+	Sint_Defecto(&p);
+	snprintf(texto, sizeof(texto), "%s", gen);
+	if (Sint_Interpretar(texto, &p) != true || p.largo > LARGO_MAXIMO) return 0;
+	if (Zoh_Preparar(&Compensacion, taps) != true) return 0;
+	*recortadas = Sint_Generar(&p, Tabla);
+	*recortadas += Zoh_Compensar(&Compensacion, Tabla, p.largo);
+	*largo = p.largo;
+
+	*traza = malloc(muestras * sizeof(uint16_t));
+	for (uint32_t i=0, j=0; i<muestras; i++) {
+		(*traza)[i] = Tabla[j];
+		if (++j == p.largo) j = 0;
+	}
+	return muestras;
+}
+
+/*
+ * Ventana, FFT real y medidas. Devuelve 0 si pudo analizar.
+ */
+static int analizar(const uint16_t * traza, uint32_t largo, const configuracion_t * c, analisis_t * a) {
+	uint64_t total = (uint64_t) largo * c->retencion;
+	uint32_t m = MUESTRAS_MINIMAS;
+	if (total > MUESTRAS_MAXIMAS) return 1;
+	while ((uint64_t) m * 2 <= total) m *= 2;
+	uint32_t h = m / 2, bins = h + 1;
+	double fs = c->fs * c->retencion;
+	double inicio = ahora();
+
+	// Giros e^{-2 pi i k / m}, k < m / 2: la FFT de h usa los pares
+	double * giroRe = malloc(h * sizeof(double));
+	double * giroIm = malloc(h * sizeof(double));
+	double * re = malloc(bins * sizeof(double));
+	double * im = malloc(h * sizeof(double));
+	uint8_t * marca = calloc(bins, 1);
+	for (uint32_t k=0; k<h; k++) {
+		giroRe[k] = cos(2.0 * PI * k / m);
+		giroIm[k] = -sin(2.0 * PI * k / m);
+	}
+
+	// Ventana y empaquetado: par -> real, impar -> imaginaria. cos(2 pi j n / m)
+	// sale de la tabla de giros (cos(2 pi (m - i) / m) = cos(2 pi i / m), y
+	// la tabla no llega a i = m / 2: cos(pi) = -1)
+	double sumaW2 = 0.0;
+	for (uint32_t n=0; n<m; n++) {
+		double w = 0.35875;
+		static const double b[] = { -0.48829, 0.14128, -0.01168 };
+		for (uint32_t j=1; j<=3; j++) {
+			uint32_t i = (uint32_t) (((uint64_t) j * n) % m);
+			w += b[j - 1] * ((i < h) ? giroRe[i] : (i == h) ? -1.0 : giroRe[m - i]);
+		}
+		double x = traza[n / c->retencion] * w;
+		sumaW2 += w * w;
+		if (n & 1) im[n / 2] = x;
+		else re[n / 2] = x;
+	}
+	fft(re, im, h, giroRe, giroIm, 2);
+
+	// X[k] = Zpar + e^{-2 pi i k / m} Zimpar; potencias en re[0..h]
+	double z0r = re[0], z0i = im[0];
+	for (uint32_t k=1; k<=h/2; k++) {
+		uint32_t q = h - k;
+		double ar = re[k], ai = im[k], br = re[q], bi = im[q];
+		double pr = 0.5 * (ar + br), pi = 0.5 * (ai - bi);		// Zpar[k]
+		double ir = 0.5 * (ai + bi), ii = -0.5 * (ar - br);		// Zimpar[k]
+		double tr = giroRe[k] * ir - giroIm[k] * ii, ti = giroRe[k] * ii + giroIm[k] * ir;
+		double xkr = pr + tr, xki = pi + ti;
+		// X[h - k] = conj(Zpar[k]) + e^{-2 pi i (h - k) / m} conj(Zimpar[k]) = conj(Zpar[k] - giro[k] Zimpar[k])
+		double xqr = pr - tr, xqi = -(pi - ti);
+		re[k] = xkr * xkr + xki * xki;
+		re[q] = xqr * xqr + xqi * xqi;
+	}
+	re[0] = (z0r + z0i) * (z0r + z0i);
+	re[h] = (z0r - z0i) * (z0r - z0i);
+
+	// Retención de orden cero analítica: |sinc(f / fs)|^2
+	if (c->retencion == 1) {
+		for (uint32_t k=1; k<bins; k++) {
+			double x = PI * k / m;
+			re[k] *= (sin(x) / x) * (sin(x) / x);
+		}
+	}
+	double * p = re;
+
+	// Fundamental
+	uint32_t desde = LOBULO + 1, hasta = h - 1;
+	if (c->objetivo > 0.0) {
+		double b0 = c->objetivo * m / fs;
+		double ancho = (BUSQUEDA * b0 > LOBULO) ? BUSQUEDA * b0 : LOBULO;
+		desde = (b0 - ancho > LOBULO + 1) ? (uint32_t) (b0 - ancho) : LOBULO + 1;
+		hasta = (b0 + ancho < h - 1) ? (uint32_t) (b0 + ancho + 1) : h - 1;
+	}
+	uint32_t k1 = pico(p, bins, desde, hasta);
+	double momento;
+	double p1 = lobulo(p, bins, k1, &momento);
+	a->fft = m;
+	a->frecuencia = momento / p1 * fs / m;
+	a->nivel = 10.0 * log10(4.0 * p1 / ((double) m * sumaW2) / (PLENA_ESCALA * PLENA_ESCALA));
+
+	for (uint32_t k=0; k<=LOBULO; k++) marca[k] = 2;			// Continua
+	marcar(marca, bins, k1);
+
+	// Armónicos plegados a 0..fs/2: el mayor bin a +-2 del previsto
+	double pArmonicos = 0.0;
+	for (uint32_t j=2; j<=c->armonicos; j++) {
+		double f = fmod(j * a->frecuencia, fs);
+		if (f > fs / 2) f = fs - f;
+		uint32_t kj = (uint32_t) lround(f * m / fs);
+		kj = pico(p, bins, (kj > 2) ? kj - 2 : 0, (kj + 2 < h) ? kj + 2 : h);
+		uint32_t chocan = 0;
+		for (int32_t d=-LOBULO; d<=LOBULO; d++) {
+			int64_t k = (int64_t) kj + d;
+			if (k >= 0 && k < bins && marca[k] == 1) chocan = 1;
+		}
+		if (kj <= LOBULO || chocan) { a->armonico[j] = NAN; continue; }
+		double pj = lobulo(p, bins, kj, &momento);
+		a->armonico[j] = 10.0 * log10(pj / p1);
+		pArmonicos += pj;
+		marcar(marca, bins, kj);
+	}
+	// marcar() deja 1 en la fundamental y los armónicos: se vuelven a marcar
+	// para distinguirlos en la búsqueda del espurio
+	for (int32_t d=-LOBULO; d<=LOBULO; d++) {
+		int64_t k = (int64_t) k1 + d;
+		if (k >= 0 && k < bins) marca[k] = 3;
+	}
+
+	// Mayor espurio: fuera de la continua y de la fundamental
+	double pEspurio = 0.0;
+	uint32_t kEspurio = 0;
+	for (uint32_t k=LOBULO+1; k<bins; k++) {
+		if (marca[k] < 2 && p[k] > (kEspurio ? p[kEspurio] : 0.0)) kEspurio = k;
+	}
+	if (kEspurio) {
+		pEspurio = 0.0;
+		for (int32_t d=-LOBULO; d<=LOBULO; d++) {
+			int64_t k = (int64_t) kEspurio + d;
+			if (k >= 0 && k < bins && marca[k] < 2) pEspurio += p[k];
+		}
+	}
+
+	// Ruido: bins sin marcar, escalado a toda la banda fuera de la continua
+	double pRuido = 0.0;
+	uint32_t libres = 0, banda = bins - (LOBULO + 1);
+	for (uint32_t k=LOBULO+1; k<bins; k++) {
+		if (marca[k] == 0) { pRuido += p[k]; libres++; }
+	}
+	pRuido = (libres > 0) ? pRuido * banda / libres : 0.0;
+
+	a->thd = 10.0 * log10(pArmonicos / p1);
+	a->sfdr = (pEspurio > 0.0) ? 10.0 * log10(p1 / pEspurio) : INFINITY;
+	a->espurio = kEspurio * fs / m;
+	a->snr = 10.0 * log10(p1 / pRuido);
+	a->sinad = 10.0 * log10(p1 / (pRuido + pArmonicos));
+	a->enob = (a->sinad - 1.76 - a->nivel) / 6.02;
+	a->segundos = ahora() - inicio;
+
+	free(giroRe); free(giroIm); free(re); free(im); free(marca);
+	return 0;
+}
+
+/*
+ * FFT compleja radix 2 en el lugar, n potencia de 2. El giro
+ * e^{-2 pi i j / largo} es giro[j * paso * (n / largo)].
+ */
+static void fft(double * re, double * im, uint32_t n, const double * giroRe, const double * giroIm,
+		        uint32_t paso) {
+	for (uint32_t i=1, j=0; i<n; i++) {
+		uint32_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j |= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+	for (uint32_t largo=2; largo<=n; largo<<=1) {
+		uint32_t mitad = largo / 2, salto = paso * (n / largo);
+		for (uint32_t bloque=0; bloque<n; bloque+=largo) {
+			for (uint32_t j=0; j<mitad; j++) {
+				double wr = giroRe[j * salto], wi = giroIm[j * salto];
+				uint32_t i = bloque + j, k = i + mitad;
+				double tr = wr * re[k] - wi * im[k];
+				double ti = wr * im[k] + wi * re[k];
+				re[k] = re[i] - tr; im[k] = im[i] - ti;
+				re[i] += tr; im[i] += ti;
+			}
+		}
+	}
+}
+
+// Potencia del lóbulo centrado en 'centro' y su momento (sum k p[k])
+static double lobulo(const double * p, uint32_t bins, uint32_t centro, double * momento) {
+	double suma = 0.0;
+	*momento = 0.0;
+	for (int32_t d=-LOBULO; d<=LOBULO; d++) {
+		int64_t k = (int64_t) centro + d;
+		if (k < 0 || k >= bins) continue;
+		suma += p[k];
+		*momento += (double) k * p[k];
+	}
+	return suma;
+}
+
+static void marcar(uint8_t * marca, uint32_t bins, uint32_t centro) {
+	for (int32_t d=-LOBULO; d<=LOBULO; d++) {
+		int64_t k = (int64_t) centro + d;
+		if (k >= 0 && k < bins && marca[k] == 0) marca[k] = 1;
+	}
+}
+
+static uint32_t pico(const double * p, uint32_t bins, uint32_t desde, uint32_t hasta) {
+	uint32_t mejor = desde;
+	for (uint32_t k=desde; k<=hasta && k<bins; k++) if (p[k] > p[mejor]) mejor = k;
+	return mejor;
+}
+
+// JSON y umbrales: devuelve 1 si alguno no pasó
+static int informar(const char * origen, uint32_t muestras, uint32_t recortadas,
+		            const configuracion_t * c, const analisis_t * a) {
+	const char * fallas[5];
+	uint32_t nf = 0;
+	double ppm = (c->objetivo > 0.0) ? (a->frecuencia - c->objetivo) / c->objetivo * 1e6 : NAN;
+	if (!isnan(c->minSfdr) && !(a->sfdr >= c->minSfdr)) fallas[nf++] = "sfdr_dbc";
+	if (!isnan(c->maxThd) && !(a->thd <= c->maxThd)) fallas[nf++] = "thd_dbc";
+	if (!isnan(c->minSnr) && !(a->snr >= c->minSnr)) fallas[nf++] = "snr_db";
+	if (!isnan(c->minEnob) && !(a->enob >= c->minEnob)) fallas[nf++] = "enob";
+	if (!isnan(c->maxPpm) && !(fabs(ppm) <= c->maxPpm)) fallas[nf++] = "error_ppm";
+
+	printf("{\n  \"origen\": \"");
+	for (const char * s = origen; *s; s++) {
+		if (*s == '"' || *s == '\\') putchar('\\');
+		putchar(*s);
+	}
+	printf("\",\n");
+	printf("  \"muestras\": %u,\n  \"fft\": %u,\n  \"retencion\": %u,\n  \"recortadas\": %u,\n",
+		   muestras, a->fft, c->retencion, recortadas);
+	printf("  \"fs_hz\": %.3f,\n", c->fs);
+	if (c->objetivo > 0.0) printf("  \"objetivo_hz\": %.6f,\n", c->objetivo);
+	else printf("  \"objetivo_hz\": null,\n");
+	printf("  \"frecuencia_hz\": %.6f,\n", a->frecuencia);
+	if (c->objetivo > 0.0) {
+		printf("  \"error_hz\": %.6f,\n  \"error_ppm\": %.4f,\n", a->frecuencia - c->objetivo, ppm);
+	} else {
+		printf("  \"error_hz\": null,\n  \"error_ppm\": null,\n");
+	}
+	printf("  \"nivel_dbfs\": %.3f,\n  \"thd_dbc\": %.3f,\n", a->nivel, a->thd);
+	if (isinf(a->sfdr)) printf("  \"sfdr_dbc\": null,\n  \"espurio_hz\": null,\n");
+	else printf("  \"sfdr_dbc\": %.3f,\n  \"espurio_hz\": %.3f,\n", a->sfdr, a->espurio);
+	printf("  \"snr_db\": %.3f,\n  \"sinad_db\": %.3f,\n  \"enob\": %.3f,\n", a->snr, a->sinad, a->enob);
+	printf("  \"armonicos_dbc\": [");
+	for (uint32_t j=2; j<=c->armonicos; j++) {
+		if (isnan(a->armonico[j])) printf("%snull", (j > 2) ? ", " : "");
+		else printf("%s%.3f", (j > 2) ? ", " : "", a->armonico[j]);
+	}
+	printf("],\n  \"segundos\": %.4f,\n", a->segundos);
+	printf("  \"pasa\": %s,\n  \"fallas\": [", nf ? "false" : "true");
+	for (uint32_t i=0; i<nf; i++) printf("%s\"%s\"", i ? ", " : "", fallas[i]);
+	printf("]\n}\n");
+	return nf ? 1 : 0;
+}
+
+/*
+ * Prueba contra señales conocidas, cuantizadas a 12 bits como en el DAC:
+ *  - senoidal sola, frecuencia que no cae en un bin: ENOB entre 11,9 y
+ *    12,4 (el sinc atenúa el ruido alto) y error de frecuencia < 0,01 ppm;
+ *  - con armónicos de 3º a -70 dBc y 5º a -80 dBc: THD = -69,59 dBc y
+ *    SFDR = 70 dB (+-0,5);
+ *  - a 100 ppm del objetivo: error_ppm = 100 (+-0,1);
+ *  - tiempo con 2^23 muestras.
+ */
+static int autoprueba(void) {
+	const double fs = FRECUENCIA_TIM2 / (PERIODO_DAC_DEFECTO + 1);
+	const uint32_t n = 1u << 21, nGrande = 1u << 23;
+	configuracion_t c = { fs, 0.0, ARMONICOS_DEFECTO, 1,
+			              SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL, SIN_UMBRAL };
+	uint16_t * traza = malloc(nGrande * sizeof(uint16_t));
+	analisis_t a;
+	int bien = 1, caso;
+
+	static const struct { double f, ppm, h3, h5; } casos[] = {
+		{ 100037.0, 0.0, 0.0, 0.0 },
+		{ 100037.0, 0.0, -70.0, -80.0 },
+		{ 100000.0, 100.0, 0.0, 0.0 },
+	};
+	printf("%-34s %10s %9s %9s %9s %7s %10s\n", "caso", "nivel", "THD", "SFDR", "SNR", "ENOB", "error ppm");
+	for (uint32_t i=0; i<sizeof(casos)/sizeof(casos[0]); i++) {
+		double f = casos[i].f * (1.0 + casos[i].ppm * 1e-6);
+		double g3 = (casos[i].h3 != 0.0) ? pow(10.0, casos[i].h3 / 20.0) : 0.0;
+		double g5 = (casos[i].h5 != 0.0) ? pow(10.0, casos[i].h5 / 20.0) : 0.0;
+		for (uint32_t k=0; k<n; k++) {
+			double t = 2.0 * PI * f * k / fs;
+			traza[k] = (uint16_t) lround(2048.0 + 2000.0 * (sin(t) + g3 * sin(3 * t) + g5 * sin(5 * t)));
+		}
+		c.objetivo = casos[i].f;
+		analizar(traza, n, &c, &a);
+		double ppm = (a.frecuencia - c.objetivo) / c.objetivo * 1e6;
+		switch (i) {
+		case 0: caso = (a.enob > 11.9 && a.enob < 12.4 && fabs(ppm) < 0.01); break;
+		case 1: caso = (fabs(a.thd + 69.59) < 0.5 && fabs(a.sfdr - 70.0) < 0.5); break;
+		default: caso = (fabs(ppm - 100.0) < 0.1); break;
+		}
+		bien &= caso;
+		char nombre[40];
+		snprintf(nombre, sizeof(nombre), "%.0f Hz%s%s", f,
+				 (g3 != 0.0) ? " + H3 -70 + H5 -80" : "", (casos[i].ppm != 0.0) ? " (+100 ppm)" : "");
+		printf("%-34s %8.2fdB %7.2fdB %7.2fdB %7.2fdB %7.2f %10.4f  %s\n", nombre, a.nivel, a.thd,
+			   a.sfdr, a.snr, a.enob, ppm, caso ? "ok" : "ERROR");
+	}
+
+	for (uint32_t k=0; k<nGrande; k++) {
+		traza[k] = (uint16_t) lround(2048.0 + 2000.0 * sin(2.0 * PI * 100037.0 * k / fs));
+	}
+	c.objetivo = 100037.0;
+	analizar(traza, nGrande, &c, &a);
+	printf("\n%u muestras: %.2f s (ventana, FFT y analisis)\n", nGrande, a.segundos);
+	free(traza);
+	return bien ? 0 : 1;
+}
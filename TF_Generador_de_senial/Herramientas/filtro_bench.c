@@ -0,0 +1,291 @@
+/*******************************************************************************
+  * @file		filtro_bench.c
+  * @brief      Verificación, medición y referencia en la PC de los filtros
+  *             del modo DSP
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_filtro.c del firmware (con equivalentes en C de las
+  * instrucciones SIMD) y lo compara bit a bit contra una versión escalar
+  * directa, muestra por muestra, para distintas cantidades de coeficientes
+  * (pares e impares), de biquads y de muestras por bloque, con entradas y
+  * coeficientes que saturan. Verifica el rechazo de un FIR que desbordaría
+  * y mide el tiempo por muestra. En el dispositivo, DSP? informa los ciclos
+  * medidos con el contador DWT.
+  *
+  * Con un archivo de coeficientes (las mismas líneas FIR, TAP y BQ que se
+  * envían por UART) filtra las muestras de la entrada estándar y escribe la
+  * salida que debe dar el dispositivo, una muestra por línea.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o filtro_bench filtro_bench.c \
+  *               ../Drivers/API/Src/API_filtro.c ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./filtro_bench
+  *            ./filtro_bench <coeficientes> [bloque] < entrada.txt > salida.txt
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_filtro.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define LARGO_PRUEBA	3000				// Muestras de cada caso
+#define MUESTRAS_BENCH	(4 * 1024 * 1024)	// Muestras procesadas por medición
+#define MAX_ENTRADA		(1 << 20)
+#define LARGO_LINEA		256
+#define PI				3.14159265358979323846
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t entrada[LARGO_PRUEBA];
+static uint16_t salida[LARGO_PRUEBA];
+static uint16_t esperada[LARGO_PRUEBA];
+static filtro_t filtro;
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int32_t saturar16(int64_t valor) {
+	return (valor > INT16_MAX) ? INT16_MAX : (valor < INT16_MIN) ? INT16_MIN : (int32_t) valor;
+}
+
+// Referencia escalar: la misma cuenta, una muestra por vez y en 64 bits
+static uint32_t referencia(const coefFiltro_t * c, const uint16_t * origen, uint16_t * destino,
+		                   uint32_t largo) {
+	int64_t x[LARGO_PRUEBA];
+	int64_t estado[FILTRO_MAX_ETAPAS][4] = { { 0 } };
+	uint32_t saturadas = 0;
+
+	for (uint32_t n=0; n<largo; n++) x[n] = (int64_t) (origen[n] & FILTRO_MAX_DAC) - FILTRO_CENTRO;
+	for (uint32_t n=0; n<largo; n++) {
+		int64_t y = x[n];
+		if (c->taps > 0) {
+			int64_t suma = 1 << (FILTRO_BITS_FIR - 1);
+			for (uint32_t k=0; k<c->taps && k<=n; k++) suma += (int64_t) c->fir[k] * x[n - k];
+			y = saturar16(suma >> FILTRO_BITS_FIR);
+		}
+		for (uint32_t e=0; e<c->etapas; e++) {
+			const int16_t * b = c->biquad[e];
+			int64_t * s = estado[e];
+			int64_t suma = (1 << (FILTRO_BITS_BIQUAD - 1)) + b[0] * y + b[1] * s[0] + b[2] * s[1]
+					       - b[3] * s[2] - b[4] * s[3];
+			int64_t z = saturar16(suma >> FILTRO_BITS_BIQUAD);
+			saturadas += (z != (suma >> FILTRO_BITS_BIQUAD));
+			s[1] = s[0];
+			s[0] = y;
+			s[3] = s[2];
+			s[2] = z;
+			y = z;
+		}
+		int64_t z = y + FILTRO_CENTRO;
+		int64_t w = (z < 0) ? 0 : (z > FILTRO_MAX_DAC) ? FILTRO_MAX_DAC : z;
+		saturadas += (w != z);
+		destino[n] = (uint16_t) w;
+	}
+	return saturadas;
+}
+
+// Biquad de audio (RBJ) en Q14: pasabajos o pasaaltos
+static void disenarBiquad(int16_t * b, double frecuencia, double q, int pasaaltos) {
+	double w = 2 * PI * frecuencia, alfa = sin(w) / (2 * q), cw = cos(w);
+	double a0 = 1 + alfa;
+	double b0 = pasaaltos ? (1 + cw) / 2 : (1 - cw) / 2;
+	double b1 = pasaaltos ? -(1 + cw) : 1 - cw;
+	double coef[5] = { b0, b1, b0, -2 * cw, 1 - alfa };
+	for (int i=0; i<5; i++) b[i] = (int16_t) lround(coef[i] / a0 * (1 << FILTRO_BITS_BIQUAD));
+}
+
+static int probarCaso(const coefFiltro_t * c, uint32_t bloque, int * casos) {
+	if (Filtro_Preparar(&filtro, c) != true) {
+		printf("ERROR: rechazado taps=%u norma=%u\n", c->taps, Filtro_Norma(c));
+		return 1;
+	}
+	uint32_t a = 0;
+	for (uint32_t n=0; n<LARGO_PRUEBA; n+=bloque) {
+		uint32_t largo = (LARGO_PRUEBA - n < bloque) ? LARGO_PRUEBA - n : bloque;
+		a += Filtro_Procesar(&filtro, &entrada[n], &salida[n], largo);
+	}
+	uint32_t b = referencia(c, entrada, esperada, LARGO_PRUEBA);
+	(*casos)++;
+	for (uint32_t n=0; n<LARGO_PRUEBA; n++) {
+		if (salida[n] != esperada[n]) {
+			printf("ERROR: taps=%u etapas=%u bloque=%u muestra %u: %u (esperada %u)\n",
+			       c->taps, c->etapas, bloque, n, salida[n], esperada[n]);
+			return 1;
+		}
+	}
+	if (a != b) {
+		printf("ERROR: taps=%u etapas=%u bloque=%u saturadas %u (esperadas %u)\n",
+		       c->taps, c->etapas, bloque, a, b);
+		return 1;
+	}
+	return 0;
+}
+
+static void coeficientesAzar(coefFiltro_t * c, uint32_t taps, uint32_t etapas, int fuerte) {
+	Filtro_Defecto(c);
+	c->taps = taps;
+	for (uint32_t k=0; k<taps; k++) c->fir[k] = (int16_t) (rand() % 65535 - 32767);
+	// Escala para que sum |h| quede por debajo del máximo (o bien cerca de 1)
+	uint32_t norma = Filtro_Norma(c);
+	uint32_t objetivo = fuerte ? FILTRO_NORMA_MAXIMA - 1 : 32768;
+	if (norma > objetivo) {
+		for (uint32_t k=0; k<taps; k++) c->fir[k] = (int16_t) ((int64_t) c->fir[k] * objetivo / norma);
+	}
+	c->etapas = etapas;
+	for (uint32_t e=0; e<etapas; e++) {
+		if (fuerte) {
+			for (int i=0; i<5; i++) c->biquad[e][i] = (int16_t) (rand() % 65535 - 32767);
+		} else {
+			disenarBiquad(c->biquad[e], 0.01 + 0.4 * rand() / RAND_MAX, 0.5 + 4.0 * rand() / RAND_MAX, rand() & 1);
+		}
+	}
+}
+
+static int probarInterpretes(void) {
+	coefFiltro_t c;
+	int errores = 0;
+	Filtro_Defecto(&c);
+
+	errores += (Filtro_Interpretar_Taps("0 1", &c) != false);			// Sin FIR
+	errores += (Filtro_Interpretar_Fir("129", &c) != false);
+	errores += (Filtro_Interpretar_Fir("5", &c) != true || c.taps != 5);
+	errores += (Filtro_Interpretar_Taps("1 100 -200 300", &c) != true);
+	errores += (c.fir[0] != 0 || c.fir[1] != 100 || c.fir[2] != -200 || c.fir[3] != 300 || c.fir[4] != 0);
+	errores += (Filtro_Interpretar_Taps("3 1 2 3", &c) != false);		// No entran
+	errores += (Filtro_Interpretar_Taps("0 32768", &c) != false);
+	errores += (Filtro_Interpretar_Taps("0 12x", &c) != false);
+	errores += (Filtro_Interpretar_Taps("5 1", &c) != false);
+	errores += (c.fir[3] != 300);										// No cambió
+	errores += (Filtro_Interpretar_Biquad("1 1 2 3 4 5", &c) != false);	// Falta la 0
+	errores += (Filtro_Interpretar_Biquad("0 16384 0 0 0 0", &c) != true || c.etapas != 1);
+	errores += (Filtro_Interpretar_Biquad("1 1 2 3 4", &c) != false);
+	errores += (Filtro_Interpretar_Biquad("0 1 2 3 4 5", &c) != true || c.etapas != 1 || c.biquad[0][4] != 5);
+	errores += (Filtro_Interpretar_Biquad("CLR", &c) != true || c.etapas != 0);
+	if (errores) printf("ERROR: %d fallas en los interpretes\n", errores);
+	return errores;
+}
+
+static int probarDesborde(void) {
+	coefFiltro_t c;
+	int errores = 0;
+	Filtro_Defecto(&c);
+
+	// Todos los coeficientes al máximo: rechazado
+	c.taps = FILTRO_MAX_TAPS;
+	for (uint32_t k=0; k<c.taps; k++) c.fir[k] = 32767;
+	errores += (Filtro_Preparar(&filtro, &c) != false);
+
+	// Justo debajo del límite, con la entrada del peor caso: igual a la referencia
+	uint32_t resto = FILTRO_NORMA_MAXIMA - 1;
+	for (uint32_t k=0; k<c.taps; k++) {
+		int16_t h = (int16_t) ((resto > 32767) ? 32767 : resto);
+		resto -= (uint32_t) h;
+		c.fir[k] = (k & 1) ? -h : h;
+	}
+	for (uint32_t n=0; n<LARGO_PRUEBA; n++) entrada[n] = ((n & 1) ^ ((n / 7) & 1)) ? 0 : FILTRO_MAX_DAC;
+	int casos = 0;
+	errores += probarCaso(&c, 64, &casos);
+	if (errores) printf("ERROR: control de desborde del FIR\n");
+	return errores;
+}
+
+static double medir(const coefFiltro_t * c, uint32_t bloque) {
+	uint32_t vueltas = MUESTRAS_BENCH / LARGO_PRUEBA;
+	Filtro_Preparar(&filtro, c);
+	double inicio = ahora();
+	for (uint32_t v=0; v<vueltas; v++) {
+		for (uint32_t n=0; n + bloque <= LARGO_PRUEBA; n+=bloque) {
+			Filtro_Procesar(&filtro, &entrada[n], &salida[n], bloque);
+		}
+	}
+	return (ahora() - inicio) * 1e9 / (vueltas * (LARGO_PRUEBA / bloque * bloque));
+}
+
+// Modo referencia: coeficientes de un archivo, muestras por la entrada estándar
+static int filtrarArchivo(const char * nombre, uint32_t bloque) {
+	static uint16_t muestras[MAX_ENTRADA];
+	char linea[LARGO_LINEA];
+	coefFiltro_t c;
+	FILE * f = fopen(nombre, "r");
+	if (f == NULL) { perror(nombre); return 1; }
+
+	Filtro_Defecto(&c);
+	while (fgets(linea, sizeof(linea), f) != NULL) {
+		linea[strcspn(linea, "\r\n")] = '\0';
+		if (linea[0] == '\0' || linea[0] == '#') continue;
+		bool_t ok;
+		if      (strncmp(linea, "FIR ", 4) == 0) ok = Filtro_Interpretar_Fir(linea + 4, &c);
+		else if (strncmp(linea, "TAP ", 4) == 0) ok = Filtro_Interpretar_Taps(linea + 4, &c);
+		else if (strncmp(linea, "BQ ", 3) == 0)  ok = Filtro_Interpretar_Biquad(linea + 3, &c);
+		else ok = false;
+		if (!ok) { fprintf(stderr, "Linea invalida: %s\n", linea); return 1; }
+	}
+	fclose(f);
+	if (Filtro_Preparar(&filtro, &c) != true) {
+		fprintf(stderr, "FIR invalido: sum |h| = %u >= %ld\n", Filtro_Norma(&c), (long) FILTRO_NORMA_MAXIMA);
+		return 1;
+	}
+
+	uint32_t n = 0, saturadas = 0;
+	unsigned valor;
+	while (n < MAX_ENTRADA && scanf("%u%*[^0-9]", &valor) == 1) muestras[n++] = (uint16_t) valor;
+	for (uint32_t i=0; i<n; i+=bloque) {
+		uint32_t largo = (n - i < bloque) ? n - i : bloque;
+		saturadas += Filtro_Procesar(&filtro, &muestras[i], &muestras[i], largo);
+	}
+	for (uint32_t i=0; i<n; i++) printf("%u\n", muestras[i]);
+	fprintf(stderr, "%u muestras, taps=%u biquads=%u, %u saturadas\n", n, c.taps, c.etapas, saturadas);
+	return 0;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	static const uint32_t tapsProbados[] = { 0, 1, 2, 3, 4, 5, 16, 31, 32, 63, 64, 127, 128 };
+	static const uint32_t etapasProbadas[] = { 0, 1, 2, FILTRO_MAX_ETAPAS };
+	static const uint32_t bloques[] = { 1, 2, 3, 7, 64, 255, FILTRO_MAX_BLOQUE };
+	coefFiltro_t c;
+	int errores = 0, casos = 0;
+
+	if (argc > 1) return filtrarArchivo(argv[1], (argc > 2) ? (uint32_t) atoi(argv[2]) : 64);
+
+	// 1) Igualdad bit a bit (y de la cuenta de saturadas) contra la referencia
+	srand(1);
+	errores += probarInterpretes();
+	errores += probarDesborde();
+	for (int fuerte=0; fuerte<2; fuerte++) {
+		for (uint32_t n=0; n<LARGO_PRUEBA; n++) {
+			// Senoidal con ruido y, en el caso fuerte, saltos de riel a riel
+			double s = 2048 + 1500 * sin(2 * PI * n / 97.0) + rand() % 200 - 100;
+			entrada[n] = (uint16_t) (fuerte && (rand() % 8 == 0) ? (rand() & 1) * FILTRO_MAX_DAC : s);
+		}
+		for (unsigned t=0; t<sizeof(tapsProbados)/sizeof(tapsProbados[0]); t++) {
+			for (unsigned e=0; e<sizeof(etapasProbadas)/sizeof(etapasProbadas[0]); e++) {
+				for (unsigned b=0; b<sizeof(bloques)/sizeof(bloques[0]); b++) {
+					coeficientesAzar(&c, tapsProbados[t], etapasProbadas[e], fuerte);
+					errores += probarCaso(&c, bloques[b], &casos);
+				}
+			}
+		}
+	}
+	printf("%d casos comparados con la referencia, %d errores\n", casos, errores);
+
+	// 2) Tiempo por muestra (en la PC: sólo orientativo)
+	printf("taps biquads bloque  ns/muestra\n");
+	static const uint32_t tapsMedidos[] = { 0, 16, 64, 128 };
+	for (unsigned t=0; t<sizeof(tapsMedidos)/sizeof(tapsMedidos[0]); t++) {
+		for (uint32_t e=0; e<=FILTRO_MAX_ETAPAS; e+=2) {
+			coeficientesAzar(&c, tapsMedidos[t], e, 0);
+			printf("%4u %7u %6u %10.2f\n", tapsMedidos[t], e, 64, medir(&c, 64));
+		}
+	}
+	return errores ? 1 : 0;
+}
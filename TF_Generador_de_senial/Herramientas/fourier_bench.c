@@ -0,0 +1,83 @@
+/*******************************************************************************
+  * @file		fourier_bench.c
+  * @brief      Verificación y medición en la PC de la síntesis por armónicos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_fourier.c del firmware, compara los métodos directo y
+  * FFT contra la suma en punto flotante y mide el tiempo por muestra.
+  * En el dispositivo, el comando FOURIER END informa los ciclos medidos con
+  * el contador DWT.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o fourier_bench fourier_bench.c \
+  *               ../Drivers/API/Src/API_fourier.c ../Drivers/API/Src/API_sintesis.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./fourier_bench [armonicos]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "API_fourier.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define REPETICIONES	200
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t salida[FOURIER_MAX_LARGO];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Error máximo (en cuentas) contra la suma en punto flotante
+static double errorMaximo(const fourier_t * f) {
+	double peor = 0;
+	for (uint32_t n=0; n<f->largo; n++) {
+		double v = f->offset;
+		for (uint8_t h=0; h<f->cantidad; h++) {
+			const armonico_t * a = &f->armonicos[h];
+			v += a->amplitud * sin(2 * M_PI * a->indice * n / f->largo + a->fase * M_PI / 180);
+		}
+		v = (v < 0) ? 0 : (v > 4095) ? 4095 : v;
+		if (fabs(v - salida[n]) > peor) peor = fabs(v - salida[n]);
+	}
+	return peor;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	int armonicos = (argc > 1) ? atoi(argv[1]) : 8;
+	if (armonicos < 1 || armonicos > FOURIER_MAX_ARMONICOS) armonicos = 8;
+
+	printf("armonicos=%d\n", armonicos);
+	printf("%6s %-4s %10s %10s\n", "N", "met", "ns/muestra", "err_max");
+
+	for (uint32_t largo=256; largo<=FOURIER_MAX_LARGO; largo<<=1) {
+		fourier_t f;
+		Fourier_Iniciar(&f);
+		f.largo = largo;
+		// Serie de la cuadrada (armónicos impares 1/k), escalada para no saturar
+		for (int h=0; h<armonicos; h++) {
+			int k = 2 * h + 1;
+			Fourier_Agregar(&f, (uint16_t) k, (uint16_t) (1600 / k), (uint16_t) ((h * 37) % 360));
+		}
+
+		for (int m=FOURIER_DIRECTO; m<=FOURIER_FFT; m++) {
+			f.metodo = (metodoFourier_t) m;
+			double inicio = ahora();
+			for (int r=0; r<REPETICIONES; r++) Fourier_Sintetizar(&f, salida);
+			double ns = (ahora() - inicio) * 1e9 / REPETICIONES / largo;
+			printf("%6u %-4s %10.2f %10.2f\n", (unsigned) largo,
+				   (m == FOURIER_DIRECTO) ? "DFT" : "FFT", ns, errorMaximo(&f));
+		}
+	}
+	return 0;
+}
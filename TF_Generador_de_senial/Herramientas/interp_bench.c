@@ -0,0 +1,92 @@
+/*******************************************************************************
+  * @file		interp_bench.c
+  * @brief      Verificación y medición en la PC de la expansión de puntos
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_interpolacion.c del firmware (con equivalentes en C de
+  * las instrucciones SIMD), compara contra la interpolación en punto flotante
+  * y mide el tiempo por muestra. En el dispositivo, INTERP END informa los
+  * ciclos medidos con el contador DWT.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o interp_bench interp_bench.c \
+  *               ../Drivers/API/Src/API_interpolacion.c ../Drivers/API/Src/API_sintesis.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./interp_bench [puntos] [muestras]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "API_interpolacion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_MUESTRAS	16384
+#define REPETICIONES	200
+
+/* Variables privadas --------------------------------------------------------*/
+static uint16_t salida[MAX_MUESTRAS];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Referencia en punto flotante con la misma convención periódica
+static double referencia(const interpolacion_t * p, uint32_t n) {
+	uint32_t K = p->cantidad;
+	double x = (double) n * K / p->largo;
+	uint32_t j = (uint32_t) x;
+	double t = x - j;
+	double p0 = p->puntos[(j + K - 1) % K], p1 = p->puntos[j % K];
+	double p2 = p->puntos[(j + 1) % K], p3 = p->puntos[(j + 2) % K];
+	double v;
+	if (p->metodo == INTERP_LINEAL) {
+		v = p1 + (p2 - p1) * t;
+	} else {
+		v = 0.5 * (2 * p1 + (p2 - p0) * t + (2 * p0 - 5 * p1 + 4 * p2 - p3) * t * t
+		           + (3 * (p1 - p2) + p3 - p0) * t * t * t);
+	}
+	return (v < 0) ? 0 : (v > 4095) ? 4095 : v;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	int K = (argc > 1) ? atoi(argv[1]) : 32;
+	long N = (argc > 2) ? atol(argv[2]) : 10000;
+	if (K < 2 || K > INTERP_MAX_PUNTOS) K = 32;
+	if (N < K || N > MAX_MUESTRAS) N = 10000;
+
+	interpolacion_t p;
+	Interp_Iniciar(&p);
+	p.largo = (uint32_t) N;
+	// Puntos de un seno con algo de tercer armónico
+	for (int j=0; j<K; j++) {
+		double x = 2 * M_PI * j / K;
+		Interp_Agregar(&p, (uint16_t) lround(2048 + 1500 * sin(x) + 400 * sin(3 * x)));
+	}
+
+	printf("K=%d N=%ld (carga %.0f veces menor)\n", K, N, (double) N / K);
+	printf("%-4s %10s %10s %10s\n", "met", "ns/muestra", "err_max", "saturadas");
+	for (int m=INTERP_LINEAL; m<=INTERP_CATMULL_ROM; m++) {
+		p.metodo = (metodoInterp_t) m;
+		uint32_t saturadas = 0;
+		double inicio = ahora();
+		for (int r=0; r<REPETICIONES; r++) saturadas = Interp_Expandir(&p, salida);
+		double ns = (ahora() - inicio) * 1e9 / REPETICIONES / N;
+
+		double peor = 0;
+		for (uint32_t n=0; n<p.largo; n++) {
+			double e = fabs(referencia(&p, n) - salida[n]);
+			if (e > peor) peor = e;
+		}
+		printf("%-4s %10.2f %10.2f %10u\n", (m == INTERP_LINEAL) ? "LIN" : "CR", ns, peor, (unsigned) saturadas);
+	}
+	return 0;
+}
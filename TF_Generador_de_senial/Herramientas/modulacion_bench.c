@@ -0,0 +1,354 @@
+/*******************************************************************************
+  * @file		modulacion_bench.c
+  * @brief      Verificación y medición en la PC de la modulación (MOD)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_modulacion.c del firmware y lo genera de a bloques
+  * del tamaño del modo MOD, como la interrupción del DMA. Cada muestra se
+  * compara contra un modelo ideal en doble precisión (AM, FM y PM, con
+  * portadora seno o de tabla y las tres modulantes); en PWM se cuentan las
+  * muestras que caen del lado equivocado del umbral lejos de un flanco.
+  * Verifica también:
+  *  - el suavizado: un cambio de profundidad o de desvío en marcha llega al
+  *    valor pedido sin escalones (el mayor salto del índice entre dos
+  *    muestras contra el que daría aplicarlo de golpe),
+  *  - la continuidad de fase al cambiar FC y FMOD en marcha,
+  *  - los rechazos (frecuencias a fs / 2, FM que pasa fs / 2, PM de media
+  *    vuelta, tabla vacía, parámetros mal escritos),
+  * y mide el tiempo por muestra de cada tipo. En el dispositivo, MOD?
+  * informa los ciclos medidos con el contador DWT y la fs máxima de cada
+  * tipo para una fracción de la CPU.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o modulacion_bench modulacion_bench.c \
+  *               ../Drivers/API/Src/API_modulacion.c ../Drivers/API/Src/API_sintesis.c \
+  *               ../Drivers/API/Src/API_numeros.c -lm
+  * Uso:       ./modulacion_bench
+  *            ./modulacion_bench "<argumentos de MOD>" [periodo] > traza.txt
+  *            (traza: muestra, código del DAC)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "API_modulacion.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define RELOJ			84000000	// FRECUENCIA_TIM2
+#define BLOQUE			128			// MOD_MITAD
+#define MUESTRAS		65536		// Por caso
+#define MAX_ERROR_LSB	4			// Tabla de seno interpolada + redondeo
+#define RESOLUCION_FM	8192.0		// FM: la modulante Q15 se integra en la fase, el
+									// error crece con el desvío pico (DEV / FMOD rad)
+#define LARGO_TABLA		100			// Portadora de tabla: no es potencia de 2
+#define DOS_PI			6.283185307179586
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	const char * nombre;
+	const char * argumentos;		// Como en el comando MOD
+	uint32_t periodo;				// ARR de TIM2
+} caso_t;
+
+/* Casos ---------------------------------------------------------------------*/
+static const caso_t Casos[] = {
+	{ "AM seno",               "AM FC=10000 FMOD=100 DEPTH=50",                        83 },
+	{ "AM 100%",               "AM FC=20000 FMOD=1000 DEPTH=100 AMP=1023",             83 },
+	{ "AM triangular",         "AM FC=5000 FMOD=50 DEPTH=80 WAVE=TRIANGLE AMP=1100",   83 },
+	{ "AM cuadrada",           "AM FC=5000 FMOD=50 DEPTH=30 WAVE=SQUARE",              83 },
+	{ "AM tabla",              "AM FC=1000 FMOD=10 DEPTH=50 CAR=TABLE",                83 },
+	{ "FM seno",               "FM FC=100000 FMOD=1000 DEV=20000",                     83 },
+	{ "FM banda ancha",        "FM FC=1000000 FMOD=10000 DEV=2000000",                 7  },
+	{ "FM triangular",         "FM FC=20000 FMOD=100 DEV=5000 WAVE=TRIANGLE",          83 },
+	{ "FM tabla",              "FM FC=2000 FMOD=20 DEV=500 CAR=TABLE",                 83 },
+	{ "PM seno",               "PM FC=10000 FMOD=500 DEV=90",                          83 },
+	{ "PM maximo",             "PM FC=10000 FMOD=500 DEV=179 WAVE=SQUARE",             83 },
+	{ "PM tabla",              "PM FC=1000 FMOD=100 DEV=45 CAR=TABLE",                 83 },
+	{ "PWM seno",              "PWM FC=10000 FMOD=100 DEPTH=90",                       83 },
+	{ "PWM triangular",        "PWM FC=1000 FMOD=10 DEPTH=100 WAVE=TRIANGLE",          83 },
+	{ "PWM 10,5 Msps",         "PWM FC=100000 FMOD=1000 DEPTH=50",                     7  },
+};
+
+// Deben fallar en Mod_Interpretar o en Mod_Calcular
+static const caso_t Rechazos[] = {
+	{ "FC en fs / 2",          "AM FC=500000",                                         83 },
+	{ "FMOD en fs / 2",        "AM FMOD=500000",                                       83 },
+	{ "FM pasa fs / 2",        "FM FC=400000 DEV=100000",                              83 },
+	{ "PM media vuelta",       "PM DEV=180",                                           83 },
+	{ "DEPTH > 100",           "AM DEPTH=101",                                         83 },
+	{ "forma desconocida",     "AM WAVE=SAW",                                          83 },
+	{ "portadora desconocida", "AM CAR=NOISE",                                         83 },
+	{ "sin valor",             "AM FC",                                                83 },
+};
+
+/* Variables -----------------------------------------------------------------*/
+static uint16_t Tabla[LARGO_TABLA];
+static uint16_t Salida[MUESTRAS];
+static estadoModulacion_t Estado;
+
+/* Prototipos ----------------------------------------------------------------*/
+static bool_t preparar(const caso_t * c, modulacion_t * m, ajusteModulacion_t * a);
+static double modulante(const modulacion_t * m, double fase);
+static double portadora(const modulacion_t * m, double fase);
+static bool_t verificar(const caso_t * c);
+static bool_t verificarSuavizado(const char * argumentos, const char * cambio);
+static bool_t verificarContinuidad(void);
+static void medir(void);
+static void generar(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad);
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	bool_t bien = true;
+
+	// Una portadora de tabla con armónicos (seno + tercera armónica)
+	for (uint32_t i=0; i<LARGO_TABLA; i++) {
+		double x = sin(DOS_PI * i / LARGO_TABLA) + 0.3 * sin(3 * DOS_PI * i / LARGO_TABLA);
+		Tabla[i] = (uint16_t) lround(2048 + 1500 * x);
+	}
+
+	if (argc > 1) {
+		caso_t traza = { "traza", argv[1], (argc > 2) ? (uint32_t) atoi(argv[2]) : 83 };
+		modulacion_t m;
+		ajusteModulacion_t a;
+		if (preparar(&traza, &m, &a) != true) {
+			fprintf(stderr, "Parametros invalidos para la fs.\n");
+			return 1;
+		}
+		generar(&Estado, Salida, MUESTRAS);
+		for (uint32_t n=0; n<MUESTRAS; n++) printf("%u %u\n", n, Salida[n]);
+		return 0;
+	}
+
+	for (uint32_t i=0; i<sizeof(Casos)/sizeof(Casos[0]); i++) bien &= verificar(&Casos[i]);
+
+	for (uint32_t i=0; i<sizeof(Rechazos)/sizeof(Rechazos[0]); i++) {
+		modulacion_t m;
+		ajusteModulacion_t a;
+		bool_t rechazado = (preparar(&Rechazos[i], &m, &a) != true);
+		printf("%-22s %s\n", Rechazos[i].nombre, rechazado ? "rechazado" : "ACEPTADO (error)");
+		bien &= rechazado;
+	}
+	{
+		// CAR=TABLE sin señal cargada
+		modulacion_t m;
+		ajusteModulacion_t a;
+		Mod_Defecto(&m);
+		m.tabla = true;
+		bool_t rechazado = (Mod_Calcular(&a, &m, RELOJ, 84) == true
+				            && Mod_Preparar(&Estado, &a, NULL, 0) != true);
+		printf("%-22s %s\n", "tabla vacia", rechazado ? "rechazado" : "ACEPTADO (error)");
+		bien &= rechazado;
+	}
+
+	bien &= verificarSuavizado("AM FC=10000 FMOD=100 DEPTH=0", "DEPTH=100");
+	bien &= verificarSuavizado("PWM FC=10000 FMOD=100 DEPTH=100", "DEPTH=0");
+	bien &= verificarSuavizado("FM FC=100000 FMOD=1000 DEV=0", "DEV=50000");
+	bien &= verificarSuavizado("PM FC=10000 FMOD=500 DEV=179", "DEV=10");
+	bien &= verificarContinuidad();
+	medir();
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+/**
+  * @brief Interpreta, convierte y prepara el estado global
+  */
+static bool_t preparar(const caso_t * c, modulacion_t * m, ajusteModulacion_t * a) {
+	char texto[128];
+	strncpy(texto, c->argumentos, sizeof(texto) - 1);
+	texto[sizeof(texto) - 1] = '\0';
+	Mod_Defecto(m);
+	if (Mod_Interpretar(texto, m) != true) return false;
+	if (Mod_Calcular(a, m, RELOJ, c->periodo + 1) != true) return false;
+	return Mod_Preparar(&Estado, a, Tabla, LARGO_TABLA);
+}
+
+/**
+  * @brief Genera de a bloques, como la interrupción del DMA
+  */
+static void generar(estadoModulacion_t * e, uint16_t * destino, uint32_t cantidad) {
+	for (uint32_t n=0; n<cantidad; n+=BLOQUE) Mod_Generar(e, destino + n, BLOQUE);
+}
+
+/**
+  * @brief Modulante ideal, fase en ciclos
+  */
+static double modulante(const modulacion_t * m, double fase) {
+	double f = fase - floor(fase);
+	switch (m->forma) {
+	case MOD_SENO:       return sin(DOS_PI * f);
+	case MOD_TRIANGULAR: return (f < 0.25) ? 4 * f : (f < 0.75) ? 2 - 4 * f : 4 * f - 4;
+	default:             return (f < 0.5) ? 1 : -1;
+	}
+}
+
+/**
+  * @brief Portadora ideal (-1 .. 1), fase en ciclos
+  */
+static double portadora(const modulacion_t * m, double fase) {
+	double f = fase - floor(fase);
+	if (!m->tabla) return sin(DOS_PI * f);
+	double posicion = f * LARGO_TABLA;
+	uint32_t i = (uint32_t) posicion;
+	if (i >= LARGO_TABLA) i = LARGO_TABLA - 1;
+	double x0 = Tabla[i];
+	double x1 = Tabla[(i + 1) % LARGO_TABLA];
+	return (x0 + (x1 - x0) * (posicion - i) - 2048) / 2048;
+}
+
+/**
+  * @brief Compara un caso contra el modelo ideal. Las frecuencias ideales
+  *        son las de los pasos Q0.32 (la resolución de frecuencia del DDS
+  *        no es error del modelo).
+  */
+static bool_t verificar(const caso_t * c) {
+	modulacion_t m;
+	ajusteModulacion_t a;
+	if (preparar(c, &m, &a) != true) {
+		printf("%-22s RECHAZADO (error)\n", c->nombre);
+		return false;
+	}
+	generar(&Estado, Salida, MUESTRAS);
+
+	double fc = a.pasoPortadora / 4294967296.0;		// Ciclos por muestra
+	double fm = a.pasoModulante / 4294967296.0;
+	double indice = (m.tipo == MOD_FM || m.tipo == MOD_PM) ? a.indice / 4294967296.0 : a.indice / 1073741824.0;
+	double fase = 0;
+	int32_t errorMaximo = 0;
+	uint32_t pwmMal = 0;
+
+	for (uint32_t n=0; n<MUESTRAS; n++) {
+		double s = modulante(&m, fm * n);
+		double ideal;
+		switch (m.tipo) {
+		case MOD_AM:
+			ideal = m.offset + m.amplitud * portadora(&m, fc * n) * (1 + indice * s);
+			break;
+		case MOD_FM:
+			ideal = m.offset + m.amplitud * portadora(&m, fase);
+			fase += fc + indice * s;
+			break;
+		case MOD_PM:
+			ideal = m.offset + m.amplitud * portadora(&m, fc * n + indice * s);
+			break;
+		default: {
+			double f = fc * n - floor(fc * n);
+			double umbral = 0.5 * (1 + indice * s);
+			if (fabs(f - umbral) < 1e-4 || f < 1e-9) continue;	// Sobre el flanco
+			ideal = (f < umbral) ? m.offset + m.amplitud : m.offset - m.amplitud;
+			if (ideal < 0) ideal = 0;
+			if (ideal > 4095) ideal = 4095;
+			if (fabs(Salida[n] - ideal) > 0.5) pwmMal++;
+			continue;
+		}
+		}
+		if (ideal < 0) ideal = 0;
+		if (ideal > 4095) ideal = 4095;
+		int32_t error = abs((int32_t) Salida[n] - (int32_t) lround(ideal));
+		if (error > errorMaximo) errorMaximo = error;
+	}
+
+	int32_t limite = MAX_ERROR_LSB;
+	if (m.tipo == MOD_FM && m.modulante > 0) {
+		// Pendiente de la portadora de tabla: hasta el doble que la del seno
+		limite += (int32_t) ceil(2.0 * m.amplitud * m.desvio / m.modulante / RESOLUCION_FM);
+	}
+	bool_t bien = (errorMaximo <= limite && pwmMal == 0);
+	if (m.tipo == MOD_PWM) printf("%-22s PWM mal=%u  %s\n", c->nombre, pwmMal, bien ? "ok" : "ERROR");
+	else printf("%-22s error=%d LSB (max %d)  %s\n", c->nombre, errorMaximo, limite, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/**
+  * @brief Arranca con 'argumentos', cambia en marcha con 'cambio' y sigue
+  *        el índice muestra a muestra: debe llegar al pedido, sin pasarse
+  *        y con saltos mucho menores que el cambio de golpe.
+  */
+static bool_t verificarSuavizado(const char * argumentos, const char * cambio) {
+	caso_t c = { "suavizado", argumentos, 83 };
+	modulacion_t m;
+	ajusteModulacion_t a, nuevo;
+	char texto[64];
+
+	if (preparar(&c, &m, &a) != true) return false;
+	generar(&Estado, Salida, 4 * BLOQUE);
+	strncpy(texto, cambio, sizeof(texto) - 1);
+	texto[sizeof(texto) - 1] = '\0';
+	if (Mod_Interpretar(texto, &m) != true || Mod_Calcular(&nuevo, &m, RELOJ, 84) != true) return false;
+	Mod_Ajustar(&Estado, &nuevo);
+
+	int64_t inicio = Estado.indice;
+	int64_t salto = llabs((int64_t) nuevo.indice - inicio);
+	int64_t saltoMaximo = 0;
+	uint32_t bloques = 0;
+	bool_t pasado = false;
+	while (Estado.indice != nuevo.indice && bloques < 1000) {
+		// Rampa del bloque: la misma cuenta que Mod_Generar
+		int64_t antes = Estado.indice;
+		Mod_Generar(&Estado, Salida, BLOQUE);
+		int64_t porMuestra = llabs((int64_t) Estado.indice - antes) / BLOQUE + 1;
+		if (porMuestra > saltoMaximo) saltoMaximo = porMuestra;
+		if ((nuevo.indice - inicio) * ((int64_t) nuevo.indice - Estado.indice) < 0) pasado = true;
+		bloques++;
+	}
+	bool_t bien = (Estado.indice == nuevo.indice && !pasado && saltoMaximo * 100 < salto);
+	printf("%-22s %-30s -> %-10s %4u bloques, salto %.4f%% del cambio  %s\n", "suavizado", argumentos, cambio,
+			bloques, salto ? 100.0 * saltoMaximo / salto : 0.0, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/**
+  * @brief Cambia FC y FMOD en marcha: la fase de la portadora no salta (la
+  *        diferencia entre dos muestras de la salida no supera la que da la
+  *        frecuencia mayor).
+  */
+static bool_t verificarContinuidad(void) {
+	caso_t c = { "continuidad", "AM FC=1000 FMOD=10 DEPTH=0", 83 };
+	modulacion_t m;
+	ajusteModulacion_t a, nuevo;
+	char texto[] = "FC=3000 FMOD=30";
+
+	if (preparar(&c, &m, &a) != true) return false;
+	Mod_Generar(&Estado, Salida, 3 * BLOQUE + 37);	// Un cambio a mitad de período
+	uint32_t fase = Estado.fasePortadora;
+	if (Mod_Interpretar(texto, &m) != true || Mod_Calcular(&nuevo, &m, RELOJ, 84) != true) return false;
+	Mod_Ajustar(&Estado, &nuevo);
+	bool_t bien = (Estado.fasePortadora == fase);
+	uint16_t anterior = Salida[3 * BLOQUE + 36];
+	generar(&Estado, Salida, BLOQUE);
+	double maximo = m.amplitud * DOS_PI * 3000.0 / 1000000.0 + 2;
+	bien &= (fabs((double) Salida[0] - anterior) <= maximo);
+	printf("%-22s salto=%d LSB (max %.0f)  %s\n", "continuidad de fase",
+			abs((int32_t) Salida[0] - (int32_t) anterior), maximo, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/**
+  * @brief Tiempo por muestra de cada tipo, con portadora seno y de tabla
+  */
+static void medir(void) {
+	static const char * const Tipos[] = { "AM", "FM", "PM", "PWM" };
+	printf("\nTiempo por muestra (PC):\n");
+	for (uint32_t t=0; t<MOD_TIPOS; t++) {
+		for (uint32_t tabla=0; tabla<2; tabla++) {
+			char texto[96];
+			snprintf(texto, sizeof(texto), "%s FC=10000 FMOD=100 DEPTH=50 DEV=%s CAR=%s", Tipos[t],
+					(t == MOD_PM) ? "90" : "1000", tabla ? "TABLE" : "SINE");
+			caso_t c = { Tipos[t], texto, 83 };
+			modulacion_t m;
+			ajusteModulacion_t a;
+			if (preparar(&c, &m, &a) != true) continue;
+			clock_t inicio = clock();
+			uint32_t vueltas = 200;
+			for (uint32_t v=0; v<vueltas; v++) generar(&Estado, Salida, MUESTRAS);
+			double ns = 1e9 * (double) (clock() - inicio) / CLOCKS_PER_SEC / ((double) vueltas * MUESTRAS);
+			printf("  %-4s CAR=%-6s %.2f ns/muestra\n", Tipos[t], tabla ? "TABLE" : "SINE", ns);
+		}
+	}
+}
@@ -0,0 +1,298 @@
+/*******************************************************************************
+  * @file		puntos_sim.c
+  * @brief      Simulación en la PC de la salida punto por punto (PTS)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_puntos.c del firmware y recorre la tabla preparada
+  * con un modelo de lo que arma Comenzar_Puntos_DAC_DMA:
+  *  - TIM2 con precarga de ARR: en cada actualización el ARR activo toma
+  *    el de la precarga y el próximo disparo sale ARR + 1 ciclos después,
+  *  - el DAC pasa DHR a la salida con cada disparo y su DMA escribe el
+  *    DHR siguiente 'latencia' ciclos después,
+  *  - el DMA de la actualización escribe la precarga de ARR detrás del
+  *    DAC (mismo DMA1, el stream 6 va primero): a 2 x 'latencia' ciclos.
+  * La salida se compara, disparo a disparo, contra la tabla en el orden
+  * natural: cada punto debe salir con su valor y durar exactamente sus
+  * ciclos, vuelta tras vuelta, y el fin de cada punto debe caer a medio
+  * ciclo de la suma de las duraciones pedidas (sin deriva). También:
+  *  - con puntos de PTS_CICLOS_MINIMO ciclos, latencias hasta 7 ciclos
+  *    andan y 8 no: el modelo detecta la escritura tardía,
+  *  - los rechazos (valor, duración, punto corto, tabla llena, texto) y
+  *    que un texto con un par inválido no agregue ninguno,
+  *  - que Pts_Restaurar deje la tabla como estaba.
+  * La latencia de DMA1 en el dispositivo no está medida: el mínimo de 16
+  * ciclos supone hasta 7 ciclos de TIM2 (14 de AHB) por transferencia.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o puntos_sim puntos_sim.c \
+  *               ../Drivers/API/Src/API_puntos.c ../Drivers/API/Src/API_numeros.c
+  * Uso:       ./puntos_sim
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "API_puntos.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define RELOJ			84000000	// Hz de TIM2
+#define VUELTAS			3
+#define MAX_DISPAROS	(VUELTAS * PTS_MAX_PUNTOS + 1)
+#define LATENCIA_MAXIMA	7			// Ciclos de TIM2 por transferencia de DMA
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	uint32_t disparos;
+	uint32_t subejecuciones;		// El DAC disparó con su DMA pendiente
+	uint32_t atrasos;				// La actualización tomó una precarga vieja
+} resultado_t;
+
+/* Variables -----------------------------------------------------------------*/
+static puntos_t Puntos;
+static uint16_t Valores[PTS_MAX_PUNTOS];	// Orden natural, antes de preparar
+static uint32_t Periodos[PTS_MAX_PUNTOS];
+static uint32_t Duraciones[PTS_MAX_PUNTOS];	// ns pedidos
+static uint64_t Instantes[MAX_DISPAROS];
+static uint16_t Salida[MAX_DISPAROS];
+
+/* Prototipos ----------------------------------------------------------------*/
+static bool_t agregar(uint32_t nanosegundos, uint16_t valor);
+static void simular(const puntos_t * p, uint32_t latencia, uint32_t disparos, resultado_t * r);
+static bool_t verificar(const char * nombre);
+static bool_t verificarLatencia(void);
+static bool_t verificarRechazos(void);
+
+/* Programa ------------------------------------------------------------------*/
+int main(void) {
+	bool_t bien = true;
+
+	srand(1);
+
+	// Niveles largos con flancos de a pasos cortos
+	Pts_Vaciar(&Puntos);
+	for (uint32_t nivel=0; nivel<4; nivel++) {
+		agregar(10000000, (uint16_t) (nivel * 1000));
+		for (uint32_t paso=1; paso<=5; paso++) agregar(200, (uint16_t) (nivel * 1000 + paso * 200));
+	}
+	bien &= verificar("niveles y flancos");
+
+	Pts_Vaciar(&Puntos);
+	for (uint32_t i=0; i<PTS_MAX_PUNTOS; i++) {
+		agregar(191 + (uint32_t) rand() % 100000, (uint16_t) (rand() % 4096));
+	}
+	bien &= verificar("al azar, tabla llena");
+
+	Pts_Vaciar(&Puntos);
+	agregar(1000, 2048);
+	bien &= verificar("un punto");
+
+	Pts_Vaciar(&Puntos);
+	agregar(191, 0);
+	agregar(191, 4095);
+	bien &= verificar("dos puntos minimos");
+
+	Pts_Vaciar(&Puntos);
+	for (uint32_t i=0; i<3; i++) agregar(PTS_MAX_DURACION, (uint16_t) (i * 2000));
+	bien &= verificar("puntos de un segundo");
+
+	Pts_Vaciar(&Puntos);
+	for (uint32_t i=0; i<1000; i++) agregar(200, (uint16_t) (i & 1 ? 4095 : 0));
+	bien &= verificar("redondeo 200 ns");
+
+	bien &= verificarLatencia();
+	bien &= verificarRechazos();
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+/**
+  * @brief Agrega un punto y guarda la copia en orden natural
+  */
+static bool_t agregar(uint32_t nanosegundos, uint16_t valor) {
+	uint32_t i = Puntos.cantidad;
+	if (Pts_Agregar(&Puntos, nanosegundos, valor, RELOJ) != true) return false;
+	Valores[i] = valor;
+	Periodos[i] = Puntos.periodos[i];
+	Duraciones[i] = nanosegundos;
+	return true;
+}
+
+/**
+  * @brief Modelo de TIM2 con precarga de ARR y los dos DMA. Arranca como
+  *        Comenzar_Puntos_DAC_DMA: ARR activo y precarga con el primer
+  *        punto, CNT = ARR y el primer valor en DHR; el primer disparo
+  *        sale un ciclo después de habilitar el timer (instante 0).
+  *        Anota el instante y el valor de salida de cada disparo.
+  */
+static void simular(const puntos_t * p, uint32_t latencia, uint32_t disparos, resultado_t * r) {
+	uint32_t n = p->cantidad;
+	uint32_t activo = p->periodos[n - 1], precarga = activo;
+	uint16_t dhr = p->valores[n - 1];
+	uint32_t iDac = 0, iTim = 0;
+	bool_t dacPendiente = false, timPendiente = false;
+	uint64_t dacListo = 0, timListo = 0;
+	uint16_t dacValor = 0;
+	uint32_t timValor = 0;
+	uint64_t t = 1;						// CNT = ARR: desborda en un ciclo
+
+	memset(r, 0, sizeof(*r));
+	for (uint32_t k=0; k<disparos; k++) {
+		// Lo que los DMA terminaron de escribir antes de este disparo
+		if (dacPendiente && dacListo < t) {
+			dhr = dacValor;
+			dacPendiente = false;
+		}
+		if (timPendiente && timListo < t) {
+			precarga = timValor;
+			timPendiente = false;
+		}
+		if (dacPendiente) r->subejecuciones++;
+		if (timPendiente) r->atrasos++;
+
+		// Disparo: DHR a la salida y la precarga al ARR activo
+		Salida[k] = dhr;
+		Instantes[k] = t;
+		activo = precarga;
+		r->disparos++;
+
+		// Pedidos de DMA del disparo (un pedido pendiente no se repite)
+		if (!dacPendiente) {
+			dacPendiente = true;
+			dacListo = t + latencia;
+			dacValor = p->valores[iDac++ % n];
+		}
+		if (!timPendiente) {
+			timPendiente = true;
+			timListo = t + 2 * latencia;
+			timValor = p->periodos[iTim++ % n];
+		}
+		t += (uint64_t) activo + 1;
+	}
+}
+
+/**
+  * @brief Prepara la tabla, la simula con todas las latencias hasta
+  *        LATENCIA_MAXIMA y compara cada disparo contra el orden natural
+  */
+static bool_t verificar(const char * nombre) {
+	uint32_t n = Puntos.cantidad;
+	uint32_t disparos = VUELTAS * n + 1;
+	uint32_t distintos = 0, deriva = 0, errores = 0;
+	resultado_t r;
+
+	if (Pts_Preparar(&Puntos) != true) {
+		printf("%-24s NO SE PUDO PREPARAR\n", nombre);
+		return false;
+	}
+	for (uint32_t latencia=0; latencia<=LATENCIA_MAXIMA; latencia++) {
+		simular(&Puntos, latencia, disparos, &r);
+		errores += r.subejecuciones + r.atrasos;
+		if (Instantes[0] != 1) distintos++;
+		for (uint32_t k=0; k+1<disparos; k++) {
+			uint32_t i = k % n;
+			if (Salida[k] != Valores[i] || Instantes[k + 1] - Instantes[k] != (uint64_t) Periodos[i] + 1) {
+				distintos++;
+			}
+		}
+	}
+
+	// Fin de cada punto contra la suma de lo pedido, en medios ciclos
+	uint64_t nanosegundos = 0;
+	for (uint32_t i=0; i<n; i++) {
+		nanosegundos += Duraciones[i];
+		int64_t doble = 2 * (int64_t) (Instantes[i + 1] - Instantes[0]);
+		int64_t ideal = (int64_t) ((2 * nanosegundos * RELOJ + 500000000) / 1000000000);
+		if (llabs(doble - ideal) > 1) deriva++;
+	}
+	if (Instantes[n] - Instantes[0] != Puntos.ciclos) deriva++;
+
+	// Pts_Restaurar deja la tabla como antes de preparar
+	Pts_Restaurar(&Puntos);
+	bool_t restaurada = (memcmp(Puntos.valores, Valores, n * sizeof(Valores[0])) == 0
+			             && memcmp(Puntos.periodos, Periodos, n * sizeof(Periodos[0])) == 0);
+
+	bool_t bien = (distintos == 0 && deriva == 0 && errores == 0 && restaurada);
+	printf("%-24s puntos=%5u ciclos=%12llu memoria=%6u uniforme=%12llu muestras  distintos=%u deriva=%u%s  %s\n",
+			nombre, n, (unsigned long long) Puntos.ciclos, n * 6,
+			(unsigned long long) Pts_Muestras_Uniformes(&Puntos), distintos, deriva,
+			restaurada ? "" : " NO RESTAURADA", bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/**
+  * @brief Con puntos de PTS_CICLOS_MINIMO ciclos, una latencia de más hace
+  *        que el ARR llegue tarde y el modelo lo detecta
+  */
+static bool_t verificarLatencia(void) {
+	resultado_t r;
+	Pts_Vaciar(&Puntos);
+	agregar(191, 100);
+	agregar(191, 200);
+	Pts_Preparar(&Puntos);
+	simular(&Puntos, LATENCIA_MAXIMA + 1, 100, &r);
+	bool_t detectado = (r.atrasos > 0);
+	printf("%-24s %s (atrasos=%u)\n", "latencia de 8 ciclos", detectado ? "detectada" : "NO DETECTADA (error)",
+			r.atrasos);
+	return detectado;
+}
+
+/**
+  * @brief Lo que Pts_Agregar, Pts_Interpretar y Pts_Preparar deben rechazar
+  */
+static bool_t verificarRechazos(void) {
+	bool_t bien = true, rechazado;
+
+	Pts_Vaciar(&Puntos);
+	rechazado = (Pts_Preparar(&Puntos) != true);
+	printf("%-24s %s\n", "tabla vacia", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Agregar(&Puntos, 1000, PTS_MAX_VALOR + 1, RELOJ) != true);
+	printf("%-24s %s\n", "valor de mas", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Agregar(&Puntos, 0, 0, RELOJ) != true);
+	printf("%-24s %s\n", "duracion cero", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Agregar(&Puntos, PTS_MAX_DURACION + 1, 0, RELOJ) != true);
+	printf("%-24s %s\n", "duracion de mas", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Agregar(&Puntos, 150, 0, RELOJ) != true);
+	printf("%-24s %s\n", "punto de 13 ciclos", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Interpretar("1000 5 2000 4096", &Puntos, RELOJ) != true && Puntos.cantidad == 0);
+	printf("%-24s %s\n", "texto con un par malo", rechazado ? "rechazado entero" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Pts_Interpretar("1000", &Puntos, RELOJ) != true && Pts_Interpretar("1000 5x", &Puntos, RELOJ) != true
+			     && Pts_Interpretar("", &Puntos, RELOJ) != true && Puntos.cantidad == 0);
+	printf("%-24s %s\n", "texto incompleto", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	bool_t aceptado = (Pts_Interpretar(" 1000 5  2000 4095 ", &Puntos, RELOJ) == true && Puntos.cantidad == 2
+			           && Puntos.periodos[0] == 83 && Puntos.periodos[1] == 167);
+	printf("%-24s %s\n", "texto valido", aceptado ? "aceptado" : "RECHAZADO (error)");
+	bien &= aceptado;
+
+	// Agregar con la tabla preparada la vuelve al orden natural
+	Pts_Preparar(&Puntos);
+	aceptado = (Pts_Agregar(&Puntos, 3000, 7, RELOJ) == true && Puntos.valores[0] == 5
+			    && Puntos.valores[1] == 4095 && Puntos.valores[2] == 7);
+	printf("%-24s %s\n", "agregar preparada", aceptado ? "en orden" : "DESORDENADA (error)");
+	bien &= aceptado;
+
+	while (Pts_Agregar(&Puntos, 1000, 0, RELOJ) == true) {
+		// Hasta llenarla
+	}
+	rechazado = (Puntos.cantidad == PTS_MAX_PUNTOS);
+	printf("%-24s %s\n", "tabla llena", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+	return bien;
+}
@@ -0,0 +1,228 @@
+/*******************************************************************************
+  * @file		retencion_bench.c
+  * @brief      Verificación y medición en la PC de la compensación de la
+  *             retención de orden cero (FIR inverso de sinc circular)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_compensacion.c del firmware y:
+  *  - lo compara bit a bit contra una convolución circular directa, con
+  *    largos cortos (menos muestras que taps), alrededor de ZOH_BLOQUE y
+  *    de 16384, y entradas que saturan;
+  *  - verifica que no hay bordes: compensar la tabla rotada da la tabla
+  *    compensada rotada;
+  *  - calcula la planicidad de sinc(f / fs) x H(f) hasta ZOH_BANDA y
+  *    contra la tabla del firmware (ZOH? la informa);
+  *  - mide el resultado completo: cuadrada de banda limitada de 105
+  *    muestras, salida del DAC con su retención, error de cada armónico;
+  *  - mide el tiempo por cada 1 K muestras. En el dispositivo, ZOH?
+  *    informa los ciclos medidos con el contador DWT.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o retencion_bench retencion_bench.c \
+  *               ../Drivers/API/Src/API_compensacion.c -lm
+  * Uso:       ./retencion_bench
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "API_compensacion.h"
+
+/* Defines privados ----------------------------------------------------------*/
+#define MAX_MUESTRAS	16384
+#define MUESTRAS_BENCH	(16 * 1024 * 1024)	// Muestras procesadas por medición
+#define PUNTOS_BANDA	20000				// Frecuencias evaluadas hasta ZOH_BANDA
+#define N_CUADRADA		105
+#define AMP_CUADRADA	1200.0				// Deja lugar al realce de los armónicos
+#define PI				3.14159265358979323846
+
+/* Variables privadas --------------------------------------------------------*/
+static const uint32_t Taps[] = { 3, 5, 7, 9 };
+static compensacion_t Comp;
+static uint16_t entrada[MAX_MUESTRAS];
+static uint16_t salida[MAX_MUESTRAS];
+static uint16_t esperada[MAX_MUESTRAS];
+static uint16_t rotada[MAX_MUESTRAS];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static double sinc(double f) {
+	return (f == 0.0) ? 1.0 : sin(PI * f) / (PI * f);
+}
+
+// Respuesta del FIR (fase cero) a f / fs
+static double respuesta(uint32_t taps, double f) {
+	const int16_t * h = Zoh_Coeficientes(taps);
+	double r = h[0];
+	for (uint32_t k=1; k<=taps/2; k++) r += 2.0 * h[k] * cos(2.0 * PI * k * f);
+	return r / (1 << ZOH_BITS);
+}
+
+// Peor desvío de sinc x H hasta ZOH_BANDA, en dB (taps 0: sin compensar)
+static double planicidad(uint32_t taps) {
+	double peor = 0.0;
+	for (uint32_t i=0; i<=PUNTOS_BANDA; i++) {
+		double f = ZOH_BANDA * 1e-3 * i / PUNTOS_BANDA;
+		double g = sinc(f) * ((taps == 0) ? 1.0 : respuesta(taps, f));
+		if (fabs(20.0 * log10(g)) > peor) peor = fabs(20.0 * log10(g));
+	}
+	return peor;
+}
+
+// Referencia: convolución circular directa, una muestra por vez
+static uint32_t referencia(uint32_t taps, const uint16_t * x, uint16_t * y, uint32_t largo) {
+	const int16_t * mitad = Zoh_Coeficientes(taps);
+	uint32_t m = taps / 2, saturadas = 0;
+	for (uint32_t n=0; n<largo; n++) {
+		int32_t acumulado = 1L << (ZOH_BITS - 1);
+		for (int32_t k=-(int32_t) m; k<=(int32_t) m; k++) {
+			int64_t i = ((int64_t) n + k) % (int64_t) largo;
+			if (i < 0) i += largo;
+			acumulado += mitad[abs(k)] * (int32_t) x[i];
+		}
+		int32_t v = acumulado >> ZOH_BITS;
+		int32_t z = (v < 0) ? 0 : (v > ZOH_MAX_DAC) ? ZOH_MAX_DAC : v;
+		saturadas += (z != v);
+		y[n] = (uint16_t) z;
+	}
+	return saturadas;
+}
+
+// Cuadrada de banda limitada: armónicos impares hasta el último bajo fs/2
+static void cuadrada(uint16_t * x, uint32_t largo) {
+	for (uint32_t n=0; n<largo; n++) {
+		double s = 0.0;
+		for (uint32_t k=1; 2*k<largo; k+=2) s += sin(2.0 * PI * k * n / largo) / k;
+		x[n] = (uint16_t) lround(2048.0 + AMP_CUADRADA * 4.0 / PI * s);
+	}
+}
+
+// Amplitud del armónico k de la tabla (DFT directa)
+static double armonico(const uint16_t * x, uint32_t largo, uint32_t k) {
+	double re = 0.0, im = 0.0;
+	for (uint32_t n=0; n<largo; n++) {
+		re += x[n] * cos(2.0 * PI * k * n / largo);
+		im -= x[n] * sin(2.0 * PI * k * n / largo);
+	}
+	return 2.0 * sqrt(re * re + im * im) / largo;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(void) {
+	static const uint32_t largos[] = { 1, 2, 3, 4, 5, 8, 9, 105, 255, 256, 257, 511, 513,
+			                           1000, 1024, 4099, MAX_MUESTRAS };
+	uint32_t errores = 0;
+
+	// 1) Bit a bit contra la referencia (ruido de 12 bits y extremos que saturan)
+	srand(1);
+	for (uint32_t t=0; t<sizeof(Taps)/sizeof(Taps[0]); t++) {
+		Zoh_Preparar(&Comp, Taps[t]);
+		for (uint32_t l=0; l<sizeof(largos)/sizeof(largos[0]); l++) {
+			for (uint32_t caso=0; caso<2; caso++) {
+				uint32_t n = largos[l];
+				for (uint32_t i=0; i<n; i++) {
+					entrada[i] = (caso == 0) ? (uint16_t) (rand() & 0x0FFF)
+							                 : ((i / 3) & 1) ? ZOH_MAX_DAC : 0;
+				}
+				uint32_t se = referencia(Taps[t], entrada, esperada, n);
+				memcpy(salida, entrada, n * sizeof(salida[0]));
+				uint32_t ss = Zoh_Compensar(&Comp, salida, n);
+				if (se != ss || memcmp(salida, esperada, n * sizeof(salida[0])) != 0) {
+					printf("ERROR: taps=%u N=%u caso=%u\n", (unsigned) Taps[t], (unsigned) n, (unsigned) caso);
+					errores++;
+				}
+			}
+		}
+	}
+	printf("verificacion: %s\n", errores ? "ERROR" : "bit a bit igual a la convolucion circular");
+
+	// 2) Sin bordes: la rotación conmuta con la compensación
+	uint32_t rotaciones = 0;
+	for (uint32_t t=0; t<sizeof(Taps)/sizeof(Taps[0]); t++) {
+		Zoh_Preparar(&Comp, Taps[t]);
+		for (uint32_t r=1; r<1000; r+=37) {
+			for (uint32_t i=0; i<1000; i++) entrada[i] = (uint16_t) (rand() & 0x0FFF);
+			for (uint32_t i=0; i<1000; i++) rotada[i] = entrada[(i + r) % 1000];
+			Zoh_Compensar(&Comp, entrada, 1000);
+			Zoh_Compensar(&Comp, rotada, 1000);
+			for (uint32_t i=0; i<1000; i++) {
+				if (rotada[i] != entrada[(i + r) % 1000]) { rotaciones++; break; }
+			}
+		}
+	}
+	printf("bordes: %s\n", rotaciones ? "ERROR" : "compensar y rotar conmutan (sin transitorios)");
+	errores += rotaciones;
+
+	// 3) Planicidad de la salida hasta ZOH_BANDA
+	printf("\nplanicidad de sinc x H hasta %.2f fs (dB)\n", ZOH_BANDA * 1e-3);
+	printf("%6s %10s %10s %12s %12s\n", "taps", "desvio", "firmware", "en fs/2", "suma |h|");
+	printf("%6s %10.3f %10.2f %12.3f %12s\n", "sin", planicidad(0), Zoh_Planicidad(0) * 0.01,
+			20.0 * log10(sinc(0.5)), "-");
+	for (uint32_t t=0; t<sizeof(Taps)/sizeof(Taps[0]); t++) {
+		const int16_t * h = Zoh_Coeficientes(Taps[t]);
+		int32_t suma = h[0], norma = abs(h[0]);
+		for (uint32_t k=1; k<=Taps[t]/2; k++) {
+			suma += 2 * h[k];
+			norma += 2 * abs(h[k]);
+		}
+		double p = planicidad(Taps[t]);
+		if ((uint32_t) ceil(p * 100.0) != Zoh_Planicidad(Taps[t]) || suma != (1 << ZOH_BITS)) {
+			printf("ERROR: la tabla del firmware no coincide (taps=%u)\n", (unsigned) Taps[t]);
+			errores++;
+		}
+		printf("%6u %10.3f %10.2f %12.3f %12.3f\n", (unsigned) Taps[t], p, Zoh_Planicidad(Taps[t]) * 0.01,
+				20.0 * log10(sinc(0.5) * respuesta(Taps[t], 0.5)), (double) norma / (1 << ZOH_BITS));
+	}
+
+	// 4) Cuadrada de N = 105: armónicos a la salida del DAC (tabla x sinc)
+	//    contra los de la tabla sin compensar, con el redondeo a 12 bits
+	cuadrada(entrada, N_CUADRADA);
+	uint32_t ultimo = (uint32_t) (ZOH_BANDA * 1e-3 * N_CUADRADA);
+	printf("\ncuadrada N=%u AMP=%.0f: error de los armonicos hasta k=%u a la salida del DAC (dB)\n",
+			N_CUADRADA, AMP_CUADRADA, (unsigned) ultimo);
+	printf("%6s %12s %12s %10s\n", "taps", "peor", "k=35", "saturadas");
+	for (uint32_t t=0; t<=sizeof(Taps)/sizeof(Taps[0]); t++) {
+		uint32_t taps = (t == 0) ? 0 : Taps[t - 1];
+		double peor = 0.0, k35 = 0.0;
+		memcpy(salida, entrada, N_CUADRADA * sizeof(salida[0]));
+		Zoh_Preparar(&Comp, taps);
+		uint32_t saturadas = Zoh_Compensar(&Comp, salida, N_CUADRADA);
+		for (uint32_t k=1; k<=ultimo; k+=2) {
+			double e = 20.0 * log10(armonico(salida, N_CUADRADA, k) * sinc((double) k / N_CUADRADA)
+					                / armonico(entrada, N_CUADRADA, k));
+			if (fabs(e) > fabs(peor)) peor = e;
+			if (k == 35) k35 = e;
+		}
+		char nombre[12] = "sin";
+		if (taps != 0) snprintf(nombre, sizeof(nombre), "%u", (unsigned) taps);
+		printf("%6s %12.3f %12.3f %10u\n", nombre, peor, k35, (unsigned) saturadas);
+	}
+
+	// 5) Costo por 1 K muestras
+	printf("\n%8s %6s %16s\n", "N", "taps", "ns / 1K muestras");
+	for (uint32_t i=0; i<MAX_MUESTRAS; i++) entrada[i] = (uint16_t) (rand() & 0x0FFF);
+	static const uint32_t largosBench[] = { N_CUADRADA, 1024, MAX_MUESTRAS };
+	for (uint32_t l=0; l<sizeof(largosBench)/sizeof(largosBench[0]); l++) {
+		for (uint32_t t=0; t<sizeof(Taps)/sizeof(Taps[0]); t++) {
+			uint32_t n = largosBench[l], vueltas = MUESTRAS_BENCH / n;
+			Zoh_Preparar(&Comp, Taps[t]);
+			double inicio = ahora();
+			for (uint32_t v=0; v<vueltas; v++) {
+				memcpy(salida, entrada, n * sizeof(salida[0]));
+				Zoh_Compensar(&Comp, salida, n);
+			}
+			double ns = (ahora() - inicio) * 1e9 / ((double) vueltas * n) * 1024.0;
+			printf("%8u %6u %16.0f\n", (unsigned) n, (unsigned) Taps[t], ns);
+		}
+	}
+	return errores != 0;
+}
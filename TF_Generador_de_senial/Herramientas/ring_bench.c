@@ -0,0 +1,237 @@
+/*******************************************************************************
+  * @file		ring_bench.c
+  * @brief      Prueba de carga y medición en la PC del buffer circular SPSC
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_ring.c del firmware (con __DMB() como barrera
+  * completa de C11) y lo usa desde dos hilos, productor y consumidor, en
+  * núcleos distintos: un caso más exigente que interrupción y lazo
+  * principal en un solo núcleo.
+  *  - Registros: el productor escribe registros numerados con una suma de
+  *    verificación; el consumidor comprueba que lleguen todos, una sola
+  *    vez, en orden y sin mezclar mitades de dos registros.
+  *  - Bytes: una secuencia pseudoaleatoria en tramos de largo al azar
+  *    (ringPutBytes / ringGetBytes, que copian en dos partes al dar la
+  *    vuelta) y byte a byte (ringPutByte / ringGetByte).
+  * Capacidad chica (16) para pasar seguido por lleno y vacío, e índices
+  * que arrancan cerca de 2^32 para cruzar el desborde de los contadores.
+  * Con el anillo lleno o vacío cada hilo cede el procesador (sched_yield),
+  * así la prueba también avanza en una máquina de un solo núcleo.
+  * Luego mide el costo por operación en un hilo (sin competencia) y
+  * entre dos hilos.
+  *
+  * Compilar:  cc -O2 -pthread -I../Drivers/API/Inc -o ring_bench ring_bench.c \
+  *               ../Drivers/API/Src/API_ring.c
+  * Uso:       ./ring_bench [millones de registros]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "API_ring.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define CAPACIDAD_PRUEBA	16
+#define CAPACIDAD_BENCH		256
+#define INDICE_INICIAL		(UINT32_MAX - 1000u)	// Los índices desbordan enseguida
+#define MAX_TRAMO			23						// Bytes por ringPutBytes / ringGetBytes
+#define OPERACIONES_BENCH	(20u * 1000u * 1000u)
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	uint32_t numero;
+	uint32_t inverso;			// ~numero
+	uint32_t mezcla;			// numero * constante impar
+} registro_t;
+
+typedef struct {
+	ring_t * r;
+	uint32_t cantidad;			// Registros o bytes a pasar
+	uint32_t tramos;			// 0: de a uno; 1: en tramos al azar
+	uint64_t perdidos, repetidos, desordenados, corruptos;
+} prueba_t;
+
+/* Variables -----------------------------------------------------------------*/
+static registro_t memoriaRegistros[CAPACIDAD_BENCH];
+static uint8_t memoriaBytes[CAPACIDAD_BENCH];
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static inline uint32_t xorshift(uint32_t * s) {
+	*s ^= *s << 13;
+	*s ^= *s >> 17;
+	*s ^= *s << 5;
+	return *s;
+}
+
+static void arrancarCercaDelDesborde(ring_t * r) {
+	r->cabeza = INDICE_INICIAL;
+	r->cola = INDICE_INICIAL;
+}
+
+// Registros -------------------------------------------------------------------
+static void * producirRegistros(void * arg) {
+	prueba_t * p = arg;
+	for (uint32_t n=0; n<p->cantidad; ) {
+		registro_t reg = { n, ~n, n * 2654435761u };
+		if (ringPut(p->r, &reg)) n++;
+		else sched_yield();
+	}
+	return NULL;
+}
+
+static void consumirRegistros(prueba_t * p) {
+	uint32_t esperado = 0;
+	registro_t reg;
+	while (esperado < p->cantidad) {
+		if (!ringGet(p->r, &reg)) { sched_yield(); continue; }
+		if (reg.inverso != ~reg.numero || reg.mezcla != reg.numero * 2654435761u) p->corruptos++;
+		if (reg.numero == esperado) esperado++;
+		else if (reg.numero > esperado) { p->perdidos += reg.numero - esperado; esperado = reg.numero + 1; }
+		else if (reg.numero + 1 == esperado) p->repetidos++;
+		else p->desordenados++;
+	}
+}
+
+// Bytes -----------------------------------------------------------------------
+static void * producirBytes(void * arg) {
+	prueba_t * p = arg;
+	uint32_t semilla = 12345, largo, estado = 1;
+	uint8_t datos[MAX_TRAMO];
+	for (uint32_t n=0; n<p->cantidad; ) {
+		if (!p->tramos) {
+			uint8_t b = (uint8_t) (xorshift(&estado) >> 24);
+			while (!ringPutByte(p->r, b)) sched_yield();
+			n++;
+			continue;
+		}
+		largo = 1 + xorshift(&semilla) % MAX_TRAMO;
+		if (largo > p->cantidad - n) largo = p->cantidad - n;
+		for (uint32_t k=0; k<largo; k++) datos[k] = (uint8_t) (xorshift(&estado) >> 24);
+		for (uint32_t hechos=0; hechos<largo; ) {
+			uint32_t puestos = ringPutBytes(p->r, datos + hechos, largo - hechos);
+			if (puestos == 0) sched_yield();
+			hechos += puestos;
+		}
+		n += largo;
+	}
+	return NULL;
+}
+
+static void consumirBytes(prueba_t * p) {
+	uint32_t semilla = 777, estado = 1;
+	uint8_t datos[MAX_TRAMO];
+	for (uint32_t n=0; n<p->cantidad; ) {
+		uint32_t leidos;
+		if (p->tramos) {
+			uint32_t pedido = 1 + xorshift(&semilla) % MAX_TRAMO;
+			leidos = ringGetBytes(p->r, datos, pedido);
+		} else {
+			leidos = ringGetByte(p->r, datos) ? 1 : 0;
+		}
+		if (leidos == 0) sched_yield();
+		for (uint32_t k=0; k<leidos; k++) {
+			if (datos[k] != (uint8_t) (xorshift(&estado) >> 24)) p->corruptos++;
+		}
+		n += leidos;
+	}
+	if (ringCount(p->r) != 0) p->repetidos += ringCount(p->r);
+}
+
+// Una prueba de dos hilos: el productor en otro hilo, el consumidor en éste
+static int probar(const char * nombre, ring_t * r, prueba_t * p, void * (*productor)(void *),
+		          void (*consumidor)(prueba_t *)) {
+	pthread_t hilo;
+	arrancarCercaDelDesborde(r);
+	p->r = r;
+	double inicio = ahora();
+	pthread_create(&hilo, NULL, productor, p);
+	consumidor(p);
+	pthread_join(hilo, NULL);
+	double segundos = ahora() - inicio;
+	int bien = (p->perdidos | p->repetidos | p->desordenados | p->corruptos) == 0 && ringCount(r) == 0;
+	printf("%-34s %10u %8llu %8llu %8llu %8llu %8.1f  %s\n", nombre, p->cantidad,
+		   (unsigned long long) p->perdidos, (unsigned long long) p->repetidos,
+		   (unsigned long long) p->desordenados, (unsigned long long) p->corruptos,
+		   segundos * 1e9 / p->cantidad, bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/* Programa ------------------------------------------------------------------*/
+int main(int argc, char * argv[]) {
+	uint32_t millones = (argc > 1) ? (uint32_t) atoi(argv[1]) : 5;
+	uint32_t cantidad = millones * 1000000u;
+	ring_t r;
+	int bien = 1;
+
+	printf("dos hilos, capacidad %u, indices desde 2^32 - 1001\n", CAPACIDAD_PRUEBA);
+	printf("%-34s %10s %8s %8s %8s %8s %8s\n", "prueba", "cantidad", "perdidos", "repetid.",
+		   "desorden", "corrupt.", "ns/op");
+
+	ringInit(&r, memoriaRegistros, CAPACIDAD_PRUEBA, sizeof(registro_t));
+	prueba_t a = { 0, cantidad, 0, 0, 0, 0, 0 };
+	bien &= probar("registros de 12 bytes", &r, &a, producirRegistros, consumirRegistros);
+
+	ringInit(&r, memoriaBytes, CAPACIDAD_PRUEBA, 1);
+	prueba_t b = { 0, cantidad, 1, 0, 0, 0, 0 };
+	bien &= probar("bytes en tramos de 1..23", &r, &b, producirBytes, consumirBytes);
+
+	ringInit(&r, memoriaBytes, CAPACIDAD_PRUEBA, 1);
+	prueba_t c = { 0, cantidad / 2, 0, 0, 0, 0, 0 };
+	bien &= probar("bytes de a uno", &r, &c, producirBytes, consumirBytes);
+
+	// Costo sin competencia: poner y sacar en el mismo hilo
+	printf("\nun hilo, capacidad %u: costo de poner + sacar\n", CAPACIDAD_BENCH);
+	volatile uint32_t sumidero = 0;
+	uint8_t byte = 0, bloque[64];
+	registro_t reg = { 1, ~1u, 3 };
+	double t0;
+
+	ringInit(&r, memoriaBytes, CAPACIDAD_BENCH, 1);
+	t0 = ahora();
+	for (uint32_t i=0; i<OPERACIONES_BENCH; i++) {
+		ringPutByte(&r, (uint8_t) i);
+		ringGetByte(&r, &byte);
+		sumidero += byte;
+	}
+	printf("%-34s %8.2f ns\n", "ringPutByte + ringGetByte", (ahora() - t0) * 1e9 / OPERACIONES_BENCH);
+
+	ringInit(&r, memoriaBytes, CAPACIDAD_BENCH, 1);
+	t0 = ahora();
+	for (uint32_t i=0; i<OPERACIONES_BENCH / 64; i++) {
+		ringPutBytes(&r, bloque, sizeof(bloque));
+		ringGetBytes(&r, bloque, sizeof(bloque));
+		sumidero += bloque[0];
+	}
+	printf("%-34s %8.2f ns por byte\n", "ringPutBytes + ringGetBytes (64)",
+		   (ahora() - t0) * 1e9 / (OPERACIONES_BENCH / 64 * 64));
+
+	ringInit(&r, memoriaRegistros, CAPACIDAD_BENCH, sizeof(registro_t));
+	t0 = ahora();
+	for (uint32_t i=0; i<OPERACIONES_BENCH; i++) {
+		reg.numero = i;
+		ringPut(&r, &reg);
+		ringGet(&r, &reg);
+		sumidero += reg.mezcla;
+	}
+	printf("%-34s %8.2f ns\n", "ringPut + ringGet (12 bytes)", (ahora() - t0) * 1e9 / OPERACIONES_BENCH);
+
+	// Entre dos hilos, con lugar de sobra: el costo lo pone la coherencia de caché
+	ringInit(&r, memoriaRegistros, CAPACIDAD_BENCH, sizeof(registro_t));
+	prueba_t d = { 0, OPERACIONES_BENCH, 0, 0, 0, 0, 0 };
+	printf("\ndos hilos, capacidad %u\n", CAPACIDAD_BENCH);
+	bien &= probar("registros de 12 bytes", &r, &d, producirRegistros, consumirRegistros);
+
+	(void) sumidero;
+	return bien ? 0 : 1;
+}
@@ -0,0 +1,284 @@
+/*******************************************************************************
+  * @file		secuencia_sim.c
+  * @brief      Simulación en la PC de las secuencias de segmentos (SEQ)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Compila el mismo API_secuencia.c del firmware y lo recorre con un modelo
+  * del DMA en doble buffer: dos memorias de un gránulo, el DAC lee la
+  * activa, al completarla pasa a la otra (CT) y la interrupción, que entra
+  * unas muestras después, apunta la memoria libre al gránulo siguiente.
+  * La salida se compara muestra a muestra contra una secuencia de
+  * referencia escrita de nuevo, de a una muestra (sin gránulos):
+  *  - repeticiones, segmentos INF, vuelta al primero y cantidad de vueltas,
+  *  - NEXT en momentos al azar (sale al terminar la pasada en curso),
+  *  - demoras de la interrupción al azar, hasta un gránulo menos una
+  *    muestra; con un gránulo entero el modelo debe detectar el atraso (en
+  *    el DMA es un error de transferencia),
+  *  - los rechazos (MCD menor que SEQ_GRANULO_MINIMO, largo cero, lista
+  *    llena, repeticiones de más, secuencia vacía),
+  * y mide el tiempo de Seq_Siguiente(). En el dispositivo, SEQ? informa la
+  * respuesta medida de la interrupción y la fs máxima que resulta.
+  *
+  * Compilar:  cc -O2 -I../Drivers/API/Inc -o secuencia_sim secuencia_sim.c \
+  *               ../Drivers/API/Src/API_secuencia.c
+  * Uso:       ./secuencia_sim
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "API_secuencia.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define MEMORIA			65536		// Muestras para los segmentos de un caso
+#define MAX_MUESTRAS	400000		// Salida simulada por caso
+#define MAX_AVANCES		8
+#define SIN_DEMORA		0xFFFFFFFF	// Demora al azar, hasta un gránulo - 1
+
+/* Tipos ---------------------------------------------------------------------*/
+typedef struct {
+	uint32_t largo;
+	uint32_t repeticiones;			// SEQ_INFINITO: para siempre
+} definicion_t;
+
+typedef struct {
+	const char * nombre;
+	definicion_t segmentos[SEQ_MAX_SEGMENTOS];
+	uint32_t cantidad;
+	uint32_t muestras;				// A simular
+	uint32_t demora;				// Muestras entre el cambio de memoria y la
+									// interrupción, o SIN_DEMORA (al azar)
+	uint32_t avances[MAX_AVANCES];	// Muestras de salida en que llega un NEXT
+	uint32_t cantidadAvances;
+} caso_t;
+
+typedef struct {
+	uint32_t segmento;
+	uint32_t posicion;
+	uint32_t pasada;				// Pasadas hechas del segmento en curso
+	uint32_t vueltas;
+	bool_t avanzar;
+} referencia_t;
+
+/* Casos ---------------------------------------------------------------------*/
+#define INF		SEQ_INFINITO
+
+static const caso_t Casos[] = {
+	{ "A x10, B x1, C INF",   { {64, 10}, {192, 1}, {128, INF} },             3, 200000, SIN_DEMORA, {0}, 0 },
+	{ "vuelta al primero",    { {48, 3}, {80, 1}, {112, 2} },                 3, 100000, SIN_DEMORA, {0}, 0 },
+	{ "granulo = segmento",   { {16, INF} },                                  1,  10000, SIN_DEMORA, {0}, 0 },
+	{ "granulo de 8192",      { {8192, 2}, {16384, 1} },                      2, 400000, SIN_DEMORA, {0}, 0 },
+	{ "NEXT desde INF",       { {64, INF}, {128, INF}, {32, 5} },             3, 100000, SIN_DEMORA,
+	                          { 1000, 1001, 5000, 20000, 20010, 60000 }, 6 },
+	{ "NEXT con repeticiones",{ {96, 1000}, {160, 2} },                       2, 100000, SIN_DEMORA,
+	                          { 33, 7000, 50000, 50100 }, 4 },
+	{ "NEXT en el borde",     { {32, INF}, {32, INF} },                       2,   5000, 0,
+	                          { 31, 32, 95, 160, 161 }, 5 },
+	{ "16 segmentos",         { {16, 1}, {32, 2}, {48, 3}, {64, 4}, {80, 5}, {96, 6}, {112, 7}, {128, 8},
+	                            {144, 1}, {160, 2}, {176, 3}, {192, 4}, {208, 5}, {224, 6}, {240, 7},
+	                            {256, INF} },                                16, 300000, SIN_DEMORA, {0}, 0 },
+	{ "demora al limite",     { {64, 3}, {128, 2} },                          2, 100000, 63,         {0}, 0 },
+};
+
+/* Variables -----------------------------------------------------------------*/
+static uint16_t Memoria[MEMORIA];
+static uint16_t Salida[MAX_MUESTRAS];
+static secuencia_t Secuencia;
+
+/* Prototipos ----------------------------------------------------------------*/
+static bool_t armar(const caso_t * c);
+static bool_t simularDMA(const caso_t * c, uint16_t * salida, uint32_t * entregadas, uint32_t demora);
+static bool_t verificar(const caso_t * c);
+static bool_t verificarAtraso(void);
+static bool_t verificarRechazos(void);
+static void medir(void);
+
+/* Programa ------------------------------------------------------------------*/
+int main(void) {
+	bool_t bien = true;
+
+	srand(1);
+	for (uint32_t i=0; i<sizeof(Casos)/sizeof(Casos[0]); i++) bien &= verificar(&Casos[i]);
+	bien &= verificarAtraso();
+	bien &= verificarRechazos();
+	medir();
+
+	printf(bien ? "\nTodo bien.\n" : "\nHAY ERRORES.\n");
+	return bien ? 0 : 1;
+}
+
+/* Funciones -----------------------------------------------------------------*/
+
+/**
+  * @brief Llena los segmentos (cada muestra identifica segmento y posición)
+  *        y prepara la secuencia con el MCD de los largos
+  */
+static bool_t armar(const caso_t * c) {
+	uint32_t usado = 0;
+	Seq_Vaciar(&Secuencia);
+	for (uint32_t i=0; i<c->cantidad; i++) {
+		const definicion_t * d = &c->segmentos[i];
+		if (usado + d->largo > MEMORIA) return false;
+		for (uint32_t n=0; n<d->largo; n++) Memoria[usado + n] = (uint16_t) ((i << 12) | (n & 0x0FFF));
+		if (Seq_Agregar(&Secuencia, Memoria + usado, d->largo, d->repeticiones) != true) return false;
+		usado += d->largo;
+	}
+	return Seq_Preparar(&Secuencia, Seq_Granulo(&Secuencia));
+}
+
+/**
+  * @brief Modelo del DMA en doble buffer. Antes de la primera muestra las
+  *        dos memorias tienen los dos primeros gránulos; al completar una
+  *        memoria el DAC sigue con la otra y la interrupción entra 'demora'
+  *        muestras después a escribir la libre. Si para el próximo cambio
+  *        la interrupción no entró, se atrasó.
+  * @param entregadas: muestras entregadas por la secuencia en cada NEXT
+  * @retval false si la interrupción se atrasó
+  */
+static bool_t simularDMA(const caso_t * c, uint16_t * salida, uint32_t * entregadas, uint32_t demora) {
+	uint32_t g = Secuencia.granulo;
+	const uint16_t * memoria[2];
+	memoria[0] = Seq_Siguiente(&Secuencia);
+	memoria[1] = Seq_Siguiente(&Secuencia);
+	uint32_t ct = 0, posicion = 0, avance = 0;
+	uint32_t entregado = 2 * g;
+	bool_t pendiente = false;
+	uint32_t instante = 0;
+
+	for (uint32_t t=0; t<c->muestras; t++) {
+		if (avance < c->cantidadAvances && c->avances[avance] == t) {
+			Seq_Avanzar(&Secuencia);
+			entregadas[avance++] = entregado;
+		}
+		if (pendiente && t == instante) {
+			memoria[ct ^ 1] = Seq_Siguiente(&Secuencia);
+			entregado += g;
+			pendiente = false;
+		}
+		salida[t] = memoria[ct][posicion];
+		if (++posicion == g) {
+			if (pendiente) return false;
+			posicion = 0;
+			ct ^= 1;
+			pendiente = true;
+			instante = t + 1 + ((demora == SIN_DEMORA) ? (uint32_t) rand() % g : demora);
+		}
+	}
+	return true;
+}
+
+/**
+  * @brief Compara contra la referencia, que recorre los segmentos de a una
+  *        muestra. Un NEXT pedido cuando la secuencia había entregado E
+  *        muestras se marca en la referencia al llegar a la muestra E.
+  */
+static bool_t verificar(const caso_t * c) {
+	static uint32_t entregadas[MAX_AVANCES];
+	if (armar(c) != true) {
+		printf("%-24s RECHAZADO (error)\n", c->nombre);
+		return false;
+	}
+	uint32_t g = Secuencia.granulo;
+	bool_t aTiempo = simularDMA(c, Salida, entregadas, c->demora);
+
+	referencia_t r = { 0, 0, 0, 0, false };
+	uint32_t distintas = 0, primera = 0, avance = 0;
+	for (uint32_t t=0; t<c->muestras; t++) {
+		while (avance < c->cantidadAvances && entregadas[avance] == t) {
+			r.avanzar = true;			// Dos NEXT en el mismo gránulo valen uno
+			avance++;
+		}
+		const definicion_t * d = &c->segmentos[r.segmento];
+		uint16_t esperada = (uint16_t) ((r.segmento << 12) | (r.posicion & 0x0FFF));
+		if (Salida[t] != esperada && distintas++ == 0) primera = t;
+		if (++r.posicion < d->largo) continue;
+		r.posicion = 0;
+		r.pasada++;
+		bool_t sigue = !r.avanzar && (d->repeticiones == SEQ_INFINITO || r.pasada < d->repeticiones);
+		r.avanzar = false;
+		if (sigue) continue;
+		r.pasada = 0;
+		if (++r.segmento == c->cantidad) {
+			r.segmento = 0;
+			r.vueltas++;
+		}
+	}
+
+	// La secuencia va dos gránulos adelante de la salida: sus vueltas pueden
+	// ser una más que las de la referencia
+	bool_t vueltas = (Secuencia.vueltas == r.vueltas || Secuencia.vueltas == r.vueltas + 1);
+	bool_t bien = aTiempo && distintas == 0 && vueltas;
+	printf("%-24s granulo=%5u muestras=%6u vueltas=%3u distintas=%u", c->nombre, g, c->muestras,
+			r.vueltas, distintas);
+	if (distintas > 0) printf(" (desde %u)", primera);
+	if (!aTiempo) printf(" ATRASO");
+	printf("  %s\n", bien ? "ok" : "ERROR");
+	return bien;
+}
+
+/**
+  * @brief Con la interrupción un gránulo entero tarde el modelo lo detecta
+  */
+static bool_t verificarAtraso(void) {
+	static uint32_t entregadas[MAX_AVANCES];
+	const caso_t c = { "atraso", { {64, INF} }, 1, 1000, 64, {0}, 0 };
+	bool_t detectado = (armar(&c) == true && simularDMA(&c, Salida, entregadas, c.demora) != true);
+	printf("%-24s %s\n", "demora de un granulo", detectado ? "detectado" : "NO DETECTADO (error)");
+	return detectado;
+}
+
+/**
+  * @brief Lo que Seq_Agregar y Seq_Preparar deben rechazar
+  */
+static bool_t verificarRechazos(void) {
+	bool_t bien = true, rechazado;
+
+	Seq_Vaciar(&Secuencia);
+	rechazado = (Seq_Preparar(&Secuencia, SEQ_GRANULO_MINIMO) != true);
+	printf("%-24s %s\n", "secuencia vacia", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	Seq_Agregar(&Secuencia, Memoria, 100, 1);
+	Seq_Agregar(&Secuencia, Memoria, 128, 1);
+	rechazado = (Seq_Preparar(&Secuencia, Seq_Granulo(&Secuencia)) != true);
+	printf("%-24s %s (MCD=%u)\n", "MCD menor que el minimo", rechazado ? "rechazado" : "ACEPTADO (error)",
+			Seq_Granulo(&Secuencia));
+	bien &= rechazado;
+
+	rechazado = (Seq_Preparar(&Secuencia, 32) != true);
+	printf("%-24s %s\n", "granulo que no divide", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	Seq_Vaciar(&Secuencia);
+	rechazado = (Seq_Agregar(&Secuencia, Memoria, 0, 1) != true);
+	printf("%-24s %s\n", "largo cero", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	rechazado = (Seq_Agregar(&Secuencia, Memoria, 16, SEQ_MAX_REPETICIONES + 1) != true);
+	printf("%-24s %s\n", "repeticiones de mas", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+
+	for (uint32_t i=0; i<SEQ_MAX_SEGMENTOS; i++) Seq_Agregar(&Secuencia, Memoria, 16, 1);
+	rechazado = (Seq_Agregar(&Secuencia, Memoria, 16, 1) != true);
+	printf("%-24s %s\n", "lista llena", rechazado ? "rechazado" : "ACEPTADO (error)");
+	bien &= rechazado;
+	return bien;
+}
+
+/**
+  * @brief Tiempo de Seq_Siguiente() con gránulos del mínimo, que cambian de
+  *        segmento y de pasada lo más seguido posible
+  */
+static void medir(void) {
+	const caso_t c = { "medicion", { {16, 1}, {32, 3}, {16, 2} }, 3, 0, 0, {0}, 0 };
+	if (armar(&c) != true) return;
+	uint32_t llamadas = 100000000;
+	uintptr_t suma = 0;
+	clock_t inicio = clock();
+	for (uint32_t i=0; i<llamadas; i++) suma += (uintptr_t) Seq_Siguiente(&Secuencia);
+	double ns = 1e9 * (double) (clock() - inicio) / CLOCKS_PER_SEC / llamadas;
+	printf("\nSeq_Siguiente (PC): %.2f ns por granulo (%u)\n", ns, (unsigned) (suma & 1));
+}
@@ -0,0 +1,197 @@
+/*******************************************************************************
+  * @file		stream_cliente.c
+  * @brief      Cliente de streaming para el generador (lado PC, POSIX)
+  * @author		Guillermo F. Caporaletti <gfcaporaletti@undav.edu.ar>
+  ******************************************************************************
+  * Envía al generador las muestras de un archivo (números separados por coma,
+  * como los de la carpeta Seniales) respetando los créditos que devuelve el
+  * dispositivo, y mide la tasa sostenida.
+  *
+  * Compilar:  cc -O2 -o stream_cliente stream_cliente.c
+  * Uso:       ./stream_cliente <puerto> <baudios> <periodo> <archivo> [repeticiones]
+  * Ejemplo:   ./stream_cliente /dev/ttyACM0 9600 209999 ../Seniales/senoidal.txt 20
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+/* Defines privados ----------------------------------------------------------*/
+#define BYTE_CREDITO	0x11		// Igual que STREAM_BYTE_CREDITO
+#define MUESTRA_FIN		0xFFFF		// Igual que STREAM_FIN
+#define MAX_MUESTRAS	65536
+#define LARGO_LINEA		128
+
+/* Variables privadas --------------------------------------------------------*/
+static int puerto;
+static char linea[LARGO_LINEA];		// Texto recibido del dispositivo
+static int lineaPos = 0;
+
+/* Funciones privadas --------------------------------------------------------*/
+
+static double ahora(void) {
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+static speed_t velocidad(long baudios) {
+	switch (baudios) {
+	case 9600:   return B9600;
+	case 19200:  return B19200;
+	case 38400:  return B38400;
+	case 57600:  return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	default:     return 0;
+	}
+}
+
+static int abrirPuerto(const char * nombre, long baudios) {
+	struct termios tio;
+	int fd = open(nombre, O_RDWR | O_NOCTTY);
+	if (fd < 0) return -1;
+	if (tcgetattr(fd, &tio) != 0) return -1;
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, velocidad(baudios));
+	cfsetospeed(&tio, velocidad(baudios));
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tio) != 0) return -1;
+	tcflush(fd, TCIOFLUSH);
+	return fd;
+}
+
+/*
+ * Lee lo que haya llegado (espera hasta 'espera_ms'). Devuelve la cantidad de
+ * créditos recibidos. Las líneas de texto se muestran por stderr; si una
+ * empieza con 'prefijo' se copia en 'encontrada'.
+ */
+static int atenderEntrada(int espera_ms, const char * prefijo, char * encontrada) {
+	fd_set lectura;
+	struct timeval t = { espera_ms / 1000, (espera_ms % 1000) * 1000 };
+	uint8_t rx[256];
+	int creditos = 0;
+
+	FD_ZERO(&lectura);
+	FD_SET(puerto, &lectura);
+	if (select(puerto + 1, &lectura, NULL, NULL, &t) <= 0) return 0;
+
+	ssize_t n = read(puerto, rx, sizeof(rx));
+	for (ssize_t i = 0; i < n; i++) {
+		if (rx[i] == BYTE_CREDITO) {
+			creditos++;
+		} else if (rx[i] == '\n' || rx[i] == '\r') {
+			if (lineaPos == 0) continue;
+			linea[lineaPos] = '\0';
+			lineaPos = 0;
+			fprintf(stderr, "< %s\n", linea);
+			if (prefijo != NULL && strncmp(linea, prefijo, strlen(prefijo)) == 0)
+				strcpy(encontrada, linea);
+		} else if (lineaPos < LARGO_LINEA - 1) {
+			linea[lineaPos++] = (char) rx[i];
+		}
+	}
+	return creditos;
+}
+
+static int esperarLinea(const char * prefijo, char * encontrada, int espera_ms) {
+	encontrada[0] = '\0';
+	double limite = ahora() + espera_ms / 1000.0;
+	while (encontrada[0] == '\0' && ahora() < limite) atenderEntrada(50, prefijo, encontrada);
+	return encontrada[0] != '\0';
+}
+
+static long leerArchivo(const char * nombre, uint16_t * muestras) {
+	FILE * f = fopen(nombre, "r");
+	long n = 0;
+	int c, enNumero = 0;
+	unsigned valor = 0;
+	if (f == NULL) return -1;
+	while ((c = fgetc(f)) != EOF && n < MAX_MUESTRAS) {
+		if (c >= '0' && c <= '9') {
+			valor = valor * 10 + (unsigned) (c - '0');
+			enNumero = 1;
+		} else if (enNumero) {
+			muestras[n++] = (uint16_t) (valor > 0x0FFF ? 0x0FFF : valor);
+			valor = 0;
+			enNumero = 0;
+		}
+	}
+	if (enNumero && n < MAX_MUESTRAS) muestras[n++] = (uint16_t) valor;
+	fclose(f);
+	return n;
+}
+
+/* Programa principal --------------------------------------------------------*/
+
+int main(int argc, char * argv[]) {
+	static uint16_t muestras[MAX_MUESTRAS];
+	char respuesta[LARGO_LINEA];
+	char comando[48];
+	unsigned capacidad, bloque;
+
+	if (argc < 5) {
+		fprintf(stderr, "Uso: %s <puerto> <baudios> <periodo> <archivo> [repeticiones]\n", argv[0]);
+		return 1;
+	}
+	long baudios = atol(argv[2]);
+	long periodo = atol(argv[3]);
+	long repeticiones = (argc > 5) ? atol(argv[5]) : 1;
+	long largo = leerArchivo(argv[4], muestras);
+	if (largo <= 0) { fprintf(stderr, "No se pudo leer %s\n", argv[4]); return 1; }
+	if (velocidad(baudios) == 0) { fprintf(stderr, "Baudios no soportados\n"); return 1; }
+
+	puerto = abrirPuerto(argv[1], baudios);
+	if (puerto < 0) { perror(argv[1]); return 1; }
+
+	// El generador debe estar en Recibiendo o Cargado
+	snprintf(comando, sizeof(comando), "STREAM %ld\n", periodo);
+	if (write(puerto, comando, strlen(comando)) < 0) { perror("write"); return 1; }
+	if (!esperarLinea("STREAM ", respuesta, 3000) ||
+		sscanf(respuesta, "STREAM %u %u", &capacidad, &bloque) != 2) {
+		fprintf(stderr, "El generador no respondio al comando STREAM\n");
+		return 1;
+	}
+
+	// Envío con control de flujo por créditos
+	long total = largo * repeticiones;
+	long enviadas = 0;
+	long disponibles = capacidad;
+	double inicio = ahora();
+	while (enviadas < total) {
+		uint8_t tx[2 * 64];
+		int n = 0;
+		while (disponibles > 0 && enviadas < total && n < (int) sizeof(tx)) {
+			uint16_t m = muestras[enviadas % largo];
+			tx[n++] = (uint8_t) (m & 0xFF);
+			tx[n++] = (uint8_t) (m >> 8);
+			enviadas++;
+			disponibles--;
+		}
+		if (n > 0 && write(puerto, tx, (size_t) n) < 0) { perror("write"); return 1; }
+		disponibles += (long) bloque * atenderEntrada(n > 0 ? 0 : 100, NULL, NULL);
+	}
+	uint8_t fin[2] = { MUESTRA_FIN & 0xFF, MUESTRA_FIN >> 8 };
+	if (write(puerto, fin, 2) < 0) { perror("write"); return 1; }
+	tcdrain(puerto);
+	double duracion = ahora() - inicio;
+
+	// Informe del dispositivo y del cliente
+	esperarLinea("FIN STREAM", respuesta, 10000 + (int) (capacidad * (periodo + 1.0) / 84000.0));
+	printf("muestras=%ld segundos=%.3f tasa=%.1f muestras/s limite_enlace=%.1f muestras/s\n",
+		   total, duracion, total / duracion, baudios / 20.0);
+	if (respuesta[0] != '\0') printf("%s\n", respuesta);
+
+	close(puerto);
+	return 0;
+}